@@ -0,0 +1,60 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+
+uint32_t AnimationClip::AddTarget(Transform* target)
+{
+	auto it = std::find(m_Targets.begin(), m_Targets.end(), target);
+	if (it != m_Targets.end())
+	{
+		return static_cast<uint32_t>(it - m_Targets.begin());
+	}
+
+	m_Targets.push_back(target);
+	return static_cast<uint32_t>(m_Targets.size() - 1);
+}
+
+uint32_t AnimationClip::AddWeightTarget(MeshDeformer* target)
+{
+	auto it = std::find(m_WeightTargets.begin(), m_WeightTargets.end(), target);
+	if (it != m_WeightTargets.end())
+	{
+		return static_cast<uint32_t>(it - m_WeightTargets.begin());
+	}
+
+	m_WeightTargets.push_back(target);
+	return static_cast<uint32_t>(m_WeightTargets.size() - 1);
+}
+
+void AnimationClip::AddChannel(uint32_t target, AnimationPath path, AnimationInterpolation interpolation, const float* times, uint32_t keyCount,
+	const float* values, uint32_t componentCount)
+{
+	if (keyCount == 0)
+	{
+		return;
+	}
+
+	AnimationChannel channel;
+	channel.target = target;
+	channel.path = path;
+	channel.interpolation = interpolation;
+	channel.firstKey = static_cast<uint32_t>(m_Times.size());
+	channel.keyCount = keyCount;
+	channel.componentCount = componentCount;
+	channel.firstValue = static_cast<uint32_t>(m_Values.size());
+
+	const size_t valueCount = static_cast<size_t>(keyCount) * componentCount * (interpolation == AnimationInterpolation::CubicSpline ? 3 : 1);
+	m_Times.insert(m_Times.end(), times, times + keyCount);
+	m_Values.insert(m_Values.end(), values, values + valueCount);
+	m_Channels.push_back(channel);
+
+	m_Duration = std::max(m_Duration, times[keyCount - 1]);
+}
+
+void AnimationClip::Finalize()
+{
+	std::stable_sort(m_Channels.begin(), m_Channels.end(), [](const AnimationChannel& a, const AnimationChannel& b)
+		{
+			return a.path < b.path;
+		});
+}
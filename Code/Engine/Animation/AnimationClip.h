@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Transform;
+class MeshDeformer;
+
+/**
+ * @brief Transform property a channel animates
+ */
+enum class AnimationPath : uint8_t
+{
+	Translation,
+	Rotation,
+	Scale,
+	Weights
+};
+
+enum class AnimationInterpolation : uint8_t
+{
+	Linear,
+	Step,
+	/// Every key stores in-tangent, value and out-tangent
+	CubicSpline
+};
+
+/**
+ * @brief One animated property of one target, its keys are ranges of the clip arrays
+ */
+struct AnimationChannel
+{
+	/// Index into the targets, or into the weight targets for weight channels
+	uint32_t target = 0;
+	AnimationPath path = AnimationPath::Translation;
+	AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+
+	uint32_t firstKey = 0;
+	uint32_t keyCount = 0;
+
+	/// Floats per value: 3 for translation and scale, 4 for rotation (x, y, z, w), the target count for weights
+	uint32_t componentCount = 0;
+	uint32_t firstValue = 0;
+};
+
+/**
+ * @brief Keyframe data of an animation in structure of arrays form
+ * The key times of all channels share one array and the values another, every channel owns a contiguous range
+ * of both. Channels are sorted by path so a sampler walks long runs of the same kind.
+ */
+class AnimationClip
+{
+public:
+	AnimationClip(const std::string& name) : m_Name(name) {}
+
+	inline const std::string& GetName() const { return m_Name; }
+
+	/**
+	 * @brief Time of the last key of any channel, in seconds
+	 */
+	inline float GetDuration() const { return m_Duration; }
+
+	inline const std::vector<AnimationChannel>& GetChannels() const { return m_Channels; }
+	inline const std::vector<Transform*>& GetTargets() const { return m_Targets; }
+	inline const std::vector<MeshDeformer*>& GetWeightTargets() const { return m_WeightTargets; }
+
+	inline const float* GetTimes(const AnimationChannel& channel) const { return m_Times.data() + channel.firstKey; }
+	inline const float* GetValues(const AnimationChannel& channel) const { return m_Values.data() + channel.firstValue; }
+
+	/**
+	 * @brief Bytes of keys and channels
+	 */
+	inline size_t GetByteSize() const { return (m_Times.size() + m_Values.size()) * sizeof(float) + m_Channels.size() * sizeof(AnimationChannel); }
+
+	/**
+	 * @brief Index of target in the target list, added when it is not there yet
+	 */
+	uint32_t AddTarget(Transform* target);
+
+	/**
+	 * @brief Index of the morph weights owner in the weight target list, added when it is not there yet
+	 */
+	uint32_t AddWeightTarget(MeshDeformer* target);
+
+	/**
+	 * @brief Appends a channel, times are ascending seconds and values hold keyCount (x3 for cubic spline) values
+	 */
+	void AddChannel(uint32_t target, AnimationPath path, AnimationInterpolation interpolation, const float* times, uint32_t keyCount,
+		const float* values, uint32_t componentCount);
+
+	/**
+	 * @brief Sorts the channels by path, call after the last AddChannel
+	 */
+	void Finalize();
+
+private:
+	std::string m_Name;
+	float m_Duration{ 0.0f };
+
+	std::vector<float> m_Times;
+	std::vector<float> m_Values;
+	std::vector<AnimationChannel> m_Channels;
+	std::vector<Transform*> m_Targets;
+	std::vector<MeshDeformer*> m_WeightTargets;
+};
@@ -0,0 +1,688 @@
+#include "AnimationSampler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#include "Animation/AnimationClip.h"
+#include "Animation/CompressedClip.h"
+#include "Animation/MeshDeformer.h"
+#include "Framework/JobSystem.h"
+#include "Scene/Transform.h"
+
+#if WL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if WL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+// Channels blended together, the SoA lanes of one batch stay in L1
+static const uint32_t kBatchSize = 64;
+// Channels per job of SampleParallel
+static const uint32_t kParallelBatchSize = 512;
+// Keys a cursor steps forward before it falls back to a binary search
+static const uint32_t kCursorSteps = 4;
+
+static std::atomic<uint32_t> s_SimdLevelCap{ static_cast<uint32_t>(SimdLevel::AVX2) };
+
+/**
+ * @brief Cursors a state needs, a compressed clip also samples the channels it left uncompressed
+ */
+inline uint32_t GetCursorCount(const AnimationState& state)
+{
+	if (state.compressedClip)
+	{
+		const std::shared_ptr<const AnimationClip>& uncompressed = state.compressedClip->GetUncompressed();
+		return static_cast<uint32_t>(state.compressedClip->GetChannels().size() + (uncompressed ? uncompressed->GetChannels().size() : 0));
+	}
+
+	return state.clip ? static_cast<uint32_t>(state.clip->GetChannels().size()) : 0;
+}
+
+AnimationState::AnimationState(std::shared_ptr<const AnimationClip> clip)
+	: clip(std::move(clip))
+{
+	cursors.resize(GetCursorCount(*this), 0);
+}
+
+AnimationState::AnimationState(std::shared_ptr<const CompressedClip> clip)
+	: compressedClip(std::move(clip))
+{
+	cursors.resize(GetCursorCount(*this), 0);
+}
+
+float AnimationState::GetDuration() const
+{
+	if (compressedClip)
+	{
+		return compressedClip->GetDuration();
+	}
+
+	return clip ? clip->GetDuration() : 0.0f;
+}
+
+void AnimationState::Advance(float deltaTime)
+{
+	const float duration = GetDuration();
+
+	time += deltaTime * speed;
+	if (loop && duration > 0.0f)
+	{
+		time = std::fmod(time, duration);
+		time = time < 0.0f ? time + duration : time;
+	}
+	else
+	{
+		time = std::min(std::max(time, 0.0f), duration);
+	}
+}
+
+/**
+ * @brief Two keys and a blend factor per lane, blended in place into a
+ */
+struct SampleBatch
+{
+	alignas(32) float a[4][kBatchSize];
+	alignas(32) float b[4][kBatchSize];
+	alignas(32) float t[kBatchSize];
+
+	Transform* targets[kBatchSize];
+	AnimationPath paths[kBatchSize];
+	uint32_t count = 0;
+};
+
+/**
+ * @brief Last key at or before time, starting the search at the cursor of the previous sample
+ */
+template<typename T>
+inline uint32_t FindKey(const T* times, uint32_t keyCount, float time, uint32_t& cursor)
+{
+	uint32_t key = cursor < keyCount ? cursor : 0;
+	if (times[key] > time)
+	{
+		// Looped or scrubbed backwards
+		key = 0;
+	}
+
+	uint32_t steps = 0;
+	while (key + 1 < keyCount && times[key + 1] <= time)
+	{
+		if (++steps > kCursorSteps)
+		{
+			key = static_cast<uint32_t>(std::upper_bound(times + key, times + keyCount, time) - times) - 1;
+			break;
+		}
+		++key;
+	}
+
+	cursor = key;
+	return key;
+}
+
+// Scalar, also the tail of the SIMD paths
+
+static void LerpScalar(SampleBatch& batch, uint32_t begin, uint32_t end)
+{
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			batch.a[c][i] = batch.a[c][i] + (batch.b[c][i] - batch.a[c][i]) * batch.t[i];
+		}
+	}
+}
+
+/**
+ * @brief nlerp with the blend factor corrected towards slerp, see "Approximating slerp" by A. Kapoulkine
+ */
+static void SlerpScalar(SampleBatch& batch, uint32_t begin, uint32_t end)
+{
+	for (uint32_t i = begin; i < end; ++i)
+	{
+		float a[4] = { batch.a[0][i], batch.a[1][i], batch.a[2][i], batch.a[3][i] };
+		float b[4] = { batch.b[0][i], batch.b[1][i], batch.b[2][i], batch.b[3][i] };
+		const float t = batch.t[i];
+
+		float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		if (std::signbit(d))
+		{
+			for (uint32_t c = 0; c < 4; ++c)
+			{
+				b[c] = -b[c];
+			}
+			d = -d;
+		}
+
+		const float A = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+		const float B = 0.848013f + d * (-1.06021f + d * 0.215638f);
+		const float h = t - 0.5f;
+		const float k = A * h * h + B;
+		const float ot = t + t * h * (t - 1.0f) * k;
+
+		float r[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			r[c] = a[c] + (b[c] - a[c]) * ot;
+		}
+
+		const float length = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3]);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			batch.a[c][i] = r[c] / length;
+		}
+	}
+}
+
+#if WL_SIMD_SSE2
+
+// SSE2
+
+static uint32_t LerpSse2(SampleBatch& batch, uint32_t begin, uint32_t count)
+{
+	uint32_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 t = _mm_load_ps(&batch.t[i]);
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			__m128 a = _mm_load_ps(&batch.a[c][i]);
+			__m128 b = _mm_load_ps(&batch.b[c][i]);
+			_mm_store_ps(&batch.a[c][i], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+		}
+	}
+
+	return i;
+}
+
+static uint32_t SlerpSse2(SampleBatch& batch, uint32_t begin, uint32_t count)
+{
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	uint32_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 a[4], b[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			a[c] = _mm_load_ps(&batch.a[c][i]);
+			b[c] = _mm_load_ps(&batch.b[c][i]);
+		}
+		const __m128 t = _mm_load_ps(&batch.t[i]);
+
+		__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2])), _mm_mul_ps(a[3], b[3]));
+
+		// Take the short way around, negating b where the keys point into opposite hemispheres
+		const __m128 sign = _mm_and_ps(d, signBit);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			b[c] = _mm_xor_ps(b[c], sign);
+		}
+		d = _mm_xor_ps(d, sign);
+
+		__m128 A = _mm_sub_ps(_mm_set1_ps(3.55645f), _mm_mul_ps(d, _mm_set1_ps(1.43519f)));
+		A = _mm_add_ps(_mm_set1_ps(-3.2452f), _mm_mul_ps(d, A));
+		A = _mm_add_ps(_mm_set1_ps(1.0904f), _mm_mul_ps(d, A));
+		__m128 B = _mm_add_ps(_mm_set1_ps(-1.06021f), _mm_mul_ps(d, _mm_set1_ps(0.215638f)));
+		B = _mm_add_ps(_mm_set1_ps(0.848013f), _mm_mul_ps(d, B));
+		const __m128 h = _mm_sub_ps(t, half);
+		const __m128 k = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(A, h), h), B);
+		const __m128 ot = _mm_add_ps(t, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, h), _mm_sub_ps(t, one)), k));
+
+		__m128 r[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			r[c] = _mm_add_ps(a[c], _mm_mul_ps(_mm_sub_ps(b[c], a[c]), ot));
+		}
+
+		const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r[0], r[0]), _mm_mul_ps(r[1], r[1])), _mm_mul_ps(r[2], r[2])), _mm_mul_ps(r[3], r[3])));
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			_mm_store_ps(&batch.a[c][i], _mm_div_ps(r[c], length));
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+#if WL_SIMD_AVX2
+
+// AVX2
+
+WL_TARGET_AVX2 static uint32_t LerpAvx2(SampleBatch& batch, uint32_t begin, uint32_t count)
+{
+	uint32_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 t = _mm256_load_ps(&batch.t[i]);
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			__m256 a = _mm256_load_ps(&batch.a[c][i]);
+			__m256 b = _mm256_load_ps(&batch.b[c][i]);
+			_mm256_store_ps(&batch.a[c][i], _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t)));
+		}
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 static uint32_t SlerpAvx2(SampleBatch& batch, uint32_t begin, uint32_t count)
+{
+	const __m256 signBit = _mm256_set1_ps(-0.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	uint32_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 a[4], b[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			a[c] = _mm256_load_ps(&batch.a[c][i]);
+			b[c] = _mm256_load_ps(&batch.b[c][i]);
+		}
+		const __m256 t = _mm256_load_ps(&batch.t[i]);
+
+		__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[0], b[0]), _mm256_mul_ps(a[1], b[1])), _mm256_mul_ps(a[2], b[2])), _mm256_mul_ps(a[3], b[3]));
+
+		const __m256 sign = _mm256_and_ps(d, signBit);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			b[c] = _mm256_xor_ps(b[c], sign);
+		}
+		d = _mm256_xor_ps(d, sign);
+
+		__m256 A = _mm256_sub_ps(_mm256_set1_ps(3.55645f), _mm256_mul_ps(d, _mm256_set1_ps(1.43519f)));
+		A = _mm256_add_ps(_mm256_set1_ps(-3.2452f), _mm256_mul_ps(d, A));
+		A = _mm256_add_ps(_mm256_set1_ps(1.0904f), _mm256_mul_ps(d, A));
+		__m256 B = _mm256_add_ps(_mm256_set1_ps(-1.06021f), _mm256_mul_ps(d, _mm256_set1_ps(0.215638f)));
+		B = _mm256_add_ps(_mm256_set1_ps(0.848013f), _mm256_mul_ps(d, B));
+		const __m256 h = _mm256_sub_ps(t, half);
+		const __m256 k = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(A, h), h), B);
+		const __m256 ot = _mm256_add_ps(t, _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, h), _mm256_sub_ps(t, one)), k));
+
+		__m256 r[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			r[c] = _mm256_add_ps(a[c], _mm256_mul_ps(_mm256_sub_ps(b[c], a[c]), ot));
+		}
+
+		const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], r[0]), _mm256_mul_ps(r[1], r[1])), _mm256_mul_ps(r[2], r[2])), _mm256_mul_ps(r[3], r[3])));
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			_mm256_store_ps(&batch.a[c][i], _mm256_div_ps(r[c], length));
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+static void FlushBatch(SampleBatch& batch, bool rotation, SimdLevel level)
+{
+	uint32_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = rotation ? SlerpAvx2(batch, 0, batch.count) : LerpAvx2(batch, 0, batch.count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = rotation ? SlerpSse2(batch, done, batch.count) : LerpSse2(batch, done, batch.count);
+	}
+#endif
+
+	if (rotation)
+	{
+		SlerpScalar(batch, done, batch.count);
+	}
+	else
+	{
+		LerpScalar(batch, done, batch.count);
+	}
+
+	for (uint32_t i = 0; i < batch.count; ++i)
+	{
+		switch (batch.paths[i])
+		{
+		case AnimationPath::Translation:
+			batch.targets[i]->SetTranslation(glm::vec3(batch.a[0][i], batch.a[1][i], batch.a[2][i]));
+			break;
+		case AnimationPath::Rotation:
+			batch.targets[i]->SetRotation(glm::quat(batch.a[3][i], batch.a[0][i], batch.a[1][i], batch.a[2][i]));
+			break;
+		case AnimationPath::Scale:
+			batch.targets[i]->SetScale(glm::vec3(batch.a[0][i], batch.a[1][i], batch.a[2][i]));
+			break;
+		default:
+			break;
+		}
+	}
+
+	batch.count = 0;
+}
+
+/**
+ * @brief Hermite spline between two keys, every key holds in-tangent, value and out-tangent
+ */
+static void SampleCubicSpline(const AnimationClip& clip, const AnimationChannel& channel, Transform* target, uint32_t key, float time)
+{
+	const float* times = clip.GetTimes(channel);
+	const float* values = clip.GetValues(channel);
+	const uint32_t n = channel.componentCount;
+
+	float result[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if (key + 1 < channel.keyCount && time > times[key])
+	{
+		const float dt = times[key + 1] - times[key];
+		const float t = (time - times[key]) / dt;
+		const float t2 = t * t;
+		const float t3 = t2 * t;
+
+		const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+		const float h10 = t3 - 2.0f * t2 + t;
+		const float h01 = -2.0f * t3 + 3.0f * t2;
+		const float h11 = t3 - t2;
+
+		const float* k0 = values + static_cast<size_t>(key) * n * 3;
+		const float* k1 = k0 + n * 3;
+		for (uint32_t c = 0; c < n && c < 4; ++c)
+		{
+			result[c] = h00 * k0[n + c] + h10 * dt * k0[2 * n + c] + h01 * k1[n + c] + h11 * dt * k1[c];
+		}
+	}
+	else
+	{
+		const float* k0 = values + static_cast<size_t>(key) * n * 3;
+		for (uint32_t c = 0; c < n && c < 4; ++c)
+		{
+			result[c] = k0[n + c];
+		}
+	}
+
+	switch (channel.path)
+	{
+	case AnimationPath::Translation:
+		target->SetTranslation(glm::vec3(result[0], result[1], result[2]));
+		break;
+	case AnimationPath::Rotation:
+		target->SetRotation(glm::normalize(glm::quat(result[3], result[0], result[1], result[2])));
+		break;
+	case AnimationPath::Scale:
+		target->SetScale(glm::vec3(result[0], result[1], result[2]));
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Morph weights of the target, one value per morph target, blended one weight at a time
+ */
+static void SampleWeights(const AnimationClip& clip, const AnimationChannel& channel, MeshDeformer* target, uint32_t key, float time)
+{
+	const float* times = clip.GetTimes(channel);
+	const float* values = clip.GetValues(channel);
+	const uint32_t n = channel.componentCount;
+
+	std::vector<float>& weights = target->GetWeights();
+	weights.resize(std::max<size_t>(weights.size(), n), 0.0f);
+
+	const bool cubic = channel.interpolation == AnimationInterpolation::CubicSpline;
+	const size_t keyStride = cubic ? n * 3 : n;
+	const float* k0 = values + static_cast<size_t>(key) * keyStride + (cubic ? n : 0);
+	if (key + 1 >= channel.keyCount || time <= times[key] || channel.interpolation == AnimationInterpolation::Step)
+	{
+		std::copy(k0, k0 + n, weights.begin());
+		return;
+	}
+
+	const float dt = times[key + 1] - times[key];
+	const float t = dt > 0.0f ? (time - times[key]) / dt : 0.0f;
+	const float* k1 = k0 + keyStride;
+	if (!cubic)
+	{
+		for (uint32_t c = 0; c < n; ++c)
+		{
+			weights[c] = k0[c] + (k1[c] - k0[c]) * t;
+		}
+		return;
+	}
+
+	const float t2 = t * t;
+	const float t3 = t2 * t;
+	const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+	const float h10 = t3 - 2.0f * t2 + t;
+	const float h01 = -2.0f * t3 + 3.0f * t2;
+	const float h11 = t3 - t2;
+
+	// k0 and k1 point at the values, the out-tangent follows a value and the in-tangent precedes it
+	const float* outTangent = k0 + n;
+	const float* inTangent = k1 - n;
+	for (uint32_t c = 0; c < n; ++c)
+	{
+		weights[c] = h00 * k0[c] + h10 * dt * outTangent[c] + h01 * k1[c] + h11 * dt * inTangent[c];
+	}
+}
+
+void AnimationSampler::Sample(const AnimationClip& clip, float time, uint32_t* cursors, uint32_t firstChannel, uint32_t lastChannel)
+{
+	const SimdLevel level = GetSimdLevel();
+	const std::vector<AnimationChannel>& channels = clip.GetChannels();
+	const std::vector<Transform*>& targets = clip.GetTargets();
+
+	SampleBatch vectorBatch;
+	SampleBatch rotationBatch;
+
+	for (uint32_t i = firstChannel; i < lastChannel; ++i)
+	{
+		const AnimationChannel& channel = channels[i];
+		const float* times = clip.GetTimes(channel);
+		const uint32_t key = FindKey(times, channel.keyCount, time, cursors[i]);
+
+		if (channel.path == AnimationPath::Weights)
+		{
+			SampleWeights(clip, channel, clip.GetWeightTargets()[channel.target], key, time);
+			continue;
+		}
+
+		Transform* target = targets[channel.target];
+
+		if (channel.interpolation == AnimationInterpolation::CubicSpline)
+		{
+			SampleCubicSpline(clip, channel, target, key, time);
+			continue;
+		}
+
+		// Before the first key, after the last one and for step channels both lanes hold the same key
+		uint32_t next = key;
+		float t = 0.0f;
+		if (channel.interpolation == AnimationInterpolation::Linear && key + 1 < channel.keyCount && time > times[key])
+		{
+			next = key + 1;
+			const float dt = times[next] - times[key];
+			t = dt > 0.0f ? (time - times[key]) / dt : 0.0f;
+		}
+
+		const bool rotation = channel.path == AnimationPath::Rotation;
+		SampleBatch& batch = rotation ? rotationBatch : vectorBatch;
+
+		const uint32_t lane = batch.count++;
+		const uint32_t componentCount = rotation ? 4 : 3;
+		const float* a = clip.GetValues(channel) + static_cast<size_t>(key) * componentCount;
+		const float* b = clip.GetValues(channel) + static_cast<size_t>(next) * componentCount;
+		for (uint32_t c = 0; c < componentCount; ++c)
+		{
+			batch.a[c][lane] = a[c];
+			batch.b[c][lane] = b[c];
+		}
+		batch.t[lane] = t;
+		batch.targets[lane] = target;
+		batch.paths[lane] = channel.path;
+
+		if (batch.count == kBatchSize)
+		{
+			FlushBatch(batch, rotation, level);
+		}
+	}
+
+	FlushBatch(vectorBatch, false, level);
+	FlushBatch(rotationBatch, true, level);
+}
+
+void AnimationSampler::Sample(const CompressedClip& clip, float time, uint32_t* cursors, uint32_t firstChannel, uint32_t lastChannel)
+{
+	const SimdLevel level = GetSimdLevel();
+	const std::vector<CompressedChannel>& channels = clip.GetChannels();
+	const std::vector<Transform*>& targets = clip.GetTargets();
+
+	// Key times are compared on the tick grid, the way ClipCompressor measured its error
+	const float tick = clip.GetTimeStep() > 0.0f ? time / clip.GetTimeStep() : 0.0f;
+
+	SampleBatch vectorBatch;
+	SampleBatch rotationBatch;
+
+	float a[4];
+	float b[4];
+	for (uint32_t i = firstChannel; i < lastChannel; ++i)
+	{
+		const CompressedChannel& channel = channels[i];
+		const uint16_t* ticks = clip.GetTicks(channel);
+		const uint32_t key = FindKey(ticks, channel.keyCount, tick, cursors[i]);
+
+		uint32_t next = key;
+		float t = 0.0f;
+		if (channel.interpolation == AnimationInterpolation::Linear && key + 1 < channel.keyCount && tick > ticks[key])
+		{
+			next = key + 1;
+			t = (tick - ticks[key]) / static_cast<float>(ticks[next] - ticks[key]);
+		}
+
+		clip.DecodeKey(channel, key, a);
+		if (next != key)
+		{
+			clip.DecodeKey(channel, next, b);
+		}
+
+		const bool rotation = channel.path == AnimationPath::Rotation;
+		SampleBatch& batch = rotation ? rotationBatch : vectorBatch;
+
+		const uint32_t lane = batch.count++;
+		const uint32_t componentCount = rotation ? 4 : 3;
+		for (uint32_t c = 0; c < componentCount; ++c)
+		{
+			batch.a[c][lane] = a[c];
+			batch.b[c][lane] = next != key ? b[c] : a[c];
+		}
+		batch.t[lane] = t;
+		batch.targets[lane] = targets[channel.target];
+		batch.paths[lane] = channel.path;
+
+		if (batch.count == kBatchSize)
+		{
+			FlushBatch(batch, rotation, level);
+		}
+	}
+
+	FlushBatch(vectorBatch, false, level);
+	FlushBatch(rotationBatch, true, level);
+}
+
+void AnimationSampler::Sample(AnimationState& state)
+{
+	state.cursors.resize(GetCursorCount(state), 0);
+
+	if (!state.compressedClip)
+	{
+		Sample(*state.clip, state.time, state.cursors.data(), 0, static_cast<uint32_t>(state.cursors.size()));
+		return;
+	}
+
+	const uint32_t channelCount = static_cast<uint32_t>(state.compressedClip->GetChannels().size());
+	Sample(*state.compressedClip, state.time, state.cursors.data(), 0, channelCount);
+	if (const std::shared_ptr<const AnimationClip>& uncompressed = state.compressedClip->GetUncompressed())
+	{
+		Sample(*uncompressed, state.time, state.cursors.data() + channelCount, 0, static_cast<uint32_t>(uncompressed->GetChannels().size()));
+	}
+}
+
+void AnimationSampler::SampleParallel(AnimationState& state)
+{
+	state.cursors.resize(GetCursorCount(state), 0);
+
+	// Channels of one target write different properties, so the batches never write the same memory
+	const float time = state.time;
+	uint32_t* cursors = state.cursors.data();
+	if (!state.compressedClip)
+	{
+		const AnimationClip& clip = *state.clip;
+		JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(state.cursors.size()), kParallelBatchSize, [&clip, time, cursors](uint32_t begin, uint32_t end)
+			{
+				Sample(clip, time, cursors, begin, end);
+			});
+		return;
+	}
+
+	// The uncompressed channels follow the compressed ones in the cursors and in the ranges of the jobs
+	const CompressedClip& clip = *state.compressedClip;
+	const AnimationClip* uncompressed = clip.GetUncompressed().get();
+	const uint32_t channelCount = static_cast<uint32_t>(clip.GetChannels().size());
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(state.cursors.size()), kParallelBatchSize, [&clip, uncompressed, channelCount, time, cursors](uint32_t begin, uint32_t end)
+		{
+			if (begin < channelCount)
+			{
+				Sample(clip, time, cursors, begin, std::min(end, channelCount));
+			}
+			if (end > channelCount)
+			{
+				Sample(*uncompressed, time, cursors + channelCount, std::max(begin, channelCount) - channelCount, end - channelCount);
+			}
+		});
+}
+
+void AnimationSampler::Blend(AnimationPath path, const float* a, const float* b, float t, float* result)
+{
+	SampleBatch batch;
+	const bool rotation = path == AnimationPath::Rotation;
+	const uint32_t componentCount = rotation ? 4 : 3;
+	for (uint32_t c = 0; c < componentCount; ++c)
+	{
+		batch.a[c][0] = a[c];
+		batch.b[c][0] = b[c];
+	}
+	batch.t[0] = t;
+
+	if (rotation)
+	{
+		SlerpScalar(batch, 0, 1);
+	}
+	else
+	{
+		LerpScalar(batch, 0, 1);
+	}
+
+	for (uint32_t c = 0; c < componentCount; ++c)
+	{
+		result[c] = batch.a[c][0];
+	}
+}
+
+SimdLevel AnimationSampler::GetSimdLevel()
+{
+	SimdLevel supported = CpuFeatures::GetSimdLevel();
+	SimdLevel cap = static_cast<SimdLevel>(s_SimdLevelCap.load(std::memory_order_relaxed));
+	return static_cast<uint32_t>(cap) < static_cast<uint32_t>(supported) ? cap : supported;
+}
+
+void AnimationSampler::SetSimdLevel(SimdLevel level)
+{
+	s_SimdLevelCap.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Framework/CpuFeatures.h"
+#include "Animation/AnimationClip.h"
+
+class CompressedClip;
+
+/**
+ * @brief Playback position of a clip, with the key cursor of every channel
+ */
+struct AnimationState
+{
+	AnimationState(std::shared_ptr<const AnimationClip> clip);
+	AnimationState(std::shared_ptr<const CompressedClip> clip);
+
+	/// One of the two is set
+	std::shared_ptr<const AnimationClip> clip;
+	std::shared_ptr<const CompressedClip> compressedClip;
+	float time = 0.0f;
+	float speed = 1.0f;
+	bool loop = true;
+
+	/// Per channel, the key at or before the last sampled time, so playing forward looks at most a few keys ahead.
+	/// A compressed clip has its channels first and those of its uncompressed clip after them.
+	std::vector<uint32_t> cursors;
+
+	float GetDuration() const;
+
+	/**
+	 * @brief Moves the time by deltaTime * speed, wrapping around or clamping at the clip duration
+	 */
+	void Advance(float deltaTime);
+};
+
+/**
+ * @brief Evaluates animation channels and writes the result into the Transform of their targets, or the morph weights of their MeshDeformer
+ * Linear and step channels are gathered into batches and blended across channels with SIMD, lerp for
+ * translation and scale and a corrected nlerp (within 2e-3 radians of slerp) for rotation. The scalar, SSE2 and AVX2
+ * paths produce the same values. Cubic spline and weight channels are evaluated one at a time.
+ */
+class AnimationSampler
+{
+public:
+	/**
+	 * @brief Samples the channels [firstChannel, lastChannel) of clip at time, cursors has one entry per channel
+	 */
+	static void Sample(const AnimationClip& clip, float time, uint32_t* cursors, uint32_t firstChannel, uint32_t lastChannel);
+
+	/**
+	 * @brief Same for the channels [firstChannel, lastChannel) of a compressed clip, its uncompressed channels are not included
+	 */
+	static void Sample(const CompressedClip& clip, float time, uint32_t* cursors, uint32_t firstChannel, uint32_t lastChannel);
+
+	static void Sample(AnimationState& state);
+
+	/**
+	 * @brief Same as Sample, with the channels split across the job pool
+	 */
+	static void SampleParallel(AnimationState& state);
+
+	/**
+	 * @brief Scalar blend of two keys of a linear translation, rotation or scale channel, the value Sample would write
+	 */
+	static void Blend(AnimationPath path, const float* a, const float* b, float t, float* result);
+
+	static SimdLevel GetSimdLevel();
+
+	/**
+	 * @brief Caps the sampler paths at level, the CPU support still applies
+	 */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	AnimationSampler() {};
+	~AnimationSampler() {};
+};
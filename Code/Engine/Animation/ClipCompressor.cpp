@@ -0,0 +1,297 @@
+#include "ClipCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationSampler.h"
+#include "Animation/CompressedClip.h"
+#include "Scene/Transform.h"
+
+// Keys one kept key may span, bounds the quadratic cost of the error checks on long smooth channels
+static const uint32_t kMaxKeySpan = 512;
+
+inline uint16_t QuantizeUnorm16(float value, float minimum, float extent)
+{
+	const float normalized = extent > 0.0f ? (value - minimum) / extent : 0.0f;
+	return static_cast<uint16_t>(std::min(std::max(normalized, 0.0f), 1.0f) * 65535.0f + 0.5f);
+}
+
+/**
+ * @brief Object space distance one unit of channel error moves a point, per target
+ */
+struct TargetErrorScale
+{
+	/// For translation, the world scale of the parent
+	float linear = 1.0f;
+	/// For rotation (per radian) and scale, the lever of the joints below the target on top of that
+	float angular = 1.0f;
+};
+
+static std::vector<TargetErrorScale> ComputeErrorScales(const std::vector<Transform*>& targets, float shellDistance)
+{
+	std::unordered_map<const Transform*, size_t> targetIndices;
+	std::vector<glm::vec3> positions(targets.size());
+	std::vector<float> levers(targets.size(), 0.0f);
+	std::vector<TargetErrorScale> scales(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i)
+	{
+		targetIndices.emplace(targets[i], i);
+		positions[i] = glm::vec3(targets[i]->GetWorldMatrix()[3]);
+
+		if (const Transform* parent = targets[i]->GetParent())
+		{
+			const glm::mat4 world = parent->GetWorldMatrix();
+			scales[i].linear = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+		}
+	}
+
+	// A target moves every animated joint below it
+	for (size_t i = 0; i < targets.size(); ++i)
+	{
+		for (const Transform* ancestor = targets[i]->GetParent(); ancestor; ancestor = ancestor->GetParent())
+		{
+			auto it = targetIndices.find(ancestor);
+			if (it != targetIndices.end())
+			{
+				levers[it->second] = std::max(levers[it->second], glm::length(positions[i] - positions[it->second]));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < targets.size(); ++i)
+	{
+		scales[i].angular = scales[i].linear * (levers[i] + shellDistance);
+	}
+
+	return scales;
+}
+
+/**
+ * @brief Object space error of a sampled value against the original one
+ */
+inline float MeasureError(AnimationPath path, const float* value, const float* original, const TargetErrorScale& scale)
+{
+	if (path == AnimationPath::Rotation)
+	{
+		// Angle of conjugate(original) * value, from its vector part and w so small angles stay accurate
+		const float* a = original;
+		const float* b = value;
+		const float w = a[3] * b[3] + a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+		const float x = a[3] * b[0] - a[0] * b[3] - a[1] * b[2] + a[2] * b[1];
+		const float y = a[3] * b[1] - a[1] * b[3] - a[2] * b[0] + a[0] * b[2];
+		const float z = a[3] * b[2] - a[2] * b[3] - a[0] * b[1] + a[1] * b[0];
+		const float angle = 2.0f * std::atan2(std::sqrt(x * x + y * y + z * z), std::fabs(w));
+		return angle * scale.angular;
+	}
+
+	float error = 0.0f;
+	for (uint32_t c = 0; c < 3; ++c)
+	{
+		error = std::max(error, std::fabs(value[c] - original[c]));
+	}
+
+	return error * (path == AnimationPath::Scale ? scale.angular : scale.linear);
+}
+
+/**
+ * @brief Kept keys of a quantized channel, the interpolation between them stays within tolerance at every original key
+ */
+static std::vector<uint32_t> ReduceKeys(const AnimationChannel& channel, const float* times, const float* values, float timeStep,
+	const std::vector<uint16_t>& ticks, const std::vector<float>& decoded, float tolerance, const TargetErrorScale& scale)
+{
+	const uint32_t keyCount = channel.keyCount;
+	const uint32_t n = channel.path == AnimationPath::Rotation ? 4 : 3;
+
+	std::vector<uint32_t> kept(1, 0);
+
+	bool constant = true;
+	for (uint32_t k = 1; k < keyCount && constant; ++k)
+	{
+		constant = MeasureError(channel.path, &decoded[0], values + static_cast<size_t>(k) * n, scale) <= tolerance;
+	}
+
+	if (constant)
+	{
+		return kept;
+	}
+
+	float sampled[4];
+	uint32_t i = 0;
+	while (i + 1 < keyCount)
+	{
+		uint32_t best = i + 1;
+		for (uint32_t j = i + 2; j < keyCount && j - i <= kMaxKeySpan; ++j)
+		{
+			if (ticks[j] == ticks[i])
+			{
+				break;
+			}
+
+			bool withinTolerance = true;
+			for (uint32_t k = i + 1; k < j && withinTolerance; ++k)
+			{
+				// The sampler compares times on the tick grid
+				const float tick = timeStep > 0.0f ? times[k] / timeStep : 0.0f;
+				const float* a = &decoded[static_cast<size_t>(i) * n];
+				if (channel.interpolation == AnimationInterpolation::Step || tick <= ticks[i])
+				{
+					std::copy(a, a + n, sampled);
+				}
+				else if (tick >= ticks[j])
+				{
+					std::copy(&decoded[static_cast<size_t>(j) * n], &decoded[static_cast<size_t>(j) * n] + n, sampled);
+				}
+				else
+				{
+					const float t = (tick - ticks[i]) / static_cast<float>(ticks[j] - ticks[i]);
+					AnimationSampler::Blend(channel.path, a, &decoded[static_cast<size_t>(j) * n], t, sampled);
+				}
+
+				withinTolerance = MeasureError(channel.path, sampled, values + static_cast<size_t>(k) * n, scale) <= tolerance;
+			}
+
+			if (!withinTolerance)
+			{
+				break;
+			}
+			best = j;
+		}
+
+		kept.push_back(best);
+		i = best;
+	}
+
+	return kept;
+}
+
+std::shared_ptr<CompressedClip> ClipCompressor::Compress(const AnimationClip& clip, const ClipCompressionSettings& settings, ClipCompressionStatistics* statistics)
+{
+	auto compressed = std::make_shared<CompressedClip>(clip.GetName());
+	compressed->m_Duration = clip.GetDuration();
+	compressed->m_TimeStep = clip.GetDuration() / 65535.0f;
+	compressed->m_Targets = clip.GetTargets();
+
+	const std::vector<TargetErrorScale> errorScales = ComputeErrorScales(clip.GetTargets(), settings.shellDistance);
+	auto uncompressed = std::make_shared<AnimationClip>(clip.GetName());
+
+	uint32_t uncompressedKeys = 0;
+	uint32_t fullPrecisionChannels = 0;
+	std::vector<uint16_t> ticks;
+	std::vector<uint16_t> keys;
+	std::vector<float> decoded;
+	for (const AnimationChannel& channel : clip.GetChannels())
+	{
+		const float* times = clip.GetTimes(channel);
+		const float* values = clip.GetValues(channel);
+
+		auto keepUncompressed = [&]()
+		{
+			const uint32_t target = channel.path == AnimationPath::Weights ? uncompressed->AddWeightTarget(clip.GetWeightTargets()[channel.target])
+				: uncompressed->AddTarget(clip.GetTargets()[channel.target]);
+			uncompressed->AddChannel(target, channel.path, channel.interpolation, times, channel.keyCount, values, channel.componentCount);
+		};
+
+		if (channel.path == AnimationPath::Weights || channel.interpolation == AnimationInterpolation::CubicSpline)
+		{
+			keepUncompressed();
+			continue;
+		}
+
+		CompressedChannel compressedChannel;
+		compressedChannel.target = channel.target;
+		compressedChannel.path = channel.path;
+		compressedChannel.interpolation = channel.interpolation;
+
+		const uint32_t n = channel.path == AnimationPath::Rotation ? 4 : 3;
+		if (channel.path != AnimationPath::Rotation)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				float minimum = values[c];
+				float maximum = values[c];
+				for (uint32_t k = 1; k < channel.keyCount; ++k)
+				{
+					minimum = std::min(minimum, values[static_cast<size_t>(k) * 3 + c]);
+					maximum = std::max(maximum, values[static_cast<size_t>(k) * 3 + c]);
+				}
+
+				compressedChannel.rangeMin[c] = minimum;
+				compressedChannel.rangeExtent[c] = maximum - minimum;
+			}
+		}
+
+		// Quantize every key first, the reduction measures the error of the values the runtime decodes
+		ticks.resize(channel.keyCount);
+		keys.resize(static_cast<size_t>(channel.keyCount) * 3);
+		decoded.resize(static_cast<size_t>(channel.keyCount) * n);
+		for (uint32_t k = 0; k < channel.keyCount; ++k)
+		{
+			const float tick = compressed->m_TimeStep > 0.0f ? times[k] / compressed->m_TimeStep : 0.0f;
+			ticks[k] = static_cast<uint16_t>(std::min(std::max(tick, 0.0f), 65535.0f) + 0.5f);
+
+			uint16_t* key = &keys[static_cast<size_t>(k) * 3];
+			const float* value = values + static_cast<size_t>(k) * n;
+			if (channel.path == AnimationPath::Rotation)
+			{
+				CompressedClip::EncodeRotation(value, key);
+			}
+			else
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					key[c] = QuantizeUnorm16(value[c], compressedChannel.rangeMin[c], compressedChannel.rangeExtent[c]);
+				}
+			}
+
+			CompressedClip::DecodeValue(compressedChannel, key, &decoded[static_cast<size_t>(k) * n]);
+		}
+
+		// Keeping every key cannot bring the error below the quantization error, a unorm16 range or a smallest three
+		// rotation too coarse for the tolerance keeps the channel at full precision instead
+		float quantizationError = 0.0f;
+		for (uint32_t k = 0; k < channel.keyCount; ++k)
+		{
+			const size_t offset = static_cast<size_t>(k) * n;
+			quantizationError = std::max(quantizationError, MeasureError(channel.path, &decoded[offset], values + offset, errorScales[channel.target]));
+		}
+
+		if (quantizationError > settings.tolerance)
+		{
+			keepUncompressed();
+			fullPrecisionChannels++;
+			continue;
+		}
+
+		const std::vector<uint32_t> kept = ReduceKeys(channel, times, values, compressed->m_TimeStep, ticks, decoded, settings.tolerance, errorScales[channel.target]);
+
+		compressedChannel.firstKey = static_cast<uint32_t>(compressed->m_Ticks.size());
+		compressedChannel.keyCount = static_cast<uint32_t>(kept.size());
+		for (uint32_t k : kept)
+		{
+			compressed->m_Ticks.push_back(ticks[k]);
+			compressed->m_Keys.insert(compressed->m_Keys.end(), &keys[static_cast<size_t>(k) * 3], &keys[static_cast<size_t>(k) * 3] + 3);
+		}
+		compressed->m_Channels.push_back(compressedChannel);
+
+		uncompressedKeys += channel.keyCount;
+	}
+
+	if (!uncompressed->GetChannels().empty())
+	{
+		uncompressed->Finalize();
+		compressed->m_Uncompressed = uncompressed;
+	}
+
+	if (statistics)
+	{
+		statistics->uncompressedBytes = clip.GetByteSize();
+		statistics->compressedBytes = compressed->GetByteSize();
+		statistics->uncompressedKeys = uncompressedKeys;
+		statistics->compressedKeys = static_cast<uint32_t>(compressed->m_Ticks.size());
+		statistics->fullPrecisionChannels = fullPrecisionChannels;
+	}
+
+	return compressed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class AnimationClip;
+class CompressedClip;
+
+struct ClipCompressionSettings
+{
+	/// Distance in object space units a point near a joint may move away from the uncompressed animation
+	float tolerance = 1e-4f;
+	/// Distance from a joint of the points the error is measured at, on top of the animated joints below it
+	float shellDistance = 0.1f;
+};
+
+struct ClipCompressionStatistics
+{
+	size_t uncompressedBytes = 0;
+	size_t compressedBytes = 0;
+	uint32_t uncompressedKeys = 0;
+	uint32_t compressedKeys = 0;
+	/// Linear and step channels whose quantized keys alone exceed the tolerance, kept uncompressed
+	uint32_t fullPrecisionChannels = 0;
+
+	inline float GetRatio() const { return compressedBytes > 0 ? static_cast<float>(uncompressedBytes) / static_cast<float>(compressedBytes) : 0.0f; }
+};
+
+/**
+ * @brief Builds the CompressedClip of an AnimationClip
+ * Keys are quantized first, then every linear or step channel keeps the fewest keys whose interpolation stays within
+ * the tolerance at all original key times. A channel whose quantized keys already miss the tolerance, a wide
+ * translation range for example, is not quantized and stays in the uncompressed clip. The error of a channel is converted to object space through its target:
+ * rotation and scale errors are scaled by the distance to the farthest animated joint below the target plus the
+ * shell distance, all errors by the world scale of the parent. The transforms as they are when Compress runs serve
+ * as the reference pose for those distances.
+ */
+class ClipCompressor
+{
+public:
+	static std::shared_ptr<CompressedClip> Compress(const AnimationClip& clip, const ClipCompressionSettings& settings, ClipCompressionStatistics* statistics = nullptr);
+
+private:
+	ClipCompressor() {};
+	~ClipCompressor() {};
+};
@@ -0,0 +1,86 @@
+#include "CompressedClip.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Smallest three components lie in [-1/sqrt(2), 1/sqrt(2)], stored as 15-bit unorm
+static const float kSmallestThreeRange = 0.70710678f;
+static const float kSmallestThreeMax = 32767.0f;
+
+void CompressedClip::EncodeRotation(const float* rotation, uint16_t* key)
+{
+	uint32_t largest = 0;
+	for (uint32_t c = 1; c < 4; ++c)
+	{
+		largest = std::fabs(rotation[c]) > std::fabs(rotation[largest]) ? c : largest;
+	}
+
+	// q and -q are the same rotation, the dropped component is always rebuilt positive
+	const float sign = rotation[largest] < 0.0f ? -1.0f : 1.0f;
+
+	uint64_t bits = largest;
+	for (uint32_t c = 0; c < 4; ++c)
+	{
+		if (c != largest)
+		{
+			const float value = std::min(std::max(rotation[c] * sign, -kSmallestThreeRange), kSmallestThreeRange);
+			const uint64_t quantized = static_cast<uint64_t>((value / kSmallestThreeRange * 0.5f + 0.5f) * kSmallestThreeMax + 0.5f);
+			bits = (bits << 15) | quantized;
+		}
+	}
+
+	key[0] = static_cast<uint16_t>(bits);
+	key[1] = static_cast<uint16_t>(bits >> 16);
+	key[2] = static_cast<uint16_t>(bits >> 32);
+}
+
+void CompressedClip::DecodeRotation(const uint16_t* key, float* rotation)
+{
+	const uint64_t bits = static_cast<uint64_t>(key[0]) | (static_cast<uint64_t>(key[1]) << 16) | (static_cast<uint64_t>(key[2]) << 32);
+	const uint32_t largest = static_cast<uint32_t>(bits >> 45) & 3;
+
+	float sum = 0.0f;
+	uint32_t shift = 30;
+	for (uint32_t c = 0; c < 4; ++c)
+	{
+		if (c != largest)
+		{
+			const float quantized = static_cast<float>((bits >> shift) & 0x7FFF);
+			rotation[c] = quantized * (2.0f * kSmallestThreeRange / kSmallestThreeMax) - kSmallestThreeRange;
+			sum += rotation[c] * rotation[c];
+			shift -= 15;
+		}
+	}
+
+	rotation[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+}
+
+void CompressedClip::DecodeKey(const CompressedChannel& channel, uint32_t key, float* value) const
+{
+	DecodeValue(channel, m_Keys.data() + static_cast<size_t>(channel.firstKey + key) * 3, value);
+}
+
+void CompressedClip::DecodeValue(const CompressedChannel& channel, const uint16_t* key, float* value)
+{
+	if (channel.path == AnimationPath::Rotation)
+	{
+		DecodeRotation(key, value);
+		return;
+	}
+
+	for (uint32_t c = 0; c < 3; ++c)
+	{
+		value[c] = channel.rangeMin[c] + channel.rangeExtent[c] * (static_cast<float>(key[c]) * (1.0f / 65535.0f));
+	}
+}
+
+size_t CompressedClip::GetByteSize() const
+{
+	size_t size = m_Ticks.size() * sizeof(uint16_t) + m_Keys.size() * sizeof(uint16_t) + m_Channels.size() * sizeof(CompressedChannel);
+	if (m_Uncompressed)
+	{
+		size += m_Uncompressed->GetByteSize();
+	}
+
+	return size;
+}
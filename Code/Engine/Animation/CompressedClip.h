@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Animation/AnimationClip.h"
+
+/**
+ * @brief Translation, rotation or scale channel of a CompressedClip, its keys are ranges of the clip arrays
+ */
+struct CompressedChannel
+{
+	uint32_t target = 0;
+	AnimationPath path = AnimationPath::Translation;
+	/// Linear or step
+	AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+
+	uint32_t firstKey = 0;
+	uint32_t keyCount = 0;
+
+	/// Translation and scale keys are unorm16 between rangeMin and rangeMin + rangeExtent
+	float rangeMin[3] = { 0.0f, 0.0f, 0.0f };
+	float rangeExtent[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+/**
+ * @brief Runtime form of an AnimationClip with fewer and smaller keys, see ClipCompressor
+ * Every key is 8 bytes: a 16-bit time on a clip wide grid of duration / 65535 and a 48-bit value, smallest three
+ * for rotations and unorm16 against the channel range for translation and scale. Keys are decoded one channel at a
+ * time, so sampling never expands the clip. Cubic spline and weight channels are kept as they are in GetUncompressed().
+ */
+class CompressedClip
+{
+public:
+	CompressedClip(const std::string& name) : m_Name(name) {}
+
+	inline const std::string& GetName() const { return m_Name; }
+
+	inline float GetDuration() const { return m_Duration; }
+
+	inline const std::vector<CompressedChannel>& GetChannels() const { return m_Channels; }
+	inline const std::vector<Transform*>& GetTargets() const { return m_Targets; }
+
+	/**
+	 * @brief Channels ClipCompressor leaves uncompressed, sampled like any AnimationClip
+	 */
+	inline const std::shared_ptr<const AnimationClip>& GetUncompressed() const { return m_Uncompressed; }
+
+	/**
+	 * @brief Key times of a channel in units of GetTimeStep()
+	 */
+	inline const uint16_t* GetTicks(const CompressedChannel& channel) const { return m_Ticks.data() + channel.firstKey; }
+
+	inline float GetTimeStep() const { return m_TimeStep; }
+
+	/**
+	 * @brief Writes 3 floats for translation and scale, x, y, z, w for rotation
+	 */
+	void DecodeKey(const CompressedChannel& channel, uint32_t key, float* value) const;
+
+	/**
+	 * @brief Same for the 3 values of a key that is not stored in a clip yet
+	 */
+	static void DecodeValue(const CompressedChannel& channel, const uint16_t* key, float* value);
+
+	/**
+	 * @brief Bytes of keys, channels and uncompressed channels
+	 */
+	size_t GetByteSize() const;
+
+	static void EncodeRotation(const float* rotation, uint16_t* key);
+	static void DecodeRotation(const uint16_t* key, float* rotation);
+
+private:
+	friend class ClipCompressor;
+
+	std::string m_Name;
+	float m_Duration{ 0.0f };
+	float m_TimeStep{ 0.0f };
+
+	std::vector<uint16_t> m_Ticks;
+	/// 3 per key
+	std::vector<uint16_t> m_Keys;
+	std::vector<CompressedChannel> m_Channels;
+	std::vector<Transform*> m_Targets;
+
+	std::shared_ptr<const AnimationClip> m_Uncompressed;
+};
@@ -0,0 +1,623 @@
+#include "MeshDeformer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include "Animation/Skin.h"
+#include "Framework/JobSystem.h"
+#include "Geometry/MeshUtils.h"
+#include "Geometry/VertexQuantizer.h"
+#include "Scene/Mesh.h"
+#include "Scene/Scene.h"
+#include "Scene/Transform.h"
+#include <glm/gtc/type_ptr.hpp>
+
+#if WL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if WL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+// Vertices per job of Deform, a range of positions, normals and tangents stays in L2
+static const uint32_t kVertexBatchSize = 4096;
+
+static std::atomic<uint32_t> s_SimdLevelCap{ static_cast<uint32_t>(SimdLevel::AVX2) };
+
+/**
+ * @brief Stream of a submesh decoded to componentCount floats per vertex, empty when the stream is missing
+ */
+static std::vector<float> DecodeStream(const SubMesh& subMesh, const std::string& name, uint32_t componentCount, bool octahedral)
+{
+	std::vector<float> values;
+
+	auto it = subMesh.vertexBuffers.find(name);
+	if (it == subMesh.vertexBuffers.end() || !it->second.IsValid() || it->second.count < subMesh.vertexCount)
+	{
+		return values;
+	}
+
+	const AccessorView& view = it->second;
+	values.resize(static_cast<size_t>(subMesh.vertexCount) * componentCount);
+	for (uint32_t v = 0; v < subMesh.vertexCount; ++v)
+	{
+		glm::vec4 value = MeshUtils::DecodeElement(view.format, view.At(v));
+		if (octahedral)
+		{
+			// Octahedral xy, a tangent keeps its handedness in w
+			value = glm::vec4(VertexQuantizer::DecodeOctahedral(glm::vec2(value.x, value.y)), value.w < 0.0f ? -1.0f : 1.0f);
+		}
+
+		for (uint32_t c = 0; c < componentCount; ++c)
+		{
+			values[static_cast<size_t>(v) * componentCount + c] = value[c];
+		}
+	}
+
+	return values;
+}
+
+inline AccessorView GetOutputView(const std::shared_ptr<std::vector<float>>& data, uint32_t componentCount, uint32_t vertexCount, VkFormat format)
+{
+	AccessorView view;
+	view.buffer = reinterpret_cast<const uint8_t*>(data->data());
+	view.owner = data;
+	view.stride = componentCount * sizeof(float);
+	view.count = vertexCount;
+	view.format = format;
+
+	return view;
+}
+
+// Scalar, also the tail of the SIMD paths
+
+/**
+ * @brief dst += src * weight
+ */
+static void AxpyScalar(float* dst, const float* src, float weight, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		dst[i] = dst[i] + src[i] * weight;
+	}
+}
+
+/**
+ * @brief Influences of one vertex blended into a 4x4 matrix, the sums are in the same order on every path
+ */
+inline void BlendMatrixScalar(const glm::mat4* palette, const uint16_t* joints, const float* weights, float* blended)
+{
+	const float* m0 = glm::value_ptr(palette[joints[0]]);
+	const float* m1 = glm::value_ptr(palette[joints[1]]);
+	const float* m2 = glm::value_ptr(palette[joints[2]]);
+	const float* m3 = glm::value_ptr(palette[joints[3]]);
+
+	for (uint32_t i = 0; i < 16; ++i)
+	{
+		blended[i] = ((m0[i] * weights[0] + m1[i] * weights[1]) + m2[i] * weights[2]) + m3[i] * weights[3];
+	}
+}
+
+inline void TransformScalar(const float* m, float* v, bool point)
+{
+	const float x = v[0], y = v[1], z = v[2];
+	for (uint32_t r = 0; r < 3; ++r)
+	{
+		const float result = (m[r] * x + m[4 + r] * y) + m[8 + r] * z;
+		v[r] = point ? result + m[12 + r] : result;
+	}
+}
+
+/**
+ * @brief Inputs and in place outputs of a skinned vertex range
+ */
+struct SkinStreams
+{
+	const glm::mat4* palette;
+	const uint16_t* joints;
+	const float* weights;
+	float* positions;
+	float* normals;
+	float* tangents;
+};
+
+static void SkinScalar(const SkinStreams& s, uint32_t begin, uint32_t end)
+{
+	float m[16];
+	for (uint32_t v = begin; v < end; ++v)
+	{
+		BlendMatrixScalar(s.palette, s.joints + v * 4, s.weights + v * 4, m);
+
+		TransformScalar(m, s.positions + v * 3, true);
+		if (s.normals)
+		{
+			TransformScalar(m, s.normals + v * 3, false);
+		}
+		if (s.tangents)
+		{
+			TransformScalar(m, s.tangents + v * 4, false);
+		}
+	}
+}
+
+/**
+ * @brief Normalizes the xyz of the vectors [begin, end), stride floats apart
+ */
+static void NormalizeVectors(float* vectors, uint32_t stride, uint32_t begin, uint32_t end)
+{
+	for (uint32_t v = begin; v < end; ++v)
+	{
+		float* n = vectors + static_cast<size_t>(v) * stride;
+		const float length = std::sqrt((n[0] * n[0] + n[1] * n[1]) + n[2] * n[2]);
+		if (length > 0.0f)
+		{
+			n[0] = n[0] / length;
+			n[1] = n[1] / length;
+			n[2] = n[2] / length;
+		}
+	}
+}
+
+#if WL_SIMD_SSE2
+
+// SSE2, one vertex per iteration with a matrix column per register
+
+static size_t AxpySse2(float* dst, const float* src, float weight, size_t begin, size_t count)
+{
+	const __m128 w = _mm_set1_ps(weight);
+
+	size_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w)));
+	}
+
+	return i;
+}
+
+inline __m128 TransformSse2(const __m128* m, const float* v, bool point)
+{
+	__m128 result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0], _mm_set1_ps(v[0])), _mm_mul_ps(m[1], _mm_set1_ps(v[1]))), _mm_mul_ps(m[2], _mm_set1_ps(v[2])));
+	return point ? _mm_add_ps(result, m[3]) : result;
+}
+
+static uint32_t SkinSse2(const SkinStreams& s, uint32_t begin, uint32_t end)
+{
+	alignas(16) float result[4];
+
+	for (uint32_t v = begin; v < end; ++v)
+	{
+		const uint16_t* joints = s.joints + v * 4;
+		const float* weights = s.weights + v * 4;
+		const float* m0 = glm::value_ptr(s.palette[joints[0]]);
+		const float* m1 = glm::value_ptr(s.palette[joints[1]]);
+		const float* m2 = glm::value_ptr(s.palette[joints[2]]);
+		const float* m3 = glm::value_ptr(s.palette[joints[3]]);
+		const __m128 w0 = _mm_set1_ps(weights[0]);
+		const __m128 w1 = _mm_set1_ps(weights[1]);
+		const __m128 w2 = _mm_set1_ps(weights[2]);
+		const __m128 w3 = _mm_set1_ps(weights[3]);
+
+		__m128 m[4];
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			m[c] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m0 + c * 4), w0), _mm_mul_ps(_mm_loadu_ps(m1 + c * 4), w1)),
+				_mm_mul_ps(_mm_loadu_ps(m2 + c * 4), w2)), _mm_mul_ps(_mm_loadu_ps(m3 + c * 4), w3));
+		}
+
+		float* position = s.positions + v * 3;
+		_mm_store_ps(result, TransformSse2(m, position, true));
+		std::memcpy(position, result, sizeof(float) * 3);
+
+		if (s.normals)
+		{
+			float* normal = s.normals + v * 3;
+			_mm_store_ps(result, TransformSse2(m, normal, false));
+			std::memcpy(normal, result, sizeof(float) * 3);
+		}
+		if (s.tangents)
+		{
+			float* tangent = s.tangents + v * 4;
+			_mm_store_ps(result, TransformSse2(m, tangent, false));
+			std::memcpy(tangent, result, sizeof(float) * 3);
+		}
+	}
+
+	return end;
+}
+
+#endif
+
+#if WL_SIMD_AVX2
+
+// AVX2, one vertex per iteration with two matrix columns per register
+
+WL_TARGET_AVX2 static size_t AxpyAvx2(float* dst, const float* src, float weight, size_t begin, size_t count)
+{
+	const __m256 w = _mm256_set1_ps(weight);
+
+	size_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		_mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), w)));
+	}
+
+	return i;
+}
+
+/**
+ * @brief x * column 0 + y * column 1 + z * column 2 (+ column 3), m holds columns 0 and 1 in m[0] and 2 and 3 in m[1]
+ * The columns are summed in the same order as the scalar path.
+ */
+WL_TARGET_AVX2 inline __m128 TransformAvx2(const __m256* m, const float* v, bool point)
+{
+	// Built from two broadcasts, a set of all eight lanes goes through the stack and stalls the load
+	const __m256 xy = _mm256_mul_ps(m[0], _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(v[0])), _mm_set1_ps(v[1]), 1));
+	const __m256 zw = _mm256_mul_ps(m[1], _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(v[2])), _mm_set1_ps(1.0f), 1));
+	const __m128 result = _mm_add_ps(_mm_add_ps(_mm256_castps256_ps128(xy), _mm256_extractf128_ps(xy, 1)), _mm256_castps256_ps128(zw));
+	return point ? _mm_add_ps(result, _mm256_extractf128_ps(zw, 1)) : result;
+}
+
+WL_TARGET_AVX2 static uint32_t SkinAvx2(const SkinStreams& s, uint32_t begin, uint32_t end)
+{
+	alignas(16) float result[4];
+
+	for (uint32_t v = begin; v < end; ++v)
+	{
+		const uint16_t* joints = s.joints + v * 4;
+		const float* weights = s.weights + v * 4;
+		const float* m0 = glm::value_ptr(s.palette[joints[0]]);
+		const float* m1 = glm::value_ptr(s.palette[joints[1]]);
+		const float* m2 = glm::value_ptr(s.palette[joints[2]]);
+		const float* m3 = glm::value_ptr(s.palette[joints[3]]);
+		const __m256 w0 = _mm256_set1_ps(weights[0]);
+		const __m256 w1 = _mm256_set1_ps(weights[1]);
+		const __m256 w2 = _mm256_set1_ps(weights[2]);
+		const __m256 w3 = _mm256_set1_ps(weights[3]);
+
+		__m256 m[2];
+		for (uint32_t h = 0; h < 2; ++h)
+		{
+			m[h] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(m0 + h * 8), w0), _mm256_mul_ps(_mm256_loadu_ps(m1 + h * 8), w1)),
+				_mm256_mul_ps(_mm256_loadu_ps(m2 + h * 8), w2)), _mm256_mul_ps(_mm256_loadu_ps(m3 + h * 8), w3));
+		}
+
+		float* position = s.positions + v * 3;
+		_mm_store_ps(result, TransformAvx2(m, position, true));
+		std::memcpy(position, result, sizeof(float) * 3);
+
+		if (s.normals)
+		{
+			float* normal = s.normals + v * 3;
+			_mm_store_ps(result, TransformAvx2(m, normal, false));
+			std::memcpy(normal, result, sizeof(float) * 3);
+		}
+		if (s.tangents)
+		{
+			float* tangent = s.tangents + v * 4;
+			_mm_store_ps(result, TransformAvx2(m, tangent, false));
+			std::memcpy(tangent, result, sizeof(float) * 3);
+		}
+	}
+
+	return end;
+}
+
+#endif
+
+static void Axpy(float* dst, const float* src, float weight, size_t count, SimdLevel level)
+{
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = AxpyAvx2(dst, src, weight, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = AxpySse2(dst, src, weight, done, count);
+	}
+#endif
+
+	AxpyScalar(dst, src, weight, done, count);
+}
+
+static void SkinVertices(const SkinStreams& streams, uint32_t begin, uint32_t end, SimdLevel level)
+{
+	uint32_t done = begin;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = SkinAvx2(streams, done, end);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = SkinSse2(streams, done, end);
+	}
+#endif
+
+	SkinScalar(streams, done, end);
+}
+
+void MeshDeformer::Bind(MeshHandle mesh, Transform* node)
+{
+	m_Mesh = mesh;
+	m_Node = node;
+	m_Decoded = false;
+}
+
+void MeshDeformer::SetSkin(const std::shared_ptr<const Skin>& skin)
+{
+	m_Skin = skin;
+	m_Decoded = false;
+}
+
+void MeshDeformer::DecodeSubMeshes()
+{
+	const std::vector<SubMesh>& subMeshes = MeshRegistry::GetInstance().Get(m_Mesh)->GetSubmeshes();
+	const uint32_t jointCount = m_Skin ? m_Skin->GetJointCount() : 0;
+	const uint32_t normalBit = 1u << static_cast<uint32_t>(VertexSemantic::Normal);
+	const uint32_t tangentBit = 1u << static_cast<uint32_t>(VertexSemantic::Tangent);
+
+	m_SubMeshes.clear();
+	m_SubMeshes.resize(subMeshes.size());
+	for (size_t i = 0; i < subMeshes.size(); ++i)
+	{
+		const SubMesh& subMesh = subMeshes[i];
+		DeformedSubMesh& deformed = m_SubMeshes[i];
+
+		deformed.vertexCount = subMesh.vertexCount;
+		deformed.positions = DecodeStream(subMesh, "position", 3, false);
+		if (deformed.positions.empty())
+		{
+			deformed.vertexCount = 0;
+			continue;
+		}
+
+		deformed.normals = DecodeStream(subMesh, "normal", 3, (subMesh.octahedralMask & normalBit) != 0);
+		deformed.tangents = DecodeStream(subMesh, "tangent", 4, (subMesh.octahedralMask & tangentBit) != 0);
+
+		if (jointCount > 0)
+		{
+			std::vector<float> joints = DecodeStream(subMesh, "joints_0", 4, false);
+			std::vector<float> weights = DecodeStream(subMesh, "weights_0", 4, false);
+			if (!joints.empty() && !weights.empty())
+			{
+				// Influences on joints the skin does not have are dropped, the rest is renormalized
+				deformed.joints.resize(joints.size());
+				deformed.jointWeights.resize(weights.size());
+				for (size_t v = 0; v < joints.size(); v += 4)
+				{
+					float sum = 0.0f;
+					for (size_t k = v; k < v + 4; ++k)
+					{
+						const bool valid = joints[k] >= 0.0f && joints[k] < static_cast<float>(jointCount);
+						deformed.joints[k] = valid ? static_cast<uint16_t>(joints[k]) : 0;
+						deformed.jointWeights[k] = valid ? weights[k] : 0.0f;
+						sum += deformed.jointWeights[k];
+					}
+
+					for (size_t k = v; k < v + 4; ++k)
+					{
+						deformed.jointWeights[k] = sum > 0.0f ? deformed.jointWeights[k] / sum : (k == v ? 1.0f : 0.0f);
+					}
+				}
+			}
+		}
+
+		deformed.positionDeltas.resize(subMesh.morphTargetCount);
+		deformed.normalDeltas.resize(subMesh.morphTargetCount);
+		deformed.tangentDeltas.resize(subMesh.morphTargetCount);
+		for (uint32_t target = 0; target < subMesh.morphTargetCount; ++target)
+		{
+			deformed.positionDeltas[target] = DecodeStream(subMesh, GetMorphStreamName(target, "position"), 3, false);
+			if (!deformed.normals.empty())
+			{
+				deformed.normalDeltas[target] = DecodeStream(subMesh, GetMorphStreamName(target, "normal"), 3, false);
+			}
+			if (!deformed.tangents.empty())
+			{
+				deformed.tangentDeltas[target] = DecodeStream(subMesh, GetMorphStreamName(target, "tangent"), 3, false);
+			}
+		}
+
+		deformed.outputPositions = std::make_shared<std::vector<float>>(deformed.positions);
+		deformed.streams.position = GetOutputView(deformed.outputPositions, 3, deformed.vertexCount, VK_FORMAT_R32G32B32_SFLOAT);
+		if (!deformed.normals.empty())
+		{
+			deformed.outputNormals = std::make_shared<std::vector<float>>(deformed.normals);
+			deformed.streams.normal = GetOutputView(deformed.outputNormals, 3, deformed.vertexCount, VK_FORMAT_R32G32B32_SFLOAT);
+		}
+		if (!deformed.tangents.empty())
+		{
+			deformed.outputTangents = std::make_shared<std::vector<float>>(deformed.tangents);
+			deformed.streams.tangent = GetOutputView(deformed.outputTangents, 4, deformed.vertexCount, VK_FORMAT_R32G32B32A32_SFLOAT);
+		}
+	}
+}
+
+void MeshDeformer::Prepare()
+{
+	if (!m_Decoded)
+	{
+		DecodeSubMeshes();
+		m_Decoded = true;
+	}
+
+	if (m_Skin && m_Node)
+	{
+		m_Palette.resize(m_Skin->GetJointCount());
+		m_Skin->ComputeJointPalette(m_Node, m_Palette.data());
+	}
+	else
+	{
+		m_Palette.clear();
+	}
+}
+
+void MeshDeformer::DeformVertices(uint32_t subMesh, uint32_t begin, uint32_t end, SimdLevel level)
+{
+	DeformedSubMesh& deformed = m_SubMeshes[subMesh];
+
+	float* positions = deformed.outputPositions->data();
+	float* normals = deformed.outputNormals ? deformed.outputNormals->data() : nullptr;
+	float* tangents = deformed.outputTangents ? deformed.outputTangents->data() : nullptr;
+
+	const size_t count = end - begin;
+	std::memcpy(positions + begin * 3, deformed.positions.data() + begin * 3, count * 3 * sizeof(float));
+	if (normals)
+	{
+		std::memcpy(normals + begin * 3, deformed.normals.data() + begin * 3, count * 3 * sizeof(float));
+	}
+	if (tangents)
+	{
+		std::memcpy(tangents + begin * 4, deformed.tangents.data() + begin * 4, count * 4 * sizeof(float));
+	}
+
+	bool morphed = false;
+	const size_t targetCount = std::min(deformed.positionDeltas.size(), m_Weights.size());
+	for (size_t target = 0; target < targetCount; ++target)
+	{
+		const float weight = m_Weights[target];
+		if (weight == 0.0f)
+		{
+			continue;
+		}
+
+		if (!deformed.positionDeltas[target].empty())
+		{
+			Axpy(positions + begin * 3, deformed.positionDeltas[target].data() + begin * 3, weight, count * 3, level);
+		}
+		if (!deformed.normalDeltas[target].empty())
+		{
+			Axpy(normals + begin * 3, deformed.normalDeltas[target].data() + begin * 3, weight, count * 3, level);
+			morphed = true;
+		}
+		if (!deformed.tangentDeltas[target].empty())
+		{
+			// Tangent deltas have no handedness, so they skip every fourth output float
+			const float* delta = deformed.tangentDeltas[target].data();
+			for (uint32_t v = begin; v < end; ++v)
+			{
+				for (uint32_t c = 0; c < 3; ++c)
+				{
+					tangents[v * 4 + c] = tangents[v * 4 + c] + delta[v * 3 + c] * weight;
+				}
+			}
+			morphed = true;
+		}
+	}
+
+	const bool skinned = !deformed.joints.empty() && !m_Palette.empty();
+	if (skinned)
+	{
+		SkinStreams streams{ m_Palette.data(), deformed.joints.data(), deformed.jointWeights.data(), positions, normals, tangents };
+		SkinVertices(streams, begin, end, level);
+	}
+
+	if (skinned || morphed)
+	{
+		if (normals)
+		{
+			NormalizeVectors(normals, 3, begin, end);
+		}
+		if (tangents)
+		{
+			NormalizeVectors(tangents, 4, begin, end);
+		}
+	}
+}
+
+void MeshDeformer::Deform(const std::vector<MeshDeformer*>& deformers)
+{
+	JobSystem& jobSystem = JobSystem::GetInstance();
+
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	std::vector<MeshDeformer*> bound;
+	for (MeshDeformer* deformer : deformers)
+	{
+		if (deformer && registry.Get(deformer->m_Mesh))
+		{
+			bound.push_back(deformer);
+		}
+	}
+
+	// Palettes only read transforms, every deformer writes its own
+	jobSystem.ParallelFor(static_cast<uint32_t>(bound.size()), 1, [&bound](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				bound[i]->Prepare();
+			}
+		});
+
+	struct VertexRange
+	{
+		MeshDeformer* deformer;
+		uint32_t subMesh;
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	std::vector<VertexRange> ranges;
+	for (MeshDeformer* deformer : bound)
+	{
+		if (!deformer->m_CpuDeformation)
+		{
+			continue;
+		}
+
+		for (uint32_t subMesh = 0; subMesh < deformer->m_SubMeshes.size(); ++subMesh)
+		{
+			const uint32_t vertexCount = deformer->m_SubMeshes[subMesh].vertexCount;
+			for (uint32_t begin = 0; begin < vertexCount; begin += kVertexBatchSize)
+			{
+				ranges.push_back({ deformer, subMesh, begin, std::min(begin + kVertexBatchSize, vertexCount) });
+			}
+		}
+	}
+
+	const SimdLevel level = GetSimdLevel();
+	jobSystem.ParallelFor(static_cast<uint32_t>(ranges.size()), 1, [&ranges, level](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const VertexRange& range = ranges[i];
+				range.deformer->DeformVertices(range.subMesh, range.begin, range.end, level);
+			}
+		});
+}
+
+void MeshDeformer::Deform(const Scene& scene)
+{
+	std::vector<MeshDeformer*> deformers;
+	for (GameObjectHandle handle : scene.GetNodes())
+	{
+		GameObject* node = GameObject::Get(handle);
+		if (MeshDeformer* deformer = node ? node->GetComponent<MeshDeformer>() : nullptr)
+		{
+			deformers.push_back(deformer);
+		}
+	}
+
+	Deform(deformers);
+}
+
+SimdLevel MeshDeformer::GetSimdLevel()
+{
+	SimdLevel supported = CpuFeatures::GetSimdLevel();
+	SimdLevel cap = static_cast<SimdLevel>(s_SimdLevelCap.load(std::memory_order_relaxed));
+	return static_cast<uint32_t>(cap) < static_cast<uint32_t>(supported) ? cap : supported;
+}
+
+void MeshDeformer::SetSimdLevel(SimdLevel level)
+{
+	s_SimdLevelCap.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+}
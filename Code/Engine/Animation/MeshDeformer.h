@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Scene/Component.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/AccessorView.h"
+#include "Framework/CpuFeatures.h"
+#include "Framework/GlmCommon.h"
+
+class Skin;
+class Scene;
+class Transform;
+
+/**
+ * @brief Vertex streams of one deformed submesh, float xyz positions and normals and xyzw tangents
+ * Attributes the submesh does not have stay invalid.
+ */
+struct DeformedStreams
+{
+	AccessorView position;
+	AccessorView normal;
+	AccessorView tangent;
+};
+
+/**
+ * @brief Skins and morphs one instance of a shared mesh into vertex streams of its own
+ * The joint palette is always computed, the vertices only when CPU deformation is enabled, otherwise the palette
+ * and the weights are left for a vertex shader. Morph targets are blended first and skinning applies to the result.
+ */
+class MeshDeformer : public Component
+{
+public:
+	static constexpr ComponentType kComponentType = ComponentType::MeshDeformer;
+
+	MeshDeformer() {}
+	~MeshDeformer() {};
+
+	/**
+	 * @brief Deforms mesh, node is the transform of the GameObject it is attached to
+	 */
+	void Bind(MeshHandle mesh, Transform* node);
+
+	inline MeshHandle GetMesh() const { return m_Mesh; }
+
+	void SetSkin(const std::shared_ptr<const Skin>& skin);
+
+	inline const std::shared_ptr<const Skin>& GetSkin() const { return m_Skin; }
+
+	/**
+	 * @brief Morph target weights, targets past the end of the list have weight 0
+	 */
+	inline void SetWeights(const std::vector<float>& weights) { m_Weights = weights; }
+
+	inline std::vector<float>& GetWeights() { return m_Weights; }
+
+	inline void SetCpuDeformation(bool enabled) { m_CpuDeformation = enabled; }
+
+	inline bool IsCpuDeformation() const { return m_CpuDeformation; }
+
+	/**
+	 * @brief Skinning matrices of the last Deform, mapping bind pose mesh space to the space of the node
+	 */
+	inline const std::vector<glm::mat4>& GetJointPalette() const { return m_Palette; }
+
+	/**
+	 * @brief Output of the last Deform for a submesh of the bound mesh, valid while CPU deformation is enabled
+	 */
+	inline const DeformedStreams& GetStreams(uint32_t subMesh) const { return m_SubMeshes[subMesh].streams; }
+
+	/**
+	 * @brief Updates the palettes, then the vertices of all deformers, split into vertex ranges on the job pool
+	 * Call after the animations were sampled. Nothing else may write the joint transforms or the deformers meanwhile.
+	 */
+	static void Deform(const std::vector<MeshDeformer*>& deformers);
+
+	/**
+	 * @brief Deforms every MeshDeformer of the scene nodes
+	 */
+	static void Deform(const Scene& scene);
+
+	static SimdLevel GetSimdLevel();
+
+	/**
+	 * @brief Caps the deformation paths at level, the CPU support still applies
+	 */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	/**
+	 * @brief Bind pose of a submesh decoded to floats, and the output streams written from it
+	 */
+	struct DeformedSubMesh
+	{
+		uint32_t vertexCount = 0;
+
+		// 3 floats per vertex for positions and normals, 4 for tangents, empty when missing
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> tangents;
+
+		// 4 influences per vertex, empty when the submesh is not skinned
+		std::vector<uint16_t> joints;
+		std::vector<float> jointWeights;
+
+		// Per morph target, 3 floats per vertex, empty when the target does not move the attribute
+		std::vector<std::vector<float>> positionDeltas;
+		std::vector<std::vector<float>> normalDeltas;
+		std::vector<std::vector<float>> tangentDeltas;
+
+		std::shared_ptr<std::vector<float>> outputPositions;
+		std::shared_ptr<std::vector<float>> outputNormals;
+		std::shared_ptr<std::vector<float>> outputTangents;
+		DeformedStreams streams;
+	};
+
+	/**
+	 * @brief Decodes the bind pose after the mesh or skin changed and computes the joint palette
+	 */
+	void Prepare();
+
+	void DecodeSubMeshes();
+
+	void DeformVertices(uint32_t subMesh, uint32_t begin, uint32_t end, SimdLevel level);
+
+	MeshHandle m_Mesh;
+	Transform* m_Node{ nullptr };
+	std::shared_ptr<const Skin> m_Skin;
+	std::vector<float> m_Weights;
+	bool m_CpuDeformation{ true };
+
+	bool m_Decoded{ false };
+	std::vector<DeformedSubMesh> m_SubMeshes;
+	std::vector<glm::mat4> m_Palette;
+};
@@ -0,0 +1,42 @@
+#include "Skin.h"
+
+#include <unordered_map>
+
+#include "Scene/Transform.h"
+
+Skin::Skin(std::vector<Transform*>&& joints, std::vector<glm::mat4>&& inverseBindMatrices)
+	: m_Joints(std::move(joints))
+	, m_InverseBindMatrices(std::move(inverseBindMatrices))
+	, m_ParentJoints(m_Joints.size(), -1)
+{
+	m_InverseBindMatrices.resize(m_Joints.size(), glm::mat4(1.0f));
+
+	std::unordered_map<const Transform*, int32_t> jointIndices;
+	for (size_t j = 0; j < m_Joints.size(); ++j)
+	{
+		auto parent = jointIndices.find(m_Joints[j]->GetParent());
+		if (parent != jointIndices.end())
+		{
+			m_ParentJoints[j] = parent->second;
+		}
+
+		jointIndices.emplace(m_Joints[j], static_cast<int32_t>(j));
+	}
+}
+
+void Skin::ComputeJointPalette(const Transform* node, glm::mat4* palette) const
+{
+	const glm::mat4 inverseNode = glm::inverse(node->GetWorldMatrix());
+
+	std::vector<glm::mat4> world(m_Joints.size());
+	for (size_t j = 0; j < m_Joints.size(); ++j)
+	{
+		const int32_t parent = m_ParentJoints[j];
+		world[j] = parent >= 0 ? world[parent] * m_Joints[j]->GetMatrix() : m_Joints[j]->GetWorldMatrix();
+	}
+
+	for (size_t j = 0; j < m_Joints.size(); ++j)
+	{
+		palette[j] = inverseNode * world[j] * m_InverseBindMatrices[j];
+	}
+}
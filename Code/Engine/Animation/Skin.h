@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/GlmCommon.h"
+
+class Transform;
+
+/**
+ * @brief Joints of a skinned mesh and the matrices that move its vertices from mesh space into joint space
+ */
+class Skin
+{
+public:
+	/**
+	 * @brief inverseBindMatrices holds one matrix per joint, missing ones are identity
+	 */
+	Skin(std::vector<Transform*>&& joints, std::vector<glm::mat4>&& inverseBindMatrices);
+
+	inline uint32_t GetJointCount() const { return static_cast<uint32_t>(m_Joints.size()); }
+
+	inline const std::vector<Transform*>& GetJoints() const { return m_Joints; }
+
+	inline const std::vector<glm::mat4>& GetInverseBindMatrices() const { return m_InverseBindMatrices; }
+
+	/**
+	 * @brief Writes GetJointCount() skinning matrices from the current joint transforms
+	 * palette[j] = inverse(world of node) * world of joint j * inverse bind matrix j, so skinned vertices end up in the
+	 * space of node, the node the mesh is attached to. A joint whose parent is an earlier joint reuses its world matrix.
+	 */
+	void ComputeJointPalette(const Transform* node, glm::mat4* palette) const;
+
+private:
+	std::vector<Transform*> m_Joints;
+	std::vector<glm::mat4> m_InverseBindMatrices;
+
+	// Per joint, index of the joint that is its parent and comes before it, or -1
+	std::vector<int32_t> m_ParentJoints;
+};
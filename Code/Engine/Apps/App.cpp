@@ -1,6 +1,7 @@
 
 #include "App.h"
 #include "Apps/InputSystem.h"
+#include "Framework/JobSystem.h"
 #include "Render/RenderManager.h"
 #include "Apps/window/BasicWindow.h"
 #include "ModelReader/GltfReader.h"
@@ -10,15 +11,20 @@
 #include "Scene/GameObjectUntil.h"
 #include "Scene/Light.h"
 #include "Scene/Transform.h"
+#include "Scene/TransformHierarchy.h"
 #include "Scene/Camera.h"
 
 ExitCode App::Initialize()
 {
 	InputSystem::Initialized();
+	JobSystem::Initialized();
 
 	m_AppWindow = CreateWlWindow();
 
-	Scene* scene = GltfReader::LoadFile("C:/Wlon/WlonEngine/Code/Resources/Bonza4X.gltf");
+	// Level files load as one batch, the reads of one file overlap the decode of the others
+	const std::vector<std::string> levelFiles = { "C:/Wlon/WlonEngine/Code/Resources/Bonza4X.gltf" };
+	std::vector<Scene*> levelScenes = GltfReader::LoadFiles(levelFiles);
+	Scene* scene = levelScenes[0];
 	GameObject* rootGo = scene->GetRootNode();
 	Transform* rootTransform = rootGo->GetComponent<Transform>();
 
@@ -32,7 +38,7 @@ ExitCode App::Initialize()
 		light->SetLightType(LightType::Directional);
 		
 		transform->SetParent(rootTransform);
-		scene->AddNode(go);
+		scene->AddNode(go->GetHandle());
 	}
 
 	{
@@ -50,6 +56,11 @@ ExitCode App::PlayerLoop()
 {
 	while (!m_AppWindow->ShouldClose())
 	{
+		// Streaming loads publish their nodes and meshes here, before the frame reads the scene
+		JobSystem::GetInstance().RunMainThreadJobs();
+
+		TransformHierarchy::GetInstance().Update();
+
 		RenderManager::GetInstance().Update();
 
 		m_AppWindow->ProcessEvents();
@@ -60,5 +71,6 @@ ExitCode App::PlayerLoop()
 
 void App::Terminate()
 {
+	JobSystem::Terminate();
 	WL_DELETE(m_AppWindow);
 }
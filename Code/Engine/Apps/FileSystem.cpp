@@ -1,6 +1,19 @@
 
 #include "FileSystem.h"
+#include "Apps/BaseInclude.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <thread>
+
+#if !USE_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 FileSystem FileSystem::s_Instance;
 
@@ -40,3 +53,168 @@ std::vector<uint8_t> FileSystem::LoadFile(const std::string& filename)
 
 	return data;
 }
+
+std::shared_ptr<MappedFile> FileSystem::MapFile(const std::string& filename)
+{
+	std::shared_ptr<MappedFile> mappedFile(new MappedFile());
+
+#if USE_WINDOWS
+	// FILE_SHARE_DELETE lets WriteFile rename a new version over a file that is still mapped
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open file: " + filename);
+	}
+	mappedFile->m_File = file;
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	mappedFile->m_Size = static_cast<size_t>(size.QuadPart);
+	if (mappedFile->m_Size == 0)
+	{
+		return mappedFile;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		throw std::runtime_error("Failed to map file: " + filename);
+	}
+	mappedFile->m_Mapping = mapping;
+	mappedFile->m_Data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		throw std::runtime_error("Failed to open file: " + filename);
+	}
+	mappedFile->m_File = file;
+
+	struct stat fileStat;
+	fstat(file, &fileStat);
+	mappedFile->m_Size = static_cast<size_t>(fileStat.st_size);
+	if (mappedFile->m_Size == 0)
+	{
+		return mappedFile;
+	}
+
+	void* data = mmap(nullptr, mappedFile->m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+	mappedFile->m_Data = data == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(data);
+#endif
+
+	if (!mappedFile->m_Data)
+	{
+		throw std::runtime_error("Failed to map file: " + filename);
+	}
+
+	return mappedFile;
+}
+
+bool FileSystem::GetFileInfo(const std::string& filename, FileInfo& info)
+{
+	std::error_code error;
+	if (!std::filesystem::is_regular_file(filename, error))
+	{
+		return false;
+	}
+
+	info.size = static_cast<uint64_t>(std::filesystem::file_size(filename, error));
+	info.modifiedTime = static_cast<int64_t>(std::filesystem::last_write_time(filename, error).time_since_epoch().count());
+	return !error;
+}
+
+std::vector<std::string> FileSystem::ListFiles(const std::string& directory)
+{
+	std::vector<std::string> files;
+
+	std::error_code error;
+	for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+	{
+		if (it->is_regular_file(error))
+		{
+			files.push_back(it->path().generic_string());
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+bool FileSystem::MakeDirectories(const std::string& directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	return std::filesystem::is_directory(directory, error);
+}
+
+bool FileSystem::RemoveFile(const std::string& filename)
+{
+	std::error_code error;
+	return std::filesystem::remove(filename, error);
+}
+
+bool FileSystem::WriteFile(const std::string& filename, const void* data, size_t size)
+{
+	// Unique per writer, threads and processes may write the same file at once
+	static std::atomic<uint32_t> s_TemporaryCount{ 0 };
+#if USE_WINDOWS
+	const uint64_t process = GetCurrentProcessId();
+#else
+	const uint64_t process = static_cast<uint64_t>(getpid());
+#endif
+	const size_t thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+	const std::string temporary = filename + ".tmp" + std::to_string(process) + "_" + std::to_string(thread) + "_" + std::to_string(s_TemporaryCount++);
+
+	{
+		std::ofstream stream(temporary, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			return false;
+		}
+
+		stream.write(static_cast<const char*>(data), size);
+		stream.close();
+		if (stream.fail())
+		{
+			RemoveFile(temporary);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, filename, error);
+	if (error)
+	{
+		RemoveFile(temporary);
+		return false;
+	}
+
+	return true;
+}
+
+MappedFile::~MappedFile()
+{
+#if USE_WINDOWS
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	if (m_File)
+	{
+		CloseHandle(m_File);
+	}
+#else
+	if (m_Data)
+	{
+		munmap(const_cast<uint8_t*>(m_Data), m_Size);
+	}
+	if (m_File >= 0)
+	{
+		close(m_File);
+	}
+#endif
+}
@@ -2,6 +2,43 @@
 
 #include <vector>
 #include <string>
+#include <memory>
+
+/**
+ * @brief Read-only memory mapping of a whole file, unmapped when the last reference goes away
+ */
+class MappedFile
+{
+public:
+	~MappedFile();
+
+	inline const uint8_t* Data() const { return m_Data; }
+	inline size_t Size() const { return m_Size; }
+
+private:
+	friend class FileSystem;
+	MappedFile() {};
+
+	const uint8_t* m_Data{ nullptr };
+	size_t m_Size{ 0 };
+
+#if USE_WINDOWS
+	void* m_File{ nullptr };
+	void* m_Mapping{ nullptr };
+#else
+	int m_File{ -1 };
+#endif
+};
+
+/**
+ * @brief Size and last write time of a file, enough to tell that it changed without reading it
+ */
+struct FileInfo
+{
+	uint64_t size{ 0 };
+	/// Opaque timestamp, only compared for equality
+	int64_t modifiedTime{ 0 };
+};
 
 class FileSystem
 {
@@ -9,9 +46,33 @@ public:
 	static FileSystem& GetInstance();
 	static void Initialized();
 	static std::vector<uint8_t> LoadFile(const std::string& filename);
+	static std::shared_ptr<MappedFile> MapFile(const std::string& filename);
+
+	/**
+	 * @brief Returns false when the file does not exist or is not a regular file
+	 */
+	static bool GetFileInfo(const std::string& filename, FileInfo& info);
+
+	/**
+	 * @brief Regular files below a directory, recursively, sorted by path
+	 */
+	static std::vector<std::string> ListFiles(const std::string& directory);
+
+	/**
+	 * @brief Creates a directory and its missing parents, true when it exists afterwards
+	 */
+	static bool MakeDirectories(const std::string& directory);
+
+	static bool RemoveFile(const std::string& filename);
+
+	/**
+	 * @brief Writes a file through a temporary file in the same directory that is renamed over it
+	 * Readers that still map the previous file keep its contents, they never see a partly written one.
+	 */
+	static bool WriteFile(const std::string& filename, const void* data, size_t size);
 protected:
 private:
 	FileSystem() {};
 
 	static FileSystem s_Instance;
-};
\ No newline at end of file
+};
@@ -0,0 +1,117 @@
+
+#include "CpuFeatures.h"
+
+#if WL_SIMD_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+struct CpuFeatureFlags
+{
+	bool sse2 = false;
+	bool avx2 = false;
+};
+
+#if WL_SIMD_X86
+static void QueryCpuid(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+{
+#if defined(_MSC_VER)
+	int values[4];
+	__cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int i = 0; i < 4; ++i)
+	{
+		registers[i] = static_cast<uint32_t>(values[i]);
+	}
+#else
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+static uint64_t QueryEnabledXcr0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+static CpuFeatureFlags DetectCpuFeatures()
+{
+	CpuFeatureFlags flags;
+
+#if WL_SIMD_X86
+	uint32_t registers[4];
+	QueryCpuid(0, 0, registers);
+	const uint32_t maxLeaf = registers[0];
+
+	QueryCpuid(1, 0, registers);
+	flags.sse2 = (registers[3] & (1u << 26)) != 0;
+
+	// AVX state has to be enabled by the OS as well (OSXSAVE and the XMM/YMM bits of XCR0)
+	const bool osxsave = (registers[2] & (1u << 27)) != 0;
+	const bool avx = (registers[2] & (1u << 28)) != 0;
+	const bool popcnt = (registers[2] & (1u << 23)) != 0;
+	if (maxLeaf >= 7 && osxsave && avx && popcnt && (QueryEnabledXcr0() & 0x6) == 0x6)
+	{
+		QueryCpuid(7, 0, registers);
+		flags.avx2 = (registers[1] & (1u << 5)) != 0;
+	}
+#endif
+
+	return flags;
+}
+
+static const CpuFeatureFlags& GetCpuFeatureFlags()
+{
+	static const CpuFeatureFlags flags = DetectCpuFeatures();
+	return flags;
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE2:
+		return "SSE2";
+	case SimdLevel::AVX2:
+		return "AVX2";
+	default:
+		return "Scalar";
+	}
+}
+
+bool CpuFeatures::HasSSE2()
+{
+	return GetCpuFeatureFlags().sse2;
+}
+
+bool CpuFeatures::HasAVX2()
+{
+	return GetCpuFeatureFlags().avx2;
+}
+
+SimdLevel CpuFeatures::GetSimdLevel()
+{
+#if WL_SIMD_AVX2
+	if (HasAVX2())
+	{
+		return SimdLevel::AVX2;
+	}
+#endif
+
+#if WL_SIMD_SSE2
+	if (HasSSE2())
+	{
+		return SimdLevel::SSE2;
+	}
+#endif
+
+	return SimdLevel::Scalar;
+}
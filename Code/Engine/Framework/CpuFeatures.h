@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WL_SIMD_X86 1
+#else
+#define WL_SIMD_X86 0
+#endif
+
+// SSE2 is part of x86-64, 32-bit builds only get it when the compiler targets it
+#if WL_SIMD_X86 && (defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define WL_SIMD_SSE2 1
+#else
+#define WL_SIMD_SSE2 0
+#endif
+
+// AVX2 code paths are compiled per function and only entered after CpuFeatures::HasAVX2(), which implies POPCNT
+#if WL_SIMD_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define WL_SIMD_AVX2 1
+#define WL_TARGET_AVX2 __attribute__((target("avx2,popcnt")))
+#elif WL_SIMD_SSE2 && defined(_MSC_VER)
+#define WL_SIMD_AVX2 1
+#define WL_TARGET_AVX2
+#else
+#define WL_SIMD_AVX2 0
+#define WL_TARGET_AVX2
+#endif
+
+/**
+ * @brief Widest instruction set a SIMD code path can use
+ */
+enum class SimdLevel : uint32_t
+{
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+const char* GetSimdLevelName(SimdLevel level);
+
+/**
+ * @brief Instruction sets of the CPU the engine runs on, detected once
+ */
+class CpuFeatures
+{
+public:
+	static bool HasSSE2();
+	static bool HasAVX2();
+
+	/**
+	 * @brief Widest level both the CPU and this build support
+	 */
+	static SimdLevel GetSimdLevel();
+
+private:
+	CpuFeatures() {};
+	~CpuFeatures() {};
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 32 bit reference to an object of a HandlePool, the slot index in the low bits and the slot generation in the high bits
+ * Destroying the object moves its slot to the next generation, so every handle to it goes stale at once and is
+ * recognized by one compare. The null handle is 0, generations start at 1.
+ */
+template<typename T>
+struct Handle
+{
+	static constexpr uint32_t kIndexBits = 22;
+	static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+	static constexpr uint32_t kMaxGeneration = (1u << (32 - kIndexBits)) - 1;
+
+	uint32_t id = 0;
+
+	Handle() = default;
+	explicit Handle(uint32_t id) : id(id) {}
+	Handle(uint32_t index, uint32_t generation) : id((generation << kIndexBits) | index) {}
+
+	inline uint32_t GetIndex() const { return id & kIndexMask; }
+	inline uint32_t GetGeneration() const { return id >> kIndexBits; }
+
+	/**
+	 * @brief Not null, whether the object is still alive is up to its pool
+	 */
+	inline bool IsValid() const { return id != 0; }
+
+	inline bool operator==(const Handle& other) const { return id == other.id; }
+	inline bool operator!=(const Handle& other) const { return id != other.id; }
+	inline bool operator<(const Handle& other) const { return id < other.id; }
+};
+
+/**
+ * @brief Objects of one type in fixed size chunks, referenced by generational handles
+ * Chunks never move, so an object keeps its address for its whole life. Destroyed slots are reused before the pool
+ * grows. Debug builds fill a destroyed object with 0xDD, so raw pointers kept past Destroy fault on their next
+ * virtual call instead of reading the next object.
+ * The pool does not lock, its owner serializes Create, Destroy and ForEach. Get may run on other threads meanwhile:
+ * chunks are published with a release store and the generation and alive flag of a slot are one atomic word, written
+ * after the object is constructed and before it is destroyed. Get only tells whether the object was alive, keeping
+ * it alive while it is used (a reference, or the owner's lock) is up to the caller.
+ */
+template<typename T>
+class HandlePool
+{
+public:
+	static constexpr uint32_t kChunkShift = 10;
+	static constexpr uint32_t kChunkSize = 1u << kChunkShift;
+	static constexpr uint32_t kMaxChunks = (Handle<T>::kIndexMask + 1) >> kChunkShift;
+
+	HandlePool() {}
+	~HandlePool()
+	{
+		for (uint32_t index = 0; index < m_SlotCount; ++index)
+		{
+			Chunk& chunk = *m_Chunks[index >> kChunkShift].load(std::memory_order_relaxed);
+			if (IsAliveState(chunk.states[index & (kChunkSize - 1)].load(std::memory_order_relaxed)))
+			{
+				chunk.Get(index & (kChunkSize - 1))->~T();
+			}
+		}
+
+		for (std::atomic<Chunk*>& chunk : m_Chunks)
+		{
+			delete chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	HandlePool(const HandlePool&) = delete;
+	HandlePool& operator=(const HandlePool&) = delete;
+
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		uint32_t index;
+		if (!m_FreeSlots.empty())
+		{
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			if (m_SlotCount == kMaxChunks * kChunkSize)
+			{
+				throw std::runtime_error("Handle pool is full");
+			}
+
+			index = m_SlotCount;
+			if ((index & (kChunkSize - 1)) == 0)
+			{
+				m_Chunks[index >> kChunkShift].store(new Chunk, std::memory_order_release);
+			}
+			m_Chunks[index >> kChunkShift].load(std::memory_order_relaxed)->states[index & (kChunkSize - 1)].store(MakeState(1, false), std::memory_order_relaxed);
+			m_SlotCount++;
+		}
+
+		Chunk& chunk = *m_Chunks[index >> kChunkShift].load(std::memory_order_relaxed);
+		const uint32_t slot = index & (kChunkSize - 1);
+		try
+		{
+			new (chunk.Get(slot)) T(std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			m_FreeSlots.push_back(index);
+			throw;
+		}
+
+		const uint32_t generation = chunk.states[slot].load(std::memory_order_relaxed) >> 1;
+		chunk.states[slot].store(MakeState(generation, true), std::memory_order_release);
+		m_Count++;
+		return Handle<T>(index, generation);
+	}
+
+	/**
+	 * @brief Destroys the object of handle, false when the handle is null or stale
+	 */
+	bool Destroy(Handle<T> handle)
+	{
+		T* object = Get(handle);
+		if (!object)
+		{
+			return false;
+		}
+
+		// The slot goes stale before the object goes away, a Get from now on returns null
+		const uint32_t index = handle.GetIndex();
+		Chunk& chunk = *m_Chunks[index >> kChunkShift].load(std::memory_order_relaxed);
+		const uint32_t slot = index & (kChunkSize - 1);
+		const uint32_t generation = handle.GetGeneration();
+		chunk.states[slot].store(MakeState(generation == Handle<T>::kMaxGeneration ? 1 : generation + 1, false), std::memory_order_release);
+
+		object->~T();
+#ifndef NDEBUG
+		std::memset(static_cast<void*>(object), 0xDD, sizeof(T));
+#endif
+		m_FreeSlots.push_back(index);
+		m_Count--;
+		return true;
+	}
+
+	/**
+	 * @brief Object of handle, null when the handle is null or stale
+	 */
+	inline T* Get(Handle<T> handle) const
+	{
+		const uint32_t index = handle.GetIndex();
+		Chunk* chunk = m_Chunks[index >> kChunkShift].load(std::memory_order_acquire);
+		const uint32_t slot = index & (kChunkSize - 1);
+		if (!chunk || chunk->states[slot].load(std::memory_order_acquire) != MakeState(handle.GetGeneration(), true))
+		{
+			return nullptr;
+		}
+		return chunk->Get(slot);
+	}
+
+	inline bool IsAlive(Handle<T> handle) const { return Get(handle) != nullptr; }
+
+	inline uint32_t GetCount() const { return m_Count; }
+
+	/**
+	 * @brief Calls function(T&) for every live object in slot order, a chunk at a time
+	 */
+	template<typename F>
+	void ForEach(F&& function)
+	{
+		for (uint32_t first = 0; first < m_SlotCount; first += kChunkSize)
+		{
+			Chunk& chunk = *m_Chunks[first >> kChunkShift].load(std::memory_order_relaxed);
+			const uint32_t count = std::min(kChunkSize, m_SlotCount - first);
+			for (uint32_t slot = 0; slot < count; ++slot)
+			{
+				if (IsAliveState(chunk.states[slot].load(std::memory_order_relaxed)))
+				{
+					function(*chunk.Get(slot));
+				}
+			}
+		}
+	}
+
+private:
+	struct Chunk
+	{
+		alignas(T) unsigned char storage[sizeof(T) * kChunkSize];
+		/// Generation of the slot above the alive bit, see MakeState
+		std::atomic<uint32_t> states[kChunkSize] = {};
+
+		inline T* Get(uint32_t slot) { return reinterpret_cast<T*>(storage) + slot; }
+	};
+
+	static inline constexpr uint32_t MakeState(uint32_t generation, bool alive) { return (generation << 1) | (alive ? 1u : 0u); }
+	static inline constexpr bool IsAliveState(uint32_t state) { return (state & 1u) != 0; }
+
+	// Fixed, so Get never sees the table move
+	std::atomic<Chunk*> m_Chunks[kMaxChunks] = {};
+	uint32_t m_SlotCount{ 0 };
+	std::vector<uint32_t> m_FreeSlots;
+	uint32_t m_Count{ 0 };
+};
@@ -0,0 +1,47 @@
+
+#include "Hash.h"
+
+#include <cstring>
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ULL;
+	const int r = 47;
+
+	uint64_t h = seed ^ (size * m);
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	const uint8_t* end = bytes + (size / 8) * 8;
+
+	while (bytes != end)
+	{
+		uint64_t k;
+		std::memcpy(&k, bytes, sizeof(k));
+		bytes += 8;
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	switch (size & 7)
+	{
+	case 7: h ^= uint64_t(bytes[6]) << 48; [[fallthrough]];
+	case 6: h ^= uint64_t(bytes[5]) << 40; [[fallthrough]];
+	case 5: h ^= uint64_t(bytes[4]) << 32; [[fallthrough]];
+	case 4: h ^= uint64_t(bytes[3]) << 24; [[fallthrough]];
+	case 3: h ^= uint64_t(bytes[2]) << 16; [[fallthrough]];
+	case 2: h ^= uint64_t(bytes[1]) << 8; [[fallthrough]];
+	case 1: h ^= uint64_t(bytes[0]);
+		h *= m;
+	};
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
@@ -0,0 +1,15 @@
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief 64-bit MurmurHash2 (64A) of a byte range, used as a content hash for assets
+ */
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+	return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
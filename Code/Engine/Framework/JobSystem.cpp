@@ -0,0 +1,237 @@
+
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <iostream>
+
+JobSystem JobSystem::s_Instance;
+
+void JobGroup::RethrowException() const
+{
+	if (m_Exception)
+	{
+		std::rethrow_exception(m_Exception);
+	}
+}
+
+JobSystem& JobSystem::GetInstance()
+{
+	return s_Instance;
+}
+
+void JobSystem::Initialized(uint32_t threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	GetInstance().Stop();
+	GetInstance().Start(threadCount);
+}
+
+void JobSystem::Terminate()
+{
+	GetInstance().Stop();
+}
+
+JobSystem::~JobSystem()
+{
+	Stop();
+}
+
+uint32_t JobSystem::GetThreadCount() const
+{
+	return static_cast<uint32_t>(m_Workers.size()) + 1;
+}
+
+void JobSystem::Start(uint32_t threadCount)
+{
+	m_Stopping = false;
+
+	// The thread that waits on a group runs jobs too, so it counts as one of the threads
+	for (uint32_t i = 1; i < threadCount; ++i)
+	{
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+void JobSystem::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_QueueSignal.notify_all();
+
+	for (auto& worker : m_Workers)
+	{
+		worker.join();
+	}
+	m_Workers.clear();
+
+	// Anything submitted after the last worker left still has to run
+	while (TryRunOne())
+	{
+	}
+}
+
+void JobSystem::Submit(std::function<void()> job, JobGroup* group)
+{
+	if (group)
+	{
+		group->m_Pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	Job entry{ std::move(job), group };
+	if (m_Workers.empty())
+	{
+		Run(entry);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.push_back(std::move(entry));
+	}
+	m_QueueSignal.notify_one();
+
+	// A thread waiting on the group may run the job itself
+	if (group)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_DoneSignal.notify_all();
+	}
+}
+
+void JobSystem::Wait(JobGroup& group)
+{
+	auto hasGroupJob = [&]
+	{
+		return std::any_of(m_Queue.begin(), m_Queue.end(), [&](const Job& job) { return job.group == &group; });
+	};
+
+	while (!group.IsDone())
+	{
+		if (TryRunOne(&group))
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneSignal.wait(lock, [&] { return group.IsDone() || hasGroupJob(); });
+	}
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t begin, uint32_t end)>& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	batchSize = std::max(1u, batchSize);
+	if (m_Workers.empty() || count <= batchSize)
+	{
+		job(0, count);
+		return;
+	}
+
+	// The queued batches reference job and group, so they must all finish before an exception leaves this frame
+	JobGroup group;
+	for (uint32_t begin = 0; begin < count; begin += batchSize)
+	{
+		uint32_t end = std::min(count, begin + batchSize);
+		Submit([&job, begin, end] { job(begin, end); }, &group);
+	}
+
+	Wait(group);
+	group.RethrowException();
+}
+
+void JobSystem::SubmitToMainThread(std::function<void()> job)
+{
+	std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+	m_MainThreadQueue.push_back(std::move(job));
+}
+
+void JobSystem::RunMainThreadJobs()
+{
+	std::vector<std::function<void()>> jobs;
+	{
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		jobs.swap(m_MainThreadQueue);
+	}
+
+	for (auto& job : jobs)
+	{
+		job();
+	}
+}
+
+void JobSystem::WorkerLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_QueueSignal.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+			if (m_Queue.empty())
+			{
+				return;
+			}
+
+			job = std::move(m_Queue.front());
+			m_Queue.pop_front();
+		}
+
+		Run(job);
+	}
+}
+
+bool JobSystem::TryRunOne(JobGroup* group)
+{
+	Job job;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto it = group ? std::find_if(m_Queue.begin(), m_Queue.end(), [&](const Job& queued) { return queued.group == group; }) : m_Queue.begin();
+		if (it == m_Queue.end())
+		{
+			return false;
+		}
+
+		job = std::move(*it);
+		m_Queue.erase(it);
+	}
+
+	Run(job);
+	return true;
+}
+
+void JobSystem::Run(Job& job)
+{
+	try
+	{
+		job.function();
+	}
+	catch (...)
+	{
+		// Unwinding out of a worker would terminate the process, and out of Wait would leave the group behind
+		if (!job.group)
+		{
+			std::cerr << "JobSystem: a job without a group threw, the exception is dropped" << std::endl;
+		}
+		else if (!job.group->m_Failed.test_and_set(std::memory_order_relaxed))
+		{
+			job.group->m_Exception = std::current_exception();
+		}
+	}
+
+	if (job.group && job.group->m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		// Taking the lock orders the notification after a waiter's predicate check
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_DoneSignal.notify_all();
+	}
+}
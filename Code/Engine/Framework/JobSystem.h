@@ -0,0 +1,118 @@
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Counts the jobs of one batch that are still in flight, Wait() on it to join the batch
+ * A job that throws still counts as done, the group keeps the first exception for the waiter to rethrow.
+ */
+class JobGroup
+{
+public:
+	JobGroup() {};
+
+	inline bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+	/**
+	 * @brief First exception a job of the group threw, only valid once the group is done
+	 */
+	inline std::exception_ptr GetException() const { return m_Exception; }
+
+	/**
+	 * @brief Rethrows the first exception of the group, call after Wait
+	 */
+	void RethrowException() const;
+
+private:
+	friend class JobSystem;
+
+	std::atomic<uint32_t> m_Pending{ 0 };
+	std::atomic_flag m_Failed = ATOMIC_FLAG_INIT;
+	std::exception_ptr m_Exception;
+};
+
+/**
+ * @brief Fixed pool of worker threads fed from one shared queue
+ * Without workers (Initialized never called or a thread count of 1) every job runs inline on the caller.
+ */
+class JobSystem
+{
+public:
+	static JobSystem& GetInstance();
+
+	/**
+	 * @brief Starts the workers, 0 uses one thread per hardware core. Can be called again to resize the pool.
+	 */
+	static void Initialized(uint32_t threadCount = 0);
+	static void Terminate();
+
+	/**
+	 * @brief Number of threads that execute jobs, including the thread waiting on them
+	 */
+	uint32_t GetThreadCount() const;
+
+	void Submit(std::function<void()> job, JobGroup* group = nullptr);
+
+	/**
+	 * @brief Blocks until all jobs of the group are done, executing queued jobs of the group in the meantime
+	 * Jobs of other groups are left to the workers, so a frame waiting on a short ParallelFor never picks up a
+	 * long streaming job.
+	 */
+	void Wait(JobGroup& group);
+
+	/**
+	 * @brief Splits [0, count) into batches of batchSize and runs job(begin, end) on each, returns when all are done
+	 * If a batch throws, the first exception is rethrown here once every batch has finished.
+	 */
+	void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t begin, uint32_t end)>& job);
+
+	/**
+	 * @brief Queues a job for the main thread, callable from any thread
+	 */
+	void SubmitToMainThread(std::function<void()> job);
+
+	/**
+	 * @brief Runs the main thread jobs queued so far, called once per frame by the player loop
+	 * Jobs queued while running wait for the next call, so a job that requeues itself cannot stall the frame.
+	 */
+	void RunMainThreadJobs();
+
+private:
+	struct Job
+	{
+		std::function<void()> function;
+		JobGroup* group;
+	};
+
+	JobSystem() {};
+	~JobSystem();
+
+	void Start(uint32_t threadCount);
+	void Stop();
+	void WorkerLoop();
+	/**
+	 * @brief Runs the oldest queued job of group, or of any group when group is null
+	 */
+	bool TryRunOne(JobGroup* group = nullptr);
+	void Run(Job& job);
+
+	std::vector<std::thread> m_Workers;
+	std::deque<Job> m_Queue;
+	std::mutex m_Mutex;
+	std::condition_variable m_QueueSignal;
+	std::condition_variable m_DoneSignal;
+	bool m_Stopping{ false };
+
+	std::vector<std::function<void()>> m_MainThreadQueue;
+	std::mutex m_MainThreadMutex;
+
+	static JobSystem s_Instance;
+};
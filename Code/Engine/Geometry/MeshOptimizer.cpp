@@ -0,0 +1,363 @@
+
+#include "MeshOptimizer.h"
+
+#include "Geometry/MeshUtils.h"
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <numeric>
+
+/**
+ * @brief FIFO post-transform cache model, a vertex stays cached for cacheSize subsequent misses
+ */
+struct VertexCacheModel
+{
+	std::vector<uint32_t> timestamps;
+	uint32_t cacheSize;
+	uint32_t time;
+
+	VertexCacheModel(uint32_t vertexCount, uint32_t cacheSize) :
+		timestamps(vertexCount, 0),
+		cacheSize{ cacheSize },
+		time{ cacheSize + 1 }
+	{
+	}
+
+	inline uint32_t Access(uint32_t vertex)
+	{
+		if (time - timestamps[vertex] > cacheSize)
+		{
+			timestamps[vertex] = time++;
+			return 1;
+		}
+		return 0;
+	}
+
+	inline void Flush()
+	{
+		time += cacheSize + 1;
+	}
+};
+
+VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStatistics statistics;
+	if (indexCount < 3)
+	{
+		return statistics;
+	}
+
+	VertexCacheModel cache(vertexCount, cacheSize);
+	std::vector<uint8_t> referenced(vertexCount, 0);
+
+	uint32_t misses = 0;
+	uint32_t uniqueVertices = 0;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		misses += cache.Access(indices[i]);
+		uniqueVertices += referenced[indices[i]] ? 0 : 1;
+		referenced[indices[i]] = 1;
+	}
+
+	statistics.acmr = float(misses) / float(indexCount / 3);
+	statistics.atvr = float(misses) / float(uniqueVertices);
+
+	return statistics;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, uint32_t vertexCount, std::vector<uint32_t>* clusters)
+{
+	const size_t triangleCount = indexCount / 3;
+
+	if (clusters)
+	{
+		clusters->clear();
+	}
+
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// counts doubles as the number of not yet emitted triangles of every vertex
+	MeshUtils::TriangleAdjacency adjacency;
+	MeshUtils::BuildTriangleAdjacency(adjacency, indices, triangleCount * 3, vertexCount);
+	std::vector<uint32_t>& liveTriangles = adjacency.counts;
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnd;
+	deadEnd.reserve(triangleCount * 3);
+	std::vector<uint32_t> candidates;
+
+	const uint32_t cacheSize = kCacheSize;
+	uint32_t time = cacheSize + 1;
+	uint32_t cursor = 0;
+	size_t output = 0;
+
+	if (clusters)
+	{
+		clusters->push_back(0);
+	}
+
+	int64_t current = 0;
+	while (current >= 0)
+	{
+		candidates.clear();
+
+		const uint32_t fan = static_cast<uint32_t>(current);
+		for (uint32_t k = adjacency.offsets[fan]; k < adjacency.offsets[fan + 1]; ++k)
+		{
+			const uint32_t triangle = adjacency.triangles[k];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t v = indices[triangle * 3 + corner];
+				destination[output++] = v;
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+
+				if (time - cacheTime[v] > cacheSize)
+				{
+					cacheTime[v] = time++;
+				}
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Prefer the candidate that is still in the cache and will stay there while its fan is emitted
+		int64_t best = -1;
+		int64_t bestPriority = -1;
+		for (uint32_t v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+			{
+				continue;
+			}
+
+			int64_t priority = 0;
+			if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+			{
+				priority = time - cacheTime[v];
+			}
+
+			if (priority > bestPriority)
+			{
+				best = v;
+				bestPriority = priority;
+			}
+		}
+
+		if (best < 0)
+		{
+			// Dead end, continue with a recently used vertex or the next one in input order
+			while (!deadEnd.empty() && best < 0)
+			{
+				const uint32_t v = deadEnd.back();
+				deadEnd.pop_back();
+				if (liveTriangles[v] > 0)
+				{
+					best = v;
+				}
+			}
+
+			while (best < 0 && cursor < vertexCount)
+			{
+				if (liveTriangles[cursor] > 0)
+				{
+					best = cursor;
+				}
+				else
+				{
+					cursor++;
+				}
+			}
+
+			if (best >= 0 && clusters)
+			{
+				clusters->push_back(static_cast<uint32_t>(output / 3));
+			}
+		}
+
+		current = best;
+	}
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, uint32_t vertexCount,
+	const std::vector<uint32_t>& clusters, float threshold)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> hardClusters = clusters;
+	if (hardClusters.empty() || hardClusters[0] != 0)
+	{
+		hardClusters.insert(hardClusters.begin(), 0);
+	}
+
+	// Split the hard clusters wherever a cold cache run has already reached threshold times the cluster ACMR
+	std::vector<uint32_t> softClusters;
+	VertexCacheModel cache(vertexCount, kCacheSize);
+	for (size_t c = 0; c < hardClusters.size(); ++c)
+	{
+		const uint32_t begin = hardClusters[c];
+		const uint32_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : triangleCount;
+
+		cache.Flush();
+		uint32_t clusterMisses = 0;
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			clusterMisses += cache.Access(indices[t * 3 + 0]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+		}
+		const float targetAcmr = threshold * float(clusterMisses) / float(end - begin);
+
+		cache.Flush();
+		softClusters.push_back(begin);
+		uint32_t softBegin = begin;
+		uint32_t softMisses = 0;
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			softMisses += cache.Access(indices[t * 3 + 0]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+
+			if (t + 1 < end && float(softMisses) <= targetAcmr * float(t + 1 - softBegin))
+			{
+				softClusters.push_back(t + 1);
+				softBegin = t + 1;
+				softMisses = 0;
+				cache.Flush();
+			}
+		}
+	}
+
+	// Area weighted centroid and normal of every cluster
+	const size_t clusterCount = softClusters.size();
+	std::vector<glm::vec3> centroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> normals(clusterCount, glm::vec3(0.0f));
+	std::vector<float> areas(clusterCount, 0.0f);
+	glm::vec3 meshCentroid(0.0f);
+	float meshArea = 0.0f;
+
+	for (size_t c = 0; c < clusterCount; ++c)
+	{
+		const uint32_t begin = softClusters[c];
+		const uint32_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+
+		for (uint32_t t = begin; t < end; ++t)
+		{
+			const glm::vec3& p0 = positions[indices[t * 3 + 0]];
+			const glm::vec3& p1 = positions[indices[t * 3 + 1]];
+			const glm::vec3& p2 = positions[indices[t * 3 + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+			glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+			centroids[c] += centroid * area;
+			normals[c] += normal;
+			areas[c] += area;
+		}
+
+		meshCentroid += centroids[c];
+		meshArea += areas[c];
+		centroids[c] = areas[c] > 0.0f ? centroids[c] / areas[c] : centroids[c];
+	}
+
+	meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : meshCentroid;
+
+	// Clusters that face away from the mesh center are more likely to occlude the rest, draw them first
+	std::vector<float> sortKeys(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; ++c)
+	{
+		float normalLength = glm::length(normals[c]);
+		sortKeys[c] = normalLength > 0.0f ? glm::dot(centroids[c] - meshCentroid, normals[c] / normalLength) : 0.0f;
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	size_t output = 0;
+	for (uint32_t c : order)
+	{
+		const uint32_t begin = softClusters[c];
+		const uint32_t end = c + 1 < clusterCount ? softClusters[c + 1] : triangleCount;
+
+		for (uint32_t i = begin * 3; i < end * 3; ++i)
+		{
+			destination[output++] = indices[i];
+		}
+	}
+}
+
+uint32_t MeshOptimizer::OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, uint32_t vertexCount)
+{
+	std::fill(remap, remap + vertexCount, ~0u);
+
+	uint32_t nextVertex = 0;
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		if (remap[indices[i]] == ~0u)
+		{
+			remap[indices[i]] = nextVertex++;
+		}
+	}
+
+	return nextVertex;
+}
+
+MeshOptimizeStatistics MeshOptimizer::Optimize(SubMesh& subMesh, float overdrawThreshold)
+{
+	MeshOptimizeStatistics statistics;
+
+	// Non indexed triangle lists have nothing to share, reordering would not save any vertex
+	if (!subMesh.indexBuffer.IsValid())
+	{
+		return statistics;
+	}
+
+	std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	const uint32_t vertexCount = subMesh.vertexCount;
+	if (indices.size() < 3 || indices.size() % 3 != 0 || *std::max_element(indices.begin(), indices.end()) >= vertexCount)
+	{
+		return statistics;
+	}
+
+	statistics.before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+	std::vector<uint32_t> cacheOrder(indices.size());
+	std::vector<uint32_t> clusters;
+	OptimizeVertexCache(cacheOrder.data(), indices.data(), indices.size(), vertexCount, &clusters);
+
+	std::vector<glm::vec3> positions;
+	if (MeshUtils::ReadPositions(subMesh, positions))
+	{
+		OptimizeOverdraw(indices.data(), cacheOrder.data(), cacheOrder.size(), positions.data(), vertexCount, clusters, overdrawThreshold);
+	}
+	else
+	{
+		indices.swap(cacheOrder);
+	}
+
+	std::vector<uint32_t> remap(vertexCount);
+	uint32_t usedVertices = OptimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertexCount);
+	for (uint32_t& index : indices)
+	{
+		index = remap[index];
+	}
+
+	MeshUtils::RemapVertices(subMesh, remap, usedVertices);
+	MeshUtils::WriteIndices(subMesh, indices);
+
+	statistics.after = AnalyzeVertexCache(indices.data(), indices.size(), usedVertices);
+
+	return statistics;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Framework/GlmCommon.h"
+
+struct SubMesh;
+
+/**
+ * @brief Post-transform vertex cache efficiency of an index buffer
+ */
+struct VertexCacheStatistics
+{
+	/// Average cache miss ratio, transformed vertices per triangle (0.5 is the optimum for regular grids, 3 the worst)
+	float acmr = 0.0f;
+	/// Average transformed to vertex ratio, transformed vertices per referenced vertex (1 is the optimum)
+	float atvr = 0.0f;
+};
+
+struct MeshOptimizeStatistics
+{
+	VertexCacheStatistics before;
+	VertexCacheStatistics after;
+};
+
+/**
+ * @brief Import time index/vertex reordering for triangle lists
+ * Vertex cache order is Tipsify (Sander et al. 2007), overdraw order sorts the Tipsify clusters
+ * outward facing first, and vertex fetch order renumbers vertices by first use.
+ */
+class MeshOptimizer
+{
+public:
+	/// FIFO size that both Tipsify and the analyzer model
+	static const uint32_t kCacheSize = 16;
+
+	static VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = kCacheSize);
+
+	/**
+	 * @brief Tipsify reordering, clusters receives the first triangle of every cluster split at a dead end
+	 */
+	static void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, uint32_t vertexCount, std::vector<uint32_t>* clusters = nullptr);
+
+	/**
+	 * @brief Reorders the clusters of a vertex cache optimized index buffer to reduce overdraw
+	 * Clusters are first split further as long as their ACMR stays within threshold times the original one.
+	 */
+	static void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, uint32_t vertexCount,
+		const std::vector<uint32_t>& clusters, float threshold);
+
+	/**
+	 * @brief Fills remap with the first use order of every vertex (~0u for unused ones), returns the used vertex count
+	 */
+	static uint32_t OptimizeVertexFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+
+	/**
+	 * @brief Runs all three passes on an indexed triangle list SubMesh, the vertex layout has to be rebuilt afterwards
+	 */
+	static MeshOptimizeStatistics Optimize(SubMesh& subMesh, float overdrawThreshold);
+
+private:
+	MeshOptimizer() {};
+	~MeshOptimizer() {};
+};
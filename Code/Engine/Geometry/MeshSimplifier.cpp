@@ -0,0 +1,392 @@
+
+#include "MeshSimplifier.h"
+
+#include "Geometry/MeshOptimizer.h"
+#include "Geometry/MeshUtils.h"
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+/**
+ * @brief Symmetric 4x4 quadric of weighted planes, error is the weighted squared distance to them
+ */
+struct Quadric
+{
+	float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+	float a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+	float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+	float c = 0.0f;
+	float w = 0.0f;
+
+	static Quadric FromPlane(const glm::vec3& n, float d, float weight)
+	{
+		Quadric q;
+		q.a00 = weight * n.x * n.x;
+		q.a11 = weight * n.y * n.y;
+		q.a22 = weight * n.z * n.z;
+		q.a10 = weight * n.y * n.x;
+		q.a20 = weight * n.z * n.x;
+		q.a21 = weight * n.z * n.y;
+		q.b0 = weight * n.x * d;
+		q.b1 = weight * n.y * d;
+		q.b2 = weight * n.z * d;
+		q.c = weight * d * d;
+		q.w = weight;
+		return q;
+	}
+
+	inline Quadric& operator+=(const Quadric& q)
+	{
+		a00 += q.a00; a11 += q.a11; a22 += q.a22;
+		a10 += q.a10; a20 += q.a20; a21 += q.a21;
+		b0 += q.b0; b1 += q.b1; b2 += q.b2;
+		c += q.c;
+		w += q.w;
+		return *this;
+	}
+
+	/// Squared distance, normalized by the total weight
+	inline float Error(const glm::vec3& p) const
+	{
+		float rx = a00 * p.x + a10 * p.y + a20 * p.z + 2.0f * b0;
+		float ry = a10 * p.x + a11 * p.y + a21 * p.z + 2.0f * b1;
+		float rz = a20 * p.x + a21 * p.y + a22 * p.z + 2.0f * b2;
+		float error = rx * p.x + ry * p.y + rz * p.z + c;
+		return w > 0.0f ? std::max(error, 0.0f) / w : 0.0f;
+	}
+};
+
+struct Collapse
+{
+	uint32_t source;
+	uint32_t target;
+	float error;
+};
+
+/**
+ * @brief Maps every vertex to the first vertex with the same position
+ */
+static std::vector<uint32_t> BuildPositionRemap(const glm::vec3* positions, uint32_t vertexCount)
+{
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& p) const
+		{
+			uint32_t h[3];
+			std::memcpy(h, &p, sizeof(h));
+			return (h[0] * 73856093u) ^ (h[1] * 19349663u) ^ (h[2] * 83492791u);
+		}
+	};
+
+	std::vector<uint32_t> remap(vertexCount);
+	std::unordered_map<glm::vec3, uint32_t, PositionHash> firstVertex;
+	firstVertex.reserve(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		remap[v] = firstVertex.emplace(positions[v], v).first->second;
+	}
+
+	return remap;
+}
+
+/**
+ * @brief Locks positions on open borders and positions that are split into several vertices
+ */
+static std::vector<uint8_t> FindLockedPositions(const uint32_t* indices, size_t indexCount, const std::vector<uint32_t>& positionRemap, uint32_t vertexCount)
+{
+	std::vector<uint8_t> locked(vertexCount, 0);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		if (positionRemap[v] != v)
+		{
+			locked[positionRemap[v]] = 1;
+		}
+	}
+
+	// An edge is on a border when its opposite half edge does not exist
+	std::unordered_map<uint64_t, uint32_t> halfEdges;
+	halfEdges.reserve(indexCount);
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		for (uint32_t e = 0; e < 3; ++e)
+		{
+			uint64_t a = positionRemap[indices[i + e]];
+			uint64_t b = positionRemap[indices[i + (e + 1) % 3]];
+			halfEdges[(a << 32) | b]++;
+		}
+	}
+
+	for (auto& halfEdge : halfEdges)
+	{
+		uint64_t a = halfEdge.first >> 32;
+		uint64_t b = halfEdge.first & 0xffffffffu;
+		if (halfEdges.find((b << 32) | a) == halfEdges.end())
+		{
+			locked[a] = 1;
+			locked[b] = 1;
+		}
+	}
+
+	return locked;
+}
+
+/**
+ * @brief True when moving source to target turns a surviving triangle around source too far or degenerates it
+ */
+static bool HasTriangleFlips(const MeshUtils::TriangleAdjacency& adjacency, const uint32_t* positionIndices, const glm::vec3* positions,
+	uint32_t source, uint32_t target)
+{
+	const glm::vec3& targetPosition = positions[target];
+
+	for (uint32_t k = adjacency.offsets[source]; k < adjacency.offsets[source + 1]; ++k)
+	{
+		const uint32_t* triangle = positionIndices + static_cast<size_t>(adjacency.triangles[k]) * 3;
+		if (triangle[0] == target || triangle[1] == target || triangle[2] == target)
+		{
+			continue;
+		}
+
+		glm::vec3 p[3] = { positions[triangle[0]], positions[triangle[1]], positions[triangle[2]] };
+		glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			if (triangle[corner] == source)
+			{
+				p[corner] = targetPosition;
+			}
+		}
+		glm::vec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+		// A plain 90 degree test would still let a series of collapses turn a triangle over, 0.25 is ~75 degrees
+		if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+size_t MeshSimplifier::Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, uint32_t vertexCount,
+	size_t targetIndexCount, float maxError, float* error)
+{
+	float resultError = 0.0f;
+	std::vector<uint32_t> result(indices, indices + indexCount - indexCount % 3);
+
+	const std::vector<uint32_t> positionRemap = BuildPositionRemap(positions, vertexCount);
+	const std::vector<uint8_t> locked = FindLockedPositions(result.data(), result.size(), positionRemap, vertexCount);
+
+	// Quadrics live on positions, area weighted so that small triangles do not dominate the error
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < result.size(); i += 3)
+	{
+		const glm::vec3& p0 = positions[result[i + 0]];
+		const glm::vec3& p1 = positions[result[i + 1]];
+		const glm::vec3& p2 = positions[result[i + 2]];
+
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float area = glm::length(normal);
+		if (area <= 0.0f)
+		{
+			continue;
+		}
+		normal /= area;
+
+		Quadric q = Quadric::FromPlane(normal, -glm::dot(normal, p0), area);
+		quadrics[positionRemap[result[i + 0]]] += q;
+		quadrics[positionRemap[result[i + 1]]] += q;
+		quadrics[positionRemap[result[i + 2]]] += q;
+	}
+
+	std::vector<uint32_t> positionIndices(result.size());
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> collapseOrder;
+	std::vector<uint8_t> passLocked(vertexCount);
+	std::vector<uint32_t> vertexRemap(vertexCount);
+	MeshUtils::TriangleAdjacency adjacency;
+
+	while (result.size() > targetIndexCount)
+	{
+		for (size_t i = 0; i < result.size(); ++i)
+		{
+			positionIndices[i] = positionRemap[result[i]];
+		}
+		MeshUtils::BuildTriangleAdjacency(adjacency, positionIndices.data(), result.size(), vertexCount);
+
+		// The cheaper direction of every edge, interior edges are seen from both triangles so only p0 < p1 is kept
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			for (uint32_t e = 0; e < 3; ++e)
+			{
+				uint32_t v0 = result[i + e];
+				uint32_t v1 = result[i + (e + 1) % 3];
+				uint32_t p0 = positionRemap[v0];
+				uint32_t p1 = positionRemap[v1];
+
+				if (p0 > p1 || (locked[p0] && locked[p1]))
+				{
+					continue;
+				}
+
+				Quadric q = quadrics[p0];
+				q += quadrics[p1];
+				float error0 = locked[p0] ? std::numeric_limits<float>::max() : q.Error(positions[p1]);
+				float error1 = locked[p1] ? std::numeric_limits<float>::max() : q.Error(positions[p0]);
+
+				collapses.push_back(error0 <= error1 ? Collapse{ v0, v1, error0 } : Collapse{ v1, v0, error1 });
+			}
+		}
+
+		collapseOrder.resize(collapses.size());
+		std::iota(collapseOrder.begin(), collapseOrder.end(), 0);
+		std::sort(collapseOrder.begin(), collapseOrder.end(), [&](uint32_t a, uint32_t b) { return collapses[a].error < collapses[b].error; });
+
+		// Collapses in one pass must not touch each other, so the one ring of every collapsed vertex is locked for the pass
+		std::fill(passLocked.begin(), passLocked.end(), 0);
+		std::iota(vertexRemap.begin(), vertexRemap.end(), 0);
+
+		size_t triangleCount = result.size() / 3;
+		const size_t targetTriangleCount = targetIndexCount / 3;
+		size_t collapseCount = 0;
+
+		for (uint32_t c : collapseOrder)
+		{
+			const Collapse& collapse = collapses[c];
+			const uint32_t source = positionRemap[collapse.source];
+			const uint32_t target = positionRemap[collapse.target];
+
+			if (triangleCount <= targetTriangleCount || std::sqrt(collapse.error) > maxError)
+			{
+				break;
+			}
+
+			if (passLocked[source] || passLocked[target] || HasTriangleFlips(adjacency, positionIndices.data(), positions, source, target))
+			{
+				continue;
+			}
+
+			uint32_t removedTriangles = 0;
+			for (uint32_t k = adjacency.offsets[source]; k < adjacency.offsets[source + 1]; ++k)
+			{
+				const uint32_t* triangle = positionIndices.data() + static_cast<size_t>(adjacency.triangles[k]) * 3;
+				removedTriangles += (triangle[0] == target || triangle[1] == target || triangle[2] == target) ? 1 : 0;
+				passLocked[triangle[0]] = passLocked[triangle[1]] = passLocked[triangle[2]] = 1;
+			}
+
+			// Unlocked positions have a single vertex, so the source vertex itself is remapped
+			vertexRemap[collapse.source] = collapse.target;
+			quadrics[target] += quadrics[source];
+			resultError = std::max(resultError, collapse.error);
+			triangleCount -= removedTriangles;
+			collapseCount++;
+		}
+
+		if (collapseCount == 0)
+		{
+			break;
+		}
+
+		size_t write = 0;
+		for (size_t i = 0; i < result.size(); i += 3)
+		{
+			uint32_t a = vertexRemap[result[i + 0]];
+			uint32_t b = vertexRemap[result[i + 1]];
+			uint32_t c = vertexRemap[result[i + 2]];
+			if (positionRemap[a] != positionRemap[b] && positionRemap[b] != positionRemap[c] && positionRemap[c] != positionRemap[a])
+			{
+				result[write++] = a;
+				result[write++] = b;
+				result[write++] = c;
+			}
+		}
+		result.resize(write);
+	}
+
+	std::copy(result.begin(), result.end(), destination);
+	if (error)
+	{
+		*error = std::sqrt(resultError);
+	}
+
+	return result.size();
+}
+
+MeshSimplifyStatistics MeshSimplifier::GenerateLods(SubMesh& subMesh, const std::vector<float>& ratios)
+{
+	MeshSimplifyStatistics statistics;
+	subMesh.lods.clear();
+
+	std::vector<glm::vec3> positions;
+	if (!subMesh.indexBuffer.IsValid() || !MeshUtils::ReadPositions(subMesh, positions))
+	{
+		return statistics;
+	}
+
+	std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+	if (indices.size() < 3 || *std::max_element(indices.begin(), indices.end()) >= vertexCount)
+	{
+		return statistics;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const size_t fullIndexCount = indices.size() - indices.size() % 3;
+	float chainError = 0.0f;
+	std::vector<uint32_t> simplified(indices.size());
+	for (float ratio : ratios)
+	{
+		size_t targetIndexCount = static_cast<size_t>(float(fullIndexCount / 3) * ratio) * 3;
+		if (targetIndexCount >= indices.size())
+		{
+			continue;
+		}
+
+		float error = 0.0f;
+		statistics.inputTriangles += indices.size() / 3;
+		size_t indexCount = Simplify(simplified.data(), indices.data(), indices.size(), positions.data(), vertexCount,
+			targetIndexCount, std::numeric_limits<float>::max(), &error);
+
+		if (indexCount == 0 || indexCount > indices.size() * 95 / 100)
+		{
+			break;
+		}
+
+		indices.resize(indexCount);
+		MeshOptimizer::OptimizeVertexCache(indices.data(), simplified.data(), indexCount, vertexCount);
+		chainError += error;
+
+		SubMeshLod lod;
+		lod.error = chainError;
+		lod.indexCount = static_cast<uint32_t>(indexCount);
+		if (subMesh.indexType == VK_INDEX_TYPE_UINT16)
+		{
+			std::vector<uint8_t> data(indexCount * sizeof(uint16_t));
+			uint16_t* dst = reinterpret_cast<uint16_t*>(data.data());
+			for (size_t i = 0; i < indexCount; ++i)
+			{
+				dst[i] = static_cast<uint16_t>(indices[i]);
+			}
+			lod.indexBuffer = AccessorView::FromData(std::move(data), sizeof(uint16_t), lod.indexCount, VK_FORMAT_R16_UINT);
+		}
+		else
+		{
+			std::vector<uint8_t> data(indexCount * sizeof(uint32_t));
+			std::memcpy(data.data(), indices.data(), data.size());
+			lod.indexBuffer = AccessorView::FromData(std::move(data), sizeof(uint32_t), lod.indexCount, VK_FORMAT_R32_UINT);
+		}
+
+		subMesh.lods.push_back(std::move(lod));
+	}
+
+	statistics.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return statistics;
+}
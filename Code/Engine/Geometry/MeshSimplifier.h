@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Framework/GlmCommon.h"
+
+struct SubMesh;
+
+struct MeshSimplifyStatistics
+{
+	/// Triangles fed into the simplifier, summed over all LODs
+	uint64_t inputTriangles = 0;
+	double seconds = 0.0;
+
+	inline double GetTrianglesPerSecond() const { return seconds > 0.0 ? double(inputTriangles) / seconds : 0.0; }
+};
+
+/**
+ * @brief Quadric error metric edge collapse simplifier (Garland and Heckbert 1997)
+ * Vertices collapse onto a neighbouring vertex instead of a new optimal position, so every LOD indexes
+ * the vertex streams of the full resolution SubMesh. Vertices on open borders and attribute seams are locked.
+ */
+class MeshSimplifier
+{
+public:
+	/**
+	 * @brief Simplifies a triangle list to at most targetIndexCount indices or until the next collapse exceeds maxError
+	 * Returns the index count written to destination, error receives the largest collapse error as an object space distance.
+	 */
+	static size_t Simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const glm::vec3* positions, uint32_t vertexCount,
+		size_t targetIndexCount, float maxError, float* error);
+
+	/**
+	 * @brief Fills SubMesh::lods with one LOD per ratio of the full resolution triangle count
+	 * Every LOD is simplified from the previous one, its error adds up the errors along the chain. The chain
+	 * stops early when a LOD would not remove at least 5% of the triangles of the previous one.
+	 */
+	static MeshSimplifyStatistics GenerateLods(SubMesh& subMesh, const std::vector<float>& ratios);
+
+private:
+	MeshSimplifier() {};
+	~MeshSimplifier() {};
+};
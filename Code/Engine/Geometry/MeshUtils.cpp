@@ -0,0 +1,309 @@
+
+#include "MeshUtils.h"
+
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief How the components of a vertex format are stored and turned into floats
+ */
+enum class ComponentEncoding
+{
+	Unknown,
+	Float32,
+	Unorm8,
+	Snorm8,
+	Uint8,
+	Sint8,
+	Unorm16,
+	Snorm16,
+	Uint16,
+	Sint16,
+	Uint32,
+	Sint32
+};
+
+static ComponentEncoding GetComponentEncoding(VkFormat format, uint32_t& componentCount)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R32_SFLOAT: componentCount = 1; return ComponentEncoding::Float32;
+	case VK_FORMAT_R32G32_SFLOAT: componentCount = 2; return ComponentEncoding::Float32;
+	case VK_FORMAT_R32G32B32_SFLOAT: componentCount = 3; return ComponentEncoding::Float32;
+	case VK_FORMAT_R32G32B32A32_SFLOAT: componentCount = 4; return ComponentEncoding::Float32;
+
+	case VK_FORMAT_R8_UNORM: componentCount = 1; return ComponentEncoding::Unorm8;
+	case VK_FORMAT_R8G8_UNORM: componentCount = 2; return ComponentEncoding::Unorm8;
+	case VK_FORMAT_R8G8B8_UNORM: componentCount = 3; return ComponentEncoding::Unorm8;
+	case VK_FORMAT_R8G8B8A8_UNORM: componentCount = 4; return ComponentEncoding::Unorm8;
+
+	case VK_FORMAT_R8_SNORM: componentCount = 1; return ComponentEncoding::Snorm8;
+	case VK_FORMAT_R8G8_SNORM: componentCount = 2; return ComponentEncoding::Snorm8;
+	case VK_FORMAT_R8G8B8_SNORM: componentCount = 3; return ComponentEncoding::Snorm8;
+	case VK_FORMAT_R8G8B8A8_SNORM: componentCount = 4; return ComponentEncoding::Snorm8;
+
+	case VK_FORMAT_R8_UINT: case VK_FORMAT_R8_USCALED: componentCount = 1; return ComponentEncoding::Uint8;
+	case VK_FORMAT_R8G8_UINT: case VK_FORMAT_R8G8_USCALED: componentCount = 2; return ComponentEncoding::Uint8;
+	case VK_FORMAT_R8G8B8_UINT: case VK_FORMAT_R8G8B8_USCALED: componentCount = 3; return ComponentEncoding::Uint8;
+	case VK_FORMAT_R8G8B8A8_UINT: case VK_FORMAT_R8G8B8A8_USCALED: componentCount = 4; return ComponentEncoding::Uint8;
+
+	case VK_FORMAT_R8_SINT: case VK_FORMAT_R8_SSCALED: componentCount = 1; return ComponentEncoding::Sint8;
+	case VK_FORMAT_R8G8_SINT: case VK_FORMAT_R8G8_SSCALED: componentCount = 2; return ComponentEncoding::Sint8;
+	case VK_FORMAT_R8G8B8_SINT: case VK_FORMAT_R8G8B8_SSCALED: componentCount = 3; return ComponentEncoding::Sint8;
+	case VK_FORMAT_R8G8B8A8_SINT: case VK_FORMAT_R8G8B8A8_SSCALED: componentCount = 4; return ComponentEncoding::Sint8;
+
+	case VK_FORMAT_R16_UNORM: componentCount = 1; return ComponentEncoding::Unorm16;
+	case VK_FORMAT_R16G16_UNORM: componentCount = 2; return ComponentEncoding::Unorm16;
+	case VK_FORMAT_R16G16B16_UNORM: componentCount = 3; return ComponentEncoding::Unorm16;
+	case VK_FORMAT_R16G16B16A16_UNORM: componentCount = 4; return ComponentEncoding::Unorm16;
+
+	case VK_FORMAT_R16_SNORM: componentCount = 1; return ComponentEncoding::Snorm16;
+	case VK_FORMAT_R16G16_SNORM: componentCount = 2; return ComponentEncoding::Snorm16;
+	case VK_FORMAT_R16G16B16_SNORM: componentCount = 3; return ComponentEncoding::Snorm16;
+	case VK_FORMAT_R16G16B16A16_SNORM: componentCount = 4; return ComponentEncoding::Snorm16;
+
+	case VK_FORMAT_R16_UINT: case VK_FORMAT_R16_USCALED: componentCount = 1; return ComponentEncoding::Uint16;
+	case VK_FORMAT_R16G16_UINT: case VK_FORMAT_R16G16_USCALED: componentCount = 2; return ComponentEncoding::Uint16;
+	case VK_FORMAT_R16G16B16_UINT: case VK_FORMAT_R16G16B16_USCALED: componentCount = 3; return ComponentEncoding::Uint16;
+	case VK_FORMAT_R16G16B16A16_UINT: case VK_FORMAT_R16G16B16A16_USCALED: componentCount = 4; return ComponentEncoding::Uint16;
+
+	case VK_FORMAT_R16_SINT: case VK_FORMAT_R16_SSCALED: componentCount = 1; return ComponentEncoding::Sint16;
+	case VK_FORMAT_R16G16_SINT: case VK_FORMAT_R16G16_SSCALED: componentCount = 2; return ComponentEncoding::Sint16;
+	case VK_FORMAT_R16G16B16_SINT: case VK_FORMAT_R16G16B16_SSCALED: componentCount = 3; return ComponentEncoding::Sint16;
+	case VK_FORMAT_R16G16B16A16_SINT: case VK_FORMAT_R16G16B16A16_SSCALED: componentCount = 4; return ComponentEncoding::Sint16;
+
+	case VK_FORMAT_R32_UINT: componentCount = 1; return ComponentEncoding::Uint32;
+	case VK_FORMAT_R32G32_UINT: componentCount = 2; return ComponentEncoding::Uint32;
+	case VK_FORMAT_R32G32B32_UINT: componentCount = 3; return ComponentEncoding::Uint32;
+	case VK_FORMAT_R32G32B32A32_UINT: componentCount = 4; return ComponentEncoding::Uint32;
+
+	case VK_FORMAT_R32_SINT: componentCount = 1; return ComponentEncoding::Sint32;
+	case VK_FORMAT_R32G32_SINT: componentCount = 2; return ComponentEncoding::Sint32;
+	case VK_FORMAT_R32G32B32_SINT: componentCount = 3; return ComponentEncoding::Sint32;
+	case VK_FORMAT_R32G32B32A32_SINT: componentCount = 4; return ComponentEncoding::Sint32;
+
+	default: componentCount = 0; return ComponentEncoding::Unknown;
+	}
+}
+
+namespace MeshUtils
+{
+	uint32_t GetComponentCount(VkFormat format)
+	{
+		uint32_t componentCount = 0;
+		GetComponentEncoding(format, componentCount);
+		return componentCount;
+	}
+
+	glm::vec4 DecodeElement(VkFormat format, const uint8_t* data)
+	{
+		glm::vec4 value(0.0f);
+
+		uint32_t componentCount = 0;
+		ComponentEncoding encoding = GetComponentEncoding(format, componentCount);
+		for (uint32_t c = 0; c < componentCount; ++c)
+		{
+			switch (encoding)
+			{
+			case ComponentEncoding::Float32:
+			{
+				float component;
+				std::memcpy(&component, data + c * 4, sizeof(component));
+				value[c] = component;
+				break;
+			}
+			case ComponentEncoding::Unorm8:
+				value[c] = float(data[c]) / 255.0f;
+				break;
+			case ComponentEncoding::Snorm8:
+				value[c] = std::max(float(int8_t(data[c])) / 127.0f, -1.0f);
+				break;
+			case ComponentEncoding::Uint8:
+				value[c] = float(data[c]);
+				break;
+			case ComponentEncoding::Sint8:
+				value[c] = float(int8_t(data[c]));
+				break;
+			case ComponentEncoding::Unorm16:
+			case ComponentEncoding::Snorm16:
+			case ComponentEncoding::Uint16:
+			case ComponentEncoding::Sint16:
+			{
+				uint16_t component;
+				std::memcpy(&component, data + c * 2, sizeof(component));
+				if (encoding == ComponentEncoding::Unorm16)
+				{
+					value[c] = float(component) / 65535.0f;
+				}
+				else if (encoding == ComponentEncoding::Snorm16)
+				{
+					value[c] = std::max(float(int16_t(component)) / 32767.0f, -1.0f);
+				}
+				else
+				{
+					value[c] = encoding == ComponentEncoding::Uint16 ? float(component) : float(int16_t(component));
+				}
+				break;
+			}
+			case ComponentEncoding::Uint32:
+			case ComponentEncoding::Sint32:
+			{
+				uint32_t component;
+				std::memcpy(&component, data + c * 4, sizeof(component));
+				value[c] = encoding == ComponentEncoding::Uint32 ? float(component) : float(int32_t(component));
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		return value;
+	}
+
+	std::vector<uint32_t> ReadIndices(const SubMesh& subMesh)
+	{
+		std::vector<uint32_t> indices;
+
+		const AccessorView& indexBuffer = subMesh.indexBuffer;
+		if (!indexBuffer.IsValid())
+		{
+			indices.resize(subMesh.vertexCount);
+			for (uint32_t i = 0; i < subMesh.vertexCount; ++i)
+			{
+				indices[i] = i;
+			}
+			return indices;
+		}
+
+		indices.resize(indexBuffer.count);
+		switch (GetFormatSize(indexBuffer.format))
+		{
+		case 1:
+			for (uint32_t i = 0; i < indexBuffer.count; ++i)
+			{
+				indices[i] = *indexBuffer.At(i);
+			}
+			break;
+		case 2:
+			for (uint32_t i = 0; i < indexBuffer.count; ++i)
+			{
+				uint16_t index;
+				std::memcpy(&index, indexBuffer.At(i), sizeof(index));
+				indices[i] = index;
+			}
+			break;
+		default:
+			for (uint32_t i = 0; i < indexBuffer.count; ++i)
+			{
+				std::memcpy(&indices[i], indexBuffer.At(i), sizeof(uint32_t));
+			}
+			break;
+		}
+
+		return indices;
+	}
+
+	void WriteIndices(SubMesh& subMesh, const std::vector<uint32_t>& indices)
+	{
+		const uint32_t count = static_cast<uint32_t>(indices.size());
+
+		std::vector<uint8_t> data;
+		if (subMesh.indexType == VK_INDEX_TYPE_UINT16)
+		{
+			data.resize(indices.size() * sizeof(uint16_t));
+			uint16_t* dst = reinterpret_cast<uint16_t*>(data.data());
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				dst[i] = static_cast<uint16_t>(indices[i]);
+			}
+			subMesh.indexBuffer = AccessorView::FromData(std::move(data), sizeof(uint16_t), count, VK_FORMAT_R16_UINT);
+		}
+		else
+		{
+			data.resize(indices.size() * sizeof(uint32_t));
+			std::memcpy(data.data(), indices.data(), data.size());
+			subMesh.indexBuffer = AccessorView::FromData(std::move(data), sizeof(uint32_t), count, VK_FORMAT_R32_UINT);
+			subMesh.indexType = VK_INDEX_TYPE_UINT32;
+		}
+
+		subMesh.vertexIndices = count;
+	}
+
+	bool ReadPositions(const SubMesh& subMesh, std::vector<glm::vec3>& positions)
+	{
+		auto it = subMesh.vertexBuffers.find("position");
+		if (it == subMesh.vertexBuffers.end() || GetComponentCount(it->second.format) < 3)
+		{
+			return false;
+		}
+
+		const AccessorView& view = it->second;
+		positions.resize(view.count);
+		if (view.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			for (uint32_t i = 0; i < view.count; ++i)
+			{
+				std::memcpy(&positions[i], view.At(i), sizeof(glm::vec3));
+			}
+		}
+		else
+		{
+			for (uint32_t i = 0; i < view.count; ++i)
+			{
+				positions[i] = glm::vec3(DecodeElement(view.format, view.At(i)));
+			}
+		}
+
+		return true;
+	}
+
+	void RemapVertices(SubMesh& subMesh, const std::vector<uint32_t>& remap, uint32_t newVertexCount)
+	{
+		for (auto& vertexBuffer : subMesh.vertexBuffers)
+		{
+			const AccessorView& view = vertexBuffer.second;
+			const uint32_t elementSize = GetFormatSize(view.format);
+
+			std::vector<uint8_t> data(static_cast<size_t>(newVertexCount) * elementSize);
+			const uint32_t count = std::min<uint32_t>(view.count, static_cast<uint32_t>(remap.size()));
+			for (uint32_t v = 0; v < count; ++v)
+			{
+				if (remap[v] != ~0u)
+				{
+					std::memcpy(data.data() + static_cast<size_t>(remap[v]) * elementSize, view.At(v), elementSize);
+				}
+			}
+
+			vertexBuffer.second = AccessorView::FromData(std::move(data), elementSize, newVertexCount, view.format);
+		}
+
+		subMesh.vertexCount = newVertexCount;
+	}
+
+	void BuildTriangleAdjacency(TriangleAdjacency& adjacency, const uint32_t* indices, size_t indexCount, uint32_t vertexCount)
+	{
+		const size_t triangleCount = indexCount / 3;
+
+		adjacency.counts.assign(vertexCount, 0);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+		{
+			adjacency.counts[indices[i]]++;
+		}
+
+		adjacency.offsets.assign(static_cast<size_t>(vertexCount) + 1, 0);
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			adjacency.offsets[v + 1] = adjacency.offsets[v] + adjacency.counts[v];
+		}
+
+		adjacency.triangles.resize(triangleCount * 3);
+		std::vector<uint32_t> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; ++i)
+		{
+			adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <volk.h>
+
+#include "Framework/GlmCommon.h"
+
+struct SubMesh;
+
+/**
+ * @brief Helpers shared by the import time mesh passes, they all work on 32-bit indices and float positions
+ */
+namespace MeshUtils
+{
+	/**
+	 * @brief Index list of the SubMesh widened to 32 bits, 0..vertexCount-1 for non indexed submeshes
+	 */
+	std::vector<uint32_t> ReadIndices(const SubMesh& subMesh);
+
+	/**
+	 * @brief Replaces the index buffer, keeping the SubMesh index type
+	 */
+	void WriteIndices(SubMesh& subMesh, const std::vector<uint32_t>& indices);
+
+	/**
+	 * @brief Number of components of a vertex format, 0 for formats DecodeElement does not understand
+	 */
+	uint32_t GetComponentCount(VkFormat format);
+
+	/**
+	 * @brief Decodes one element to floats the way the vertex input stage would, missing components are 0
+	 */
+	glm::vec4 DecodeElement(VkFormat format, const uint8_t* data);
+
+	/**
+	 * @brief Decodes the position stream to floats, returns false when the SubMesh has no readable positions
+	 * Quantized positions come back in their quantized space, which is the space the node transform expects.
+	 */
+	bool ReadPositions(const SubMesh& subMesh, std::vector<glm::vec3>& positions);
+
+	/**
+	 * @brief Moves vertex v of every stream to remap[v], vertices remapped to ~0u are dropped
+	 */
+	void RemapVertices(SubMesh& subMesh, const std::vector<uint32_t>& remap, uint32_t newVertexCount);
+
+	/**
+	 * @brief Vertex to triangle adjacency, the triangles using vertex v are triangles[offsets[v]..offsets[v + 1])
+	 */
+	struct TriangleAdjacency
+	{
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+	};
+
+	void BuildTriangleAdjacency(TriangleAdjacency& adjacency, const uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+}
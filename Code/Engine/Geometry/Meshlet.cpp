@@ -0,0 +1,278 @@
+
+#include "Meshlet.h"
+
+#include "Geometry/MeshUtils.h"
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const uint8_t kNotInMeshlet = 0xff;
+
+bool MeshletData::IsBackFacing(uint32_t index, const glm::vec3& cameraPosition) const
+{
+	const float cutoff = GetBounds(MeshletBoundsArray::ConeCutoff)[index];
+	if (cutoff >= 1.0f)
+	{
+		return false;
+	}
+
+	glm::vec3 center(GetBounds(MeshletBoundsArray::CenterX)[index], GetBounds(MeshletBoundsArray::CenterY)[index], GetBounds(MeshletBoundsArray::CenterZ)[index]);
+	glm::vec3 axis(GetBounds(MeshletBoundsArray::ConeAxisX)[index], GetBounds(MeshletBoundsArray::ConeAxisY)[index], GetBounds(MeshletBoundsArray::ConeAxisZ)[index]);
+	const float radius = GetBounds(MeshletBoundsArray::Radius)[index];
+
+	glm::vec3 view = center - cameraPosition;
+	return glm::dot(view, axis) >= cutoff * glm::length(view) + radius;
+}
+
+void MeshletData::CullBackFacing(const glm::vec3& cameraPosition, std::vector<uint8_t>& visible) const
+{
+	const uint32_t count = GetCount();
+	visible.resize(count);
+	if (count == 0)
+	{
+		return;
+	}
+
+	const float* centerX = GetBounds(MeshletBoundsArray::CenterX);
+	const float* centerY = GetBounds(MeshletBoundsArray::CenterY);
+	const float* centerZ = GetBounds(MeshletBoundsArray::CenterZ);
+	const float* radius = GetBounds(MeshletBoundsArray::Radius);
+	const float* axisX = GetBounds(MeshletBoundsArray::ConeAxisX);
+	const float* axisY = GetBounds(MeshletBoundsArray::ConeAxisY);
+	const float* axisZ = GetBounds(MeshletBoundsArray::ConeAxisZ);
+	const float* cutoff = GetBounds(MeshletBoundsArray::ConeCutoff);
+
+	// Branch free over the SoA arrays so the compiler can vectorize it, a cutoff of 1 never culls
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const float viewX = centerX[i] - cameraPosition.x;
+		const float viewY = centerY[i] - cameraPosition.y;
+		const float viewZ = centerZ[i] - cameraPosition.z;
+		const float distance = std::sqrt(viewX * viewX + viewY * viewY + viewZ * viewZ);
+		const float projected = viewX * axisX[i] + viewY * axisY[i] + viewZ * axisZ[i];
+
+		visible[i] = (cutoff[i] >= 1.0f || projected < cutoff[i] * distance + radius[i]) ? 1 : 0;
+	}
+}
+
+/**
+ * @brief Bounding sphere and normal cone of one meshlet, written into the SoA bounds arrays
+ */
+static void ComputeMeshletBounds(float* bounds, uint32_t meshletCount, uint32_t meshletIndex, const Meshlet& meshlet,
+	const uint32_t* vertices, const uint8_t* triangles, const std::vector<glm::vec3>& positions)
+{
+	auto store = [&](MeshletBoundsArray array, float value) { bounds[static_cast<size_t>(array) * meshletCount + meshletIndex] = value; };
+
+	glm::vec3 minimum = positions[vertices[meshlet.vertexOffset]];
+	glm::vec3 maximum = minimum;
+	for (uint32_t v = 1; v < meshlet.vertexCount; ++v)
+	{
+		minimum = glm::min(minimum, positions[vertices[meshlet.vertexOffset + v]]);
+		maximum = glm::max(maximum, positions[vertices[meshlet.vertexOffset + v]]);
+	}
+
+	glm::vec3 center = (minimum + maximum) * 0.5f;
+	float radius = 0.0f;
+	for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+	{
+		radius = std::max(radius, glm::length(positions[vertices[meshlet.vertexOffset + v]] - center));
+	}
+
+	// The cone axis is the average triangle normal, the cutoff is the sine of the cone half angle
+	std::vector<glm::vec3> normals;
+	normals.reserve(meshlet.triangleCount);
+	glm::vec3 axis(0.0f);
+	for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+	{
+		const uint8_t* triangle = triangles + (static_cast<size_t>(meshlet.triangleOffset) + t) * 3;
+		const glm::vec3& p0 = positions[vertices[meshlet.vertexOffset + triangle[0]]];
+		const glm::vec3& p1 = positions[vertices[meshlet.vertexOffset + triangle[1]]];
+		const glm::vec3& p2 = positions[vertices[meshlet.vertexOffset + triangle[2]]];
+
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+		float length = glm::length(normal);
+		if (length > 0.0f)
+		{
+			normals.push_back(normal / length);
+			axis += normals.back();
+		}
+	}
+
+	float axisLength = glm::length(axis);
+	axis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+
+	float minimumDot = axisLength > 0.0f ? 1.0f : -1.0f;
+	for (const glm::vec3& normal : normals)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(normal, axis));
+	}
+
+	// Cones wider than ~84 degrees reject almost nothing, disable them
+	float cutoff = minimumDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minimumDot * minimumDot);
+
+	store(MeshletBoundsArray::CenterX, center.x);
+	store(MeshletBoundsArray::CenterY, center.y);
+	store(MeshletBoundsArray::CenterZ, center.z);
+	store(MeshletBoundsArray::Radius, radius);
+	store(MeshletBoundsArray::ConeAxisX, axis.x);
+	store(MeshletBoundsArray::ConeAxisY, axis.y);
+	store(MeshletBoundsArray::ConeAxisZ, axis.z);
+	store(MeshletBoundsArray::ConeCutoff, cutoff);
+}
+
+MeshletData MeshletBuilder::Build(const SubMesh& subMesh)
+{
+	MeshletData data;
+
+	std::vector<glm::vec3> positions;
+	if (!MeshUtils::ReadPositions(subMesh, positions))
+	{
+		return data;
+	}
+
+	std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	const uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+	const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+	if (triangleCount == 0 || *std::max_element(indices.begin(), indices.begin() + triangleCount * 3) >= vertexCount)
+	{
+		return data;
+	}
+
+	MeshUtils::TriangleAdjacency adjacency;
+	MeshUtils::BuildTriangleAdjacency(adjacency, indices.data(), indices.size(), vertexCount);
+
+	std::vector<Meshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint8_t> meshletTriangles;
+	meshlets.reserve(triangleCount / MeshletData::kMaxTriangles + 1);
+	meshletVertices.reserve(indices.size());
+	meshletTriangles.reserve(indices.size());
+
+	std::vector<uint8_t> localIndex(vertexCount, kNotInMeshlet);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+
+	Meshlet meshlet{ 0, 0, 0, 0 };
+	uint32_t cursor = 0;
+
+	auto finishMeshlet = [&]()
+	{
+		for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+		{
+			localIndex[meshletVertices[meshlet.vertexOffset + v]] = kNotInMeshlet;
+		}
+		meshlets.push_back(meshlet);
+		meshlet = Meshlet{ static_cast<uint32_t>(meshletVertices.size()), static_cast<uint32_t>(meshletTriangles.size() / 3), 0, 0 };
+	};
+
+	auto newVertexCount = [&](uint32_t triangle)
+	{
+		return uint32_t(localIndex[indices[triangle * 3 + 0]] == kNotInMeshlet) +
+			uint32_t(localIndex[indices[triangle * 3 + 1]] == kNotInMeshlet) +
+			uint32_t(localIndex[indices[triangle * 3 + 2]] == kNotInMeshlet);
+	};
+
+	for (uint32_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+	{
+		// Neighbour that needs the fewest new vertices, ties go to the oldest meshlet vertex which
+		// grows the meshlet outwards instead of along a strip and keeps it compact
+		int64_t best = -1;
+		uint32_t bestNewVertices = 4;
+		for (uint32_t v = 0; v < meshlet.vertexCount && bestNewVertices > 0; ++v)
+		{
+			const uint32_t vertex = meshletVertices[meshlet.vertexOffset + v];
+			for (uint32_t k = adjacency.offsets[vertex]; k < adjacency.offsets[vertex + 1]; ++k)
+			{
+				const uint32_t triangle = adjacency.triangles[k];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+
+				const uint32_t newVertices = newVertexCount(triangle);
+				if (newVertices < bestNewVertices && meshlet.vertexCount + newVertices <= MeshletData::kMaxVertices)
+				{
+					best = triangle;
+					bestNewVertices = newVertices;
+				}
+			}
+		}
+
+		if (best < 0)
+		{
+			while (emitted[cursor])
+			{
+				cursor++;
+			}
+			best = cursor;
+			bestNewVertices = newVertexCount(cursor);
+		}
+
+		if (meshlet.triangleCount == MeshletData::kMaxTriangles || meshlet.vertexCount + bestNewVertices > MeshletData::kMaxVertices)
+		{
+			finishMeshlet();
+		}
+
+		const uint32_t triangle = static_cast<uint32_t>(best);
+		for (uint32_t corner = 0; corner < 3; ++corner)
+		{
+			const uint32_t vertex = indices[triangle * 3 + corner];
+			if (localIndex[vertex] == kNotInMeshlet)
+			{
+				localIndex[vertex] = static_cast<uint8_t>(meshlet.vertexCount++);
+				meshletVertices.push_back(vertex);
+			}
+			meshletTriangles.push_back(localIndex[vertex]);
+		}
+
+		meshlet.triangleCount++;
+		emitted[triangle] = 1;
+	}
+
+	finishMeshlet();
+
+	const uint32_t meshletCount = static_cast<uint32_t>(meshlets.size());
+	std::vector<uint8_t> bounds(static_cast<size_t>(MeshletBoundsArray::Count) * meshletCount * sizeof(float));
+	for (uint32_t m = 0; m < meshletCount; ++m)
+	{
+		ComputeMeshletBounds(reinterpret_cast<float*>(bounds.data()), meshletCount, m, meshlets[m], meshletVertices.data(), meshletTriangles.data(), positions);
+	}
+
+	std::vector<uint8_t> meshletBytes(meshlets.size() * sizeof(Meshlet));
+	std::memcpy(meshletBytes.data(), meshlets.data(), meshletBytes.size());
+	std::vector<uint8_t> vertexBytes(meshletVertices.size() * sizeof(uint32_t));
+	std::memcpy(vertexBytes.data(), meshletVertices.data(), vertexBytes.size());
+
+	const uint32_t vertexTotal = static_cast<uint32_t>(meshletVertices.size());
+	const uint32_t triangleIndexTotal = static_cast<uint32_t>(meshletTriangles.size());
+	data.meshlets = AccessorView::FromData(std::move(meshletBytes), sizeof(Meshlet), meshletCount, VK_FORMAT_R32G32B32A32_UINT);
+	data.vertices = AccessorView::FromData(std::move(vertexBytes), sizeof(uint32_t), vertexTotal, VK_FORMAT_R32_UINT);
+	data.triangles = AccessorView::FromData(std::move(meshletTriangles), sizeof(uint8_t), triangleIndexTotal, VK_FORMAT_R8_UINT);
+	data.bounds = AccessorView::FromData(std::move(bounds), sizeof(float), static_cast<uint32_t>(MeshletBoundsArray::Count) * meshletCount, VK_FORMAT_R32_SFLOAT);
+
+	return data;
+}
+
+MeshletStatistics MeshletBuilder::GetStatistics(const MeshletData& meshlets)
+{
+	MeshletStatistics statistics;
+	statistics.meshletCount = meshlets.GetCount();
+	if (statistics.meshletCount == 0)
+	{
+		return statistics;
+	}
+
+	uint64_t vertices = 0;
+	uint64_t triangles = 0;
+	for (uint32_t i = 0; i < statistics.meshletCount; ++i)
+	{
+		vertices += meshlets.GetMeshlet(i).vertexCount;
+		triangles += meshlets.GetMeshlet(i).triangleCount;
+	}
+
+	statistics.vertexFill = float(vertices) / float(uint64_t(statistics.meshletCount) * MeshletData::kMaxVertices);
+	statistics.triangleFill = float(triangles) / float(uint64_t(statistics.meshletCount) * MeshletData::kMaxTriangles);
+
+	return statistics;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Framework/GlmCommon.h"
+#include "Scene/AccessorView.h"
+
+struct SubMesh;
+
+/**
+ * @brief One cluster of a SubMesh, ranges into MeshletData::vertices and MeshletData::triangles
+ */
+struct Meshlet
+{
+	uint32_t vertexOffset;
+	uint32_t triangleOffset;
+	uint32_t vertexCount;
+	uint32_t triangleCount;
+};
+
+/**
+ * @brief Bounds arrays of MeshletData::bounds, each one holds a float per meshlet
+ */
+enum class MeshletBoundsArray : uint32_t
+{
+	CenterX = 0,
+	CenterY,
+	CenterZ,
+	Radius,
+	ConeAxisX,
+	ConeAxisY,
+	ConeAxisZ,
+	ConeCutoff,
+	Count
+};
+
+/**
+ * @brief Meshlets of a SubMesh with their culling bounds
+ * All arrays are accessor views, so a cooked scene references them in place like the vertex streams.
+ */
+struct MeshletData
+{
+	static const uint32_t kMaxVertices = 64;
+	static const uint32_t kMaxTriangles = 124;
+
+	/// Meshlet descriptors, R32G32B32A32_UINT elements laid out as Meshlet
+	AccessorView meshlets;
+	/// Meshlet local to SubMesh vertex index, R32_UINT
+	AccessorView vertices;
+	/// Three meshlet local vertex indices per triangle, R8_UINT
+	AccessorView triangles;
+	/// R32_SFLOAT, MeshletBoundsArray::Count arrays of GetCount() floats one after another
+	AccessorView bounds;
+
+	inline uint32_t GetCount() const { return meshlets.count; }
+
+	inline const Meshlet& GetMeshlet(uint32_t index) const { return *reinterpret_cast<const Meshlet*>(meshlets.At(index)); }
+
+	inline const float* GetBounds(MeshletBoundsArray array) const
+	{
+		return reinterpret_cast<const float*>(bounds.Data()) + static_cast<size_t>(array) * GetCount();
+	}
+
+	/**
+	 * @brief True when every triangle of the meshlet faces away from the camera
+	 */
+	bool IsBackFacing(uint32_t index, const glm::vec3& cameraPosition) const;
+
+	/**
+	 * @brief Sets visible[i] to 0 for every back facing meshlet and to 1 for the others
+	 */
+	void CullBackFacing(const glm::vec3& cameraPosition, std::vector<uint8_t>& visible) const;
+};
+
+struct MeshletStatistics
+{
+	uint32_t meshletCount = 0;
+	/// Average fraction of kMaxVertices/kMaxTriangles that the meshlets use
+	float vertexFill = 0.0f;
+	float triangleFill = 0.0f;
+};
+
+class MeshletBuilder
+{
+public:
+	/**
+	 * @brief Splits an indexed or non indexed triangle list into meshlets
+	 * Triangles are added greedily, preferring the neighbour that brings the fewest new vertices into the
+	 * current meshlet. Returns empty data when the SubMesh has no float positions.
+	 */
+	static MeshletData Build(const SubMesh& subMesh);
+
+	static MeshletStatistics GetStatistics(const MeshletData& meshlets);
+
+private:
+	MeshletBuilder() {};
+	~MeshletBuilder() {};
+};
@@ -0,0 +1,214 @@
+
+#include "VertexQuantizer.h"
+
+#include "Geometry/MeshUtils.h"
+#include "Render/VertexLayout.h"
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+template<typename T>
+inline T QuantizeSnorm(float value, float maximum)
+{
+	return static_cast<T>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * maximum));
+}
+
+inline uint16_t QuantizeUnorm16(float value)
+{
+	return static_cast<uint16_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f));
+}
+
+template<typename T>
+inline void StoreComponents(std::vector<uint8_t>& data, uint32_t vertex, const T* components, uint32_t componentCount)
+{
+	std::memcpy(data.data() + (static_cast<size_t>(vertex) * componentCount) * sizeof(T), components, componentCount * sizeof(T));
+}
+
+PositionQuantization PositionQuantization::FromBounds(const glm::vec3& minimum, const glm::vec3& maximum)
+{
+	PositionQuantization quantization;
+	quantization.offset = (minimum + maximum) * 0.5f;
+
+	glm::vec3 halfExtent = (maximum - minimum) * 0.5f;
+	quantization.scale = std::max(std::max(halfExtent.x, halfExtent.y), halfExtent.z);
+
+	return quantization;
+}
+
+glm::vec2 VertexQuantizer::EncodeOctahedral(const glm::vec3& normal)
+{
+	float length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+	if (length <= 0.0f)
+	{
+		return glm::vec2(0.0f);
+	}
+
+	glm::vec3 n = normal / length;
+	if (n.z < 0.0f)
+	{
+		// Fold the lower hemisphere over the diagonals
+		float x = (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		float y = (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+		return glm::vec2(x, y);
+	}
+
+	return glm::vec2(n.x, n.y);
+}
+
+glm::vec3 VertexQuantizer::DecodeOctahedral(const glm::vec2& encoded)
+{
+	glm::vec3 n(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+	float t = std::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return glm::normalize(n);
+}
+
+void VertexQuantizer::Quantize(SubMesh& subMesh, const PositionQuantization& positionQuantization, uint32_t octahedralBits)
+{
+	const bool wide = octahedralBits > 8;
+	const float octahedralMaximum = wide ? 32767.0f : 127.0f;
+	bool quantizedPositions = false;
+
+	for (auto& vertexBuffer : subMesh.vertexBuffers)
+	{
+		const std::string& name = vertexBuffer.first;
+		const AccessorView& view = vertexBuffer.second;
+		const VertexSemantic semantic = GetVertexSemantic(name);
+		const uint32_t count = view.count;
+
+		std::vector<uint8_t> data;
+		VkFormat format = VK_FORMAT_UNDEFINED;
+
+		if (semantic == VertexSemantic::Position && view.format == VK_FORMAT_R32G32B32_SFLOAT && positionQuantization.IsValid())
+		{
+			// The 4th component keeps every position 8 byte aligned, 3 component 16-bit formats are rarely vertex buffer formats
+			data.resize(static_cast<size_t>(count) * 4 * sizeof(int16_t));
+			for (uint32_t v = 0; v < count; ++v)
+			{
+				glm::vec3 p = (glm::vec3(MeshUtils::DecodeElement(view.format, view.At(v))) - positionQuantization.offset) / positionQuantization.scale;
+				int16_t q[4] = { QuantizeSnorm<int16_t>(p.x, 32767.0f), QuantizeSnorm<int16_t>(p.y, 32767.0f), QuantizeSnorm<int16_t>(p.z, 32767.0f), 0 };
+				StoreComponents(data, v, q, 4);
+			}
+			format = VK_FORMAT_R16G16B16A16_SNORM;
+			quantizedPositions = true;
+		}
+		else if (semantic == VertexSemantic::Normal && view.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			data.resize(static_cast<size_t>(count) * 2 * (wide ? sizeof(int16_t) : sizeof(int8_t)));
+			for (uint32_t v = 0; v < count; ++v)
+			{
+				glm::vec2 e = EncodeOctahedral(glm::vec3(MeshUtils::DecodeElement(view.format, view.At(v))));
+				if (wide)
+				{
+					int16_t q[2] = { QuantizeSnorm<int16_t>(e.x, octahedralMaximum), QuantizeSnorm<int16_t>(e.y, octahedralMaximum) };
+					StoreComponents(data, v, q, 2);
+				}
+				else
+				{
+					int8_t q[2] = { QuantizeSnorm<int8_t>(e.x, octahedralMaximum), QuantizeSnorm<int8_t>(e.y, octahedralMaximum) };
+					StoreComponents(data, v, q, 2);
+				}
+			}
+			format = wide ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R8G8_SNORM;
+			subMesh.octahedralMask |= 1u << static_cast<uint32_t>(VertexSemantic::Normal);
+		}
+		else if (semantic == VertexSemantic::Tangent && view.format == VK_FORMAT_R32G32B32A32_SFLOAT)
+		{
+			// Octahedral xy, z unused and the handedness stays in w like in glTF
+			data.resize(static_cast<size_t>(count) * 4 * (wide ? sizeof(int16_t) : sizeof(int8_t)));
+			for (uint32_t v = 0; v < count; ++v)
+			{
+				glm::vec4 tangent = MeshUtils::DecodeElement(view.format, view.At(v));
+				glm::vec2 e = EncodeOctahedral(glm::vec3(tangent));
+				float handedness = tangent.w < 0.0f ? -1.0f : 1.0f;
+				if (wide)
+				{
+					int16_t q[4] = { QuantizeSnorm<int16_t>(e.x, octahedralMaximum), QuantizeSnorm<int16_t>(e.y, octahedralMaximum), 0, QuantizeSnorm<int16_t>(handedness, octahedralMaximum) };
+					StoreComponents(data, v, q, 4);
+				}
+				else
+				{
+					int8_t q[4] = { QuantizeSnorm<int8_t>(e.x, octahedralMaximum), QuantizeSnorm<int8_t>(e.y, octahedralMaximum), 0, QuantizeSnorm<int8_t>(handedness, octahedralMaximum) };
+					StoreComponents(data, v, q, 4);
+				}
+			}
+			format = wide ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R8G8B8A8_SNORM;
+			subMesh.octahedralMask |= 1u << static_cast<uint32_t>(VertexSemantic::Tangent);
+		}
+		else if ((semantic == VertexSemantic::Texcoord0 || semantic == VertexSemantic::Texcoord1) && view.format == VK_FORMAT_R32G32_SFLOAT)
+		{
+			// Wrapping texture coordinates would need a texture transform, those stay float
+			bool normalized = true;
+			for (uint32_t v = 0; v < count && normalized; ++v)
+			{
+				glm::vec4 uv = MeshUtils::DecodeElement(view.format, view.At(v));
+				normalized = uv.x >= 0.0f && uv.x <= 1.0f && uv.y >= 0.0f && uv.y <= 1.0f;
+			}
+
+			if (normalized)
+			{
+				data.resize(static_cast<size_t>(count) * 2 * sizeof(uint16_t));
+				for (uint32_t v = 0; v < count; ++v)
+				{
+					glm::vec4 uv = MeshUtils::DecodeElement(view.format, view.At(v));
+					uint16_t q[2] = { QuantizeUnorm16(uv.x), QuantizeUnorm16(uv.y) };
+					StoreComponents(data, v, q, 2);
+				}
+				format = VK_FORMAT_R16G16_UNORM;
+			}
+		}
+
+		if (format == VK_FORMAT_UNDEFINED)
+		{
+			continue;
+		}
+
+		const uint32_t elementSize = GetFormatSize(format);
+		vertexBuffer.second = AccessorView::FromData(std::move(data), elementSize, count, format);
+
+		VertexAttribute attribute;
+		attribute.format = format;
+		attribute.stride = elementSize;
+		subMesh.SetAttribute(name, attribute);
+	}
+
+	if (!quantizedPositions)
+	{
+		return;
+	}
+
+	// Half a quantization step per axis on top of every distance keeps the bounds conservative
+	const float invScale = 1.0f / positionQuantization.scale;
+	const float rounding = 0.8661f / 32767.0f;
+
+	for (SubMeshLod& lod : subMesh.lods)
+	{
+		lod.error = lod.error * invScale + rounding;
+	}
+
+	const uint32_t meshletCount = subMesh.meshlets.GetCount();
+	if (meshletCount > 0)
+	{
+		std::vector<uint8_t> bounds(subMesh.meshlets.bounds.Data(), subMesh.meshlets.bounds.Data() + subMesh.meshlets.bounds.ByteSize());
+		float* values = reinterpret_cast<float*>(bounds.data());
+		float* center[3] = {
+			values + static_cast<size_t>(MeshletBoundsArray::CenterX) * meshletCount,
+			values + static_cast<size_t>(MeshletBoundsArray::CenterY) * meshletCount,
+			values + static_cast<size_t>(MeshletBoundsArray::CenterZ) * meshletCount };
+		float* radius = values + static_cast<size_t>(MeshletBoundsArray::Radius) * meshletCount;
+
+		for (uint32_t m = 0; m < meshletCount; ++m)
+		{
+			for (uint32_t c = 0; c < 3; ++c)
+			{
+				center[c][m] = (center[c][m] - positionQuantization.offset[c]) * invScale;
+			}
+			radius[m] = radius[m] * invScale + rounding;
+		}
+
+		subMesh.meshlets.bounds = AccessorView::FromData(std::move(bounds), sizeof(float), subMesh.meshlets.bounds.count, VK_FORMAT_R32_SFLOAT);
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Framework/GlmCommon.h"
+
+struct SubMesh;
+
+/**
+ * @brief Dequantization of snorm16 positions, position = offset + scale * quantized
+ * The scale is uniform so normals and tangents are not affected when it is folded into a node transform.
+ */
+struct PositionQuantization
+{
+	glm::vec3 offset = glm::vec3(0.0f);
+	float scale = 0.0f;
+
+	inline bool IsValid() const { return scale > 0.0f; }
+
+	/**
+	 * @brief Centers the bounds and scales their largest half extent to 1
+	 */
+	static PositionQuantization FromBounds(const glm::vec3& minimum, const glm::vec3& maximum);
+};
+
+/**
+ * @brief Import time packing of float vertex attributes
+ * Positions become snorm16 against a PositionQuantization, normals and tangents become octahedral snorm8/snorm16
+ * (tangents keep their handedness in w) and texture coordinates inside [0, 1] become unorm16.
+ */
+class VertexQuantizer
+{
+public:
+	/**
+	 * @brief Quantizes the float attributes of a SubMesh, positions only when positionQuantization is valid
+	 * Meshlet bounds and LOD errors are moved into the quantized position space as well.
+	 */
+	static void Quantize(SubMesh& subMesh, const PositionQuantization& positionQuantization, uint32_t octahedralBits);
+
+	static glm::vec2 EncodeOctahedral(const glm::vec3& normal);
+
+	static glm::vec3 DecodeOctahedral(const glm::vec2& encoded);
+
+private:
+	VertexQuantizer() {};
+	~VertexQuantizer() {};
+};
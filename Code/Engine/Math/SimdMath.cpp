@@ -0,0 +1,788 @@
+#include "SimdMath.h"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if WL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if WL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+static std::atomic<uint32_t> s_SimdLevelCap{ static_cast<uint32_t>(SimdLevel::AVX2) };
+
+// glm::slerp falls back to a linear blend above this cosine
+static const float kSlerpLinearCosine = 1.0f - std::numeric_limits<float>::epsilon();
+
+// acos(x) = sqrt(1 - x) * polynomial(x) on [0, 1], Abramowitz and Stegun 4.4.46, error below 2e-8
+static const float kAcos[8] = { 1.5707963050f, -0.2145988016f, 0.0889789874f, -0.0501743046f, 0.0308918810f, -0.0170881256f, 0.0066700901f, -0.0012624911f };
+
+// sin(x) = x + x^3 * polynomial(x^2) on [0, pi / 2], Taylor series to x^13, error below 6e-8
+static const float kSin[6] = { -1.0f / 6.0f, 1.0f / 120.0f, -1.0f / 5040.0f, 1.0f / 362880.0f, -1.0f / 39916800.0f, 1.0f / 6227020800.0f };
+
+// Scalar, also finishes the elements the SIMD paths leave over
+
+inline float AcosScalar(float x)
+{
+	float p = kAcos[7];
+	for (int k = 6; k >= 0; --k)
+	{
+		p = p * x + kAcos[k];
+	}
+	return std::sqrt(1.0f - x) * p;
+}
+
+inline float SinScalar(float x)
+{
+	const float x2 = x * x;
+	float p = kSin[5];
+	for (int k = 4; k >= 0; --k)
+	{
+		p = p * x2 + kSin[k];
+	}
+	return x + x * x2 * p;
+}
+
+static void ComposeAffineScalar(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, Affine3x4* out, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		const glm::quat& q = rotations[i];
+		const glm::vec3& t = translations[i];
+		const glm::vec3& s = scales[i];
+
+		// The terms of glm::mat4_cast
+		const float qxx = q.x * q.x;
+		const float qyy = q.y * q.y;
+		const float qzz = q.z * q.z;
+		const float qxz = q.x * q.z;
+		const float qxy = q.x * q.y;
+		const float qyz = q.y * q.z;
+		const float qwx = q.w * q.x;
+		const float qwy = q.w * q.y;
+		const float qwz = q.w * q.z;
+
+		out[i].rows[0] = glm::vec4((1.0f - 2.0f * (qyy + qzz)) * s.x, (2.0f * (qxy - qwz)) * s.y, (2.0f * (qxz + qwy)) * s.z, t.x);
+		out[i].rows[1] = glm::vec4((2.0f * (qxy + qwz)) * s.x, (1.0f - 2.0f * (qxx + qzz)) * s.y, (2.0f * (qyz - qwx)) * s.z, t.y);
+		out[i].rows[2] = glm::vec4((2.0f * (qxz - qwy)) * s.x, (2.0f * (qyz + qwx)) * s.y, (1.0f - 2.0f * (qxx + qyy)) * s.z, t.z);
+	}
+}
+
+static void MultiplyAffineScalar(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		const Affine3x4 left = a[i];
+		const Affine3x4 right = b[i];
+		for (int r = 0; r < 3; ++r)
+		{
+			const glm::vec4& row = left.rows[r];
+			out[i].rows[r] = ((right.rows[0] * row.x + right.rows[1] * row.y) + right.rows[2] * row.z) + glm::vec4(0.0f, 0.0f, 0.0f, row.w);
+		}
+	}
+}
+
+static void NormalizeQuaternionsScalar(glm::quat* quaternions, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		glm::quat& q = quaternions[i];
+		const float length = std::sqrt((q.w * q.w + q.x * q.x) + (q.y * q.y + q.z * q.z));
+		if (length <= 0.0f)
+		{
+			q = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			continue;
+		}
+
+		const float inverse = 1.0f / length;
+		q = glm::quat(q.w * inverse, q.x * inverse, q.y * inverse, q.z * inverse);
+	}
+}
+
+static void SlerpQuaternionsScalar(const glm::quat* a, const glm::quat* b, const float* t, glm::quat* out, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		const float x[4] = { a[i].x, a[i].y, a[i].z, a[i].w };
+		float z[4] = { b[i].x, b[i].y, b[i].z, b[i].w };
+
+		float cosine = (x[3] * z[3] + x[0] * z[0]) + (x[1] * z[1] + x[2] * z[2]);
+		if (cosine < 0.0f)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				z[c] = -z[c];
+			}
+			cosine = -cosine;
+		}
+
+		float r[4];
+		if (cosine > kSlerpLinearCosine)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				r[c] = x[c] * (1.0f - t[i]) + z[c] * t[i];
+			}
+		}
+		else
+		{
+			const float angle = AcosScalar(cosine);
+			const float s0 = SinScalar((1.0f - t[i]) * angle);
+			const float s1 = SinScalar(t[i] * angle);
+			const float s = SinScalar(angle);
+			for (int c = 0; c < 4; ++c)
+			{
+				r[c] = (s0 * x[c] + s1 * z[c]) / s;
+			}
+		}
+
+		out[i] = glm::quat(r[3], r[0], r[1], r[2]);
+	}
+}
+
+static void TransformAabbsScalar(const Affine3x4* transforms, const Aabb* boxes, Aabb* out, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		const Affine3x4& m = transforms[i];
+		const glm::vec3 center = (boxes[i].min + boxes[i].max) * 0.5f;
+		const glm::vec3 extent = (boxes[i].max - boxes[i].min) * 0.5f;
+
+		Aabb result;
+		for (int r = 0; r < 3; ++r)
+		{
+			const glm::vec4& row = m.rows[r];
+			const float c = ((row[0] * center.x + row[1] * center.y) + row[2] * center.z) + row[3];
+			const float e = (std::fabs(row[0]) * extent.x + std::fabs(row[1]) * extent.y) + std::fabs(row[2]) * extent.z;
+			result.min[r] = c - e;
+			result.max[r] = c + e;
+		}
+		out[i] = result;
+	}
+}
+
+#if WL_SIMD_SSE2
+
+// SSE2, four quaternions per iteration transposed to one register per component, one matrix per iteration for the
+// products and boxes
+
+inline void Transpose4Sse2(__m128& r0, __m128& r1, __m128& r2, __m128& r3)
+{
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+static size_t ComposeAffineSse2(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, Affine3x4* out, size_t begin, size_t count)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+
+	size_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&rotations[i].x);
+		__m128 y = _mm_loadu_ps(&rotations[i + 1].x);
+		__m128 z = _mm_loadu_ps(&rotations[i + 2].x);
+		__m128 w = _mm_loadu_ps(&rotations[i + 3].x);
+		Transpose4Sse2(x, y, z, w);
+
+		const glm::vec3* t = translations + i;
+		const glm::vec3* s = scales + i;
+		const __m128 sx = _mm_setr_ps(s[0].x, s[1].x, s[2].x, s[3].x);
+		const __m128 sy = _mm_setr_ps(s[0].y, s[1].y, s[2].y, s[3].y);
+		const __m128 sz = _mm_setr_ps(s[0].z, s[1].z, s[2].z, s[3].z);
+
+		const __m128 qxx = _mm_mul_ps(x, x);
+		const __m128 qyy = _mm_mul_ps(y, y);
+		const __m128 qzz = _mm_mul_ps(z, z);
+		const __m128 qxz = _mm_mul_ps(x, z);
+		const __m128 qxy = _mm_mul_ps(x, y);
+		const __m128 qyz = _mm_mul_ps(y, z);
+		const __m128 qwx = _mm_mul_ps(w, x);
+		const __m128 qwy = _mm_mul_ps(w, y);
+		const __m128 qwz = _mm_mul_ps(w, z);
+
+		__m128 rows[3][4];
+		rows[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))), sx);
+		rows[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)), sy);
+		rows[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxz, qwy)), sz);
+		rows[0][3] = _mm_setr_ps(t[0].x, t[1].x, t[2].x, t[3].x);
+		rows[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qxy, qwz)), sx);
+		rows[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))), sy);
+		rows[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)), sz);
+		rows[1][3] = _mm_setr_ps(t[0].y, t[1].y, t[2].y, t[3].y);
+		rows[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)), sx);
+		rows[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(qyz, qwx)), sy);
+		rows[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))), sz);
+		rows[2][3] = _mm_setr_ps(t[0].z, t[1].z, t[2].z, t[3].z);
+
+		for (int r = 0; r < 3; ++r)
+		{
+			Transpose4Sse2(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+			for (int e = 0; e < 4; ++e)
+			{
+				_mm_storeu_ps(&out[i + e].rows[r].x, rows[r][e]);
+			}
+		}
+	}
+
+	return i;
+}
+
+static size_t MultiplyAffineSse2(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, size_t begin, size_t count)
+{
+	const __m128 maskW = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+	for (size_t i = begin; i < count; ++i)
+	{
+		const __m128 b0 = _mm_loadu_ps(&b[i].rows[0].x);
+		const __m128 b1 = _mm_loadu_ps(&b[i].rows[1].x);
+		const __m128 b2 = _mm_loadu_ps(&b[i].rows[2].x);
+		const __m128 a0 = _mm_loadu_ps(&a[i].rows[0].x);
+		const __m128 a1 = _mm_loadu_ps(&a[i].rows[1].x);
+		const __m128 a2 = _mm_loadu_ps(&a[i].rows[2].x);
+
+		const __m128 rows[3] = { a0, a1, a2 };
+		for (int r = 0; r < 3; ++r)
+		{
+			const __m128 row = rows[r];
+			__m128 result = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(0, 0, 0, 0)), b0), _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+			result = _mm_add_ps(result, _mm_mul_ps(_mm_shuffle_ps(row, row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+			_mm_storeu_ps(&out[i].rows[r].x, _mm_add_ps(result, _mm_and_ps(row, maskW)));
+		}
+	}
+
+	return count;
+}
+
+static size_t NormalizeQuaternionsSse2(glm::quat* quaternions, size_t begin, size_t count)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	size_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&quaternions[i].x);
+		__m128 y = _mm_loadu_ps(&quaternions[i + 1].x);
+		__m128 z = _mm_loadu_ps(&quaternions[i + 2].x);
+		__m128 w = _mm_loadu_ps(&quaternions[i + 3].x);
+		Transpose4Sse2(x, y, z, w);
+
+		const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(w, w), _mm_mul_ps(x, x)), _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z))));
+		const __m128 inverse = _mm_div_ps(one, length);
+		// Not <= 0, a NaN length keeps its NaNs like glm::normalize
+		const __m128 valid = _mm_cmpnle_ps(length, zero);
+
+		x = _mm_and_ps(valid, _mm_mul_ps(x, inverse));
+		y = _mm_and_ps(valid, _mm_mul_ps(y, inverse));
+		z = _mm_and_ps(valid, _mm_mul_ps(z, inverse));
+		w = _mm_or_ps(_mm_and_ps(valid, _mm_mul_ps(w, inverse)), _mm_andnot_ps(valid, one));
+
+		Transpose4Sse2(x, y, z, w);
+		_mm_storeu_ps(&quaternions[i].x, x);
+		_mm_storeu_ps(&quaternions[i + 1].x, y);
+		_mm_storeu_ps(&quaternions[i + 2].x, z);
+		_mm_storeu_ps(&quaternions[i + 3].x, w);
+	}
+
+	return i;
+}
+
+inline __m128 AcosSse2(__m128 x)
+{
+	__m128 p = _mm_set1_ps(kAcos[7]);
+	for (int k = 6; k >= 0; --k)
+	{
+		p = _mm_add_ps(_mm_mul_ps(p, x), _mm_set1_ps(kAcos[k]));
+	}
+	return _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), x)), p);
+}
+
+inline __m128 SinSse2(__m128 x)
+{
+	const __m128 x2 = _mm_mul_ps(x, x);
+	__m128 p = _mm_set1_ps(kSin[5]);
+	for (int k = 4; k >= 0; --k)
+	{
+		p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin[k]));
+	}
+	return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), p));
+}
+
+inline __m128 SelectSse2(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static size_t SlerpQuaternionsSse2(const glm::quat* a, const glm::quat* b, const float* t, glm::quat* out, size_t begin, size_t count)
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+
+	size_t i = begin;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x[4] = { _mm_loadu_ps(&a[i].x), _mm_loadu_ps(&a[i + 1].x), _mm_loadu_ps(&a[i + 2].x), _mm_loadu_ps(&a[i + 3].x) };
+		__m128 z[4] = { _mm_loadu_ps(&b[i].x), _mm_loadu_ps(&b[i + 1].x), _mm_loadu_ps(&b[i + 2].x), _mm_loadu_ps(&b[i + 3].x) };
+		Transpose4Sse2(x[0], x[1], x[2], x[3]);
+		Transpose4Sse2(z[0], z[1], z[2], z[3]);
+		const __m128 blend = _mm_loadu_ps(t + i);
+
+		__m128 cosine = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x[3], z[3]), _mm_mul_ps(x[0], z[0])), _mm_add_ps(_mm_mul_ps(x[1], z[1]), _mm_mul_ps(x[2], z[2])));
+		const __m128 flip = _mm_and_ps(_mm_cmplt_ps(cosine, _mm_setzero_ps()), signMask);
+		for (int c = 0; c < 4; ++c)
+		{
+			z[c] = _mm_xor_ps(z[c], flip);
+		}
+		cosine = _mm_xor_ps(cosine, flip);
+
+		const __m128 linear = _mm_cmpgt_ps(cosine, _mm_set1_ps(kSlerpLinearCosine));
+		const __m128 angle = AcosSse2(cosine);
+		const __m128 s0 = SinSse2(_mm_mul_ps(_mm_sub_ps(one, blend), angle));
+		const __m128 s1 = SinSse2(_mm_mul_ps(blend, angle));
+		const __m128 s = SinSse2(angle);
+		const __m128 oneMinusBlend = _mm_sub_ps(one, blend);
+
+		__m128 r[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			const __m128 mixed = _mm_add_ps(_mm_mul_ps(x[c], oneMinusBlend), _mm_mul_ps(z[c], blend));
+			const __m128 spherical = _mm_div_ps(_mm_add_ps(_mm_mul_ps(s0, x[c]), _mm_mul_ps(s1, z[c])), s);
+			r[c] = SelectSse2(linear, mixed, spherical);
+		}
+
+		Transpose4Sse2(r[0], r[1], r[2], r[3]);
+		for (int e = 0; e < 4; ++e)
+		{
+			_mm_storeu_ps(&out[i + e].x, r[e]);
+		}
+	}
+
+	return i;
+}
+
+static size_t TransformAabbsSse2(const Affine3x4* transforms, const Aabb* boxes, Aabb* out, size_t begin, size_t count)
+{
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	for (size_t i = begin; i < count; ++i)
+	{
+		__m128 c0 = _mm_loadu_ps(&transforms[i].rows[0].x);
+		__m128 c1 = _mm_loadu_ps(&transforms[i].rows[1].x);
+		__m128 c2 = _mm_loadu_ps(&transforms[i].rows[2].x);
+		__m128 c3 = _mm_setzero_ps();
+		Transpose4Sse2(c0, c1, c2, c3);
+
+		// (min.x, min.y, min.z, max.x) and (min.z, max.x, max.y, max.z), the six floats of the box
+		const float* box = &boxes[i].min.x;
+		const __m128 low = _mm_loadu_ps(box);
+		const __m128 high = _mm_loadu_ps(box + 2);
+		const __m128 maximum = _mm_shuffle_ps(high, high, _MM_SHUFFLE(3, 3, 2, 1));
+		const __m128 center = _mm_mul_ps(_mm_add_ps(low, maximum), half);
+		const __m128 extent = _mm_mul_ps(_mm_sub_ps(maximum, low), half);
+
+		__m128 c = _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(center, center, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(c1, _mm_shuffle_ps(center, center, _MM_SHUFFLE(1, 1, 1, 1))));
+		c = _mm_add_ps(_mm_add_ps(c, _mm_mul_ps(c2, _mm_shuffle_ps(center, center, _MM_SHUFFLE(2, 2, 2, 2)))), c3);
+		__m128 e = _mm_add_ps(_mm_mul_ps(_mm_and_ps(c0, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(_mm_and_ps(c1, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(1, 1, 1, 1))));
+		e = _mm_add_ps(e, _mm_mul_ps(_mm_and_ps(c2, absMask), _mm_shuffle_ps(extent, extent, _MM_SHUFFLE(2, 2, 2, 2))));
+
+		const __m128 resultMin = _mm_sub_ps(c, e);
+		const __m128 resultMax = _mm_add_ps(c, e);
+		// Two overlapping stores write min.xyz, max.x and then min.z, max.xyz
+		float* result = &out[i].min.x;
+		_mm_storeu_ps(result, _mm_shuffle_ps(resultMin, _mm_shuffle_ps(resultMin, resultMax, _MM_SHUFFLE(0, 0, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(result + 2, _mm_shuffle_ps(_mm_shuffle_ps(resultMin, resultMax, _MM_SHUFFLE(0, 0, 2, 2)), resultMax, _MM_SHUFFLE(2, 1, 2, 0)));
+	}
+
+	return count;
+}
+
+#endif
+
+#if WL_SIMD_AVX2
+
+// AVX2, eight quaternions per iteration with four in each 128 bit lane, two matrices per iteration for the
+// products and boxes
+
+WL_TARGET_AVX2 inline void Transpose4Avx2(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+{
+	const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+	const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+	const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+	const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+	r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+WL_TARGET_AVX2 inline __m256 LoadPairAvx2(const float* low, const float* high)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+WL_TARGET_AVX2 inline void StorePairAvx2(float* low, float* high, __m256 value)
+{
+	_mm_storeu_ps(low, _mm256_castps256_ps128(value));
+	_mm_storeu_ps(high, _mm256_extractf128_ps(value, 1));
+}
+
+/**
+ * @brief Loads quaternions [i, i + 8) as x, y, z and w registers, element e in lane e / 4, slot e % 4
+ */
+WL_TARGET_AVX2 inline void LoadQuaternionsAvx2(const glm::quat* q, __m256* xyzw)
+{
+	for (int k = 0; k < 4; ++k)
+	{
+		xyzw[k] = LoadPairAvx2(&q[k].x, &q[k + 4].x);
+	}
+	Transpose4Avx2(xyzw[0], xyzw[1], xyzw[2], xyzw[3]);
+}
+
+WL_TARGET_AVX2 inline void StoreQuaternionsAvx2(glm::quat* q, __m256* xyzw)
+{
+	Transpose4Avx2(xyzw[0], xyzw[1], xyzw[2], xyzw[3]);
+	for (int k = 0; k < 4; ++k)
+	{
+		StorePairAvx2(&q[k].x, &q[k + 4].x, xyzw[k]);
+	}
+}
+
+/**
+ * @brief Component c of eight packed vec3 in the element order of LoadQuaternionsAvx2
+ */
+WL_TARGET_AVX2 inline __m256 GatherVec3Avx2(const glm::vec3* v, int c)
+{
+	const __m256i offsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+	return _mm256_i32gather_ps(&v->x + c, offsets, 4);
+}
+
+WL_TARGET_AVX2 static size_t ComposeAffineAvx2(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, Affine3x4* out, size_t begin, size_t count)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+
+	size_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 q[4];
+		LoadQuaternionsAvx2(rotations + i, q);
+		const __m256 x = q[0];
+		const __m256 y = q[1];
+		const __m256 z = q[2];
+		const __m256 w = q[3];
+		const __m256 sx = GatherVec3Avx2(scales + i, 0);
+		const __m256 sy = GatherVec3Avx2(scales + i, 1);
+		const __m256 sz = GatherVec3Avx2(scales + i, 2);
+
+		const __m256 qxx = _mm256_mul_ps(x, x);
+		const __m256 qyy = _mm256_mul_ps(y, y);
+		const __m256 qzz = _mm256_mul_ps(z, z);
+		const __m256 qxz = _mm256_mul_ps(x, z);
+		const __m256 qxy = _mm256_mul_ps(x, y);
+		const __m256 qyz = _mm256_mul_ps(y, z);
+		const __m256 qwx = _mm256_mul_ps(w, x);
+		const __m256 qwy = _mm256_mul_ps(w, y);
+		const __m256 qwz = _mm256_mul_ps(w, z);
+
+		__m256 rows[3][4];
+		rows[0][0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz))), sx);
+		rows[0][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz)), sy);
+		rows[0][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxz, qwy)), sz);
+		rows[0][3] = GatherVec3Avx2(translations + i, 0);
+		rows[1][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qxy, qwz)), sx);
+		rows[1][1] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz))), sy);
+		rows[1][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx)), sz);
+		rows[1][3] = GatherVec3Avx2(translations + i, 1);
+		rows[2][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy)), sx);
+		rows[2][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(qyz, qwx)), sy);
+		rows[2][2] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy))), sz);
+		rows[2][3] = GatherVec3Avx2(translations + i, 2);
+
+		for (int r = 0; r < 3; ++r)
+		{
+			Transpose4Avx2(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+			for (int e = 0; e < 4; ++e)
+			{
+				StorePairAvx2(&out[i + e].rows[r].x, &out[i + e + 4].rows[r].x, rows[r][e]);
+			}
+		}
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t MultiplyAffineAvx2(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, size_t begin, size_t count)
+{
+	const __m256 maskW = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1));
+
+	size_t i = begin;
+	for (; i + 2 <= count; i += 2)
+	{
+		const __m256 b0 = LoadPairAvx2(&b[i].rows[0].x, &b[i + 1].rows[0].x);
+		const __m256 b1 = LoadPairAvx2(&b[i].rows[1].x, &b[i + 1].rows[1].x);
+		const __m256 b2 = LoadPairAvx2(&b[i].rows[2].x, &b[i + 1].rows[2].x);
+		const __m256 rows[3] = {
+			LoadPairAvx2(&a[i].rows[0].x, &a[i + 1].rows[0].x),
+			LoadPairAvx2(&a[i].rows[1].x, &a[i + 1].rows[1].x),
+			LoadPairAvx2(&a[i].rows[2].x, &a[i + 1].rows[2].x)
+		};
+
+		for (int r = 0; r < 3; ++r)
+		{
+			const __m256 row = rows[r];
+			__m256 result = _mm256_add_ps(_mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(0, 0, 0, 0)), b0), _mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(row, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+			StorePairAvx2(&out[i].rows[r].x, &out[i + 1].rows[r].x, _mm256_add_ps(result, _mm256_and_ps(row, maskW)));
+		}
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t NormalizeQuaternionsAvx2(glm::quat* quaternions, size_t begin, size_t count)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	size_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 q[4];
+		LoadQuaternionsAvx2(quaternions + i, q);
+		const __m256 x = q[0];
+		const __m256 y = q[1];
+		const __m256 z = q[2];
+		const __m256 w = q[3];
+
+		const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w, w), _mm256_mul_ps(x, x)), _mm256_add_ps(_mm256_mul_ps(y, y), _mm256_mul_ps(z, z))));
+		const __m256 inverse = _mm256_div_ps(one, length);
+		const __m256 valid = _mm256_cmp_ps(length, zero, _CMP_NLE_UQ);
+
+		q[0] = _mm256_and_ps(valid, _mm256_mul_ps(x, inverse));
+		q[1] = _mm256_and_ps(valid, _mm256_mul_ps(y, inverse));
+		q[2] = _mm256_and_ps(valid, _mm256_mul_ps(z, inverse));
+		q[3] = _mm256_blendv_ps(one, _mm256_mul_ps(w, inverse), valid);
+		StoreQuaternionsAvx2(quaternions + i, q);
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 inline __m256 AcosAvx2(__m256 x)
+{
+	__m256 p = _mm256_set1_ps(kAcos[7]);
+	for (int k = 6; k >= 0; --k)
+	{
+		p = _mm256_add_ps(_mm256_mul_ps(p, x), _mm256_set1_ps(kAcos[k]));
+	}
+	return _mm256_mul_ps(_mm256_sqrt_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), x)), p);
+}
+
+WL_TARGET_AVX2 inline __m256 SinAvx2(__m256 x)
+{
+	const __m256 x2 = _mm256_mul_ps(x, x);
+	__m256 p = _mm256_set1_ps(kSin[5]);
+	for (int k = 4; k >= 0; --k)
+	{
+		p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(kSin[k]));
+	}
+	return _mm256_add_ps(x, _mm256_mul_ps(_mm256_mul_ps(x, x2), p));
+}
+
+WL_TARGET_AVX2 static size_t SlerpQuaternionsAvx2(const glm::quat* a, const glm::quat* b, const float* t, glm::quat* out, size_t begin, size_t count)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+	size_t i = begin;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 x[4];
+		__m256 z[4];
+		LoadQuaternionsAvx2(a + i, x);
+		LoadQuaternionsAvx2(b + i, z);
+		// Blend factors in the element order of the quaternion registers
+		const __m256 blend = LoadPairAvx2(t + i, t + i + 4);
+
+		__m256 cosine = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x[3], z[3]), _mm256_mul_ps(x[0], z[0])), _mm256_add_ps(_mm256_mul_ps(x[1], z[1]), _mm256_mul_ps(x[2], z[2])));
+		const __m256 flip = _mm256_and_ps(_mm256_cmp_ps(cosine, _mm256_setzero_ps(), _CMP_LT_OQ), signMask);
+		for (int c = 0; c < 4; ++c)
+		{
+			z[c] = _mm256_xor_ps(z[c], flip);
+		}
+		cosine = _mm256_xor_ps(cosine, flip);
+
+		const __m256 linear = _mm256_cmp_ps(cosine, _mm256_set1_ps(kSlerpLinearCosine), _CMP_GT_OQ);
+		const __m256 angle = AcosAvx2(cosine);
+		const __m256 s0 = SinAvx2(_mm256_mul_ps(_mm256_sub_ps(one, blend), angle));
+		const __m256 s1 = SinAvx2(_mm256_mul_ps(blend, angle));
+		const __m256 s = SinAvx2(angle);
+		const __m256 oneMinusBlend = _mm256_sub_ps(one, blend);
+
+		__m256 r[4];
+		for (int c = 0; c < 4; ++c)
+		{
+			const __m256 mixed = _mm256_add_ps(_mm256_mul_ps(x[c], oneMinusBlend), _mm256_mul_ps(z[c], blend));
+			const __m256 spherical = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(s0, x[c]), _mm256_mul_ps(s1, z[c])), s);
+			r[c] = _mm256_blendv_ps(spherical, mixed, linear);
+		}
+
+		StoreQuaternionsAvx2(out + i, r);
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t TransformAabbsAvx2(const Affine3x4* transforms, const Aabb* boxes, Aabb* out, size_t begin, size_t count)
+{
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+	size_t i = begin;
+	for (; i + 2 <= count; i += 2)
+	{
+		__m256 c0 = LoadPairAvx2(&transforms[i].rows[0].x, &transforms[i + 1].rows[0].x);
+		__m256 c1 = LoadPairAvx2(&transforms[i].rows[1].x, &transforms[i + 1].rows[1].x);
+		__m256 c2 = LoadPairAvx2(&transforms[i].rows[2].x, &transforms[i + 1].rows[2].x);
+		__m256 c3 = _mm256_setzero_ps();
+		Transpose4Avx2(c0, c1, c2, c3);
+
+		const __m256 low = LoadPairAvx2(&boxes[i].min.x, &boxes[i + 1].min.x);
+		const __m256 high = LoadPairAvx2(&boxes[i].min.x + 2, &boxes[i + 1].min.x + 2);
+		const __m256 maximum = _mm256_permute_ps(high, _MM_SHUFFLE(3, 3, 2, 1));
+		const __m256 center = _mm256_mul_ps(_mm256_add_ps(low, maximum), half);
+		const __m256 extent = _mm256_mul_ps(_mm256_sub_ps(maximum, low), half);
+
+		__m256 c = _mm256_add_ps(_mm256_mul_ps(c0, _mm256_permute_ps(center, _MM_SHUFFLE(0, 0, 0, 0))), _mm256_mul_ps(c1, _mm256_permute_ps(center, _MM_SHUFFLE(1, 1, 1, 1))));
+		c = _mm256_add_ps(_mm256_add_ps(c, _mm256_mul_ps(c2, _mm256_permute_ps(center, _MM_SHUFFLE(2, 2, 2, 2)))), c3);
+		__m256 e = _mm256_add_ps(_mm256_mul_ps(_mm256_and_ps(c0, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(0, 0, 0, 0))), _mm256_mul_ps(_mm256_and_ps(c1, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(1, 1, 1, 1))));
+		e = _mm256_add_ps(e, _mm256_mul_ps(_mm256_and_ps(c2, absMask), _mm256_permute_ps(extent, _MM_SHUFFLE(2, 2, 2, 2))));
+
+		const __m256 resultMin = _mm256_sub_ps(c, e);
+		const __m256 resultMax = _mm256_add_ps(c, e);
+		const __m256 middle = _mm256_shuffle_ps(resultMin, resultMax, _MM_SHUFFLE(0, 0, 2, 2));
+		StorePairAvx2(&out[i].min.x, &out[i + 1].min.x, _mm256_shuffle_ps(resultMin, middle, _MM_SHUFFLE(2, 0, 1, 0)));
+		StorePairAvx2(&out[i].min.x + 2, &out[i + 1].min.x + 2, _mm256_shuffle_ps(middle, resultMax, _MM_SHUFFLE(2, 1, 2, 0)));
+	}
+
+	return i;
+}
+
+#endif
+
+void SimdMath::ComposeAffine(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, Affine3x4* out, size_t count)
+{
+	[[maybe_unused]] const SimdLevel level = GetSimdLevel();
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = ComposeAffineAvx2(translations, rotations, scales, out, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = ComposeAffineSse2(translations, rotations, scales, out, done, count);
+	}
+#endif
+
+	ComposeAffineScalar(translations, rotations, scales, out, done, count);
+}
+
+void SimdMath::MultiplyAffine(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, size_t count)
+{
+	[[maybe_unused]] const SimdLevel level = GetSimdLevel();
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = MultiplyAffineAvx2(a, b, out, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = MultiplyAffineSse2(a, b, out, done, count);
+	}
+#endif
+
+	MultiplyAffineScalar(a, b, out, done, count);
+}
+
+void SimdMath::NormalizeQuaternions(glm::quat* quaternions, size_t count)
+{
+	[[maybe_unused]] const SimdLevel level = GetSimdLevel();
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = NormalizeQuaternionsAvx2(quaternions, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = NormalizeQuaternionsSse2(quaternions, done, count);
+	}
+#endif
+
+	NormalizeQuaternionsScalar(quaternions, done, count);
+}
+
+void SimdMath::SlerpQuaternions(const glm::quat* a, const glm::quat* b, const float* t, glm::quat* out, size_t count)
+{
+	[[maybe_unused]] const SimdLevel level = GetSimdLevel();
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = SlerpQuaternionsAvx2(a, b, t, out, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = SlerpQuaternionsSse2(a, b, t, out, done, count);
+	}
+#endif
+
+	SlerpQuaternionsScalar(a, b, t, out, done, count);
+}
+
+void SimdMath::TransformAabbs(const Affine3x4* transforms, const Aabb* boxes, Aabb* out, size_t count)
+{
+	[[maybe_unused]] const SimdLevel level = GetSimdLevel();
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = TransformAabbsAvx2(transforms, boxes, out, 0, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done = TransformAabbsSse2(transforms, boxes, out, done, count);
+	}
+#endif
+
+	TransformAabbsScalar(transforms, boxes, out, done, count);
+}
+
+SimdLevel SimdMath::GetSimdLevel()
+{
+	SimdLevel supported = CpuFeatures::GetSimdLevel();
+	SimdLevel cap = static_cast<SimdLevel>(s_SimdLevelCap.load(std::memory_order_relaxed));
+	return static_cast<uint32_t>(cap) < static_cast<uint32_t>(supported) ? cap : supported;
+}
+
+void SimdMath::SetSimdLevel(SimdLevel level)
+{
+	s_SimdLevelCap.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Framework/CpuFeatures.h"
+#include "Framework/GlmCommon.h"
+#include <glm/gtx/quaternion.hpp>
+
+#if defined(GLM_FORCE_QUAT_DATA_WXYZ)
+#error "SimdMath loads quaternions as x, y, z, w"
+#endif
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "SimdMath expects packed glm::vec3");
+static_assert(sizeof(glm::quat) == 4 * sizeof(float), "SimdMath expects packed glm::quat");
+
+/**
+ * @brief Affine transform in three rows of a 3x4 matrix, the implicit fourth row is (0, 0, 0, 1)
+ * rows[r] holds (m[0][r], m[1][r], m[2][r], m[3][r]) of the equivalent column major glm::mat4.
+ */
+struct Affine3x4
+{
+	glm::vec4 rows[3];
+
+	static inline Affine3x4 FromMat4(const glm::mat4& m)
+	{
+		Affine3x4 affine;
+		for (int r = 0; r < 3; ++r)
+		{
+			affine.rows[r] = glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]);
+		}
+		return affine;
+	}
+
+	inline glm::mat4 ToMat4() const
+	{
+		glm::mat4 m(1.0f);
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				m[c][r] = rows[r][c];
+			}
+		}
+		return m;
+	}
+};
+
+struct Aabb
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+/**
+ * @brief Batched transform math over arrays, AVX2, then SSE2, then scalar for the remainder
+ * Every path rounds exactly like the scalar one, so results do not depend on the CPU. ComposeAffine and
+ * MultiplyAffine give the same bits as glm (translate * mat4_cast * scale and mat4 products), NormalizeQuaternions
+ * the same as glm::normalize. SlerpQuaternions and TransformAabbs use polynomial acos and sin and the center and
+ * extent form of the box, so they agree with glm to a few ulp instead.
+ * The input and output arrays of a call may be the same array, but may not overlap otherwise.
+ */
+class SimdMath
+{
+public:
+	/**
+	 * @brief out[i] = translate(translations[i]) * mat4_cast(rotations[i]) * scale(scales[i])
+	 */
+	static void ComposeAffine(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales, Affine3x4* out, size_t count);
+
+	/**
+	 * @brief out[i] = a[i] * b[i]
+	 */
+	static void MultiplyAffine(const Affine3x4* a, const Affine3x4* b, Affine3x4* out, size_t count);
+
+	/**
+	 * @brief quaternions[i] = glm::normalize(quaternions[i]), zero length quaternions become the identity
+	 */
+	static void NormalizeQuaternions(glm::quat* quaternions, size_t count);
+
+	/**
+	 * @brief out[i] = glm::slerp(a[i], b[i], t[i]) along the shorter arc, t in [0, 1]
+	 */
+	static void SlerpQuaternions(const glm::quat* a, const glm::quat* b, const float* t, glm::quat* out, size_t count);
+
+	/**
+	 * @brief Bounds of the boxes after their transform, out[i] encloses transforms[i] applied to boxes[i]
+	 */
+	static void TransformAabbs(const Affine3x4* transforms, const Aabb* boxes, Aabb* out, size_t count);
+
+	static SimdLevel GetSimdLevel();
+
+	/**
+	 * @brief Caps the kernels at level, the CPU support still applies
+	 */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	SimdMath() {};
+	~SimdMath() {};
+};
@@ -0,0 +1,399 @@
+#include "AccessorConversion.h"
+
+#include <atomic>
+#include <cstring>
+
+#if WL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if WL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+static std::atomic<uint32_t> s_SimdLevelCap{ static_cast<uint32_t>(SimdLevel::AVX2) };
+
+inline uint32_t ReadUnaligned16(const uint8_t* data)
+{
+	uint16_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+inline uint32_t ReadUnaligned32(const uint8_t* data)
+{
+	uint32_t value;
+	std::memcpy(&value, data, sizeof(value));
+	return value;
+}
+
+// Scalar, also the tail of the SIMD paths
+
+static void WidenIndices8To16Scalar(const uint8_t* source, uint16_t* destination, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		destination[i] = source[i];
+	}
+}
+
+static bool NarrowIndices32To16Scalar(const uint32_t* source, uint16_t* destination, size_t count)
+{
+	uint32_t highBits = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		highBits |= source[i];
+		destination[i] = static_cast<uint16_t>(source[i]);
+	}
+
+	return highBits <= 0xffff;
+}
+
+static uint32_t ReadSparseIndicesScalar(const uint8_t* source, uint32_t componentSize, uint32_t* destination, size_t count)
+{
+	uint32_t maximum = 0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		const uint8_t* element = source + i * componentSize;
+		uint32_t index = componentSize == 1 ? *element : (componentSize == 2 ? ReadUnaligned16(element) : ReadUnaligned32(element));
+		destination[i] = index;
+		maximum = index > maximum ? index : maximum;
+	}
+
+	return maximum;
+}
+
+#if WL_SIMD_SSE2
+
+// SSE2
+
+static size_t WidenIndices8To16Sse2(const uint8_t* source, uint16_t* destination, size_t count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi8(v, zero));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpackhi_epi8(v, zero));
+	}
+
+	return i;
+}
+
+/**
+ * @brief Low 16 bits of the 32-bit lanes of a and b, SSE2 only has a signed saturating pack
+ */
+inline __m128i PackLow16Sse2(__m128i a, __m128i b)
+{
+	a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+	b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+	return _mm_packs_epi32(a, b);
+}
+
+static size_t NarrowIndices32To16Sse2(const uint32_t* source, uint16_t* destination, size_t count, uint32_t& highBits)
+{
+	__m128i accumulated = _mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4));
+		accumulated = _mm_or_si128(accumulated, _mm_or_si128(a, b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), PackLow16Sse2(a, b));
+	}
+
+	accumulated = _mm_or_si128(accumulated, _mm_shuffle_epi32(accumulated, _MM_SHUFFLE(1, 0, 3, 2)));
+	accumulated = _mm_or_si128(accumulated, _mm_shuffle_epi32(accumulated, _MM_SHUFFLE(2, 3, 0, 1)));
+	highBits = static_cast<uint32_t>(_mm_cvtsi128_si32(accumulated));
+
+	return i;
+}
+
+/**
+ * @brief Unsigned 32-bit maximum, SSE2 compares are signed so both sides are biased by 2^31
+ */
+inline __m128i MaxU32Sse2(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+	__m128i greater = _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+	return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+
+inline uint32_t HorizontalMaxU32Sse2(__m128i v)
+{
+	v = MaxU32Sse2(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = MaxU32Sse2(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+	return static_cast<uint32_t>(_mm_cvtsi128_si32(v));
+}
+
+static size_t ReadSparseIndicesSse2(const uint8_t* source, uint32_t componentSize, uint32_t* destination, size_t count, uint32_t& maximum)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i maximum4 = _mm_setzero_si128();
+
+	size_t i = 0;
+	if (componentSize == 1)
+	{
+		for (; i + 16 <= count; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+			__m128i lo = _mm_unpacklo_epi8(v, zero);
+			__m128i hi = _mm_unpackhi_epi8(v, zero);
+			__m128i i0 = _mm_unpacklo_epi16(lo, zero);
+			__m128i i1 = _mm_unpackhi_epi16(lo, zero);
+			__m128i i2 = _mm_unpacklo_epi16(hi, zero);
+			__m128i i3 = _mm_unpackhi_epi16(hi, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), i0);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 4), i1);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), i2);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 12), i3);
+
+			// Values below 2^8 compare correctly as signed 32-bit integers
+			maximum4 = _mm_max_epi16(maximum4, _mm_max_epi16(_mm_max_epi16(i0, i1), _mm_max_epi16(i2, i3)));
+		}
+	}
+	else if (componentSize == 2)
+	{
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2));
+			__m128i i0 = _mm_unpacklo_epi16(v, zero);
+			__m128i i1 = _mm_unpackhi_epi16(v, zero);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), i0);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 4), i1);
+			maximum4 = MaxU32Sse2(maximum4, MaxU32Sse2(i0, i1));
+		}
+	}
+	else
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), v);
+			maximum4 = MaxU32Sse2(maximum4, v);
+		}
+	}
+
+	maximum = HorizontalMaxU32Sse2(maximum4);
+	return i;
+}
+
+#endif
+
+#if WL_SIMD_AVX2
+
+// AVX2
+
+WL_TARGET_AVX2 static size_t WidenIndices8To16Avx2(const uint8_t* source, uint16_t* destination, size_t count)
+{
+	size_t i = 0;
+	for (; i + 32 <= count; i += 32)
+	{
+		__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+		__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 16));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_cvtepu8_epi16(v0));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i + 16), _mm256_cvtepu8_epi16(v1));
+	}
+
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t NarrowIndices32To16Avx2(const uint32_t* source, uint16_t* destination, size_t count, uint32_t& highBits)
+{
+	__m256i accumulated = _mm256_setzero_si256();
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+		__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 8));
+		accumulated = _mm256_or_si256(accumulated, _mm256_or_si256(a, b));
+
+		// The pack works per 128-bit lane, the permute restores the element order
+		const __m256i lowMask = _mm256_set1_epi32(0xffff);
+		__m256i packed = _mm256_packus_epi32(_mm256_and_si256(a, lowMask), _mm256_and_si256(b, lowMask));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+
+	__m128i accumulated4 = _mm_or_si128(_mm256_castsi256_si128(accumulated), _mm256_extracti128_si256(accumulated, 1));
+	accumulated4 = _mm_or_si128(accumulated4, _mm_shuffle_epi32(accumulated4, _MM_SHUFFLE(1, 0, 3, 2)));
+	accumulated4 = _mm_or_si128(accumulated4, _mm_shuffle_epi32(accumulated4, _MM_SHUFFLE(2, 3, 0, 1)));
+	highBits = static_cast<uint32_t>(_mm_cvtsi128_si32(accumulated4));
+
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t ReadSparseIndicesAvx2(const uint8_t* source, uint32_t componentSize, uint32_t* destination, size_t count, uint32_t& maximum)
+{
+	__m256i maximum8 = _mm256_setzero_si256();
+
+	size_t i = 0;
+	if (componentSize == 1)
+	{
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256i i0 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i)));
+			__m256i i1 = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source + i + 8)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), i0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i + 8), i1);
+			maximum8 = _mm256_max_epu32(maximum8, _mm256_max_epu32(i0, i1));
+		}
+	}
+	else if (componentSize == 2)
+	{
+		for (; i + 16 <= count; i += 16)
+		{
+			__m256i i0 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2)));
+			__m256i i1 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2 + 16)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), i0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i + 8), i1);
+			maximum8 = _mm256_max_epu32(maximum8, _mm256_max_epu32(i0, i1));
+		}
+	}
+	else
+	{
+		for (; i + 8 <= count; i += 8)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i * 4));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), v);
+			maximum8 = _mm256_max_epu32(maximum8, v);
+		}
+	}
+
+	__m128i maximum4 = _mm_max_epu32(_mm256_castsi256_si128(maximum8), _mm256_extracti128_si256(maximum8, 1));
+	maximum4 = _mm_max_epu32(maximum4, _mm_shuffle_epi32(maximum4, _MM_SHUFFLE(1, 0, 3, 2)));
+	maximum4 = _mm_max_epu32(maximum4, _mm_shuffle_epi32(maximum4, _MM_SHUFFLE(2, 3, 0, 1)));
+	maximum = static_cast<uint32_t>(_mm_cvtsi128_si32(maximum4));
+
+	return i;
+}
+
+#endif
+
+/**
+ * @brief Scatter with a fixed element size, which lets the copy compile to plain loads and stores
+ */
+template <size_t ElementSize>
+static void ApplySparseValuesFixed(uint8_t* destination, const uint32_t* indices, const uint8_t* values, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::memcpy(destination + static_cast<size_t>(indices[i]) * ElementSize, values + i * ElementSize, ElementSize);
+	}
+}
+
+void AccessorConversion::WidenIndices8To16(const uint8_t* source, uint16_t* destination, size_t count)
+{
+	const SimdLevel level = GetSimdLevel();
+
+	size_t done = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = WidenIndices8To16Avx2(source, destination, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		done += WidenIndices8To16Sse2(source + done, destination + done, count - done);
+	}
+#endif
+
+	WidenIndices8To16Scalar(source + done, destination + done, count - done);
+}
+
+bool AccessorConversion::NarrowIndices32To16(const uint32_t* source, uint16_t* destination, size_t count)
+{
+	const SimdLevel level = GetSimdLevel();
+
+	size_t done = 0;
+	uint32_t highBits = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = NarrowIndices32To16Avx2(source, destination, count, highBits);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		uint32_t sse2HighBits = 0;
+		done += NarrowIndices32To16Sse2(source + done, destination + done, count - done, sse2HighBits);
+		highBits |= sse2HighBits;
+	}
+#endif
+
+	return NarrowIndices32To16Scalar(source + done, destination + done, count - done) && highBits <= 0xffff;
+}
+
+uint32_t AccessorConversion::ReadSparseIndices(const uint8_t* source, uint32_t componentSize, uint32_t* destination, size_t count)
+{
+	const SimdLevel level = GetSimdLevel();
+
+	size_t done = 0;
+	uint32_t maximum = 0;
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		done = ReadSparseIndicesAvx2(source, componentSize, destination, count, maximum);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		uint32_t sse2Maximum = 0;
+		done += ReadSparseIndicesSse2(source + done * componentSize, componentSize, destination + done, count - done, sse2Maximum);
+		maximum = sse2Maximum > maximum ? sse2Maximum : maximum;
+	}
+#endif
+
+	uint32_t tailMaximum = ReadSparseIndicesScalar(source + done * componentSize, componentSize, destination + done, count - done);
+	return tailMaximum > maximum ? tailMaximum : maximum;
+}
+
+void AccessorConversion::ApplySparseValues(uint8_t* destination, size_t elementSize, const uint32_t* indices, const uint8_t* values, size_t count)
+{
+	switch (elementSize)
+	{
+	case 1:
+		ApplySparseValuesFixed<1>(destination, indices, values, count);
+		break;
+	case 2:
+		ApplySparseValuesFixed<2>(destination, indices, values, count);
+		break;
+	case 4:
+		ApplySparseValuesFixed<4>(destination, indices, values, count);
+		break;
+	case 8:
+		ApplySparseValuesFixed<8>(destination, indices, values, count);
+		break;
+	case 12:
+		ApplySparseValuesFixed<12>(destination, indices, values, count);
+		break;
+	case 16:
+		ApplySparseValuesFixed<16>(destination, indices, values, count);
+		break;
+	default:
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::memcpy(destination + static_cast<size_t>(indices[i]) * elementSize, values + i * elementSize, elementSize);
+		}
+		break;
+	}
+}
+
+SimdLevel AccessorConversion::GetSimdLevel()
+{
+	SimdLevel supported = CpuFeatures::GetSimdLevel();
+	SimdLevel cap = static_cast<SimdLevel>(s_SimdLevelCap.load(std::memory_order_relaxed));
+	return static_cast<uint32_t>(cap) < static_cast<uint32_t>(supported) ? cap : supported;
+}
+
+void AccessorConversion::SetSimdLevel(SimdLevel level)
+{
+	s_SimdLevelCap.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Framework/CpuFeatures.h"
+
+/**
+ * @brief Bulk conversions that normalize glTF index and sparse accessor data at import
+ * The index conversions have a scalar, SSE2 and AVX2 path producing the same output. The path follows
+ * CpuFeatures::GetSimdLevel() unless SetSimdLevel() lowers it, which is how the paths are compared.
+ */
+class AccessorConversion
+{
+public:
+	/**
+	 * @brief uint8 to uint16 indices, core Vulkan has no uint8 index type
+	 */
+	static void WidenIndices8To16(const uint8_t* source, uint16_t* destination, size_t count);
+
+	/**
+	 * @brief uint32 to uint16 indices, false when an index does not fit, destination is undefined then
+	 */
+	static bool NarrowIndices32To16(const uint32_t* source, uint16_t* destination, size_t count);
+
+	/**
+	 * @brief Widens sparse accessor indices of componentSize 1, 2 or 4 bytes to uint32, returns the largest index
+	 * source does not have to be aligned.
+	 */
+	static uint32_t ReadSparseIndices(const uint8_t* source, uint32_t componentSize, uint32_t* destination, size_t count);
+
+	/**
+	 * @brief Writes the count tightly packed elements of values over the elements indices points at
+	 * destination holds tightly packed elements of elementSize bytes, every index has to be in range.
+	 */
+	static void ApplySparseValues(uint8_t* destination, size_t elementSize, const uint32_t* indices, const uint8_t* values, size_t count);
+
+	static SimdLevel GetSimdLevel();
+
+	/**
+	 * @brief Caps the conversion paths at level, the CPU support still applies
+	 */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	AccessorConversion() {};
+	~AccessorConversion() {};
+};
@@ -0,0 +1,515 @@
+#include "AssetCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "Apps/FileSystem.h"
+#include "Framework/Hash.h"
+#include "Framework/JobSystem.h"
+#include "ModelReader/CookedScene.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/Scene.h"
+
+static const uint32_t kManifestMagic = 0x4D414C57; // "WLAM"
+static const uint32_t kManifestVersion = 1;
+static const char* kManifestName = "assets.wlmanifest";
+
+inline std::string NormalizePath(std::string path)
+{
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return path;
+}
+
+inline bool HasExtension(const std::string& path, const char* extension)
+{
+	const size_t length = std::strlen(extension);
+	if (path.size() < length)
+	{
+		return false;
+	}
+
+	return std::equal(path.end() - length, path.end(), extension, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+}
+
+/**
+ * @brief Updates size, write time and, when those changed, the content hash of an input
+ */
+inline void RefreshInput(AssetInput& input, uint32_t& hashedFiles)
+{
+	FileInfo info;
+	if (!FileSystem::GetFileInfo(input.path, info))
+	{
+		input = AssetInput{ input.path };
+		return;
+	}
+
+	if (input.contentHash != 0 && info.size == input.size && info.modifiedTime == input.modifiedTime)
+	{
+		return;
+	}
+
+	input.size = info.size;
+	input.modifiedTime = info.modifiedTime;
+	input.contentHash = CookedScene::HashSource(input.path);
+	hashedFiles++;
+}
+
+template<typename T>
+inline void WriteValue(std::vector<uint8_t>& file, const T& value)
+{
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(&value);
+	file.insert(file.end(), data, data + sizeof(T));
+}
+
+inline void WriteString(std::vector<uint8_t>& file, const std::string& value)
+{
+	WriteValue(file, static_cast<uint32_t>(value.size()));
+	file.insert(file.end(), value.begin(), value.end());
+}
+
+/**
+ * @brief Bounds checked reads from the mapped manifest, every read fails once one ran past the end
+ */
+struct ManifestReader
+{
+	const uint8_t* data;
+	size_t size;
+	size_t offset;
+
+	template<typename T>
+	bool Read(T& value)
+	{
+		if (offset + sizeof(T) > size)
+		{
+			offset = size + 1;
+			return false;
+		}
+
+		std::memcpy(&value, data + offset, sizeof(T));
+		offset += sizeof(T);
+		return true;
+	}
+
+	bool ReadString(std::string& value)
+	{
+		uint32_t length = 0;
+		if (!Read(length) || offset + length > size)
+		{
+			offset = size + 1;
+			return false;
+		}
+
+		value.assign(reinterpret_cast<const char*>(data + offset), length);
+		offset += length;
+		return true;
+	}
+};
+
+AssetCache::AssetCache(const std::string& directory)
+	: m_Directory(NormalizePath(directory))
+{
+}
+
+std::string AssetCache::GetCookedPath(uint64_t key) const
+{
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+	return m_Directory + "/" + name + COOKED_SCENE_EXTENSION;
+}
+
+bool AssetCache::LoadManifest()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Records.clear();
+
+	std::shared_ptr<MappedFile> file;
+	try
+	{
+		file = FileSystem::MapFile(m_Directory + "/" + kManifestName);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+
+	ManifestReader reader{ file->Data(), file->Size(), 0 };
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t recordCount = 0;
+	if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(recordCount) || magic != kManifestMagic || version != kManifestVersion)
+	{
+		return false;
+	}
+
+	std::unordered_map<std::string, AssetRecord> records;
+	for (uint32_t i = 0; i < recordCount; ++i)
+	{
+		std::string sourcePath;
+		AssetRecord record;
+		uint32_t cookable = 0;
+		uint32_t inputCount = 0;
+		if (!reader.ReadString(sourcePath) || !reader.Read(record.key) || !reader.Read(cookable) || !reader.Read(inputCount))
+		{
+			return false;
+		}
+
+		record.cookable = cookable != 0;
+		record.inputs.resize(std::min<size_t>(inputCount, file->Size()));
+		for (AssetInput& input : record.inputs)
+		{
+			if (!reader.ReadString(input.path) || !reader.Read(input.size) || !reader.Read(input.modifiedTime) || !reader.Read(input.contentHash))
+			{
+				return false;
+			}
+		}
+
+		records.emplace(std::move(sourcePath), std::move(record));
+	}
+
+	m_Records = std::move(records);
+	return true;
+}
+
+bool AssetCache::SaveManifest()
+{
+	std::vector<uint8_t> file;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		// Sorted, so an unchanged graph writes an identical manifest
+		std::vector<const std::string*> sources;
+		for (const auto& it : m_Records)
+		{
+			sources.push_back(&it.first);
+		}
+		std::sort(sources.begin(), sources.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
+
+		WriteValue(file, kManifestMagic);
+		WriteValue(file, kManifestVersion);
+		WriteValue(file, static_cast<uint32_t>(sources.size()));
+		for (const std::string* source : sources)
+		{
+			const AssetRecord& record = m_Records.at(*source);
+			WriteString(file, *source);
+			WriteValue(file, record.key);
+			WriteValue(file, static_cast<uint32_t>(record.cookable ? 1 : 0));
+			WriteValue(file, static_cast<uint32_t>(record.inputs.size()));
+			for (const AssetInput& input : record.inputs)
+			{
+				WriteString(file, input.path);
+				WriteValue(file, input.size);
+				WriteValue(file, input.modifiedTime);
+				WriteValue(file, input.contentHash);
+			}
+		}
+	}
+
+	if (!FileSystem::MakeDirectories(m_Directory))
+	{
+		return false;
+	}
+
+	std::ofstream stream(m_Directory + "/" + kManifestName, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+	return stream.good();
+}
+
+uint64_t AssetCache::Refresh(const std::string& sourcePath, AssetRecord& record, uint64_t settingsHash, uint32_t& hashedFiles)
+{
+	if (record.inputs.empty())
+	{
+		record.inputs.push_back(AssetInput{ sourcePath });
+	}
+
+	const uint64_t previousSourceHash = record.inputs[0].contentHash;
+	RefreshInput(record.inputs[0], hashedFiles);
+	if (record.inputs[0].contentHash == 0)
+	{
+		return 0;
+	}
+
+	// Only a changed source can reference other files, the graph edges are kept otherwise
+	if (record.inputs[0].contentHash != previousSourceHash)
+	{
+		std::vector<std::string> references;
+		GltfReader::GetExternalFiles(sourcePath.c_str(), references);
+
+		std::vector<AssetInput> inputs(1, record.inputs[0]);
+		for (const std::string& reference : references)
+		{
+			const std::string path = NormalizePath(reference);
+			auto it = std::find_if(record.inputs.begin() + 1, record.inputs.end(), [&](const AssetInput& input) { return input.path == path; });
+			inputs.push_back(it != record.inputs.end() ? *it : AssetInput{ path });
+		}
+		record.inputs = std::move(inputs);
+	}
+
+	uint64_t key = HashCombine(HashCombine(kImporterVersion, CookedScene::kVersion), settingsHash);
+	for (size_t i = 0; i < record.inputs.size(); ++i)
+	{
+		if (i > 0)
+		{
+			RefreshInput(record.inputs[i], hashedFiles);
+		}
+
+		// A missing reference is part of the key too, the import fails differently once it shows up
+		key = HashCombine(key, record.inputs[i].contentHash);
+	}
+
+	return key != 0 ? key : 1;
+}
+
+bool AssetCache::IsCooked(const AssetRecord& record, uint64_t key) const
+{
+	if (record.key == key && !record.cookable)
+	{
+		return true;
+	}
+
+	// Content addressed, another source with the same inputs may have cooked it already
+	FileInfo info;
+	return FileSystem::GetFileInfo(GetCookedPath(key), info);
+}
+
+AssetCookResult AssetCache::CookAsset(const std::string& sourcePath, AssetRecord& record, uint64_t key, const GltfImportSettings& settings, Scene** keepScene, AssetCookTiming* timing)
+{
+	Scene* scene = nullptr;
+	GltfImportTimings importTimings;
+	try
+	{
+		scene = GltfReader::LoadSource(sourcePath.c_str(), settings, &importTimings);
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Failed to cook " << sourcePath << ": " << e.what() << std::endl;
+	}
+
+	if (timing)
+	{
+		timing->path = sourcePath;
+		timing->parseSeconds = importTimings.parseSeconds;
+		timing->buildSeconds = importTimings.buildSeconds;
+		timing->decodeStatistics = importTimings.decodeStatistics;
+		timing->buildStatistics = importTimings.buildStatistics;
+	}
+
+	if (!scene)
+	{
+		return AssetCookResult::Failed;
+	}
+
+	// Animated scenes have no cooked form. A failed write leaves the record cookable without a file, so the next
+	// Cook or Load tries again; a read only cache only costs the warm starts, the scene itself is fine
+	auto start = std::chrono::high_resolution_clock::now();
+	record.cookable = CookedScene::IsCookable(*scene);
+	record.key = key;
+
+	AssetCookResult result = AssetCookResult::NotCookable;
+	if (record.cookable)
+	{
+		FileSystem::MakeDirectories(m_Directory);
+		result = CookedScene::Write(*scene, key, GetCookedPath(key)) ? AssetCookResult::Cooked : AssetCookResult::Failed;
+		if (result == AssetCookResult::Failed)
+		{
+			std::cout << "Failed to write the cooked scene of " << sourcePath << std::endl;
+		}
+	}
+
+	if (timing)
+	{
+		timing->result = result;
+		timing->writeSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	if (keepScene)
+	{
+		*keepScene = scene;
+	}
+	else
+	{
+		WL_DELETE(scene);
+	}
+
+	return result;
+}
+
+AssetRecord AssetCache::Acquire(const std::string& sourcePath)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_ReleaseSignal.wait(lock, [&] { return m_Acquired.count(sourcePath) == 0; });
+	m_Acquired.insert(sourcePath);
+
+	auto it = m_Records.find(sourcePath);
+	return it != m_Records.end() ? it->second : AssetRecord();
+}
+
+void AssetCache::Release(const std::string& sourcePath, AssetRecord&& record)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Records[sourcePath] = std::move(record);
+		m_Acquired.erase(sourcePath);
+	}
+	m_ReleaseSignal.notify_all();
+}
+
+Scene* AssetCache::Load(const std::string& sourcePath, const GltfImportSettings& settings)
+{
+	const std::string path = NormalizePath(sourcePath);
+	AssetRecord record = Acquire(path);
+
+	uint32_t hashedFiles = 0;
+	const uint64_t key = Refresh(path, record, settings.Hash(), hashedFiles);
+
+	Scene* scene = nullptr;
+	if (key != 0 && record.cookable && IsCooked(record, key))
+	{
+		scene = CookedScene::Load(GetCookedPath(key), key);
+	}
+
+	if (!scene && key != 0)
+	{
+		CookAsset(path, record, key, settings, &scene);
+	}
+
+	Release(path, std::move(record));
+	return scene;
+}
+
+AssetCookStatistics AssetCache::Cook(const std::string& sourceDirectory, const GltfImportSettings& settings)
+{
+	AssetCookStatistics statistics;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::string> sources;
+	for (const std::string& path : FileSystem::ListFiles(sourceDirectory))
+	{
+		if (HasExtension(path, ".gltf") || HasExtension(path, ".glb"))
+		{
+			sources.push_back(NormalizePath(path));
+		}
+	}
+	statistics.assetCount = static_cast<uint32_t>(sources.size());
+
+	// Scan: stat every input, hash the changed ones and compare keys
+	const uint64_t settingsHash = settings.Hash();
+	std::vector<uint8_t> dirty(sources.size(), 0);
+	std::atomic<uint32_t> hashedFiles{ 0 };
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(sources.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				AssetRecord record = Acquire(sources[i]);
+				uint32_t hashed = 0;
+				const uint64_t key = Refresh(sources[i], record, settingsHash, hashed);
+				dirty[i] = key != 0 && !IsCooked(record, key);
+				hashedFiles += hashed;
+				Release(sources[i], std::move(record));
+			}
+		});
+
+	std::vector<uint32_t> dirtySources;
+	for (uint32_t i = 0; i < sources.size(); ++i)
+	{
+		if (dirty[i])
+		{
+			dirtySources.push_back(i);
+		}
+	}
+	statistics.dirtyCount = static_cast<uint32_t>(dirtySources.size());
+	statistics.scanSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	// Cook: the dirty assets only, again under their record in case a Load got to one in the meantime
+	start = std::chrono::high_resolution_clock::now();
+	std::atomic<uint32_t> cookedCount{ 0 };
+	std::atomic<uint32_t> notCookableCount{ 0 };
+	std::atomic<uint32_t> failedCount{ 0 };
+	statistics.timings.resize(dirtySources.size());
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(dirtySources.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const std::string& source = sources[dirtySources[i]];
+				AssetRecord record = Acquire(source);
+				uint32_t hashed = 0;
+				const uint64_t key = Refresh(source, record, settingsHash, hashed);
+				if (key != 0 && !IsCooked(record, key))
+				{
+					switch (CookAsset(source, record, key, settings, nullptr, &statistics.timings[i]))
+					{
+					case AssetCookResult::Cooked:
+						cookedCount++;
+						break;
+					case AssetCookResult::NotCookable:
+						notCookableCount++;
+						break;
+					case AssetCookResult::Failed:
+						failedCount++;
+						break;
+					}
+				}
+				hashedFiles += hashed;
+				Release(source, std::move(record));
+			}
+		});
+	// Dirty assets another thread cooked in the meantime left no timing
+	statistics.timings.erase(std::remove_if(statistics.timings.begin(), statistics.timings.end(), [](const AssetCookTiming& timing) { return timing.path.empty(); }), statistics.timings.end());
+	statistics.cookedCount = cookedCount;
+	statistics.notCookableCount = notCookableCount;
+	statistics.failedCount = failedCount;
+	statistics.hashedFiles = hashedFiles;
+
+	// Forget deleted sources, then every cooked scene no key refers to. A Load holding a record may be writing a
+	// cooked scene under a key the graph does not know yet, so the files are only collected while no record is held,
+	// and under the lock so no Load starts meanwhile; a skipped collection happens in the next Cook
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		std::unordered_set<std::string> usedFiles;
+		for (auto it = m_Records.begin(); it != m_Records.end();)
+		{
+			FileInfo info;
+			if (m_Acquired.count(it->first) == 0 && !FileSystem::GetFileInfo(it->first, info))
+			{
+				it = m_Records.erase(it);
+				continue;
+			}
+
+			usedFiles.insert(GetCookedPath(it->second.key));
+			++it;
+		}
+
+		if (m_Acquired.empty())
+		{
+			for (const std::string& path : FileSystem::ListFiles(m_Directory))
+			{
+				if (HasExtension(path, COOKED_SCENE_EXTENSION) && usedFiles.count(NormalizePath(path)) == 0)
+				{
+					FileSystem::RemoveFile(path);
+				}
+			}
+		}
+	}
+
+	SaveManifest();
+	statistics.cookSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	if (settings.logStatistics)
+	{
+		std::cout << "Asset cook: " << statistics.dirtyCount << "/" << statistics.assetCount << " dirty, " << statistics.cookedCount << " cooked, "
+			<< statistics.notCookableCount << " not cookable, " << statistics.failedCount << " failed, " << statistics.hashedFiles << " files hashed, scan " << statistics.scanSeconds * 1000.0
+			<< " ms, cook " << statistics.cookSeconds * 1000.0 << " ms" << std::endl;
+	}
+
+	return statistics;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ModelReader/GltfReader.h"
+#include "ModelReader/ImportSettings.h"
+
+class Scene;
+
+/**
+ * @brief One file an asset is built from, with what the cache last saw of it
+ */
+struct AssetInput
+{
+	std::string path;
+	uint64_t size{ 0 };
+	int64_t modifiedTime{ 0 };
+	/// 0 when the file is missing
+	uint64_t contentHash{ 0 };
+};
+
+/**
+ * @brief Dependency graph node of one source asset
+ * inputs[0] is the source itself, followed by the buffer and image files it references.
+ */
+struct AssetRecord
+{
+	std::vector<AssetInput> inputs;
+	/// Key of the inputs, versions and settings of the last cook, 0 before the first one
+	uint64_t key{ 0 };
+	/// False when the last cook wrote no cooked scene, scenes with animations or deformers have none and always
+	/// import from the source until an input changes
+	bool cookable{ true };
+};
+
+enum class AssetCookResult
+{
+	/// The cooked scene was written
+	Cooked,
+	/// The source imports but has no cooked form (animations, skins or morph targets), nothing was written
+	NotCookable,
+	/// The import or the write failed
+	Failed
+};
+
+/**
+ * @brief Stage times and import statistics of one asset a Cook call imported
+ */
+struct AssetCookTiming
+{
+	std::string path;
+	AssetCookResult result{ AssetCookResult::Failed };
+	double parseSeconds{ 0.0 };
+	double buildSeconds{ 0.0 };
+	double writeSeconds{ 0.0 };
+	GltfDecodeStatistics decodeStatistics;
+	GltfBuildStatistics buildStatistics;
+};
+
+struct AssetCookStatistics
+{
+	uint32_t assetCount{ 0 };
+	/// Assets whose key changed or whose cooked scene is missing
+	uint32_t dirtyCount{ 0 };
+	uint32_t cookedCount{ 0 };
+	/// Dirty assets that imported but have no cooked form, counted apart since no file was written for them
+	uint32_t notCookableCount{ 0 };
+	uint32_t failedCount{ 0 };
+	/// Inputs whose size or write time changed, the only files read to find the dirty assets
+	uint32_t hashedFiles{ 0 };
+	double scanSeconds{ 0.0 };
+	double cookSeconds{ 0.0 };
+	/// One entry per dirty asset, in source path order
+	std::vector<AssetCookTiming> timings;
+};
+
+/**
+ * @brief Content addressed store of cooked scenes with incremental re-cooking
+ * A cooked scene is named after its key, a hash of the content of every input, the importer and cooked format
+ * versions and the import settings, so identical assets share one file and a changed input never reads a stale
+ * one. The manifest remembers the inputs of every asset with their size and write time; an input is only hashed
+ * again when those change, and the references of a source are only parsed again when the source changes.
+ * Cook and Load can run from several threads, a thread working on an asset makes the others wait for it.
+ */
+class AssetCache
+{
+public:
+	/// Bump when GltfReader builds different scenes from the same input
+	static const uint32_t kImporterVersion = 1;
+
+	AssetCache(const std::string& directory);
+
+	inline const std::string& GetDirectory() const { return m_Directory; }
+
+	/**
+	 * @brief Reads the manifest of the cache directory, false (and an empty graph) when there is none or it is outdated
+	 */
+	bool LoadManifest();
+	bool SaveManifest();
+
+	/**
+	 * @brief Cooks every .gltf and .glb file below a directory whose inputs changed, on the job pool
+	 * Cooked scenes no asset refers to anymore are deleted, unless a Load is running, and the manifest is saved afterwards.
+	 */
+	AssetCookStatistics Cook(const std::string& sourceDirectory, const GltfImportSettings& settings);
+
+	/**
+	 * @brief Loads a source through the cache, cooking it first when it is dirty
+	 */
+	Scene* Load(const std::string& sourcePath, const GltfImportSettings& settings);
+
+	std::string GetCookedPath(uint64_t key) const;
+
+private:
+	/**
+	 * @brief Brings the inputs of a record up to date and returns its current key, 0 when the source is missing
+	 */
+	static uint64_t Refresh(const std::string& sourcePath, AssetRecord& record, uint64_t settingsHash, uint32_t& hashedFiles);
+
+	/**
+	 * @brief Imports the source and writes its cooked scene, the scene is returned when keepScene is set
+	 */
+	AssetCookResult CookAsset(const std::string& sourcePath, AssetRecord& record, uint64_t key, const GltfImportSettings& settings, Scene** keepScene, AssetCookTiming* timing = nullptr);
+
+	bool IsCooked(const AssetRecord& record, uint64_t key) const;
+
+	/**
+	 * @brief Takes the record of a source out of the graph until Release, waiting while another thread holds it
+	 */
+	AssetRecord Acquire(const std::string& sourcePath);
+	void Release(const std::string& sourcePath, AssetRecord&& record);
+
+	std::string m_Directory;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_ReleaseSignal;
+	std::unordered_map<std::string, AssetRecord> m_Records;
+	std::unordered_set<std::string> m_Acquired;
+};
@@ -0,0 +1,721 @@
+
+#include "CookedScene.h"
+
+#include "Apps/FileSystem.h"
+#include "Framework/Hash.h"
+#include "Scene/Scene.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Transform.h"
+#include "Scene/Camera.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Mesh.h"
+#include "Render/Material.h"
+#include "Render/MaterialTable.h"
+#include "Animation/MeshDeformer.h"
+
+#include <unordered_map>
+#include <cstring>
+
+static const uint32_t kCookedSceneMagic = 0x53434C57; // "WLCS"
+static const size_t kCookedAlignment = 16;
+static const uint32_t kMeshletStreamCount = 4;
+
+struct CookedString
+{
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct CookedHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceHash;
+	uint64_t fileSize;
+
+	uint32_t nodeCount;
+	uint32_t meshCount;
+	uint32_t subMeshCount;
+	uint32_t streamCount;
+	uint32_t materialCount;
+	uint32_t lodCount;
+	int32_t rootNode;
+
+	uint64_t nodeOffset;
+	uint64_t meshOffset;
+	uint64_t subMeshOffset;
+	uint64_t lodOffset;
+	uint64_t streamOffset;
+	uint64_t materialOffset;
+	uint64_t stringOffset;
+	uint64_t stringSize;
+	uint64_t dataOffset;
+	uint64_t dataSize;
+};
+
+struct CookedNode
+{
+	CookedString name;
+	int32_t parent;
+	int32_t mesh;
+	float translation[3];
+	float rotation[4];
+	float scale[3];
+	uint32_t hasCamera;
+	/// aspect ratio, field of view, near plane, far plane
+	float camera[4];
+};
+
+struct CookedMesh
+{
+	uint32_t firstSubMesh;
+	uint32_t subMeshCount;
+};
+
+struct CookedSubMesh
+{
+	uint32_t vertexCount;
+	uint32_t indexCount;
+	uint32_t indexType;
+	int32_t material;
+	uint32_t firstStream;
+	uint32_t streamCount;
+	/// Index into the stream table, -1 for non indexed submeshes
+	int32_t indexStream;
+	/// First of kMeshletStreamCount streams in MeshletData member order, -1 without meshlets
+	int32_t meshletStream;
+	uint32_t firstLod;
+	uint32_t lodCount;
+	uint32_t octahedralMask;
+	uint32_t padding;
+};
+
+struct CookedLod
+{
+	uint32_t indexStream;
+	uint32_t indexCount;
+	float error;
+	uint32_t padding;
+};
+
+struct CookedStream
+{
+	CookedString name;
+	uint32_t format;
+	uint32_t stride;
+	uint32_t count;
+	uint32_t padding;
+	/// Relative to CookedHeader::dataOffset
+	uint64_t dataOffset;
+};
+
+struct CookedMaterial
+{
+	float baseColorFactor[4];
+	float emissive[3];
+	float metallicFactor;
+	float roughnessFactor;
+	float alphaCutoff;
+	uint32_t alphaMode;
+	uint32_t doubleSided;
+};
+
+/**
+ * @brief Bytes per index of a VkIndexType, 0 for the types the importer never writes
+ */
+inline uint32_t GetIndexSize(uint32_t indexType)
+{
+	switch (indexType)
+	{
+	case VK_INDEX_TYPE_UINT16: return sizeof(uint16_t);
+	case VK_INDEX_TYPE_UINT32: return sizeof(uint32_t);
+	default: return 0;
+	}
+}
+
+template<typename T>
+inline void AppendTable(std::vector<uint8_t>& file, const std::vector<T>& table, uint64_t& offset)
+{
+	file.resize((file.size() + kCookedAlignment - 1) & ~(kCookedAlignment - 1));
+	offset = file.size();
+
+	const uint8_t* data = reinterpret_cast<const uint8_t*>(table.data());
+	file.insert(file.end(), data, data + table.size() * sizeof(T));
+}
+
+inline CookedString AppendString(std::vector<char>& strings, const std::string& value)
+{
+	CookedString cooked{ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size()) };
+	strings.insert(strings.end(), value.begin(), value.end());
+	return cooked;
+}
+
+inline CookedStream AppendStream(std::vector<uint8_t>& data, std::vector<char>& strings, const std::string& name, const AccessorView& view)
+{
+	data.resize((data.size() + kCookedAlignment - 1) & ~(kCookedAlignment - 1));
+
+	CookedStream stream{};
+	stream.name = AppendString(strings, name);
+	stream.format = view.format;
+	stream.stride = GetFormatSize(view.format);
+	stream.count = view.count;
+	stream.dataOffset = data.size();
+
+	std::vector<uint8_t> packed = view.CopyPacked();
+	data.insert(data.end(), packed.begin(), packed.end());
+
+	return stream;
+}
+
+uint64_t CookedScene::HashSource(const std::string& sourcePath)
+{
+	std::shared_ptr<MappedFile> file;
+	try
+	{
+		file = FileSystem::MapFile(sourcePath);
+	}
+	catch (const std::runtime_error&)
+	{
+		return 0;
+	}
+
+	return HashBytes(file->Data(), file->Size(), kVersion);
+}
+
+bool CookedScene::IsCookable(const Scene& scene)
+{
+	if (!scene.GetAnimations().empty() || !scene.GetCompressedAnimations().empty())
+	{
+		return false;
+	}
+
+	for (GameObjectHandle handle : scene.GetNodes())
+	{
+		GameObject* node = GameObject::Get(handle);
+		if (node && node->GetComponent<MeshDeformer>())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool CookedScene::Write(const Scene& scene, uint64_t sourceHash, const std::string& path)
+{
+	// Those scenes always load from the source
+	if (!IsCookable(scene))
+	{
+		return false;
+	}
+
+	// Nodes destroyed since the load are not written
+	std::vector<GameObject*> gameObjects;
+	for (GameObjectHandle handle : scene.GetNodes())
+	{
+		if (GameObject* node = GameObject::Get(handle))
+		{
+			gameObjects.push_back(node);
+		}
+	}
+
+	std::vector<CookedNode> nodes;
+	std::vector<CookedMesh> meshes;
+	std::vector<CookedSubMesh> subMeshes;
+	std::vector<CookedLod> lods;
+	std::vector<CookedStream> streams;
+	std::vector<CookedMaterial> materials;
+	std::vector<char> strings;
+	std::vector<uint8_t> data;
+
+	std::unordered_map<const Transform*, int32_t> transformIndices;
+	std::unordered_map<const Mesh*, int32_t> meshIndices;
+	std::unordered_map<uint32_t, int32_t> materialIndices;
+
+	for (size_t i = 0; i < gameObjects.size(); ++i)
+	{
+		if (Transform* transform = gameObjects[i]->GetComponent<Transform>())
+		{
+			transformIndices[transform] = static_cast<int32_t>(i);
+		}
+	}
+
+	int32_t rootNode = -1;
+	for (size_t i = 0; i < gameObjects.size(); ++i)
+	{
+		GameObject* go = gameObjects[i];
+		if (go->GetHandle() == scene.GetRootNodeHandle())
+		{
+			rootNode = static_cast<int32_t>(i);
+		}
+
+		CookedNode node{};
+		node.name = AppendString(strings, go->GetName());
+		node.parent = -1;
+		node.mesh = -1;
+		node.scale[0] = node.scale[1] = node.scale[2] = 1.0f;
+		node.rotation[3] = 1.0f;
+
+		if (Transform* transform = go->GetComponent<Transform>())
+		{
+			const glm::vec3& translation = transform->GetTranslation();
+			const glm::quat& rotation = transform->GetRotation();
+			const glm::vec3& scale = transform->GetScale();
+			for (int c = 0; c < 3; ++c)
+			{
+				node.translation[c] = translation[c];
+				node.scale[c] = scale[c];
+			}
+			node.rotation[0] = rotation.x;
+			node.rotation[1] = rotation.y;
+			node.rotation[2] = rotation.z;
+			node.rotation[3] = rotation.w;
+
+			auto parent = transformIndices.find(transform->GetParent());
+			if (parent != transformIndices.end())
+			{
+				node.parent = parent->second;
+			}
+		}
+
+		if (Camera* camera = go->GetComponent<Camera>())
+		{
+			node.hasCamera = 1;
+			node.camera[0] = camera->GetAspectRatio();
+			node.camera[1] = camera->GetFieldOfView();
+			node.camera[2] = camera->GetNearPlane();
+			node.camera[3] = camera->GetFarPlane();
+		}
+
+		MeshRenderer* meshRenderer = go->GetComponent<MeshRenderer>();
+		Mesh* mesh = meshRenderer ? meshRenderer->GetMesh() : nullptr;
+		if (mesh)
+		{
+			auto it = meshIndices.find(mesh);
+			if (it == meshIndices.end())
+			{
+				CookedMesh cookedMesh{ static_cast<uint32_t>(subMeshes.size()), static_cast<uint32_t>(mesh->GetSubmeshes().size()) };
+				for (const SubMesh& subMesh : mesh->GetSubmeshes())
+				{
+					CookedSubMesh cookedSubMesh{};
+					cookedSubMesh.vertexCount = subMesh.vertexCount;
+					cookedSubMesh.indexCount = subMesh.vertexIndices;
+					cookedSubMesh.indexType = subMesh.indexType;
+					cookedSubMesh.material = -1;
+					cookedSubMesh.indexStream = -1;
+					cookedSubMesh.meshletStream = -1;
+					cookedSubMesh.octahedralMask = subMesh.octahedralMask;
+
+					if (subMesh.material.IsValid())
+					{
+						auto material = materialIndices.find(subMesh.material.id);
+						if (material == materialIndices.end())
+						{
+							const Material& sourceMaterial = MaterialTable::GetInstance().Get(subMesh.material);
+
+							CookedMaterial cookedMaterial{};
+							for (int c = 0; c < 4; ++c)
+							{
+								cookedMaterial.baseColorFactor[c] = sourceMaterial.baseColorFactor[c];
+							}
+							for (int c = 0; c < 3; ++c)
+							{
+								cookedMaterial.emissive[c] = sourceMaterial.emissive[c];
+							}
+							cookedMaterial.metallicFactor = sourceMaterial.metallicFactor;
+							cookedMaterial.roughnessFactor = sourceMaterial.roughnessFactor;
+							cookedMaterial.alphaCutoff = sourceMaterial.alphaCutoff;
+							cookedMaterial.alphaMode = static_cast<uint32_t>(sourceMaterial.alphaMode);
+							cookedMaterial.doubleSided = sourceMaterial.doubleSided ? 1 : 0;
+
+							material = materialIndices.emplace(subMesh.material.id, static_cast<int32_t>(materials.size())).first;
+							materials.push_back(cookedMaterial);
+						}
+						cookedSubMesh.material = material->second;
+					}
+
+					cookedSubMesh.firstStream = static_cast<uint32_t>(streams.size());
+					for (auto& vertexBuffer : subMesh.vertexBuffers)
+					{
+						streams.push_back(AppendStream(data, strings, vertexBuffer.first, vertexBuffer.second));
+					}
+					cookedSubMesh.streamCount = static_cast<uint32_t>(streams.size()) - cookedSubMesh.firstStream;
+
+					if (subMesh.indexBuffer.IsValid())
+					{
+						cookedSubMesh.indexStream = static_cast<int32_t>(streams.size());
+						streams.push_back(AppendStream(data, strings, std::string(), subMesh.indexBuffer));
+					}
+
+					if (subMesh.meshlets.GetCount() > 0)
+					{
+						cookedSubMesh.meshletStream = static_cast<int32_t>(streams.size());
+						streams.push_back(AppendStream(data, strings, std::string(), subMesh.meshlets.meshlets));
+						streams.push_back(AppendStream(data, strings, std::string(), subMesh.meshlets.vertices));
+						streams.push_back(AppendStream(data, strings, std::string(), subMesh.meshlets.triangles));
+						streams.push_back(AppendStream(data, strings, std::string(), subMesh.meshlets.bounds));
+					}
+
+					cookedSubMesh.firstLod = static_cast<uint32_t>(lods.size());
+					for (const SubMeshLod& lod : subMesh.lods)
+					{
+						lods.push_back({ static_cast<uint32_t>(streams.size()), lod.indexCount, lod.error, 0 });
+						streams.push_back(AppendStream(data, strings, std::string(), lod.indexBuffer));
+					}
+					cookedSubMesh.lodCount = static_cast<uint32_t>(subMesh.lods.size());
+
+					subMeshes.push_back(cookedSubMesh);
+				}
+
+				it = meshIndices.emplace(mesh, static_cast<int32_t>(meshes.size())).first;
+				meshes.push_back(cookedMesh);
+			}
+			node.mesh = it->second;
+		}
+
+		nodes.push_back(node);
+	}
+
+	CookedHeader header{};
+	header.magic = kCookedSceneMagic;
+	header.version = kVersion;
+	header.sourceHash = sourceHash;
+	header.nodeCount = static_cast<uint32_t>(nodes.size());
+	header.meshCount = static_cast<uint32_t>(meshes.size());
+	header.subMeshCount = static_cast<uint32_t>(subMeshes.size());
+	header.streamCount = static_cast<uint32_t>(streams.size());
+	header.materialCount = static_cast<uint32_t>(materials.size());
+	header.lodCount = static_cast<uint32_t>(lods.size());
+	header.rootNode = rootNode;
+
+	std::vector<uint8_t> file(sizeof(CookedHeader));
+	AppendTable(file, nodes, header.nodeOffset);
+	AppendTable(file, meshes, header.meshOffset);
+	AppendTable(file, subMeshes, header.subMeshOffset);
+	AppendTable(file, lods, header.lodOffset);
+	AppendTable(file, streams, header.streamOffset);
+	AppendTable(file, materials, header.materialOffset);
+	AppendTable(file, strings, header.stringOffset);
+	AppendTable(file, data, header.dataOffset);
+	header.stringSize = strings.size();
+	header.dataSize = data.size();
+	header.fileSize = file.size();
+	std::memcpy(file.data(), &header, sizeof(header));
+
+	// Scenes loaded from the previous version may still map it, it is replaced and never truncated
+	return FileSystem::WriteFile(path, file.data(), file.size());
+}
+
+Scene* CookedScene::Load(const std::string& path, uint64_t sourceHash)
+{
+	std::shared_ptr<MappedFile> file;
+	try
+	{
+		file = FileSystem::MapFile(path);
+	}
+	catch (const std::runtime_error&)
+	{
+		return nullptr;
+	}
+
+	if (file->Size() < sizeof(CookedHeader))
+	{
+		return nullptr;
+	}
+
+	CookedHeader header;
+	std::memcpy(&header, file->Data(), sizeof(header));
+	if (header.magic != kCookedSceneMagic || header.version != kVersion || header.sourceHash != sourceHash || header.fileSize != file->Size())
+	{
+		return nullptr;
+	}
+
+	// Tables and streams are aligned by Write, the tables are read in place
+	auto inRange = [](uint64_t offset, uint64_t size, uint64_t rangeSize)
+	{
+		return (offset & (kCookedAlignment - 1)) == 0 && offset <= rangeSize && size <= rangeSize - offset;
+	};
+	if (!inRange(header.nodeOffset, uint64_t(header.nodeCount) * sizeof(CookedNode), header.fileSize) ||
+		!inRange(header.meshOffset, uint64_t(header.meshCount) * sizeof(CookedMesh), header.fileSize) ||
+		!inRange(header.subMeshOffset, uint64_t(header.subMeshCount) * sizeof(CookedSubMesh), header.fileSize) ||
+		!inRange(header.lodOffset, uint64_t(header.lodCount) * sizeof(CookedLod), header.fileSize) ||
+		!inRange(header.streamOffset, uint64_t(header.streamCount) * sizeof(CookedStream), header.fileSize) ||
+		!inRange(header.materialOffset, uint64_t(header.materialCount) * sizeof(CookedMaterial), header.fileSize) ||
+		!inRange(header.stringOffset, header.stringSize, header.fileSize) ||
+		!inRange(header.dataOffset, header.dataSize, header.fileSize))
+	{
+		return nullptr;
+	}
+
+	const uint8_t* base = file->Data();
+	const CookedMesh* meshes = reinterpret_cast<const CookedMesh*>(base + header.meshOffset);
+	const CookedSubMesh* subMeshes = reinterpret_cast<const CookedSubMesh*>(base + header.subMeshOffset);
+	const CookedLod* lods = reinterpret_cast<const CookedLod*>(base + header.lodOffset);
+	const CookedStream* streams = reinterpret_cast<const CookedStream*>(base + header.streamOffset);
+
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		if (uint64_t(meshes[i].firstSubMesh) + meshes[i].subMeshCount > header.subMeshCount)
+		{
+			return nullptr;
+		}
+	}
+
+	for (uint32_t i = 0; i < header.subMeshCount; ++i)
+	{
+		if (uint64_t(subMeshes[i].firstStream) + subMeshes[i].streamCount > header.streamCount ||
+			subMeshes[i].indexStream >= static_cast<int32_t>(header.streamCount) ||
+			uint64_t(subMeshes[i].firstLod) + subMeshes[i].lodCount > header.lodCount ||
+			(subMeshes[i].meshletStream >= 0 && (uint64_t(subMeshes[i].meshletStream) + kMeshletStreamCount > header.streamCount ||
+				uint64_t(streams[subMeshes[i].meshletStream + 3].count) != uint64_t(streams[subMeshes[i].meshletStream].count) * static_cast<uint32_t>(MeshletBoundsArray::Count))) ||
+			subMeshes[i].material >= static_cast<int32_t>(header.materialCount))
+		{
+			return nullptr;
+		}
+	}
+
+	for (uint32_t i = 0; i < header.lodCount; ++i)
+	{
+		if (lods[i].indexStream >= header.streamCount || lods[i].indexCount > streams[lods[i].indexStream].count)
+		{
+			return nullptr;
+		}
+	}
+
+	// The counts are what the renderer draws and the index type is what it binds, they have to fit the streams
+	for (uint32_t i = 0; i < header.subMeshCount; ++i)
+	{
+		const CookedSubMesh& subMesh = subMeshes[i];
+		const uint32_t indexSize = GetIndexSize(subMesh.indexType);
+		if (indexSize == 0)
+		{
+			return nullptr;
+		}
+
+		if (subMesh.indexStream >= 0 && (subMesh.indexCount > streams[subMesh.indexStream].count ||
+			GetFormatSize(static_cast<VkFormat>(streams[subMesh.indexStream].format)) != indexSize))
+		{
+			return nullptr;
+		}
+
+		for (uint32_t v = 0; v < subMesh.streamCount; ++v)
+		{
+			if (subMesh.vertexCount > streams[subMesh.firstStream + v].count)
+			{
+				return nullptr;
+			}
+		}
+
+		for (uint32_t l = 0; l < subMesh.lodCount; ++l)
+		{
+			if (GetFormatSize(static_cast<VkFormat>(streams[lods[subMesh.firstLod + l].indexStream].format)) != indexSize)
+			{
+				return nullptr;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < header.streamCount; ++i)
+	{
+		// Readers take the element size from the format, a smaller stride would let them read past the stream
+		if (streams[i].format == VK_FORMAT_UNDEFINED || streams[i].stride != GetFormatSize(static_cast<VkFormat>(streams[i].format)) ||
+			!inRange(streams[i].dataOffset, uint64_t(streams[i].count) * streams[i].stride, header.dataSize) ||
+			uint64_t(streams[i].name.offset) + streams[i].name.length > header.stringSize)
+		{
+			return nullptr;
+		}
+	}
+
+	const CookedNode* nodes = reinterpret_cast<const CookedNode*>(base + header.nodeOffset);
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		if (nodes[i].mesh >= static_cast<int32_t>(header.meshCount) ||
+			nodes[i].parent >= static_cast<int32_t>(header.nodeCount) ||
+			uint64_t(nodes[i].name.offset) + nodes[i].name.length > header.stringSize)
+		{
+			return nullptr;
+		}
+	}
+
+	if (header.rootNode >= static_cast<int32_t>(header.nodeCount))
+	{
+		return nullptr;
+	}
+
+	// A parent cycle would never finish a hierarchy walk: follow every parent chain until it reaches a root or a node
+	// already known to reach one, a node seen twice on the same walk is a cycle
+	std::vector<uint32_t> reachesRoot(header.nodeCount, 0);
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		const uint32_t walk = i + 2;
+		int32_t node = static_cast<int32_t>(i);
+		while (node >= 0 && reachesRoot[node] != 1)
+		{
+			if (reachesRoot[node] == walk)
+			{
+				return nullptr;
+			}
+			reachesRoot[node] = walk;
+			node = nodes[node].parent;
+		}
+
+		for (node = static_cast<int32_t>(i); node >= 0 && reachesRoot[node] == walk; node = nodes[node].parent)
+		{
+			reachesRoot[node] = 1;
+		}
+	}
+
+	const CookedMaterial* materials = reinterpret_cast<const CookedMaterial*>(base + header.materialOffset);
+	const char* strings = reinterpret_cast<const char*>(base + header.stringOffset);
+
+	auto getString = [&](const CookedString& string) { return std::string(strings + string.offset, string.length); };
+
+	// Streams point into the mapping, the mapping is their owner and lives as long as any of them
+	auto getStream = [&](const CookedStream& stream)
+	{
+		AccessorView view;
+		view.owner = file;
+		view.buffer = base;
+		view.offset = header.dataOffset + stream.dataOffset;
+		view.stride = stream.stride;
+		view.count = stream.count;
+		view.format = static_cast<VkFormat>(stream.format);
+		return view;
+	};
+
+	// Materials go through the shared table, so cooked and imported scenes reuse the same instances
+	std::vector<MaterialHandle> sceneMaterials(header.materialCount);
+	for (uint32_t i = 0; i < header.materialCount; ++i)
+	{
+		const CookedMaterial& cookedMaterial = materials[i];
+
+		Material material("");
+		material.baseColorFactor = glm::vec4(cookedMaterial.baseColorFactor[0], cookedMaterial.baseColorFactor[1], cookedMaterial.baseColorFactor[2], cookedMaterial.baseColorFactor[3]);
+		material.emissive = glm::vec3(cookedMaterial.emissive[0], cookedMaterial.emissive[1], cookedMaterial.emissive[2]);
+		material.metallicFactor = cookedMaterial.metallicFactor;
+		material.roughnessFactor = cookedMaterial.roughnessFactor;
+		material.alphaCutoff = cookedMaterial.alphaCutoff;
+		material.alphaMode = static_cast<AlphaMode>(cookedMaterial.alphaMode);
+		material.doubleSided = cookedMaterial.doubleSided != 0;
+		sceneMaterials[i] = MaterialTable::GetInstance().Add(std::move(material));
+	}
+
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	std::vector<MeshHandle> sceneMeshes(header.meshCount);
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		Mesh mesh;
+		for (uint32_t s = 0; s < meshes[i].subMeshCount; ++s)
+		{
+			const CookedSubMesh& cookedSubMesh = subMeshes[meshes[i].firstSubMesh + s];
+
+			SubMesh subMesh;
+			subMesh.vertexCount = cookedSubMesh.vertexCount;
+			subMesh.vertexIndices = cookedSubMesh.indexCount;
+			subMesh.indexType = static_cast<VkIndexType>(cookedSubMesh.indexType);
+			subMesh.material = cookedSubMesh.material >= 0 ? sceneMaterials[cookedSubMesh.material] : MaterialHandle();
+			subMesh.octahedralMask = cookedSubMesh.octahedralMask;
+
+			for (uint32_t v = 0; v < cookedSubMesh.streamCount; ++v)
+			{
+				const CookedStream& stream = streams[cookedSubMesh.firstStream + v];
+				std::string name = getString(stream.name);
+
+				VertexAttribute attribute;
+				attribute.format = static_cast<VkFormat>(stream.format);
+				attribute.stride = stream.stride;
+				subMesh.SetAttribute(name, attribute);
+
+				subMesh.vertexBuffers.insert(std::make_pair(name, getStream(stream)));
+			}
+
+			if (cookedSubMesh.indexStream >= 0)
+			{
+				subMesh.indexBuffer = getStream(streams[cookedSubMesh.indexStream]);
+			}
+
+			if (cookedSubMesh.meshletStream >= 0)
+			{
+				subMesh.meshlets.meshlets = getStream(streams[cookedSubMesh.meshletStream + 0]);
+				subMesh.meshlets.vertices = getStream(streams[cookedSubMesh.meshletStream + 1]);
+				subMesh.meshlets.triangles = getStream(streams[cookedSubMesh.meshletStream + 2]);
+				subMesh.meshlets.bounds = getStream(streams[cookedSubMesh.meshletStream + 3]);
+			}
+
+			for (uint32_t l = 0; l < cookedSubMesh.lodCount; ++l)
+			{
+				const CookedLod& cookedLod = lods[cookedSubMesh.firstLod + l];
+
+				SubMeshLod lod;
+				lod.indexBuffer = getStream(streams[cookedLod.indexStream]);
+				lod.indexCount = cookedLod.indexCount;
+				lod.error = cookedLod.error;
+				subMesh.lods.push_back(std::move(lod));
+			}
+
+			subMesh.layout = VertexLayoutBuilder::Build(subMesh);
+
+			mesh.AddSubmesh(std::move(subMesh));
+		}
+		sceneMeshes[i] = registry.Create(std::move(mesh));
+	}
+
+	std::vector<GameObject*> gameObjects(header.nodeCount);
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		const CookedNode& node = nodes[i];
+
+		GameObject* go = CreateGameObject(getString(node.name));
+		Transform* transform = go->AddComponent<Transform>();
+		transform->SetTranslation(glm::vec3(node.translation[0], node.translation[1], node.translation[2]));
+		transform->SetRotation(glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]));
+		transform->SetScale(glm::vec3(node.scale[0], node.scale[1], node.scale[2]));
+
+		if (node.mesh >= 0)
+		{
+			MeshRenderer* meshRenderer = go->AddComponent<MeshRenderer>();
+			meshRenderer->SetMesh(sceneMeshes[node.mesh]);
+		}
+
+		if (node.hasCamera)
+		{
+			Camera* camera = go->AddComponent<Camera>();
+			camera->SetAspectRatio(node.camera[0]);
+			camera->SetFieldOfView(node.camera[1]);
+			camera->SetNearPlane(node.camera[2]);
+			camera->SetFarPlane(node.camera[3]);
+		}
+
+		gameObjects[i] = go;
+	}
+
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		if (nodes[i].parent >= 0)
+		{
+			gameObjects[i]->GetComponent<Transform>()->SetParent(gameObjects[nodes[i].parent]->GetComponent<Transform>());
+		}
+	}
+
+	Scene* scene = WL_NEW(Scene);
+	if (header.rootNode >= 0)
+	{
+		scene->SetRootNode(gameObjects[header.rootNode]->GetHandle());
+	}
+
+	std::vector<GameObjectHandle> nodeHandles;
+	nodeHandles.reserve(gameObjects.size());
+	for (GameObject* go : gameObjects)
+	{
+		nodeHandles.push_back(go->GetHandle());
+	}
+	scene->SetNodes(std::move(nodeHandles));
+
+	for (MeshHandle mesh : sceneMeshes)
+	{
+		scene->AddMesh(mesh);
+	}
+
+	return scene;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+class Scene;
+
+#define COOKED_SCENE_EXTENSION ".wlscene"
+
+/**
+ * @brief Binary, mmap-able copy of a scene built by GltfReader
+ * The file starts with a versioned header that carries the key of the source (the content hash of the source
+ * file and of every buffer and image it references), followed by fixed size node/mesh/submesh/lod/stream/material
+ * tables and one data blob. Loading maps the file and points the SubMesh accessor views straight into the mapping,
+ * no JSON is parsed and no vertex data is copied.
+ */
+class CookedScene
+{
+public:
+	static const uint32_t kVersion = 5;
+
+	/**
+	 * @brief Content hash of one file, 0 when it cannot be read
+	 */
+	static uint64_t HashSource(const std::string& sourcePath);
+
+	/**
+	 * @brief Animation clips, skins and morph weights are not part of the format, scenes with them have no cooked form
+	 */
+	static bool IsCookable(const Scene& scene);
+
+	/**
+	 * @brief Returns false when the scene is not cookable or the file cannot be written
+	 */
+	static bool Write(const Scene& scene, uint64_t sourceHash, const std::string& path);
+
+	/**
+	 * @brief Returns nullptr when the file is missing, was written by another version or for another source, or is
+	 * truncated or corrupt
+	 */
+	static Scene* Load(const std::string& path, uint64_t sourceHash);
+
+private:
+	CookedScene() {};
+	~CookedScene() {};
+};
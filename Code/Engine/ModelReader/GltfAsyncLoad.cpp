@@ -0,0 +1,50 @@
+
+#include "GltfAsyncLoad.h"
+
+GltfAsyncLoad::GltfAsyncLoad(const std::string& path)
+	: m_Path(path)
+	, m_Start(std::chrono::high_resolution_clock::now())
+{
+}
+
+double GltfAsyncLoad::GetElapsedSeconds() const
+{
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_Start).count();
+}
+
+void GltfAsyncLoad::PublishHierarchy(Scene* scene, uint32_t meshNodeCount, const GltfStreamSettings& stream)
+{
+	m_Scene = scene;
+	m_MeshNodeCount = meshNodeCount;
+	m_State = GltfLoadState::Hierarchy;
+	m_TimeToHierarchy = GetElapsedSeconds();
+
+	if (stream.onHierarchyReady)
+	{
+		stream.onHierarchyReady(*this);
+	}
+}
+
+void GltfAsyncLoad::PublishNode(GameObject* node, const GltfStreamSettings& stream)
+{
+	if (m_LoadedMeshNodeCount++ == 0)
+	{
+		m_TimeToFirstVisibleNode = GetElapsedSeconds();
+	}
+
+	if (stream.onNodeReady)
+	{
+		stream.onNodeReady(*this, node);
+	}
+}
+
+void GltfAsyncLoad::Finish(GltfLoadState state, const GltfStreamSettings& stream)
+{
+	m_State = state;
+	m_TimeToComplete = GetElapsedSeconds();
+
+	if (stream.onComplete)
+	{
+		stream.onComplete(*this);
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "Framework/GlmCommon.h"
+
+class Scene;
+class GameObject;
+class GltfAsyncLoad;
+
+enum class GltfLoadState
+{
+	Loading,   /* File is being read, no scene yet */
+	Hierarchy, /* Nodes and transforms are in the scene, meshes are still streaming in */
+	Complete,  /* Every mesh is attached */
+	Failed     /* The file could not be loaded, the scene (if published) may miss meshes */
+};
+
+/**
+ * @brief Order in which an asynchronous load builds the meshes of its nodes
+ */
+enum class GltfStreamOrder
+{
+	NodeOrder,
+	CameraDistance
+};
+
+/**
+ * @brief How GltfReader::LoadFileAsync streams a file, all callbacks run on the main thread
+ */
+struct GltfStreamSettings
+{
+	GltfStreamOrder order = GltfStreamOrder::NodeOrder;
+
+	/**
+	 * @brief Viewer position for GltfStreamOrder::CameraDistance, nearest nodes first
+	 */
+	glm::vec3 viewPosition = glm::vec3(0.0f);
+
+	std::function<void(GltfAsyncLoad& load)> onHierarchyReady;
+	std::function<void(GltfAsyncLoad& load, GameObject* node)> onNodeReady;
+	std::function<void(GltfAsyncLoad& load)> onComplete;
+};
+
+/**
+ * @brief Progress of one GltfReader::LoadFileAsync call
+ * Only the main thread changes it, from the jobs JobSystem::RunMainThreadJobs() runs, so it can be read
+ * there without synchronization. Times are seconds since the load was requested, negative until reached.
+ */
+class GltfAsyncLoad
+{
+public:
+	GltfAsyncLoad(const std::string& path);
+
+	inline const std::string& GetPath() const { return m_Path; }
+	inline GltfLoadState GetState() const { return m_State; }
+	inline bool IsDone() const { return m_State == GltfLoadState::Complete || m_State == GltfLoadState::Failed; }
+
+	/**
+	 * @brief The scene, published with the hierarchy and filled in while the meshes stream in
+	 */
+	inline Scene* GetScene() const { return m_Scene; }
+
+	inline uint32_t GetMeshNodeCount() const { return m_MeshNodeCount; }
+	inline uint32_t GetLoadedMeshNodeCount() const { return m_LoadedMeshNodeCount; }
+	inline float GetProgress() const { return m_MeshNodeCount > 0 ? float(m_LoadedMeshNodeCount) / float(m_MeshNodeCount) : (IsDone() ? 1.0f : 0.0f); }
+
+	inline double GetTimeToHierarchy() const { return m_TimeToHierarchy; }
+	inline double GetTimeToFirstVisibleNode() const { return m_TimeToFirstVisibleNode; }
+	inline double GetTimeToComplete() const { return m_TimeToComplete; }
+
+private:
+	friend class GltfReader;
+
+	double GetElapsedSeconds() const;
+
+	void PublishHierarchy(Scene* scene, uint32_t meshNodeCount, const GltfStreamSettings& stream);
+	void PublishNode(GameObject* node, const GltfStreamSettings& stream);
+	void Finish(GltfLoadState state, const GltfStreamSettings& stream);
+
+	std::string m_Path;
+	GltfLoadState m_State{ GltfLoadState::Loading };
+	Scene* m_Scene{ nullptr };
+
+	uint32_t m_MeshNodeCount{ 0 };
+	uint32_t m_LoadedMeshNodeCount{ 0 };
+
+	std::chrono::high_resolution_clock::time_point m_Start;
+	double m_TimeToHierarchy{ -1.0 };
+	double m_TimeToFirstVisibleNode{ -1.0 };
+	double m_TimeToComplete{ -1.0 };
+};
+
+using GltfLoadHandle = std::shared_ptr<GltfAsyncLoad>;
@@ -0,0 +1,117 @@
+#include "GltfBatchLoad.h"
+
+static const uint32_t kStageCount = static_cast<uint32_t>(GltfBatchStage::Count);
+
+GltfBatchLoad::GltfBatchLoad(const std::vector<std::string>& paths)
+	: m_Files(paths.size())
+	, m_SourceHashes(paths.size(), 0)
+	, m_Read(paths.size(), 0)
+	, m_Start(std::chrono::high_resolution_clock::now())
+{
+	for (size_t i = 0; i < paths.size(); ++i)
+	{
+		m_Files[i].path = paths[i];
+	}
+
+	for (uint32_t stage = 0; stage < kStageCount; ++stage)
+	{
+		m_StageCounts[stage] = 0;
+		m_StageNanoseconds[stage] = 0;
+	}
+}
+
+float GltfBatchLoad::GetProgress() const
+{
+	if (m_Files.empty())
+	{
+		return IsDone() ? 1.0f : 0.0f;
+	}
+
+	return float(m_FinishedStages.load(std::memory_order_relaxed)) / float(m_Files.size() * kStageCount);
+}
+
+double GltfBatchLoad::GetStageSeconds(GltfBatchStage stage) const
+{
+	return m_StageNanoseconds[static_cast<size_t>(stage)].load(std::memory_order_relaxed) * 1e-9;
+}
+
+double GltfBatchLoad::GetElapsedSeconds() const
+{
+	const int64_t elapsed = m_ElapsedNanoseconds.load(std::memory_order_relaxed);
+	if (elapsed >= 0)
+	{
+		return elapsed * 1e-9;
+	}
+
+	return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_Start).count();
+}
+
+void GltfBatchLoad::Wait()
+{
+	JobSystem::GetInstance().Wait(m_Group);
+}
+
+std::vector<Scene*> GltfBatchLoad::GetScenes() const
+{
+	std::vector<Scene*> scenes;
+	scenes.reserve(m_Files.size());
+	for (const GltfBatchFile& file : m_Files)
+	{
+		scenes.push_back(file.scene);
+	}
+
+	return scenes;
+}
+
+void GltfBatchLoad::FinishStage(uint32_t index, GltfBatchStage stage, std::chrono::high_resolution_clock::time_point start)
+{
+	const auto elapsed = std::chrono::high_resolution_clock::now() - start;
+	m_Files[index].stageSeconds[static_cast<size_t>(stage)] = std::chrono::duration<double>(elapsed).count();
+
+	m_StageNanoseconds[static_cast<size_t>(stage)] += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	m_StageCounts[static_cast<size_t>(stage)]++;
+	m_FinishedStages++;
+}
+
+void GltfBatchLoad::FinishRead(uint32_t index, uint64_t sourceHash, bool cooked, std::chrono::high_resolution_clock::time_point start)
+{
+	FinishStage(index, GltfBatchStage::Read, start);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_SourceHashes[index] = sourceHash;
+		m_Files[index].cooked = cooked;
+		m_Read[index] = 1;
+	}
+	m_ReadSignal.notify_all();
+}
+
+void GltfBatchLoad::Fail(uint32_t index, GltfBatchStage stage)
+{
+	m_Files[index].scene = nullptr;
+	m_FinishedStages += kStageCount - static_cast<uint32_t>(stage);
+	m_FailedCount++;
+}
+
+void GltfBatchLoad::Finish()
+{
+	m_ElapsedNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_Start).count();
+	m_Done.store(true, std::memory_order_release);
+}
+
+void GltfBatchLoad::WaitForReadSlot(uint32_t index, uint32_t readAhead)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_SlotSignal.wait(lock, [&] { return index < m_Requested + readAhead; });
+}
+
+uint64_t GltfBatchLoad::WaitForRead(uint32_t index, bool& cooked)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Requested++;
+	m_SlotSignal.notify_one();
+
+	m_ReadSignal.wait(lock, [&] { return m_Read[index] != 0; });
+	cooked = m_Files[index].cooked;
+	return m_SourceHashes[index];
+}
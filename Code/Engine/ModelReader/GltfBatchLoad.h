@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Framework/JobSystem.h"
+
+class Scene;
+
+/**
+ * @brief Pipeline stages of a batch load, Read runs on the I/O thread, Parse and Build on the job pool
+ */
+enum class GltfBatchStage
+{
+	Read,  /* Source (or cooked scene) pulled into the page cache, cooked scene hash */
+	Parse, /* JSON/GLB parse and meshopt decode, skipped for cooked scenes */
+	Build, /* Scene, meshes and animations, or the cooked scene load */
+	Count
+};
+
+/**
+ * @brief How GltfReader::LoadFilesAsync pipelines a batch
+ */
+struct GltfBatchSettings
+{
+	/// Files the I/O thread may read ahead of the ones workers asked for, bounds the page cache the batch keeps
+	/// warm. 0 reads every file only once a worker waits for it.
+	uint32_t readAhead = 8;
+};
+
+/**
+ * @brief Result and per stage times of one file of a batch
+ */
+struct GltfBatchFile
+{
+	std::string path;
+	/// nullptr when the file failed to load
+	Scene* scene{ nullptr };
+	bool cooked{ false };
+	double stageSeconds[static_cast<size_t>(GltfBatchStage::Count)] = { 0.0, 0.0, 0.0 };
+};
+
+/**
+ * @brief Progress of one GltfReader::LoadFilesAsync call
+ * Counters and times can be polled from any thread while the batch runs, the files only once IsDone().
+ * Stage seconds add up the time every file spent in a stage, GetElapsedSeconds() is the wall time; the
+ * difference is what overlapping the stages of different files saved against loading them one by one.
+ */
+class GltfBatchLoad
+{
+public:
+	GltfBatchLoad(const std::vector<std::string>& paths);
+
+	inline uint32_t GetFileCount() const { return static_cast<uint32_t>(m_Files.size()); }
+	inline uint32_t GetStageCount(GltfBatchStage stage) const { return m_StageCounts[static_cast<size_t>(stage)].load(std::memory_order_relaxed); }
+	inline uint32_t GetLoadedCount() const { return GetStageCount(GltfBatchStage::Build); }
+	inline uint32_t GetFailedCount() const { return m_FailedCount.load(std::memory_order_relaxed); }
+	inline bool IsDone() const { return m_Done.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Stages finished over all stages of all files, 0 to 1
+	 */
+	float GetProgress() const;
+
+	double GetStageSeconds(GltfBatchStage stage) const;
+	double GetElapsedSeconds() const;
+
+	/**
+	 * @brief Blocks until every file is loaded, running queued jobs in the meantime
+	 */
+	void Wait();
+
+	/**
+	 * @brief Files in the order they were requested, only valid once IsDone()
+	 */
+	inline const std::vector<GltfBatchFile>& GetFiles() const { return m_Files; }
+
+	/**
+	 * @brief The scenes of GetFiles(), nullptr for failed files
+	 */
+	std::vector<Scene*> GetScenes() const;
+
+private:
+	friend class GltfReader;
+
+	void FinishStage(uint32_t index, GltfBatchStage stage, std::chrono::high_resolution_clock::time_point start);
+	void FinishRead(uint32_t index, uint64_t sourceHash, bool cooked, std::chrono::high_resolution_clock::time_point start);
+	/**
+	 * @brief Counts the stages the file will never reach as finished, so the progress still ends at 1
+	 */
+	void Fail(uint32_t index, GltfBatchStage stage);
+	void Finish();
+
+	/**
+	 * @brief I/O thread side of the read ahead window, blocks until file index may be read
+	 */
+	void WaitForReadSlot(uint32_t index, uint32_t readAhead);
+
+	/**
+	 * @brief Worker side, blocks until the I/O thread has read the file and returns its cooked scene hash
+	 */
+	uint64_t WaitForRead(uint32_t index, bool& cooked);
+
+	std::vector<GltfBatchFile> m_Files;
+	std::vector<uint64_t> m_SourceHashes;
+	std::vector<uint8_t> m_Read;
+
+	std::mutex m_Mutex;
+	std::condition_variable m_ReadSignal;
+	std::condition_variable m_SlotSignal;
+	/// Files a worker waits for or works on, the read ahead window trails it
+	uint32_t m_Requested{ 0 };
+
+	std::atomic<uint32_t> m_StageCounts[static_cast<size_t>(GltfBatchStage::Count)];
+	std::atomic<uint64_t> m_StageNanoseconds[static_cast<size_t>(GltfBatchStage::Count)];
+	std::atomic<uint32_t> m_FinishedStages{ 0 };
+	std::atomic<uint32_t> m_FailedCount{ 0 };
+	std::atomic<bool> m_Done{ false };
+
+	std::thread m_ReadThread;
+	JobGroup m_Group;
+
+	std::chrono::high_resolution_clock::time_point m_Start;
+	std::atomic<int64_t> m_ElapsedNanoseconds{ -1 };
+};
+
+using GltfBatchHandle = std::shared_ptr<GltfBatchLoad>;
@@ -11,36 +11,237 @@
 #include "Scene/Camera.h"
 #include "Scene/Transform.h"
 #include "Scene/MeshRenderer.h"
+#include "Scene/MeshRegistry.h"
 #include "Scene/Scene.h"
 
 #include "Render/Material.h"
+#include "Render/MaterialTable.h"
+#include "Apps/FileSystem.h"
+#include "ModelReader/CookedScene.h"
+#include "Framework/JobSystem.h"
+#include "Geometry/MeshOptimizer.h"
+#include "Geometry/Meshlet.h"
+#include "Geometry/MeshSimplifier.h"
+#include "Geometry/VertexQuantizer.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/MeshoptDecoder.h"
+#include "ModelReader/AccessorConversion.h"
+#include "Animation/AnimationClip.h"
+#include "Animation/ClipCompressor.h"
+#include "Animation/CompressedClip.h"
+#include "Animation/MeshDeformer.h"
+#include "Animation/Skin.h"
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
 #include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <queue>
+#include <iostream>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <cctype>
 
 #define KHR_LIGHTS_PUNCTUAL_EXTENSION "KHR_lights_punctual"
+#define KHR_MESH_QUANTIZATION_EXTENSION "KHR_mesh_quantization"
+#define EXT_MESHOPT_COMPRESSION_EXTENSION "EXT_meshopt_compression"
 
-std::unique_ptr<Material> ParseMaterial(const tinygltf::Material& gltf_material)
+static const uint32_t kGlbMagic = 0x46546C67;      // "glTF"
+static const uint32_t kGlbChunkJson = 0x4E4F534A;  // "JSON"
+static const uint32_t kGlbChunkBin = 0x004E4942;   // "BIN\0"
+static const size_t kGlbHeaderSize = 12;
+static const size_t kGlbChunkHeaderSize = 8;
+
+// Primitives decoded per job, small enough to balance scenes with a few large meshes
+static const uint32_t kPrimitiveBatchSize = 16;
+
+inline uint32_t ReadU32(const uint8_t* data)
+{
+	return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+/**
+ * @brief JSON and BIN chunks of a GLB file, the BIN chunk is optional
+ */
+inline bool FindGlbChunks(const uint8_t* data, size_t size, const uint8_t*& jsonChunk, size_t& jsonSize, const uint8_t*& binChunk, size_t& binSize, std::string& err)
+{
+	if (size < kGlbHeaderSize + kGlbChunkHeaderSize || ReadU32(data) != kGlbMagic || ReadU32(data + 4) != 2)
+	{
+		err = "Invalid GLB header";
+		return false;
+	}
+
+	size_t length = std::min<size_t>(ReadU32(data + 8), size);
+
+	size_t offset = kGlbHeaderSize;
+	while (offset + kGlbChunkHeaderSize <= length)
+	{
+		size_t chunkSize = ReadU32(data + offset);
+		uint32_t chunkType = ReadU32(data + offset + 4);
+		offset += kGlbChunkHeaderSize;
+
+		if (offset + chunkSize > length)
+		{
+			err = "GLB chunk exceeds the file size";
+			return false;
+		}
+
+		if (chunkType == kGlbChunkJson && !jsonChunk)
+		{
+			jsonChunk = data + offset;
+			jsonSize = chunkSize;
+		}
+		else if (chunkType == kGlbChunkBin && !binChunk)
+		{
+			binChunk = data + offset;
+			binSize = chunkSize;
+		}
+
+		offset += (chunkSize + 3) & ~size_t(3);
+	}
+
+	if (!jsonChunk)
+	{
+		err = "GLB file has no JSON chunk";
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Gives the data-less fallback buffers of EXT_meshopt_compression an empty data uri, tinygltf requires one
+ * Nothing reads them, every bufferView in them is decoded from a compressed buffer.
+ */
+inline void PatchMeshoptFallbackBuffers(nlohmann::json& json)
+{
+	if (!json.contains("buffers"))
+	{
+		return;
+	}
+
+	for (auto& buffer : json["buffers"])
+	{
+		if (buffer.contains("uri") || !buffer.contains("extensions") || !buffer["extensions"].contains(EXT_MESHOPT_COMPRESSION_EXTENSION))
+		{
+			continue;
+		}
+
+		if (buffer["extensions"][EXT_MESHOPT_COMPRESSION_EXTENSION].value("fallback", false))
+		{
+			buffer["uri"] = "data:application/octet-stream;base64,";
+			buffer["byteLength"] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Parses glTF JSON text, relative uris resolve against the folder of path
+ */
+inline bool ParseJsonText(const char* text, size_t size, const std::string& path, GltfDocument& document, std::string& err, std::string& warn)
+{
+	std::string baseDir = path;
+	size_t separator = baseDir.find_last_of("/\\");
+	baseDir = separator == std::string::npos ? std::string() : baseDir.substr(0, separator);
+
+	tinygltf::TinyGLTF gltfLoader;
+	document.model = std::make_shared<tinygltf::Model>();
+	return gltfLoader.LoadASCIIFromString(document.model.get(), &err, &warn, text, static_cast<unsigned int>(size), baseDir);
+}
+
+inline bool ParseJsonDocument(const nlohmann::json& json, const std::string& path, GltfDocument& document, std::string& err, std::string& warn)
+{
+	std::string patchedJson = json.dump();
+	return ParseJsonText(patchedJson.c_str(), patchedJson.size(), path, document, err, warn);
+}
+
+inline MeshoptMode GetMeshoptMode(const std::string& mode)
+{
+	if (mode == "TRIANGLES")
+	{
+		return MeshoptMode::Triangles;
+	}
+	else if (mode == "INDICES")
+	{
+		return MeshoptMode::Indices;
+	}
+
+	return MeshoptMode::Attributes;
+}
+
+inline MeshoptFilter GetMeshoptFilter(const std::string& filter)
 {
-	auto material = std::make_unique<Material>(gltf_material.name);
+	if (filter == "OCTAHEDRAL")
+	{
+		return MeshoptFilter::Octahedral;
+	}
+	else if (filter == "QUATERNION")
+	{
+		return MeshoptFilter::Quaternion;
+	}
+	else if (filter == "EXPONENTIAL")
+	{
+		return MeshoptFilter::Exponential;
+	}
+
+	return MeshoptFilter::None;
+}
+
+/**
+ * @brief Percent-decoded relative uri, as tinygltf resolves it against the folder of the file
+ */
+inline std::string DecodeUri(const std::string& uri)
+{
+	std::string decoded;
+	decoded.reserve(uri.size());
+	for (size_t i = 0; i < uri.size(); ++i)
+	{
+		if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) && std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+		{
+			decoded.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+			i += 2;
+		}
+		else
+		{
+			decoded.push_back(uri[i]);
+		}
+	}
+
+	return decoded;
+}
+
+inline bool IsBinaryFile(const std::string& path)
+{
+	if (path.size() < 4)
+	{
+		return false;
+	}
+
+	std::string extension = path.substr(path.size() - 4);
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == ".glb";
+}
+
+Material ParseMaterial(const tinygltf::Material& gltf_material)
+{
+	Material material(gltf_material.name);
 
 	for (auto& gltf_value : gltf_material.values)
 	{
 		if (gltf_value.first == "baseColorFactor")
 		{
 			const auto& color_factor = gltf_value.second.ColorFactor();
-			material->baseColorFactor = glm::vec4(color_factor[0], color_factor[1], color_factor[2], color_factor[3]);
+			material.baseColorFactor = glm::vec4(color_factor[0], color_factor[1], color_factor[2], color_factor[3]);
 		}
 		else if (gltf_value.first == "metallicFactor")
 		{
-			material->metallicFactor = static_cast<float>(gltf_value.second.Factor());
+			material.metallicFactor = static_cast<float>(gltf_value.second.Factor());
 		}
 		else if (gltf_value.first == "roughnessFactor")
 		{
-			material->roughnessFactor = static_cast<float>(gltf_value.second.Factor());
+			material.roughnessFactor = static_cast<float>(gltf_value.second.Factor());
 		}
 	}
 
@@ -50,43 +251,52 @@ std::unique_ptr<Material> ParseMaterial(const tinygltf::Material& gltf_material)
 		{
 			const auto& emissive_factor = gltf_value.second.number_array;
 
-			material->emissive = glm::vec3(emissive_factor[0], emissive_factor[1], emissive_factor[2]);
+			material.emissive = glm::vec3(emissive_factor[0], emissive_factor[1], emissive_factor[2]);
 		}
 		else if (gltf_value.first == "alphaMode")
 		{
 			if (gltf_value.second.string_value == "BLEND")
 			{
-				material->alphaMode = AlphaMode::Blend;
+				material.alphaMode = AlphaMode::Blend;
 			}
 			else if (gltf_value.second.string_value == "OPAQUE")
 			{
-				material->alphaMode = AlphaMode::Opaque;
+				material.alphaMode = AlphaMode::Opaque;
 			}
 			else if (gltf_value.second.string_value == "MASK")
 			{
-				material->alphaMode = AlphaMode::Mask;
+				material.alphaMode = AlphaMode::Mask;
 			}
 		}
 		else if (gltf_value.first == "alphaCutoff")
 		{
-			material->alphaCutoff = static_cast<float>(gltf_value.second.number_value);
+			material.alphaCutoff = static_cast<float>(gltf_value.second.number_value);
 		}
 		else if (gltf_value.first == "doubleSided")
 		{
-			material->doubleSided = gltf_value.second.bool_value;
+			material.doubleSided = gltf_value.second.bool_value;
 		}
 	}
 
 	return material;
 }
 
-std::unique_ptr<Material> CreateDefaultMaterial()
+/**
+ * @brief Handles of the document materials in the shared MaterialTable, in glTF material order
+ */
+std::vector<MaterialHandle> ParseMaterials(const tinygltf::Model& model)
 {
-	tinygltf::Material gltf_material;
-	return ParseMaterial(gltf_material);
-}
+	MaterialTable& materialTable = MaterialTable::GetInstance();
+
+	std::vector<MaterialHandle> materials;
+	materials.reserve(model.materials.size());
+	for (auto& gltf_material : model.materials)
+	{
+		materials.push_back(materialTable.Add(ParseMaterial(gltf_material)));
+	}
 
-std::unique_ptr<Material> defaultMaterial = CreateDefaultMaterial();
+	return materials;
+}
 
 /**
  * @brief Helper Function to change array type T to array type Y
@@ -103,21 +313,11 @@ struct TypeCast
 	}
 };
 
-std::unordered_map<std::string, bool> supportedExtensions = {
-	{KHR_LIGHTS_PUNCTUAL_EXTENSION, false} };
-
-inline std::vector<uint8_t> GetAttributeData(const tinygltf::Model* model, uint32_t accessorId)
-{
-	auto& accessor = model->accessors.at(accessorId);
-	auto& bufferView = model->bufferViews.at(accessor.bufferView);
-	auto& buffer = model->buffers.at(bufferView.buffer);
-
-	size_t stride = accessor.ByteStride(bufferView);
-	size_t startByte = accessor.byteOffset + bufferView.byteOffset;
-	size_t endByte = startByte + accessor.count * stride;
-
-	return { buffer.data.begin() + startByte, buffer.data.begin() + endByte };
-};
+// Read by every load thread, the extensions a file enables are kept in its GltfDocument
+static const std::unordered_set<std::string> supportedExtensions = {
+	KHR_LIGHTS_PUNCTUAL_EXTENSION,
+	KHR_MESH_QUANTIZATION_EXTENSION,
+	EXT_MESHOPT_COMPRESSION_EXTENSION };
 
 inline size_t GetAttributeSize(const tinygltf::Model* model, uint32_t accessorId)
 {
@@ -146,7 +346,19 @@ inline VkFormat GetAttributeFormat(const tinygltf::Model* model, uint32_t access
 															  {TINYGLTF_TYPE_VEC3, VK_FORMAT_R8G8B8_SINT},
 															  {TINYGLTF_TYPE_VEC4, VK_FORMAT_R8G8B8A8_SINT} };
 
-		format = mapped_format.at(accessor.type);
+		static const std::map<int, VkFormat> mapped_format_normalize = { {TINYGLTF_TYPE_SCALAR, VK_FORMAT_R8_SNORM},
+																		{TINYGLTF_TYPE_VEC2, VK_FORMAT_R8G8_SNORM},
+																		{TINYGLTF_TYPE_VEC3, VK_FORMAT_R8G8B8_SNORM},
+																		{TINYGLTF_TYPE_VEC4, VK_FORMAT_R8G8B8A8_SNORM} };
+
+		if (accessor.normalized)
+		{
+			format = mapped_format_normalize.at(accessor.type);
+		}
+		else
+		{
+			format = mapped_format.at(accessor.type);
+		}
 
 		break;
 	}
@@ -173,12 +385,24 @@ inline VkFormat GetAttributeFormat(const tinygltf::Model* model, uint32_t access
 		break;
 	}
 	case TINYGLTF_COMPONENT_TYPE_SHORT: {
-		static const std::map<int, VkFormat> mapped_format = { {TINYGLTF_TYPE_SCALAR, VK_FORMAT_R8_SINT},
-															  {TINYGLTF_TYPE_VEC2, VK_FORMAT_R8G8_SINT},
-															  {TINYGLTF_TYPE_VEC3, VK_FORMAT_R8G8B8_SINT},
-															  {TINYGLTF_TYPE_VEC4, VK_FORMAT_R8G8B8A8_SINT} };
+		static const std::map<int, VkFormat> mapped_format = { {TINYGLTF_TYPE_SCALAR, VK_FORMAT_R16_SINT},
+															  {TINYGLTF_TYPE_VEC2, VK_FORMAT_R16G16_SINT},
+															  {TINYGLTF_TYPE_VEC3, VK_FORMAT_R16G16B16_SINT},
+															  {TINYGLTF_TYPE_VEC4, VK_FORMAT_R16G16B16A16_SINT} };
 
-		format = mapped_format.at(accessor.type);
+		static const std::map<int, VkFormat> mapped_format_normalize = { {TINYGLTF_TYPE_SCALAR, VK_FORMAT_R16_SNORM},
+																		{TINYGLTF_TYPE_VEC2, VK_FORMAT_R16G16_SNORM},
+																		{TINYGLTF_TYPE_VEC3, VK_FORMAT_R16G16B16_SNORM},
+																		{TINYGLTF_TYPE_VEC4, VK_FORMAT_R16G16B16A16_SNORM} };
+
+		if (accessor.normalized)
+		{
+			format = mapped_format_normalize.at(accessor.type);
+		}
+		else
+		{
+			format = mapped_format.at(accessor.type);
+		}
 
 		break;
 	}
@@ -243,279 +467,1825 @@ inline VkFormat GetAttributeFormat(const tinygltf::Model* model, uint32_t access
 	return format;
 };
 
-void ParseCamera(const tinygltf::Camera& gltf_camera, GameObject* go)
+/**
+ * @brief Start of the bytes at byteOffset in a bufferView, throws when size bytes from there leave the buffer
+ */
+inline const uint8_t* GetBufferViewData(const GltfDocument& document, int bufferViewId, size_t byteOffset, size_t size)
 {
-	Camera* camera = go->AddComponent<Camera>();
+	auto& bufferView = document.model->bufferViews.at(bufferViewId);
+	auto& buffer = document.buffers.at(bufferView.buffer);
 
-	if (gltf_camera.type == "perspective")
-	{
-		camera->SetAspectRatio(static_cast<float>(gltf_camera.perspective.aspectRatio));
-		camera->SetFieldOfView(static_cast<float>(gltf_camera.perspective.yfov));
-		camera->SetNearPlane(static_cast<float>(gltf_camera.perspective.znear));
-		camera->SetFarPlane(static_cast<float>(gltf_camera.perspective.zfar));
-	}
-	else
+	const size_t offset = bufferView.byteOffset + byteOffset;
+	if (byteOffset + size > bufferView.byteLength || offset + size > buffer.size)
 	{
-		//LOGW("Camera type not supported");
+		throw std::runtime_error("Couldn't load glTF file, accessor data is out of bounds");
 	}
+
+	return buffer.data + offset;
 }
 
-void ParseMesh(tinygltf::Model& model, const tinygltf::Mesh& gltfMesh, GameObject* go)
+/**
+ * @brief Dense copy of an accessor with its sparse values applied, accessors without a bufferView start out as zeros
+ */
+AccessorView GetSparseAttributeData(const GltfDocument& document, const tinygltf::Accessor& accessor, VkFormat format)
 {
-	Mesh* mesh = WL_NEW(Mesh);
-	MeshRenderer* meshRenderer = go->AddComponent<MeshRenderer>();
-	meshRenderer->SetMesh(mesh);
-	for (auto& gltfPrimitive : gltfMesh.primitives)
+	const uint32_t elementSize = GetFormatSize(format);
+	const uint32_t count = static_cast<uint32_t>(accessor.count);
+	if (elementSize == 0)
 	{
-		SubMesh subMesh;
-		for (auto& attribute : gltfPrimitive.attributes)
-		{
-			std::string attributeName = attribute.first;
-			std::transform(attributeName.begin(), attributeName.end(), attributeName.begin(), ::tolower);
-
-			uint32_t accessorId = attribute.second;
-			std::vector<uint8_t> vertexData = GetAttributeData(&model, attribute.second);
-			if (attributeName == "position")
-			{
-				subMesh.vertexCount = model.accessors.at(attribute.second).count;
-			}
-			subMesh.vertexBuffers.insert(std::make_pair(attributeName, std::move(vertexData)));
+		throw std::runtime_error("Couldn't load glTF file, sparse accessor has an unsupported type");
+	}
 
-			VertexAttribute attrib;
-			attrib.format = GetAttributeFormat(&model, attribute.second);
-			attrib.stride = GetAttributeStride(&model, attribute.second);
-			subMesh.SetAttribute(attributeName, attrib);
-		}
+	std::vector<uint8_t> data;
+	if (accessor.bufferView >= 0)
+	{
+		auto& bufferView = document.model->bufferViews.at(accessor.bufferView);
+		const uint32_t stride = static_cast<uint32_t>(accessor.ByteStride(bufferView));
+
+		AccessorView base;
+		base.buffer = GetBufferViewData(document, accessor.bufferView, accessor.byteOffset, count > 0 ? static_cast<size_t>(count - 1) * stride + elementSize : 0);
+		base.stride = stride;
+		base.count = count;
+		base.format = format;
+		data = base.CopyPacked();
+	}
+	else
+	{
+		data.resize(static_cast<size_t>(count) * elementSize, 0);
+	}
 
-		if (gltfPrimitive.indices >= 0)
+	auto& sparse = accessor.sparse;
+	if (sparse.isSparse && sparse.count > 0)
+	{
+		const size_t sparseCount = static_cast<size_t>(sparse.count);
+		const uint32_t indexSize = static_cast<uint32_t>(tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(sparse.indices.componentType)));
+		if (indexSize != 1 && indexSize != 2 && indexSize != 4)
 		{
-			subMesh.vertexIndices = GetAttributeSize(&model, gltfPrimitive.indices);
-
-			auto format = GetAttributeFormat(&model, gltfPrimitive.indices);
-			auto indexData = GetAttributeData(&model, gltfPrimitive.indices);
-
-			switch (format)
-			{
-			case VK_FORMAT_R8_UINT:
-				// Converts uint8 data into uint16 data, still represented by a uint8 vector
-				//indexData = convert_underlying_data_stride(index_data, 1, 2);
-				//submesh->index_type = VK_INDEX_TYPE_UINT16;
-
-				break;
-			case VK_FORMAT_R16_UINT:
-				subMesh.indexType = VK_INDEX_TYPE_UINT16;
-				break;
-			case VK_FORMAT_R32_UINT:
-				subMesh.indexType = VK_INDEX_TYPE_UINT32;
-				break;
-			default:
-				break;
-			}
+			throw std::runtime_error("Couldn't load glTF file, sparse accessor indices have an invalid type");
 		}
 
-		if (gltfPrimitive.material < 0)
-		{
-			subMesh.material = &(*defaultMaterial);
-		}
-		else
+		const uint8_t* indices = GetBufferViewData(document, sparse.indices.bufferView, sparse.indices.byteOffset, sparseCount * indexSize);
+		const uint8_t* values = GetBufferViewData(document, sparse.values.bufferView, sparse.values.byteOffset, sparseCount * elementSize);
+
+		// Widened and range checked in one pass, so the scatter runs without per element checks
+		std::vector<uint32_t> elementIndices(sparseCount);
+		if (AccessorConversion::ReadSparseIndices(indices, indexSize, elementIndices.data(), sparseCount) >= count)
 		{
-			subMesh.material = &(*defaultMaterial);
+			throw std::runtime_error("Couldn't load glTF file, sparse accessor index is out of range");
 		}
 
-		mesh->AddSubmesh(subMesh);
+		AccessorConversion::ApplySparseValues(data.data(), elementSize, elementIndices.data(), values, sparseCount);
 	}
+
+	return AccessorView::FromData(std::move(data), elementSize, count, format);
 }
 
-GameObject* ParseNode(const tinygltf::Node& gltf_node, size_t index)
+inline AccessorView GetAttributeData(const GltfDocument& document, uint32_t accessorId)
 {
-	auto node = WL_NEW(GameObject)(gltf_node.name);
-
-	auto transform = node->AddComponent<Transform>();
-
-	if (!gltf_node.translation.empty())
+	auto& model = document.model;
+	auto& accessor = model->accessors.at(accessorId);
+	if (accessor.sparse.isSparse || accessor.bufferView < 0)
 	{
-		glm::vec3 translation;
-
-		std::transform(gltf_node.translation.begin(), gltf_node.translation.end(), glm::value_ptr(translation), TypeCast<double, float>{});
-
-		transform->SetTranslation(translation);
+		return GetSparseAttributeData(document, accessor, GetAttributeFormat(model.get(), accessorId));
 	}
 
-	if (!gltf_node.rotation.empty())
+	auto& bufferView = model->bufferViews.at(accessor.bufferView);
+	auto& buffer = document.buffers.at(bufferView.buffer);
+
+	// The view references the buffer memory directly, the owner keeps it alive
+	AccessorView view;
+	view.owner = buffer.owner;
+	view.buffer = buffer.data;
+	view.offset = accessor.byteOffset + bufferView.byteOffset;
+	view.stride = static_cast<uint32_t>(accessor.ByteStride(bufferView));
+	view.count = static_cast<uint32_t>(accessor.count);
+	view.format = GetAttributeFormat(model.get(), accessorId);
+
+	// Views read the buffer without checks, an accessor reaching past it must not get that far
+	const size_t end = view.count == 0 ? 0 : view.offset + static_cast<size_t>(view.count - 1) * view.stride + GetFormatSize(view.format);
+	if (end > buffer.size || end > bufferView.byteOffset + bufferView.byteLength)
 	{
-		glm::quat rotation;
-
-		std::transform(gltf_node.rotation.begin(), gltf_node.rotation.end(), glm::value_ptr(rotation), TypeCast<double, float>{});
-
-		transform->SetRotation(rotation);
+		throw std::out_of_range("Couldn't load glTF file, accessor " + std::to_string(accessorId) + " reaches past its bufferView");
 	}
 
-	if (!gltf_node.scale.empty())
-	{
-		glm::vec3 scale;
-
-		std::transform(gltf_node.scale.begin(), gltf_node.scale.end(), glm::value_ptr(scale), TypeCast<double, float>{});
+	return view;
+};
 
-		transform->SetScale(scale);
+/**
+ * @brief Vertex input format for a glTF attribute stored with a small integer type (KHR_mesh_quantization)
+ * Attributes the shader reads as floats use the SCALED formats when they are not normalized. 3 component
+ * 8/16-bit formats are fetched as 4 components when stride and buffer leave room, few GPUs fetch the former.
+ */
+inline VkFormat GetVertexInputFormat(VkFormat format, VertexSemantic semantic, const AccessorView& view, size_t bufferSize)
+{
+	static const std::unordered_map<uint32_t, VkFormat> scaledFormats = {
+		{VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8_USCALED}, {VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8_SSCALED},
+		{VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8_USCALED}, {VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8_SSCALED},
+		{VK_FORMAT_R8G8B8A8_UINT, VK_FORMAT_R8G8B8A8_USCALED}, {VK_FORMAT_R8G8B8A8_SINT, VK_FORMAT_R8G8B8A8_SSCALED},
+		{VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16_USCALED}, {VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16_SSCALED},
+		{VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16_USCALED}, {VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16_SSCALED},
+		{VK_FORMAT_R16G16B16A16_UINT, VK_FORMAT_R16G16B16A16_USCALED}, {VK_FORMAT_R16G16B16A16_SINT, VK_FORMAT_R16G16B16A16_SSCALED} };
+
+	static const std::unordered_map<uint32_t, VkFormat> widenedFormats = {
+		{VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM}, {VK_FORMAT_R8G8B8_SNORM, VK_FORMAT_R8G8B8A8_SNORM},
+		{VK_FORMAT_R8G8B8_USCALED, VK_FORMAT_R8G8B8A8_USCALED}, {VK_FORMAT_R8G8B8_SSCALED, VK_FORMAT_R8G8B8A8_SSCALED},
+		{VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16A16_UNORM}, {VK_FORMAT_R16G16B16_SNORM, VK_FORMAT_R16G16B16A16_SNORM},
+		{VK_FORMAT_R16G16B16_USCALED, VK_FORMAT_R16G16B16A16_USCALED}, {VK_FORMAT_R16G16B16_SSCALED, VK_FORMAT_R16G16B16A16_SSCALED} };
+
+	const bool readAsFloat = semantic == VertexSemantic::Position || semantic == VertexSemantic::Normal || semantic == VertexSemantic::Tangent ||
+		semantic == VertexSemantic::Texcoord0 || semantic == VertexSemantic::Texcoord1;
+
+	if (readAsFloat)
+	{
+		auto scaled = scaledFormats.find(format);
+		format = scaled != scaledFormats.end() ? scaled->second : format;
 	}
 
-	if (!gltf_node.matrix.empty())
+	auto widened = widenedFormats.find(format);
+	if (widened != widenedFormats.end() && view.count > 0)
 	{
-		glm::mat4 matrix;
-
-		std::transform(gltf_node.matrix.begin(), gltf_node.matrix.end(), glm::value_ptr(matrix), TypeCast<double, float>{});
-
-		transform->SetMatrix(matrix);
+		const uint32_t widenedSize = GetFormatSize(widened->second);
+		const size_t end = view.offset + static_cast<size_t>(view.count - 1) * view.stride + widenedSize;
+		if (view.stride >= widenedSize && end <= bufferSize)
+		{
+			format = widened->second;
+		}
 	}
 
-	return node;
+	return format;
 }
 
-Scene* GltfReader::LoadFile(const char* path)
+/**
+ * @brief Attribute data with the format the vertex input stage reads it with
+ */
+inline AccessorView GetVertexAttributeData(const GltfDocument& document, uint32_t accessorId, VertexSemantic semantic)
 {
-	Scene* scene = WL_NEW(Scene);
-
-	int scene_index = -1;
+	AccessorView view = GetAttributeData(document, accessorId);
 
-	std::string err;
-	std::string warn;
-
-	tinygltf::TinyGLTF gltfLoader;
+	// Densified sparse data ends with its last element, which leaves no room to fetch a 4th component
+	auto& accessor = document.model->accessors.at(accessorId);
+	const size_t bufferSize = accessor.sparse.isSparse || accessor.bufferView < 0 ? view.ByteSize()
+		: document.buffers.at(document.model->bufferViews.at(accessor.bufferView).buffer).size;
+	view.format = GetVertexInputFormat(view.format, semantic, view, bufferSize);
 
-	tinygltf::Model model;
-	bool importResult = gltfLoader.LoadASCIIFromFile(&model, &err, &warn, path);
-	if (!importResult)
-	{
-		return nullptr;
-	}
+	return view;
+}
 
-	if (!err.empty())
-	{
-		return nullptr;
-	}
+/**
+ * @brief Shared dequantization of all primitives of a mesh, invalid when the mesh cannot be quantized
+ * Skinned and morphed meshes are skipped because their positions are not only transformed by the node.
+ */
+PositionQuantization ComputeMeshQuantization(const GltfDocument& document, const tinygltf::Mesh& gltfMesh)
+{
+	auto& model = document.model;
 
-	if (!warn.empty())
+	glm::vec3 minimum(std::numeric_limits<float>::max());
+	glm::vec3 maximum(-std::numeric_limits<float>::max());
+	for (auto& gltfPrimitive : gltfMesh.primitives)
 	{
-		return nullptr;
-	}
+		auto position = gltfPrimitive.attributes.find("POSITION");
+		if (position == gltfPrimitive.attributes.end() || !gltfPrimitive.targets.empty() || gltfPrimitive.attributes.count("JOINTS_0") > 0)
+		{
+			return PositionQuantization();
+		}
 
-	//std::string fileName = path;
-	//size_t pos = fileName.find_last_of('/');
+		auto& accessor = model->accessors.at(position->second);
+		if (accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || accessor.type != TINYGLTF_TYPE_VEC3)
+		{
+			return PositionQuantization();
+		}
 
-	for (auto& usedExtension: model.extensionsUsed)
-	{
-		auto it = supportedExtensions.find(usedExtension);
-		if (it == supportedExtensions.end())
+		if (accessor.minValues.size() == 3 && accessor.maxValues.size() == 3)
 		{
-			if (std::find(model.extensionsRequired.begin(), model.extensionsRequired.end(), usedExtension) != model.extensionsRequired.end())
-			{
-				throw std::runtime_error("Cannot load glTF file. Contains a required unsupported extension: " + usedExtension);
-			}
-			else
+			for (int c = 0; c < 3; ++c)
 			{
-
+				minimum[c] = std::min(minimum[c], static_cast<float>(accessor.minValues[c]));
+				maximum[c] = std::max(maximum[c], static_cast<float>(accessor.maxValues[c]));
 			}
 		}
 		else
 		{
-			it->second = true;
+			AccessorView view = GetAttributeData(document, position->second);
+			for (uint32_t v = 0; v < view.count; ++v)
+			{
+				glm::vec3 p = glm::vec3(MeshUtils::DecodeElement(view.format, view.At(v)));
+				minimum = glm::min(minimum, p);
+				maximum = glm::max(maximum, p);
+			}
 		}
 	}
 
-	//LoadLight(model);
-	
-	std::vector<GameObject*> nodes;
-	for (size_t node_index = 0; node_index < model.nodes.size(); ++node_index)
+	if (gltfMesh.primitives.empty() || minimum.x > maximum.x)
 	{
-		auto gltfNode = model.nodes[node_index];
-		auto node = ParseNode(gltfNode, node_index);
+		return PositionQuantization();
+	}
+
+	return PositionQuantization::FromBounds(minimum, maximum);
+}
+
+/**
+ * @brief Index data as uint16, uint8 indices always fit (core Vulkan has no uint8 index type) and uint32 indices
+ * when every value does. Returns an invalid view when the indices have to stay 32-bit.
+ */
+AccessorView NarrowIndexData(const AccessorView& indexData)
+{
+	const uint32_t count = indexData.count;
+	std::vector<uint8_t> data(static_cast<size_t>(count) * sizeof(uint16_t));
+	uint16_t* dst = reinterpret_cast<uint16_t*>(data.data());
+
+	if (indexData.format == VK_FORMAT_R8_UINT)
+	{
+		if (indexData.IsTightlyPacked())
+		{
+			AccessorConversion::WidenIndices8To16(indexData.Data(), dst, count);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				dst[i] = *indexData.At(i);
+			}
+		}
+	}
+	else
+	{
+		// glTF index buffer views have no stride and their accessors are aligned to 4 bytes
+		if (!indexData.IsTightlyPacked() || !AccessorConversion::NarrowIndices32To16(reinterpret_cast<const uint32_t*>(indexData.Data()), dst, count))
+		{
+			return AccessorView();
+		}
+	}
+
+	return AccessorView::FromData(std::move(data), sizeof(uint16_t), count, VK_FORMAT_R16_UINT);
+}
+
+void ParseCamera(const tinygltf::Camera& gltf_camera, GameObject* go)
+{
+	Camera* camera = go->AddComponent<Camera>();
+
+	if (gltf_camera.type == "perspective")
+	{
+		camera->SetAspectRatio(static_cast<float>(gltf_camera.perspective.aspectRatio));
+		camera->SetFieldOfView(static_cast<float>(gltf_camera.perspective.yfov));
+		camera->SetNearPlane(static_cast<float>(gltf_camera.perspective.znear));
+		camera->SetFarPlane(static_cast<float>(gltf_camera.perspective.zfar));
+	}
+	else
+	{
+		//LOGW("Camera type not supported");
+	}
+}
+
+SubMesh ParsePrimitive(const GltfDocument& document, const tinygltf::Primitive& gltfPrimitive, const std::vector<MaterialHandle>& materials, const GltfImportSettings& settings,
+	const PositionQuantization& positionQuantization, GltfBuildStatistics& statistics)
+{
+	auto& model = document.model;
+
+	SubMesh subMesh;
+	for (auto& attribute : gltfPrimitive.attributes)
+	{
+		std::string attributeName = attribute.first;
+		std::transform(attributeName.begin(), attributeName.end(), attributeName.begin(), ::tolower);
+
+		AccessorView vertexData = GetVertexAttributeData(document, attribute.second, GetVertexSemantic(attributeName));
+		if (attributeName == "position")
+		{
+			subMesh.vertexCount = vertexData.count;
+		}
+
+		VertexAttribute attrib;
+		attrib.format = vertexData.format;
+		attrib.stride = vertexData.stride;
+		subMesh.SetAttribute(attributeName, attrib);
+
+		subMesh.vertexBuffers.insert(std::make_pair(attributeName, std::move(vertexData)));
+	}
+
+	// Morph target deltas travel with the other vertex streams through the passes below
+	for (size_t target = 0; target < gltfPrimitive.targets.size(); ++target)
+	{
+		for (auto& attribute : gltfPrimitive.targets[target])
+		{
+			std::string attributeName = attribute.first;
+			std::transform(attributeName.begin(), attributeName.end(), attributeName.begin(), ::tolower);
+			if (attributeName != "position" && attributeName != "normal" && attributeName != "tangent")
+			{
+				continue;
+			}
+
+			AccessorView deltaData = GetAttributeData(document, attribute.second);
+			if (deltaData.count != subMesh.vertexCount)
+			{
+				throw std::runtime_error("Couldn't load glTF file, morph target " + std::to_string(target) + " has a different vertex count");
+			}
+
+			subMesh.vertexBuffers.insert(std::make_pair(GetMorphStreamName(static_cast<uint32_t>(target), attributeName.c_str()), std::move(deltaData)));
+		}
+	}
+	subMesh.morphTargetCount = static_cast<uint32_t>(gltfPrimitive.targets.size());
+
+	if (gltfPrimitive.indices >= 0)
+	{
+		subMesh.vertexIndices = static_cast<uint32_t>(GetAttributeSize(model.get(), gltfPrimitive.indices));
+
+		auto indexData = GetAttributeData(document, gltfPrimitive.indices);
+
+		// uint16 indices are referenced in place, uint8 and (where the vertex count allows it) uint32 ones are copied
+		switch (indexData.format)
+		{
+		case VK_FORMAT_R8_UINT:
+			indexData = NarrowIndexData(indexData);
+			subMesh.indexType = VK_INDEX_TYPE_UINT16;
+			break;
+		case VK_FORMAT_R16_UINT:
+			subMesh.indexType = VK_INDEX_TYPE_UINT16;
+			break;
+		case VK_FORMAT_R32_UINT:
+			subMesh.indexType = VK_INDEX_TYPE_UINT32;
+			if (settings.narrowIndices && subMesh.vertexCount <= 0x10000)
+			{
+				AccessorView narrowed = NarrowIndexData(indexData);
+				if (narrowed.IsValid())
+				{
+					indexData = std::move(narrowed);
+					subMesh.indexType = VK_INDEX_TYPE_UINT16;
+				}
+			}
+			break;
+		default:
+			throw std::runtime_error("Couldn't load glTF file, indices have to be unsigned integers");
+		}
+
+		subMesh.indexBuffer = std::move(indexData);
+	}
+
+	if (gltfPrimitive.material < 0 || gltfPrimitive.material >= static_cast<int>(materials.size()))
+	{
+		subMesh.material = MaterialTable::GetInstance().GetDefault();
+	}
+	else
+	{
+		subMesh.material = materials[gltfPrimitive.material];
+	}
+
+	const bool isTriangleList = gltfPrimitive.mode == TINYGLTF_MODE_TRIANGLES || gltfPrimitive.mode == -1;
+	if (settings.optimizeMeshes && isTriangleList)
+	{
+		MeshOptimizeStatistics optimize = MeshOptimizer::Optimize(subMesh, settings.overdrawThreshold);
+		const uint32_t triangles = subMesh.vertexIndices / 3;
+		statistics.optimizedTriangles += triangles;
+		statistics.missesBefore += static_cast<double>(optimize.before.acmr) * triangles;
+		statistics.missesAfter += static_cast<double>(optimize.after.acmr) * triangles;
+	}
+
+	if (settings.generateLods && isTriangleList)
+	{
+		MeshSimplifyStatistics simplify = MeshSimplifier::GenerateLods(subMesh, settings.lodRatios);
+		statistics.lodCount += static_cast<uint32_t>(subMesh.lods.size());
+		statistics.simplifiedTriangles += simplify.inputTriangles;
+		statistics.simplifySeconds += simplify.seconds;
+	}
+
+	if (settings.buildMeshlets && isTriangleList)
+	{
+		subMesh.meshlets = MeshletBuilder::Build(subMesh);
+		statistics.meshletCount += MeshletBuilder::GetStatistics(subMesh.meshlets).meshletCount;
+	}
+
+	// Last, the passes above all read float positions in the space they were authored in
+	if (settings.quantizeVertices)
+	{
+		VertexQuantizer::Quantize(subMesh, positionQuantization, settings.octahedralBits);
+	}
+
+	subMesh.layout = VertexLayoutBuilder::Build(subMesh);
+
+	return subMesh;
+}
+
+void AttachMesh(GameObject* go, MeshHandle mesh)
+{
+	MeshRenderer* meshRenderer = go->AddComponent<MeshRenderer>();
+	meshRenderer->SetMesh(mesh);
+
+	if (MeshDeformer* deformer = go->GetComponent<MeshDeformer>())
+	{
+		deformer->Bind(mesh, go->GetComponent<Transform>());
+	}
+}
+
+GameObject* ParseNode(const tinygltf::Node& gltf_node, size_t index)
+{
+	auto node = CreateGameObject(gltf_node.name);
+
+	auto transform = node->AddComponent<Transform>();
+
+	if (!gltf_node.translation.empty())
+	{
+		glm::vec3 translation;
+
+		std::transform(gltf_node.translation.begin(), gltf_node.translation.end(), glm::value_ptr(translation), TypeCast<double, float>{});
+
+		transform->SetTranslation(translation);
+	}
+
+	if (!gltf_node.rotation.empty())
+	{
+		glm::quat rotation;
+
+		std::transform(gltf_node.rotation.begin(), gltf_node.rotation.end(), glm::value_ptr(rotation), TypeCast<double, float>{});
+
+		transform->SetRotation(rotation);
+	}
+
+	if (!gltf_node.scale.empty())
+	{
+		glm::vec3 scale;
+
+		std::transform(gltf_node.scale.begin(), gltf_node.scale.end(), glm::value_ptr(scale), TypeCast<double, float>{});
+
+		transform->SetScale(scale);
+	}
+
+	if (!gltf_node.matrix.empty())
+	{
+		glm::mat4 matrix;
+
+		std::transform(gltf_node.matrix.begin(), gltf_node.matrix.end(), glm::value_ptr(matrix), TypeCast<double, float>{});
+
+		transform->SetMatrix(matrix);
+	}
+
+	return node;
+}
+
+/**
+ * @brief Key of the cooked scene for a source file, the buffers and images it references and the import settings,
+ * 0 when no cooked scene is used
+ */
+inline uint64_t GetCookedSceneHash(const std::string& path, const GltfImportSettings& settings)
+{
+	if (!settings.useCookedScene)
+	{
+		return 0;
+	}
+
+	uint64_t sourceHash = CookedScene::HashSource(path);
+	if (sourceHash == 0)
+	{
+		return 0;
+	}
+
+	std::vector<std::string> references;
+	GltfReader::GetExternalFiles(path.c_str(), references);
+
+	uint64_t key = HashCombine(sourceHash, settings.Hash());
+	for (const std::string& reference : references)
+	{
+		// A missing reference is part of the key too, like in AssetCache::Refresh
+		key = HashCombine(key, CookedScene::HashSource(reference));
+	}
+
+	return key != 0 ? key : 1;
+}
+
+/**
+ * @brief Faults every page of a file into the page cache, false when it cannot be opened
+ */
+inline bool PrefetchFile(const std::string& path)
+{
+	std::shared_ptr<MappedFile> file;
+	try
+	{
+		file = FileSystem::MapFile(path);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
+	}
+
+	const size_t pageSize = 4096;
+	volatile uint8_t sum = 0;
+	for (size_t offset = 0; offset < file->Size(); offset += pageSize)
+	{
+		sum = sum + file->Data()[offset];
+	}
+
+	return true;
+}
+
+Scene* GltfReader::LoadFile(const char* path, const GltfImportSettings& settings)
+{
+	std::string cookedPath = std::string(path) + COOKED_SCENE_EXTENSION;
+	uint64_t sourceHash = GetCookedSceneHash(path, settings);
+	bool useCookedScene = sourceHash != 0;
+
+	if (useCookedScene)
+	{
+		if (Scene* cookedScene = CookedScene::Load(cookedPath, sourceHash))
+		{
+			return cookedScene;
+		}
+	}
+
+	Scene* scene = LoadSource(path, settings);
+	if (scene && useCookedScene)
+	{
+		// A read only asset folder only costs the warm start, the scene itself is fine
+		CookedScene::Write(*scene, sourceHash, cookedPath);
+	}
+
+	return scene;
+}
+
+Scene* GltfReader::LoadSource(const char* path, const GltfImportSettings& settings, GltfImportTimings* timings)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	GltfDocument document;
+	if (!LoadDocument(path, document))
+	{
+		return nullptr;
+	}
+
+	if (timings)
+	{
+		timings->parseSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		timings->decodeStatistics = document.decodeStatistics;
+		start = std::chrono::high_resolution_clock::now();
+	}
+
+	Scene* scene = BuildScene(document, settings, timings ? &timings->buildStatistics : nullptr);
+
+	if (timings)
+	{
+		timings->buildSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	return scene;
+}
+
+/**
+ * @brief Accessor elements decoded to floats, one after the other
+ */
+inline void ReadFloats(const GltfDocument& document, int accessorId, std::vector<float>& values)
+{
+	AccessorView view = GetAttributeData(document, accessorId);
+	const uint32_t componentCount = MeshUtils::GetComponentCount(view.format);
+	if (componentCount == 0)
+	{
+		throw std::runtime_error("Couldn't load glTF file, animation data has an unsupported type");
+	}
+
+	values.resize(static_cast<size_t>(view.count) * componentCount);
+	for (uint32_t i = 0; i < view.count; ++i)
+	{
+		glm::vec4 value = MeshUtils::DecodeElement(view.format, view.At(i));
+		for (uint32_t c = 0; c < componentCount; ++c)
+		{
+			values[static_cast<size_t>(i) * componentCount + c] = value[c];
+		}
+	}
+}
+
+std::shared_ptr<Skin> ParseSkin(const GltfDocument& document, const tinygltf::Skin& gltfSkin, const std::vector<GameObject*>& nodes)
+{
+	std::vector<Transform*> joints;
+	for (int joint : gltfSkin.joints)
+	{
+		if (joint < 0 || joint >= static_cast<int>(nodes.size()))
+		{
+			throw std::runtime_error("Couldn't load glTF file, skin " + gltfSkin.name + " references a missing joint");
+		}
+
+		joints.push_back(nodes[joint]->GetComponent<Transform>());
+	}
+
+	std::vector<glm::mat4> inverseBindMatrices;
+	if (gltfSkin.inverseBindMatrices >= 0)
+	{
+		std::vector<float> values;
+		ReadFloats(document, gltfSkin.inverseBindMatrices, values);
+		if (values.size() < joints.size() * 16)
+		{
+			throw std::runtime_error("Couldn't load glTF file, skin " + gltfSkin.name + " has too few inverse bind matrices");
+		}
+
+		inverseBindMatrices.resize(joints.size());
+		for (size_t j = 0; j < joints.size(); ++j)
+		{
+			inverseBindMatrices[j] = glm::make_mat4(values.data() + j * 16);
+		}
+	}
+
+	return std::make_shared<Skin>(std::move(joints), std::move(inverseBindMatrices));
+}
+
+std::shared_ptr<AnimationClip> ParseAnimation(const GltfDocument& document, const tinygltf::Animation& gltfAnimation, const std::vector<GameObject*>& nodes,
+	const std::vector<MeshDeformer*>& deformers)
+{
+	static const std::unordered_map<std::string, AnimationPath> paths = {
+		{"translation", AnimationPath::Translation}, {"rotation", AnimationPath::Rotation},
+		{"scale", AnimationPath::Scale}, {"weights", AnimationPath::Weights} };
+
+	auto clip = std::make_shared<AnimationClip>(gltfAnimation.name);
+
+	std::vector<float> times;
+	std::vector<float> values;
+	for (auto& gltfChannel : gltfAnimation.channels)
+	{
+		auto path = paths.find(gltfChannel.target_path);
+		if (path == paths.end() || gltfChannel.target_node < 0 || gltfChannel.target_node >= static_cast<int>(nodes.size()) ||
+			gltfChannel.sampler < 0 || gltfChannel.sampler >= static_cast<int>(gltfAnimation.samplers.size()))
+		{
+			continue;
+		}
+
+		auto& gltfSampler = gltfAnimation.samplers[gltfChannel.sampler];
+		AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+		if (gltfSampler.interpolation == "STEP")
+		{
+			interpolation = AnimationInterpolation::Step;
+		}
+		else if (gltfSampler.interpolation == "CUBICSPLINE")
+		{
+			interpolation = AnimationInterpolation::CubicSpline;
+		}
+
+		ReadFloats(document, gltfSampler.input, times);
+		ReadFloats(document, gltfSampler.output, values);
+
+		const uint32_t keyCount = static_cast<uint32_t>(times.size());
+		const size_t valuesPerKey = interpolation == AnimationInterpolation::CubicSpline ? 3 : 1;
+		uint32_t componentCount = path->second == AnimationPath::Rotation ? 4 : 3;
+		if (path->second == AnimationPath::Weights)
+		{
+			componentCount = keyCount > 0 ? static_cast<uint32_t>(values.size() / (keyCount * valuesPerKey)) : 0;
+		}
+
+		if (keyCount == 0 || componentCount == 0 || values.size() < keyCount * valuesPerKey * componentCount)
+		{
+			throw std::runtime_error("Couldn't load glTF file, animation sampler " + std::to_string(gltfChannel.sampler) + " has too few values");
+		}
+
+		if (path->second == AnimationPath::Weights)
+		{
+			// Weights only animate nodes with morph targets
+			if (MeshDeformer* deformer = deformers[gltfChannel.target_node])
+			{
+				clip->AddChannel(clip->AddWeightTarget(deformer), path->second, interpolation, times.data(), keyCount, values.data(), componentCount);
+			}
+			continue;
+		}
+
+		Transform* target = nodes[gltfChannel.target_node]->GetComponent<Transform>();
+		clip->AddChannel(clip->AddTarget(target), path->second, interpolation, times.data(), keyCount, values.data(), componentCount);
+	}
+
+	clip->Finalize();
+	return clip;
+}
+
+/**
+ * @brief Scene nodes of a document with transforms and cameras, built before any mesh is decoded
+ */
+struct GltfHierarchy
+{
+	Scene* scene{ nullptr };
+
+	// Per glTF node, the GameObject that gets the node's MeshRenderer or null for nodes without a mesh
+	std::vector<GameObject*> meshNodes;
+
+	// Per glTF mesh, invalid when the mesh keeps float positions
+	std::vector<PositionQuantization> meshQuantization;
+
+	// Per glTF material
+	std::vector<MaterialHandle> materials;
+
+	// Summed over the animations compressed into the scene
+	ClipCompressionStatistics animationStatistics;
+};
+
+GltfHierarchy BuildHierarchy(const GltfDocument& document, const GltfImportSettings& settings)
+{
+	int scene_index = -1;
+
+	auto& model = document.model;
+
+	//std::string fileName = path;
+	//size_t pos = fileName.find_last_of('/');
+
+	for (auto& usedExtension: model->extensionsUsed)
+	{
+		if (document.enabledExtensions.count(usedExtension) == 0)
+		{
+			if (std::find(model->extensionsRequired.begin(), model->extensionsRequired.end(), usedExtension) != model->extensionsRequired.end())
+			{
+				throw std::runtime_error("Cannot load glTF file. Contains a required unsupported extension: " + usedExtension);
+			}
+		}
+	}
+
+	//LoadLight(document);
+
+	GltfHierarchy hierarchy;
+	hierarchy.meshNodes.resize(model->nodes.size(), nullptr);
+	hierarchy.meshQuantization.resize(model->meshes.size());
+	hierarchy.materials = ParseMaterials(*model);
+
+	std::vector<PositionQuantization>& meshQuantization = hierarchy.meshQuantization;
+	if (settings.quantizeVertices)
+	{
+		for (size_t mesh_index = 0; mesh_index < model->meshes.size(); ++mesh_index)
+		{
+			meshQuantization[mesh_index] = ComputeMeshQuantization(document, model->meshes[mesh_index]);
+		}
+
+		for (const auto& gltfNode : model->nodes)
+		{
+			if (gltfNode.mesh >= 0 && gltfNode.skin >= 0)
+			{
+				meshQuantization[gltfNode.mesh] = PositionQuantization();
+			}
+		}
+	}
+
+	// The transform of an animated node is overwritten, it cannot carry the dequantization
+	std::vector<bool> animatedNodes(model->nodes.size(), false);
+	for (auto& gltfAnimation : model->animations)
+	{
+		for (auto& gltfChannel : gltfAnimation.channels)
+		{
+			if (gltfChannel.target_node >= 0 && gltfChannel.target_node < static_cast<int>(model->nodes.size()) && gltfChannel.target_path != "weights")
+			{
+				animatedNodes[gltfChannel.target_node] = true;
+			}
+		}
+	}
+
+	std::vector<GameObject*> nodes;
+	std::vector<GameObject*> dequantizationNodes;
+	for (size_t node_index = 0; node_index < model->nodes.size(); ++node_index)
+	{
+		const auto& gltfNode = model->nodes[node_index];
+		auto node = ParseNode(gltfNode, node_index);
 
 		if (gltfNode.mesh >= 0)
 		{
-			auto& mesh = model.meshes[gltfNode.mesh];
-			ParseMesh(model, mesh, &(*node));
+			GameObject* meshNode = node;
+
+			// Fold the position dequantization into the transform, through an extra child when it would also scale children
+			// or a camera, or when an animation replaces the transform
+			const PositionQuantization& quantization = meshQuantization[gltfNode.mesh];
+			if (quantization.IsValid())
+			{
+				if (!gltfNode.children.empty() || gltfNode.camera >= 0 || animatedNodes[node_index])
+				{
+					meshNode = CreateGameObject(gltfNode.name + "_Dequantize");
+					Transform* dequantization = meshNode->AddComponent<Transform>();
+					dequantization->SetTranslation(quantization.offset);
+					dequantization->SetScale(glm::vec3(quantization.scale));
+					dequantization->SetParent(node->GetComponent<Transform>());
+					dequantizationNodes.push_back(meshNode);
+				}
+				else
+				{
+					// T * R * S * T(offset) * S(scale) is again a TRS because the dequantization scale is uniform
+					Transform* transform = node->GetComponent<Transform>();
+					transform->SetTranslation(transform->GetTranslation() + transform->GetRotation() * (transform->GetScale() * quantization.offset));
+					transform->SetScale(transform->GetScale() * quantization.scale);
+				}
+			}
+
+			hierarchy.meshNodes[node_index] = meshNode;
+		}
+
+		if (gltfNode.camera >= 0)
+		{
+			auto& camera = model->cameras[gltfNode.camera];
+			ParseCamera(camera, &(*node));
+		}
+
+		/*if (auto extension = get_extension(gltf_node.extensions, KHR_LIGHTS_PUNCTUAL_EXTENSION))
+		{
+			auto& lights = model->lights[gltfNode.light];
+			auto light = lights.at(static_cast<size_t>(extension->Get("light").Get<int>()));
+
+			node->set_component(*light);
+
+			light->set_node(*node);
+		}*/
+
+		nodes.push_back(node);
+	}
+
+	// Load scenes
+	std::queue<std::pair<GameObject*, int>> traverseNodes;
+
+	tinygltf::Scene* gltf_scene{ nullptr };
+
+	if (scene_index >= 0 && scene_index < static_cast<int>(model->scenes.size()))
+	{
+		gltf_scene = &model->scenes[scene_index];
+	}
+	else if (model->defaultScene >= 0 && model->defaultScene < static_cast<int>(model->scenes.size()))
+	{
+		gltf_scene = &model->scenes[model->defaultScene];
+	}
+	else if (model->scenes.size() > 0)
+	{
+		gltf_scene = &model->scenes[0];
+	}
+
+	if (!gltf_scene)
+	{
+		throw std::runtime_error("Couldn't determine which scene to load!");
+	}
+
+	auto rootNode = CreateGameObject(gltf_scene->name);
+	auto rootTransform = rootNode->AddComponent<Transform>();
+
+	for (auto nodeIndex : gltf_scene->nodes)
+	{
+		traverseNodes.push(std::make_pair(&(*rootNode), nodeIndex));
+	}
+
+	while (!traverseNodes.empty())
+	{
+		auto nodeIt = traverseNodes.front();
+		traverseNodes.pop();
+
+		auto& currentNode = *nodes.at(nodeIt.second);
+		auto& traverseRootNode = nodeIt.first;
+
+	 	Transform* currentNodeTransform = currentNode.GetComponent<Transform>();
+		Transform* traverseRootNodeTransform = traverseRootNode->GetComponent<Transform>();
+		currentNodeTransform->SetParent(traverseRootNodeTransform);
+
+		for (auto childNodeIndex : model->nodes[nodeIt.second].children)
+		{
+			traverseNodes.push(std::make_pair(&(currentNode), childNodeIndex));
+		}
+	}
+
+	// Skins need the parents set, their joints may come after the nodes they deform
+	std::vector<std::shared_ptr<Skin>> skins;
+	for (auto& gltfSkin : model->skins)
+	{
+		skins.push_back(ParseSkin(document, gltfSkin, nodes));
+	}
+
+	std::vector<MeshDeformer*> deformers(model->nodes.size(), nullptr);
+	for (size_t node_index = 0; node_index < model->nodes.size(); ++node_index)
+	{
+		const auto& gltfNode = model->nodes[node_index];
+		if (gltfNode.mesh < 0)
+		{
+			continue;
+		}
+
+		const auto& gltfMesh = model->meshes[gltfNode.mesh];
+		const bool skinned = gltfNode.skin >= 0 && gltfNode.skin < static_cast<int>(skins.size());
+		const bool morphed = std::any_of(gltfMesh.primitives.begin(), gltfMesh.primitives.end(), [](const tinygltf::Primitive& primitive) { return !primitive.targets.empty(); });
+		if (!skinned && !morphed)
+		{
+			continue;
+		}
+
+		// Skinned and morphed meshes are never quantized, so the mesh node is the glTF node itself
+		MeshDeformer* deformer = hierarchy.meshNodes[node_index]->AddComponent<MeshDeformer>();
+		if (skinned)
+		{
+			deformer->SetSkin(skins[gltfNode.skin]);
+		}
+
+		const std::vector<double>& weights = gltfNode.weights.empty() ? gltfMesh.weights : gltfNode.weights;
+		deformer->SetWeights(std::vector<float>(weights.begin(), weights.end()));
+
+		deformers[node_index] = deformer;
+	}
+
+	std::vector<std::shared_ptr<AnimationClip>> animations;
+	for (auto& gltfAnimation : model->animations)
+	{
+		animations.push_back(ParseAnimation(document, gltfAnimation, nodes, deformers));
+	}
+
+	nodes.insert(nodes.end(), dequantizationNodes.begin(), dequantizationNodes.end());
+
+	hierarchy.scene = WL_NEW(Scene);
+	for (auto& animation : animations)
+	{
+		if (!settings.compressAnimations)
+		{
+			hierarchy.scene->AddAnimation(animation);
+			continue;
+		}
+
+		ClipCompressionSettings compression;
+		compression.tolerance = settings.animationTolerance;
+
+		ClipCompressionStatistics statistics;
+		hierarchy.scene->AddCompressedAnimation(ClipCompressor::Compress(*animation, compression, &statistics));
+		ClipCompressionStatistics& total = hierarchy.animationStatistics;
+		total.uncompressedBytes += statistics.uncompressedBytes;
+		total.compressedBytes += statistics.compressedBytes;
+		total.uncompressedKeys += statistics.uncompressedKeys;
+		total.compressedKeys += statistics.compressedKeys;
+		total.fullPrecisionChannels += statistics.fullPrecisionChannels;
+	}
+	hierarchy.scene->SetRootNode(rootNode->GetHandle());
+	nodes.push_back(rootNode);
+
+	// Store nodes into the scene
+	std::vector<GameObjectHandle> nodeHandles;
+	nodeHandles.reserve(nodes.size());
+	for (GameObject* node : nodes)
+	{
+		nodeHandles.push_back(node->GetHandle());
+	}
+	hierarchy.scene->SetNodes(std::move(nodeHandles));
+
+	return hierarchy;
+}
+
+inline void HashContent(MeshContentKey& key, uint64_t value)
+{
+	key.hash = HashCombine(key.hash, value);
+	key.verify = HashCombine(key.verify, value);
+}
+
+inline void HashContent(MeshContentKey& key, const void* data, size_t size)
+{
+	key.hash = HashBytes(data, size, key.hash);
+	key.verify = HashBytes(data, size, key.verify);
+}
+
+inline void HashAccessor(const GltfDocument& document, int accessorId, MeshContentKey& key)
+{
+	AccessorView view = GetAttributeData(document, accessorId);
+
+	HashContent(key, view.format);
+	HashContent(key, view.stride);
+	HashContent(key, view.count);
+	if (view.count > 0)
+	{
+		const size_t size = static_cast<size_t>(view.count - 1) * view.stride + GetFormatSize(view.format);
+		HashContent(key, view.Data(), size);
+		key.size += size;
+	}
+}
+
+/**
+ * @brief Key of everything a decoded mesh depends on, the same in every file holding the same mesh
+ */
+MeshContentKey HashMeshContent(const GltfDocument& document, uint32_t meshIndex, const GltfHierarchy& hierarchy, uint64_t settingsHash)
+{
+	MeshContentKey key;
+	key.hash = settingsHash;
+	key.verify = HashCombine(settingsHash, 0x2545f4914f6cdd1dULL);
+
+	const PositionQuantization& quantization = hierarchy.meshQuantization[meshIndex];
+	HashContent(key, &quantization.offset[0], sizeof(float) * 3);
+	HashContent(key, &quantization.scale, sizeof(float));
+
+	HashContent(key, document.model->meshes[meshIndex].primitives.size());
+	for (auto& gltfPrimitive : document.model->meshes[meshIndex].primitives)
+	{
+		HashContent(key, static_cast<uint64_t>(gltfPrimitive.mode + 1));
+
+		const bool hasMaterial = gltfPrimitive.material >= 0 && gltfPrimitive.material < static_cast<int>(hierarchy.materials.size());
+		HashContent(key, hasMaterial ? hierarchy.materials[gltfPrimitive.material].id : MaterialTable::GetInstance().GetDefault().id);
+
+		// Counts and indices first, so the attributes of neighbouring primitives and targets cannot trade places
+		HashContent(key, gltfPrimitive.attributes.size());
+		for (auto& attribute : gltfPrimitive.attributes)
+		{
+			HashContent(key, attribute.first.size());
+			HashContent(key, attribute.first.data(), attribute.first.size());
+			HashAccessor(document, attribute.second, key);
+		}
+
+		HashContent(key, gltfPrimitive.targets.size());
+		for (size_t targetIndex = 0; targetIndex < gltfPrimitive.targets.size(); ++targetIndex)
+		{
+			const auto& target = gltfPrimitive.targets[targetIndex];
+			HashContent(key, targetIndex);
+			HashContent(key, target.size());
+			for (auto& attribute : target)
+			{
+				HashContent(key, attribute.first.size());
+				HashContent(key, attribute.first.data(), attribute.first.size());
+				HashAccessor(document, attribute.second, key);
+			}
+		}
+
+		if (gltfPrimitive.indices >= 0)
+		{
+			HashAccessor(document, gltfPrimitive.indices, key);
+		}
+		else
+		{
+			HashContent(key, 0);
+		}
+	}
+
+	return key;
+}
+
+/**
+ * @brief Mesh already decoded from this source or with the same content, content is set when there is none
+ * A found mesh comes with a reference for the caller, like every handle the MeshRegistry returns.
+ */
+MeshHandle FindRegisteredMesh(const GltfDocument& document, uint32_t meshIndex, const GltfHierarchy& hierarchy, uint64_t settingsHash, MeshContentKey& content)
+{
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	MeshHandle mesh = registry.FindSource(document.path, meshIndex, settingsHash);
+	if (mesh.IsValid())
+	{
+		return mesh;
+	}
+
+	content = HashMeshContent(document, meshIndex, hierarchy, settingsHash);
+	mesh = registry.FindContent(content);
+	if (mesh.IsValid())
+	{
+		return registry.Register(document.path, meshIndex, settingsHash, content, mesh);
+	}
+
+	return MeshHandle();
+}
+
+/**
+ * @brief Decodes a glTF mesh, or reuses the registered one, and returns the shared Mesh with a reference for the caller
+ */
+MeshHandle LoadMeshInstance(const GltfDocument& document, uint32_t meshIndex, const GltfHierarchy& hierarchy, const GltfImportSettings& settings)
+{
+	const uint64_t settingsHash = settings.Hash();
+
+	MeshContentKey content;
+	MeshHandle registered = FindRegisteredMesh(document, meshIndex, hierarchy, settingsHash, content);
+	if (registered.IsValid())
+	{
+		return registered;
+	}
+
+	Mesh mesh;
+	GltfBuildStatistics statistics;
+	for (auto& gltfPrimitive : document.model->meshes[meshIndex].primitives)
+	{
+		mesh.AddSubmesh(ParsePrimitive(document, gltfPrimitive, hierarchy.materials, settings, hierarchy.meshQuantization[meshIndex], statistics));
+	}
+
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	return registry.Register(document.path, meshIndex, settingsHash, content, registry.Create(std::move(mesh)));
+}
+
+Scene* GltfReader::BuildScene(const GltfDocument& document, const GltfImportSettings& settings, GltfBuildStatistics* statistics)
+{
+	auto& model = document.model;
+
+	GltfHierarchy hierarchy = BuildHierarchy(document, settings);
+	const uint64_t settingsHash = settings.Hash();
+
+	// Every glTF mesh the nodes use is looked up once, nodes instancing the same mesh share it
+	std::vector<uint32_t> usedMeshes;
+	std::vector<bool> meshUsed(model->meshes.size(), false);
+	for (const auto& gltfNode : model->nodes)
+	{
+		if (gltfNode.mesh >= 0 && !meshUsed[gltfNode.mesh])
+		{
+			meshUsed[gltfNode.mesh] = true;
+			usedMeshes.push_back(static_cast<uint32_t>(gltfNode.mesh));
+		}
+	}
+
+	std::vector<MeshHandle> meshes(model->meshes.size());
+	std::vector<MeshContentKey> contents(model->meshes.size());
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	uint32_t decodedMeshes = 0;
+	try
+	{
+		JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(usedMeshes.size()), 1, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					const uint32_t mesh_index = usedMeshes[i];
+					meshes[mesh_index] = FindRegisteredMesh(document, mesh_index, hierarchy, settingsHash, contents[mesh_index]);
+				}
+			});
+
+		// Meshes of this file with the same content as an earlier one are not decoded, they share its mesh
+		std::vector<int32_t> firstWithContent(model->meshes.size(), -1);
+		std::unordered_map<uint64_t, uint32_t> contentMeshes;
+		for (uint32_t mesh_index : usedMeshes)
+		{
+			if (!meshes[mesh_index].IsValid())
+			{
+				auto first = contentMeshes.emplace(contents[mesh_index].hash, mesh_index).first;
+				if (first->second != mesh_index && contents[first->second] == contents[mesh_index])
+				{
+					firstWithContent[mesh_index] = static_cast<int32_t>(first->second);
+				}
+			}
+		}
+
+		// Decode the primitives of the meshes seen for the first time on the job pool. Every primitive writes
+		// its own slot and the slots are gathered in mesh order, so the result does not depend on the thread count.
+		std::vector<const tinygltf::Primitive*> primitives;
+		std::vector<uint32_t> primitiveMeshes;
+		for (uint32_t mesh_index : usedMeshes)
+		{
+			if (!meshes[mesh_index].IsValid() && firstWithContent[mesh_index] < 0)
+			{
+				for (auto& gltfPrimitive : model->meshes[mesh_index].primitives)
+				{
+					primitives.push_back(&gltfPrimitive);
+					primitiveMeshes.push_back(mesh_index);
+				}
+			}
+		}
+
+		std::vector<SubMesh> subMeshes(primitives.size());
+		std::vector<GltfBuildStatistics> primitiveStatistics(primitives.size());
+		JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(primitives.size()), kPrimitiveBatchSize, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; ++i)
+				{
+					subMeshes[i] = ParsePrimitive(document, *primitives[i], hierarchy.materials, settings, hierarchy.meshQuantization[primitiveMeshes[i]], primitiveStatistics[i]);
+				}
+			});
+
+		if (statistics)
+		{
+			*statistics = GltfBuildStatistics();
+			for (const GltfBuildStatistics& primitive : primitiveStatistics)
+			{
+				statistics->optimizedTriangles += primitive.optimizedTriangles;
+				statistics->missesBefore += primitive.missesBefore;
+				statistics->missesAfter += primitive.missesAfter;
+				statistics->lodCount += primitive.lodCount;
+				statistics->simplifiedTriangles += primitive.simplifiedTriangles;
+				statistics->simplifySeconds += primitive.simplifySeconds;
+				statistics->meshletCount += primitive.meshletCount;
+			}
+			statistics->decodedPrimitives = static_cast<uint32_t>(primitives.size());
+		}
+
+		for (size_t i = 0; i < primitives.size();)
+		{
+			const uint32_t mesh_index = primitiveMeshes[i];
+
+			Mesh mesh;
+			for (; i < primitives.size() && primitiveMeshes[i] == mesh_index; ++i)
+			{
+				mesh.AddSubmesh(std::move(subMeshes[i]));
+			}
+
+			meshes[mesh_index] = registry.Register(document.path, mesh_index, settingsHash, contents[mesh_index], registry.Create(std::move(mesh)));
+			++decodedMeshes;
+		}
+
+		for (uint32_t mesh_index : usedMeshes)
+		{
+			if (firstWithContent[mesh_index] >= 0)
+			{
+				meshes[mesh_index] = registry.Register(document.path, mesh_index, settingsHash, contents[mesh_index], registry.Share(meshes[firstWithContent[mesh_index]]));
+			}
+		}
+	}
+	catch (...)
+	{
+		// A malformed primitive, the meshes found or decoded so far and the half built scene go with it
+		for (MeshHandle mesh : meshes)
+		{
+			registry.Release(mesh);
+		}
+		WL_DELETE(hierarchy.scene);
+		throw;
+	}
+
+	uint32_t instances = 0;
+	for (size_t node_index = 0; node_index < model->nodes.size(); ++node_index)
+	{
+		if (GameObject* meshNode = hierarchy.meshNodes[node_index])
+		{
+			AttachMesh(meshNode, meshes[model->nodes[node_index].mesh]);
+			++instances;
+		}
+	}
+
+	// The scene keeps the references the lookups took, one per used mesh
+	for (uint32_t mesh_index : usedMeshes)
+	{
+		hierarchy.scene->AddMesh(meshes[mesh_index]);
+	}
+
+	if (statistics)
+	{
+		statistics->instances = instances;
+		statistics->usedMeshes = static_cast<uint32_t>(usedMeshes.size());
+		statistics->decodedMeshes = decodedMeshes;
+		statistics->animations = hierarchy.animationStatistics;
+	}
+
+	return hierarchy.scene;
+}
+
+GltfLoadHandle GltfReader::LoadFileAsync(const char* path, const GltfImportSettings& settings, const GltfStreamSettings& stream)
+{
+	GltfLoadHandle load = std::make_shared<GltfAsyncLoad>(path);
+
+	JobSystem::GetInstance().Submit([load, settings, stream]
+		{
+			StreamFile(load, settings, stream);
+		});
+
+	return load;
+}
+
+void GltfReader::StreamFile(GltfLoadHandle load, const GltfImportSettings& settings, const GltfStreamSettings& stream)
+{
+	JobSystem& jobSystem = JobSystem::GetInstance();
+	const std::string& path = load->GetPath();
+
+	std::string cookedPath = path + COOKED_SCENE_EXTENSION;
+	uint64_t sourceHash = GetCookedSceneHash(path, settings);
+	if (sourceHash != 0)
+	{
+		// A cooked scene is mapped as a whole, there is nothing left to stream
+		if (Scene* cookedScene = CookedScene::Load(cookedPath, sourceHash))
+		{
+			jobSystem.SubmitToMainThread([load, stream, cookedScene]
+				{
+					load->PublishHierarchy(cookedScene, 0, stream);
+					load->Finish(GltfLoadState::Complete, stream);
+				});
+			return;
+		}
+	}
+
+	// Shared with the mesh jobs, which outlive this one
+	auto document = std::make_shared<GltfDocument>();
+	auto hierarchy = std::make_shared<GltfHierarchy>();
+	try
+	{
+		if (!LoadDocument(path.c_str(), *document))
+		{
+			jobSystem.SubmitToMainThread([load, stream] { load->Finish(GltfLoadState::Failed, stream); });
+			return;
+		}
+
+		*hierarchy = BuildHierarchy(*document, settings);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Failed to load " << path << ": " << e.what() << std::endl;
+		jobSystem.SubmitToMainThread([load, stream] { load->Finish(GltfLoadState::Failed, stream); });
+		return;
+	}
+
+	std::vector<uint32_t> streamOrder;
+	for (uint32_t node_index = 0; node_index < hierarchy->meshNodes.size(); ++node_index)
+	{
+		if (hierarchy->meshNodes[node_index])
+		{
+			streamOrder.push_back(node_index);
 		}
+	}
 
-		if (gltfNode.camera >= 0)
+	if (stream.order == GltfStreamOrder::CameraDistance)
+	{
+		std::vector<float> distances(hierarchy->meshNodes.size(), 0.0f);
+		// The nodes are not in an update yet, their world matrices come from the local transforms
+		for (uint32_t node_index : streamOrder)
 		{
-			auto& camera = model.cameras[gltfNode.camera];
-			ParseCamera(camera, &(*node));
+			distances[node_index] = glm::distance(stream.viewPosition, glm::vec3(hierarchy->meshNodes[node_index]->GetComponent<Transform>()->ComputeWorldMatrix()[3]));
 		}
 
-		/*if (auto extension = get_extension(gltf_node.extensions, KHR_LIGHTS_PUNCTUAL_EXTENSION))
+		std::stable_sort(streamOrder.begin(), streamOrder.end(), [&](uint32_t a, uint32_t b) { return distances[a] < distances[b]; });
+	}
+
+	// Until here nothing else could see the scene, from now on only the main thread touches it
+	Scene* scene = hierarchy->scene;
+	const uint32_t meshNodeCount = static_cast<uint32_t>(streamOrder.size());
+	jobSystem.SubmitToMainThread([load, stream, scene, meshNodeCount]
 		{
-			auto& lights = model.lights[gltfNode.light];
-			auto light = lights.at(static_cast<size_t>(extension->Get("light").Get<int>()));
+			load->PublishHierarchy(scene, meshNodeCount, stream);
+			if (meshNodeCount == 0)
+			{
+				load->Finish(GltfLoadState::Complete, stream);
+			}
+		});
 
-			node->set_component(*light);
+	// One job per glTF mesh, in the order of its first node in the stream. The job queue is FIFO, submitting in
+	// stream order is what prioritizes the nodes. All nodes instancing a mesh are published together.
+	auto meshInstances = std::make_shared<std::vector<std::vector<GameObject*>>>(document->model->meshes.size());
+	std::vector<uint32_t> meshOrder;
+	for (uint32_t node_index : streamOrder)
+	{
+		const uint32_t mesh_index = static_cast<uint32_t>(document->model->nodes[node_index].mesh);
+		if ((*meshInstances)[mesh_index].empty())
+		{
+			meshOrder.push_back(mesh_index);
+		}
+		(*meshInstances)[mesh_index].push_back(hierarchy->meshNodes[node_index]);
+	}
 
-			light->set_node(*node);
-		}*/
+	for (uint32_t mesh_index : meshOrder)
+	{
+		jobSystem.Submit([load, settings, stream, document, hierarchy, meshInstances, mesh_index, sourceHash, cookedPath]
+			{
+				MeshHandle mesh;
+				try
+				{
+					mesh = LoadMeshInstance(*document, mesh_index, *hierarchy, settings);
+				}
+				catch (const std::exception& e)
+				{
+					std::cerr << "Failed to load mesh " << document->model->meshes[mesh_index].name << " in " << load->GetPath() << ": " << e.what() << std::endl;
+				}
 
-		nodes.push_back(node);
+				JobSystem::GetInstance().SubmitToMainThread([load, stream, hierarchy, meshInstances, mesh_index, mesh, sourceHash, cookedPath]
+					{
+						// A failed mesh ends the load, later meshes are dropped
+						if (load->IsDone())
+						{
+							MeshRegistry::GetInstance().Release(mesh);
+							return;
+						}
+
+						if (!mesh.IsValid())
+						{
+							load->Finish(GltfLoadState::Failed, stream);
+							return;
+						}
+
+						for (GameObject* meshNode : (*meshInstances)[mesh_index])
+						{
+							AttachMesh(meshNode, mesh);
+							load->PublishNode(meshNode, stream);
+						}
+						hierarchy->scene->AddMesh(mesh);
+
+						if (load->GetLoadedMeshNodeCount() < load->GetMeshNodeCount())
+						{
+							return;
+						}
+
+						if (sourceHash != 0)
+						{
+							CookedScene::Write(*hierarchy->scene, sourceHash, cookedPath);
+						}
+
+						load->Finish(GltfLoadState::Complete, stream);
+					});
+			});
 	}
+}
 
-	// Load scenes
-	std::queue<std::pair<GameObject*, int>> traverseNodes;
+GltfBatchHandle GltfReader::LoadFilesAsync(const std::vector<std::string>& paths, const GltfImportSettings& settings, const GltfBatchSettings& batch)
+{
+	GltfBatchHandle load = std::make_shared<GltfBatchLoad>(paths);
 
-	tinygltf::Scene* gltf_scene{ nullptr };
+	JobSystem::GetInstance().Submit([load, settings, batch]
+		{
+			LoadBatch(load, settings, batch);
+		}, &load->m_Group);
+
+	return load;
+}
+
+std::vector<Scene*> GltfReader::LoadFiles(const std::vector<std::string>& paths, const GltfImportSettings& settings, const GltfBatchSettings& batch)
+{
+	GltfBatchHandle load = LoadFilesAsync(paths, settings, batch);
+	load->Wait();
+	return load->GetScenes();
+}
+
+void GltfReader::LoadBatch(GltfBatchHandle load, const GltfImportSettings& settings, const GltfBatchSettings& batch)
+{
+	// Reads block on the disk and not on a core, so they get their own thread instead of a worker. It runs even
+	// without workers, then the reads of the next files overlap the decode of this one on the calling thread.
+	load->m_ReadThread = std::thread([&] { ReadBatchFiles(*load, settings, batch); });
+
+	JobSystem::GetInstance().ParallelFor(load->GetFileCount(), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t index = begin; index < end; ++index)
+			{
+				LoadBatchFile(*load, index, settings);
+			}
+		});
+
+	load->m_ReadThread.join();
+	load->Finish();
+}
+
+void GltfReader::ReadBatchFiles(GltfBatchLoad& load, const GltfImportSettings& settings, const GltfBatchSettings& batch)
+{
+	for (uint32_t index = 0; index < load.GetFileCount(); ++index)
+	{
+		load.WaitForReadSlot(index, batch.readAhead);
+
+		const auto start = std::chrono::high_resolution_clock::now();
+		const std::string& path = load.GetFiles()[index].path;
 
-	if (scene_index >= 0 && scene_index < static_cast<int>(model.scenes.size()))
+		// Hashing reads the whole source, for a cooked scene that is the only other file the load maps
+		uint64_t sourceHash = GetCookedSceneHash(path, settings);
+		bool cooked = sourceHash != 0 && PrefetchFile(path + COOKED_SCENE_EXTENSION);
+		if (sourceHash == 0)
+		{
+			PrefetchFile(path);
+		}
+
+		load.FinishRead(index, sourceHash, cooked, start);
+	}
+}
+
+void GltfReader::LoadBatchFile(GltfBatchLoad& load, uint32_t index, const GltfImportSettings& settings)
+{
+	bool cooked = false;
+	const uint64_t sourceHash = load.WaitForRead(index, cooked);
+
+	GltfBatchFile& file = load.m_Files[index];
+	const std::string cookedPath = file.path + COOKED_SCENE_EXTENSION;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	if (cooked)
 	{
-		gltf_scene = &model.scenes[scene_index];
+		if (Scene* cookedScene = CookedScene::Load(cookedPath, sourceHash))
+		{
+			file.scene = cookedScene;
+			load.FinishStage(index, GltfBatchStage::Parse, start);
+			load.FinishStage(index, GltfBatchStage::Build, start);
+			return;
+		}
+
+		// A stale cooked scene, its rejected load counts towards parsing the source
+		file.cooked = false;
 	}
-	else if (model.defaultScene >= 0 && model.defaultScene < static_cast<int>(model.scenes.size()))
+
+	GltfBatchStage stage = GltfBatchStage::Parse;
+	try
 	{
-		gltf_scene = &model.scenes[model.defaultScene];
+		GltfDocument document;
+		if (!LoadDocument(file.path.c_str(), document))
+		{
+			std::cerr << "Failed to load " << file.path << std::endl;
+			load.Fail(index, stage);
+			return;
+		}
+		load.FinishStage(index, stage, start);
+
+		stage = GltfBatchStage::Build;
+		start = std::chrono::high_resolution_clock::now();
+		file.scene = BuildScene(document, settings);
+		if (sourceHash != 0)
+		{
+			CookedScene::Write(*file.scene, sourceHash, cookedPath);
+		}
+		load.FinishStage(index, stage, start);
 	}
-	else if (model.scenes.size() > 0)
+	catch (const std::exception& e)
 	{
-		gltf_scene = &model.scenes[0];
+		std::cerr << "Failed to load " << file.path << ": " << e.what() << std::endl;
+		load.Fail(index, stage);
 	}
+}
 
-	if (!gltf_scene)
+bool GltfReader::GetExternalFiles(const char* path, std::vector<std::string>& files)
+{
+	std::shared_ptr<MappedFile> file;
+	try
 	{
-		throw std::runtime_error("Couldn't determine which scene to load!");
+		file = FileSystem::MapFile(path);
+	}
+	catch (const std::runtime_error&)
+	{
+		return false;
 	}
 
-	auto rootNode = WL_NEW(GameObject)(gltf_scene->name);
-	auto rootTransform = rootNode->GetComponent<Transform>();
+	const uint8_t* jsonChunk = file->Data();
+	size_t jsonSize = file->Size();
+	if (IsBinaryFile(path))
+	{
+		std::string err;
+		const uint8_t* binChunk = nullptr;
+		size_t binSize = 0;
+		jsonChunk = nullptr;
+		if (!FindGlbChunks(file->Data(), file->Size(), jsonChunk, jsonSize, binChunk, binSize, err))
+		{
+			return false;
+		}
+	}
 
-	for (auto nodeIndex : gltf_scene->nodes)
+	nlohmann::json json = nlohmann::json::parse(jsonChunk, jsonChunk + jsonSize, nullptr, false);
+	if (json.is_discarded())
 	{
-		traverseNodes.push(std::make_pair(&(*rootNode), nodeIndex));
+		return false;
 	}
 
-	while (!traverseNodes.empty())
+	std::string baseDir = path;
+	size_t separator = baseDir.find_last_of("/\\");
+	baseDir = separator == std::string::npos ? std::string() : baseDir.substr(0, separator + 1);
+
+	for (const char* property : { "buffers", "images" })
 	{
-		auto nodeIt = traverseNodes.front();
-		traverseNodes.pop();
+		if (!json.contains(property))
+		{
+			continue;
+		}
 
-		auto& currentNode = *nodes.at(nodeIt.second);
-		auto& traverseRootNode = nodeIt.first;
+		for (const auto& item : json[property])
+		{
+			if (!item.contains("uri") || !item["uri"].is_string())
+			{
+				continue;
+			}
 
-	 	Transform* currentNodeTransform = currentNode.GetComponent<Transform>();
-		Transform* traverseRootNodeTransform = currentNode.GetComponent<Transform>();
-		currentNodeTransform->SetParent(traverseRootNodeTransform);
+			const std::string uri = item["uri"].get<std::string>();
+			if (uri.compare(0, 5, "data:") != 0)
+			{
+				files.push_back(baseDir + DecodeUri(uri));
+			}
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+	return true;
+}
+
+bool GltfReader::LoadDocument(const char* path, GltfDocument& document)
+{
+	std::string err;
+	std::string warn;
+
+	document.path = path;
 
-		for (auto childNodeIndex : model.nodes[nodeIt.second].children)
+	if (IsBinaryFile(path))
+	{
+		if (!LoadBinaryDocument(path, document, err, warn))
 		{
-			traverseNodes.push(std::make_pair(&(currentNode), childNodeIndex));
+			return false;
 		}
 	}
+	else
+	{
+		std::shared_ptr<MappedFile> file;
+		try
+		{
+			file = FileSystem::MapFile(path);
+		}
+		catch (const std::runtime_error&)
+		{
+			return false;
+		}
 
-	scene->SetRootNode(rootNode);
-	nodes.push_back(std::move(rootNode));
+		// Fallback buffers of compressed files have no uri, only those files need their JSON patched
+		const char* text = reinterpret_cast<const char*>(file->Data());
+		const std::string extension = EXT_MESHOPT_COMPRESSION_EXTENSION;
+		if (std::search(text, text + file->Size(), extension.begin(), extension.end()) != text + file->Size())
+		{
+			nlohmann::json json = nlohmann::json::parse(text, text + file->Size(), nullptr, false);
+			if (json.is_discarded())
+			{
+				return false;
+			}
 
-	// Store nodes into the scene
-	scene->SetNodes(std::move(nodes));
+			PatchMeshoptFallbackBuffers(json);
 
-	return scene;
+			if (!ParseJsonDocument(json, path, document, err, warn))
+			{
+				return false;
+			}
+		}
+		else if (!ParseJsonText(text, file->Size(), path, document, err, warn))
+		{
+			return false;
+		}
+
+		for (auto& buffer : document.model->buffers)
+		{
+			document.buffers.push_back({ buffer.data.data(), buffer.data.size(), document.model });
+		}
+	}
+
+	if (!err.empty())
+	{
+		return false;
+	}
+
+	if (!warn.empty())
+	{
+		return false;
+	}
+
+	for (auto& usedExtension : document.model->extensionsUsed)
+	{
+		if (supportedExtensions.count(usedExtension) != 0)
+		{
+			document.enabledExtensions.insert(usedExtension);
+		}
+	}
+
+	if (!DecodeCompressedBufferViews(document, err))
+	{
+		std::cerr << "Failed to decode " << path << ": " << err << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool GltfReader::DecodeCompressedBufferViews(GltfDocument& document, std::string& err)
+{
+	struct CompressedBufferView
+	{
+		size_t bufferView;
+		const uint8_t* source;
+		size_t sourceSize;
+		size_t count;
+		size_t byteStride;
+		MeshoptMode mode;
+		MeshoptFilter filter;
+		size_t offset;
+	};
+
+	auto& model = document.model;
+
+	std::vector<CompressedBufferView> compressed;
+	size_t decodedSize = 0;
+	for (size_t view_index = 0; view_index < model->bufferViews.size(); ++view_index)
+	{
+		const auto& bufferView = model->bufferViews[view_index];
+		auto extension = bufferView.extensions.find(EXT_MESHOPT_COMPRESSION_EXTENSION);
+		if (extension == bufferView.extensions.end())
+		{
+			continue;
+		}
+
+		const tinygltf::Value& meshopt = extension->second;
+		if (!meshopt.Has("buffer") || !meshopt.Has("byteLength") || !meshopt.Has("byteStride") || !meshopt.Has("count") || !meshopt.Has("mode"))
+		{
+			err = "Incomplete " EXT_MESHOPT_COMPRESSION_EXTENSION " bufferView " + std::to_string(view_index);
+			return false;
+		}
+
+		CompressedBufferView view;
+		view.bufferView = view_index;
+		view.count = static_cast<size_t>(meshopt.Get("count").GetNumberAsInt());
+		view.byteStride = static_cast<size_t>(meshopt.Get("byteStride").GetNumberAsInt());
+		view.mode = GetMeshoptMode(meshopt.Get("mode").Get<std::string>());
+		view.filter = meshopt.Has("filter") ? GetMeshoptFilter(meshopt.Get("filter").Get<std::string>()) : MeshoptFilter::None;
+
+		size_t buffer = static_cast<size_t>(meshopt.Get("buffer").GetNumberAsInt());
+		size_t byteOffset = meshopt.Has("byteOffset") ? static_cast<size_t>(meshopt.Get("byteOffset").GetNumberAsInt()) : 0;
+		view.sourceSize = static_cast<size_t>(meshopt.Get("byteLength").GetNumberAsInt());
+		if (buffer >= document.buffers.size() || byteOffset + view.sourceSize > document.buffers[buffer].size)
+		{
+			err = "Compressed bufferView " + std::to_string(view_index) + " is outside of its buffer";
+			return false;
+		}
+		view.source = document.buffers[buffer].data + byteOffset;
+
+		// Keep every decoded view 16 byte aligned inside the shared allocation
+		view.offset = decodedSize;
+		decodedSize += (view.count * view.byteStride + 15) & ~size_t(15);
+
+		compressed.push_back(view);
+	}
+
+	if (compressed.empty())
+	{
+		return true;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+
+	// One allocation backs all decoded views, which are independent and decoded on the job pool
+	auto decoded = std::make_shared<std::vector<uint8_t>>(decodedSize);
+	std::atomic<bool> failed{ false };
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(compressed.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const CompressedBufferView& view = compressed[i];
+				if (!MeshoptDecoder::Decode(decoded->data() + view.offset, view.count, view.byteStride, view.source, view.sourceSize, view.mode, view.filter))
+				{
+					failed.store(true, std::memory_order_relaxed);
+				}
+			}
+		});
+
+	if (failed.load())
+	{
+		err = "Malformed " EXT_MESHOPT_COMPRESSION_EXTENSION " data";
+		return false;
+	}
+
+	// Accessors keep addressing the bufferView, which now lives in the decoded buffer
+	uint32_t decodedBuffer = static_cast<uint32_t>(document.buffers.size());
+	document.buffers.push_back({ decoded->data(), decoded->size(), decoded });
+
+	GltfDecodeStatistics& statistics = document.decodeStatistics;
+	for (const CompressedBufferView& view : compressed)
+	{
+		auto& bufferView = model->bufferViews[view.bufferView];
+		bufferView.buffer = static_cast<int>(decodedBuffer);
+		bufferView.byteOffset = view.offset;
+		bufferView.byteLength = view.count * view.byteStride;
+
+		statistics.compressedBytes += view.sourceSize;
+		statistics.decodedBytes += view.count * view.byteStride;
+	}
+	statistics.bufferViews = compressed.size();
+	statistics.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return true;
+}
+
+bool GltfReader::LoadBinaryDocument(const char* path, GltfDocument& document, std::string& err, std::string& warn)
+{
+	// The BIN chunk is never handed to tinygltf, which would copy it into tinygltf::Buffer::data.
+	// Only the JSON chunk is parsed, with the embedded buffer replaced by an empty one, and accessors
+	// of buffer 0 then point straight into the mapping.
+	std::shared_ptr<MappedFile> file;
+	try
+	{
+		file = FileSystem::MapFile(path);
+	}
+	catch (const std::runtime_error& e)
+	{
+		err = e.what();
+		return false;
+	}
+
+	const uint8_t* jsonChunk = nullptr;
+	size_t jsonSize = 0;
+	const uint8_t* binChunk = nullptr;
+	size_t binSize = 0;
+	if (!FindGlbChunks(file->Data(), file->Size(), jsonChunk, jsonSize, binChunk, binSize, err))
+	{
+		return false;
+	}
+
+	nlohmann::json json = nlohmann::json::parse(jsonChunk, jsonChunk + jsonSize, nullptr, false);
+	if (json.is_discarded())
+	{
+		err = "Failed to parse the GLB JSON chunk";
+		return false;
+	}
+
+	nlohmann::json* binaryBuffer = nullptr;
+	if (json.contains("buffers") && json["buffers"].size() > 0 && !json["buffers"][size_t(0)].contains("uri"))
+	{
+		binaryBuffer = &json["buffers"][size_t(0)];
+	}
+
+	bool embeddedBuffer = binaryBuffer != nullptr;
+	if (embeddedBuffer)
+	{
+		if (!binChunk || binaryBuffer->value("byteLength", size_t(0)) > binSize)
+		{
+			err = "GLB BIN chunk is missing or too small";
+			return false;
+		}
+
+		(*binaryBuffer)["uri"] = "data:application/octet-stream;base64,";
+		(*binaryBuffer)["byteLength"] = 0;
+
+		// Images are not loaded by the engine yet, drop the ones stored in the BIN chunk so tinygltf never reads from it
+		if (json.contains("images"))
+		{
+			json.erase("images");
+		}
+	}
+
+	PatchMeshoptFallbackBuffers(json);
+
+	if (!ParseJsonDocument(json, path, document, err, warn))
+	{
+		return false;
+	}
+
+	for (auto& buffer : document.model->buffers)
+	{
+		document.buffers.push_back({ buffer.data.data(), buffer.data.size(), document.model });
+	}
+
+	if (embeddedBuffer)
+	{
+		document.buffers[0] = { binChunk, binSize, file };
+	}
+
+	return true;
 }
 
-void GltfReader::LoadLight(tinygltf::Model& model)
+void GltfReader::LoadLight(const GltfDocument& document)
 {
-	if (IsExtensionEnabled(KHR_LIGHTS_PUNCTUAL_EXTENSION))
+	tinygltf::Model& model = *document.model;
+	if (IsExtensionEnabled(document, KHR_LIGHTS_PUNCTUAL_EXTENSION))
 	{
 		if (model.extensions.find(KHR_LIGHTS_PUNCTUAL_EXTENSION) == model.extensions.end() || !model.extensions.at(KHR_LIGHTS_PUNCTUAL_EXTENSION).Has("lights"))
 		{
@@ -602,85 +2372,32 @@ void GltfReader::LoadLight(tinygltf::Model& model)
 	}
 }
 
-void GltfReader::LoadMesh(tinygltf::Model& model)
+std::vector<MeshHandle> GltfReader::LoadMesh(const GltfDocument& document, const GltfImportSettings& settings)
 {
-	auto defaultMaterial = CreateDefaultMaterial();
+	GltfHierarchy hierarchy;
+	hierarchy.materials = ParseMaterials(*document.model);
+	hierarchy.meshQuantization.resize(document.model->meshes.size());
 
-	for (auto& gltfMesh : model.meshes)
+	std::vector<MeshHandle> meshes;
+	try
 	{
-		Mesh* mesh = WL_NEW(Mesh);
-		for (auto& gltfPrimitive : gltfMesh.primitives)
+		for (uint32_t mesh_index = 0; mesh_index < document.model->meshes.size(); ++mesh_index)
 		{
-			SubMesh subMesh;
-
-			for (auto& attribute : gltfPrimitive.attributes)
-			{
-				std::string attributeName = attribute.first;
-				std::transform(attributeName.begin(), attributeName.end(), attributeName.begin(), ::tolower);
-
-				uint32_t accessorId = attribute.second;
-				std::vector<uint8_t> vertexData = GetAttributeData(&model, attribute.second);
-				if (attributeName == "position")
-				{
-					subMesh.vertexCount = model.accessors.at(attribute.second).count;
-				}
-				subMesh.vertexBuffers.insert(std::make_pair(attributeName, std::move(vertexData)));
-
-				VertexAttribute attrib;
-				attrib.format = GetAttributeFormat(&model, attribute.second);
-				attrib.stride = GetAttributeStride(&model, attribute.second);
-				subMesh.SetAttribute(attributeName, attrib);
-			}
-
-			if (gltfPrimitive.indices >= 0)
-			{
-				subMesh.vertexIndices = GetAttributeSize(&model, gltfPrimitive.indices);
-
-				auto format = GetAttributeFormat(&model, gltfPrimitive.indices);
-				auto indexData = GetAttributeData(&model, gltfPrimitive.indices);
-
-				switch (format)
-				{
-				case VK_FORMAT_R8_UINT:
-					// Converts uint8 data into uint16 data, still represented by a uint8 vector
-					//indexData = convert_underlying_data_stride(index_data, 1, 2);
-					//submesh->index_type = VK_INDEX_TYPE_UINT16;
-					
-					break;
-				case VK_FORMAT_R16_UINT:
-					subMesh.indexType = VK_INDEX_TYPE_UINT16;
-					break;
-				case VK_FORMAT_R32_UINT:
-					subMesh.indexType = VK_INDEX_TYPE_UINT32;
-					break;
-				default:
-					break;
-				}
-			}
-
-			if (gltfPrimitive.material < 0)
-			{
-				subMesh.material = &(*defaultMaterial);
-			}
-			else
-			{
-				subMesh.material = &(*defaultMaterial);
-			}
-
-			mesh->AddSubmesh(subMesh);
+			meshes.push_back(LoadMeshInstance(document, mesh_index, hierarchy, settings));
+		}
+	}
+	catch (...)
+	{
+		for (MeshHandle mesh : meshes)
+		{
+			MeshRegistry::GetInstance().Release(mesh);
 		}
+		throw;
 	}
+	return meshes;
 }
 
-bool GltfReader::IsExtensionEnabled(const std::string& requestedExtension)
+bool GltfReader::IsExtensionEnabled(const GltfDocument& document, const std::string& requestedExtension)
 {
-	auto it = supportedExtensions.find(requestedExtension);
-	if (it != supportedExtensions.end())
-	{
-		return it->second;
-	}
-	else
-	{
-		return false;
-	}
+	return document.enabledExtensions.count(requestedExtension) != 0;
 }
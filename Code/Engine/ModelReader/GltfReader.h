@@ -1,25 +1,154 @@
 #pragma once
 
 #include <string>
+#include <memory>
+#include <unordered_set>
+#include <vector>
 
 #define TINYGLTF_NO_STB_IMAGE
 #define TINYGLTF_NO_STB_IMAGE_WRITE
 #define TINYGLTF_NO_EXTERNAL_IMAGE
 #include <tiny_gltf.h>
 
+#include "Animation/ClipCompressor.h"
+#include "ModelReader/ImportSettings.h"
+#include "ModelReader/GltfAsyncLoad.h"
+#include "ModelReader/GltfBatchLoad.h"
+#include "Scene/MeshRegistry.h"
+
 class Scene;
 
+/**
+ * @brief Memory backing one glTF buffer
+ */
+struct GltfBufferSource
+{
+	const uint8_t* data{ nullptr };
+	size_t size{ 0 };
+	std::shared_ptr<const void> owner;
+};
+
+/**
+ * @brief Work done decoding EXT_meshopt_compression bufferViews of a document
+ */
+struct GltfDecodeStatistics
+{
+	size_t bufferViews{ 0 };
+	size_t compressedBytes{ 0 };
+	size_t decodedBytes{ 0 };
+	double seconds{ 0.0 };
+
+	inline double GetGigabytesPerSecond() const { return seconds > 0.0 ? decodedBytes / seconds * 1e-9 : 0.0; }
+};
+
+/**
+ * @brief A parsed glTF file together with the memory its accessors point into
+ * For .gltf files that is tinygltf::Buffer::data, for .glb files the BIN chunk stays in the mapped file.
+ */
+struct GltfDocument
+{
+	std::string path;
+	std::shared_ptr<tinygltf::Model> model;
+	std::vector<GltfBufferSource> buffers;
+	/// Extensions the file uses that the reader supports
+	std::unordered_set<std::string> enabledExtensions;
+	GltfDecodeStatistics decodeStatistics;
+};
+
+/**
+ * @brief Work the mesh passes, the mesh sharing and the animation compression of one scene build did
+ * Primitives are summed in mesh order, so the totals do not depend on the thread count.
+ */
+struct GltfBuildStatistics
+{
+	/// Mesh nodes, the glTF meshes they use and how many of those this build decoded instead of sharing
+	uint32_t instances{ 0 };
+	uint32_t usedMeshes{ 0 };
+	uint32_t decodedMeshes{ 0 };
+	uint32_t decodedPrimitives{ 0 };
+	/// Triangles of the optimized primitives and their vertex cache misses in the source and the optimized order
+	uint64_t optimizedTriangles{ 0 };
+	double missesBefore{ 0.0 };
+	double missesAfter{ 0.0 };
+	uint32_t lodCount{ 0 };
+	/// Triangles fed into the simplifier and the time it took, summed over all primitives
+	uint64_t simplifiedTriangles{ 0 };
+	double simplifySeconds{ 0.0 };
+	uint32_t meshletCount{ 0 };
+	ClipCompressionStatistics animations;
+
+	inline double GetAcmrBefore() const { return optimizedTriangles > 0 ? missesBefore / optimizedTriangles : 0.0; }
+	inline double GetAcmrAfter() const { return optimizedTriangles > 0 ? missesAfter / optimizedTriangles : 0.0; }
+};
+
+/**
+ * @brief Time one GltfReader::LoadSource call spent in each import stage and the work the stages did
+ */
+struct GltfImportTimings
+{
+	/// JSON or GLB parse and meshopt decode
+	double parseSeconds{ 0.0 };
+	/// Hierarchy, materials, mesh processing and animations
+	double buildSeconds{ 0.0 };
+	GltfDecodeStatistics decodeStatistics;
+	GltfBuildStatistics buildStatistics;
+};
+
 class GltfReader
 {
 public:
 	GltfReader() {};
 	~GltfReader() {};
 
-	static Scene* LoadFile(const char* path);
+	/**
+	 * @brief Loads a .gltf or .glb file, reusing the cooked scene next to it when it matches the source content and settings
+	 */
+	static Scene* LoadFile(const char* path, const GltfImportSettings& settings = GltfImportSettings());
+
+	/**
+	 * @brief Starts loading a file on the job pool and returns right away
+	 * The scene is published with its node hierarchy first, the meshes follow one node at a time in the order of
+	 * the stream settings. Progress and callbacks are delivered through JobSystem::RunMainThreadJobs().
+	 */
+	static GltfLoadHandle LoadFileAsync(const char* path, const GltfImportSettings& settings = GltfImportSettings(), const GltfStreamSettings& stream = GltfStreamSettings());
+
+	/**
+	 * @brief Starts loading many files as one pipeline and returns right away
+	 * A dedicated I/O thread reads the files ahead in order while the job pool parses and builds the ones already
+	 * read, so the I/O of one file overlaps the decode of others. Each file loads as LoadFile would.
+	 */
+	static GltfBatchHandle LoadFilesAsync(const std::vector<std::string>& paths, const GltfImportSettings& settings = GltfImportSettings(), const GltfBatchSettings& batch = GltfBatchSettings());
+
+	/**
+	 * @brief Same as LoadFilesAsync, blocking until every file is loaded. Scenes are in the order of the paths.
+	 */
+	static std::vector<Scene*> LoadFiles(const std::vector<std::string>& paths, const GltfImportSettings& settings = GltfImportSettings(), const GltfBatchSettings& batch = GltfBatchSettings());
+
+	/**
+	 * @brief Loads and builds the source file, never reads or writes a cooked scene
+	 */
+	static Scene* LoadSource(const char* path, const GltfImportSettings& settings = GltfImportSettings(), GltfImportTimings* timings = nullptr);
+
+	/**
+	 * @brief Buffer and image files a .gltf or .glb file references, resolved against its folder, sorted and unique
+	 * Returns false when the file cannot be read or parsed. Embedded data uris are not files and are skipped.
+	 */
+	static bool GetExternalFiles(const char* path, std::vector<std::string>& files);
+
+	static bool LoadDocument(const char* path, GltfDocument& document);
 
 private:
-	static void LoadLight(tinygltf::Model& model);
-	static void LoadMesh(tinygltf::Model& model);
-	static bool IsExtensionEnabled(const std::string& requestedExtension);
+	static Scene* BuildScene(const GltfDocument& document, const GltfImportSettings& settings, GltfBuildStatistics* statistics = nullptr);
+	static bool LoadBinaryDocument(const char* path, GltfDocument& document, std::string& err, std::string& warn);
+	static bool DecodeCompressedBufferViews(GltfDocument& document, std::string& err);
+	static void StreamFile(GltfLoadHandle load, const GltfImportSettings& settings, const GltfStreamSettings& stream);
+	static void LoadBatch(GltfBatchHandle load, const GltfImportSettings& settings, const GltfBatchSettings& batch);
+	static void ReadBatchFiles(GltfBatchLoad& load, const GltfImportSettings& settings, const GltfBatchSettings& batch);
+	static void LoadBatchFile(GltfBatchLoad& load, uint32_t index, const GltfImportSettings& settings);
+	static void LoadLight(const GltfDocument& document);
+	/**
+	 * @brief Every glTF mesh of document, each handle comes with a reference for the caller
+	 */
+	static std::vector<MeshHandle> LoadMesh(const GltfDocument& document, const GltfImportSettings& settings);
+	static bool IsExtensionEnabled(const GltfDocument& document, const std::string& requestedExtension);
 };
-
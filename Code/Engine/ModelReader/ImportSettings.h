@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Framework/Hash.h"
+
+/**
+ * @brief Options that change what GltfReader produces, part of the cooked scene cache key
+ * The defaults are the runtime path, which imports the file as it is. The mesh passes are offline work, AssetCook
+ * starts from ForCooking.
+ */
+struct GltfImportSettings
+{
+	/// Reuse/write the cooked scene next to the source file
+	bool useCookedScene = false;
+	/// Vertex cache, overdraw and vertex fetch reordering of triangle lists
+	bool optimizeMeshes = false;
+	/// ACMR a cluster may lose to the overdraw pass, relative to the pure vertex cache order
+	float overdrawThreshold = 1.05f;
+	/// Split triangle lists into meshlets with culling bounds
+	bool buildMeshlets = false;
+	/// Simplified LODs of triangle lists, one per ratio of the full resolution triangle count
+	bool generateLods = false;
+	std::vector<float> lodRatios = { 0.5f, 0.25f, 0.125f };
+	/// Snorm16 positions against the mesh bounds with the dequantization folded into the node transform,
+	/// octahedral normals/tangents and unorm16 texture coordinates
+	bool quantizeVertices = false;
+	/// 8 or 16 bits per octahedral component
+	uint32_t octahedralBits = 16;
+	/// Store uint32 indices as uint16 when every index fits, halving the index bandwidth
+	bool narrowIndices = false;
+	/// Replace the animation clips by compressed ones, see ClipCompressor. Animations are never cooked, so these
+	/// stay out of the hash.
+	bool compressAnimations = false;
+	/// Object space distance compression may move a point near an animated joint
+	float animationTolerance = 1e-4f;
+	/// Print a summary of the work done. GltfReader returns the statistics of a load through GltfImportTimings
+	/// instead of printing them, tools like AssetCook print them per asset.
+	bool logStatistics = false;
+
+	/**
+	 * @brief Every mesh pass and the cooked scene on, what shipped assets are built with
+	 */
+	static inline GltfImportSettings ForCooking()
+	{
+		GltfImportSettings settings;
+		settings.useCookedScene = true;
+		settings.optimizeMeshes = true;
+		settings.buildMeshlets = true;
+		settings.generateLods = true;
+		settings.narrowIndices = true;
+		return settings;
+	}
+
+	/**
+	 * @brief Hash of the settings that affect the imported data
+	 */
+	inline uint64_t Hash() const
+	{
+		uint32_t threshold = 0;
+		std::memcpy(&threshold, &overdrawThreshold, sizeof(threshold));
+
+		uint64_t hash = HashCombine(0, optimizeMeshes ? 1 : 0);
+		hash = HashCombine(hash, optimizeMeshes ? threshold : 0);
+		hash = HashCombine(hash, buildMeshlets ? 1 : 0);
+		hash = HashCombine(hash, generateLods ? lodRatios.size() : 0);
+		if (generateLods)
+		{
+			hash = HashBytes(lodRatios.data(), lodRatios.size() * sizeof(float), hash);
+		}
+		hash = HashCombine(hash, quantizeVertices ? octahedralBits : 0);
+		hash = HashCombine(hash, narrowIndices ? 1 : 0);
+		return hash;
+	}
+};
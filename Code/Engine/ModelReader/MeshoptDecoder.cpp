@@ -0,0 +1,1291 @@
+
+#include "MeshoptDecoder.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if WL_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if WL_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+// Bitstream constants of the meshoptimizer codecs, see the EXT_meshopt_compression specification
+static const uint8_t kVertexHeader = 0xa0;
+static const uint8_t kIndexHeader = 0xe0;
+static const uint8_t kSequenceHeader = 0xd0;
+
+static const size_t kVertexBlockSizeBytes = 8192;
+static const size_t kVertexBlockMaxSize = 256;
+static const size_t kByteGroupSize = 16;
+static const size_t kByteGroupDecodeLimit = 24;
+static const size_t kTailMaxSize = 32;
+static const size_t kMaxVertexSize = 256;
+
+static std::atomic<uint32_t> s_SimdLevelCap{ static_cast<uint32_t>(SimdLevel::AVX2) };
+
+inline size_t GetVertexBlockSize(size_t vertexSize)
+{
+	size_t result = (kVertexBlockSizeBytes / vertexSize) & ~(kByteGroupSize - 1);
+	return result < kVertexBlockMaxSize ? result : kVertexBlockMaxSize;
+}
+
+inline uint8_t Unzigzag8(uint8_t v)
+{
+	return static_cast<uint8_t>(-(v & 1) ^ (v >> 1));
+}
+
+inline uint32_t CountTrailingZeros(uint32_t value)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+}
+
+inline uint64_t RotateLeft64(uint64_t value, uint32_t shift)
+{
+	return (value << shift) | (value >> ((64 - shift) & 63));
+}
+
+// Vertex codec, scalar
+
+static const uint8_t* DecodeBytesGroupScalar(const uint8_t* data, uint8_t* buffer, int bitslog2)
+{
+	switch (bitslog2)
+	{
+	case 0:
+		std::memset(buffer, 0, kByteGroupSize);
+		return data;
+	case 1:
+	case 2:
+	{
+		// Packed values from the high bits down, the all ones value escapes to a byte after the packed ones
+		const uint32_t bits = 1u << bitslog2;
+		const uint32_t escape = (1u << bits) - 1;
+		const uint8_t* packed = data;
+		const uint8_t* escaped = data + bits * 2;
+		for (size_t i = 0; i < kByteGroupSize; ++i)
+		{
+			uint32_t byte = packed[i * bits / 8];
+			uint32_t value = (byte >> (8 - bits - (i * bits) % 8)) & escape;
+			buffer[i] = value == escape ? *escaped++ : static_cast<uint8_t>(value);
+		}
+		return escaped;
+	}
+	default:
+		std::memcpy(buffer, data, kByteGroupSize);
+		return data + kByteGroupSize;
+	}
+}
+
+static const uint8_t* DecodeBytesScalar(const uint8_t* data, const uint8_t* dataEnd, uint8_t* buffer, size_t bufferSize)
+{
+	// 2 bits of mode per group in front of the groups
+	const uint8_t* header = data;
+	size_t headerSize = (bufferSize / kByteGroupSize + 3) / 4;
+	if (static_cast<size_t>(dataEnd - data) < headerSize)
+	{
+		return nullptr;
+	}
+	data += headerSize;
+
+	for (size_t i = 0; i < bufferSize; i += kByteGroupSize)
+	{
+		if (static_cast<size_t>(dataEnd - data) < kByteGroupDecodeLimit)
+		{
+			return nullptr;
+		}
+
+		size_t headerOffset = i / kByteGroupSize;
+		int bitslog2 = (header[headerOffset / 4] >> ((headerOffset % 4) * 2)) & 3;
+		data = DecodeBytesGroupScalar(data, buffer + i, bitslog2);
+	}
+
+	return data;
+}
+
+static const uint8_t* DecodeVertexBlockScalar(const uint8_t* data, const uint8_t* dataEnd, uint8_t* vertexData, size_t vertexCount, size_t vertexSize, uint8_t* lastVertex)
+{
+	uint8_t buffer[kVertexBlockMaxSize];
+	uint8_t transposed[kVertexBlockSizeBytes];
+
+	size_t vertexCountAligned = (vertexCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+
+	// One byte channel at a time, every byte is a zigzag delta to the same byte of the previous vertex
+	for (size_t k = 0; k < vertexSize; ++k)
+	{
+		data = DecodeBytesScalar(data, dataEnd, buffer, vertexCountAligned);
+		if (!data)
+		{
+			return nullptr;
+		}
+
+		uint8_t p = lastVertex[k];
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			p = static_cast<uint8_t>(Unzigzag8(buffer[i]) + p);
+			transposed[i * vertexSize + k] = p;
+		}
+	}
+
+	std::memcpy(vertexData, transposed, vertexCount * vertexSize);
+	std::memcpy(lastVertex, &transposed[vertexSize * (vertexCount - 1)], vertexSize);
+
+	return data;
+}
+
+// Vertex codec, SIMD
+
+#if WL_SIMD_SSE2
+static const uint8_t* DecodeBytesGroupSse2(const uint8_t* data, uint8_t* buffer, int bitslog2)
+{
+	switch (bitslog2)
+	{
+	case 0:
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), _mm_setzero_si128());
+		return data;
+	case 1:
+	case 2:
+	{
+		// Spread the packed values to one per byte, most significant first
+		__m128i sel;
+		int escape;
+		const uint8_t* escaped;
+		if (bitslog2 == 1)
+		{
+			int32_t packed;
+			std::memcpy(&packed, data, sizeof(packed));
+			__m128i sel2 = _mm_cvtsi32_si128(packed);
+			__m128i sel22 = _mm_unpacklo_epi8(_mm_srli_epi16(sel2, 4), sel2);
+			__m128i sel2222 = _mm_unpacklo_epi8(_mm_srli_epi16(sel22, 2), sel22);
+			sel = _mm_and_si128(sel2222, _mm_set1_epi8(3));
+			escape = 3;
+			escaped = data + 4;
+		}
+		else
+		{
+			__m128i sel4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+			__m128i sel44 = _mm_unpacklo_epi8(_mm_srli_epi16(sel4, 4), sel4);
+			sel = _mm_and_si128(sel44, _mm_set1_epi8(15));
+			escape = 15;
+			escaped = data + 8;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), sel);
+
+		// SSE2 has no byte shuffle, the few escaped bytes are patched in one by one
+		uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(sel, _mm_set1_epi8(static_cast<char>(escape)))));
+		while (mask)
+		{
+			buffer[CountTrailingZeros(mask)] = *escaped++;
+			mask &= mask - 1;
+		}
+		return escaped;
+	}
+	default:
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+		return data + kByteGroupSize;
+	}
+}
+
+static const uint8_t* DecodeBytesSse2(const uint8_t* data, const uint8_t* dataEnd, uint8_t* buffer, size_t bufferSize)
+{
+	const uint8_t* header = data;
+	size_t headerSize = (bufferSize / kByteGroupSize + 3) / 4;
+	if (static_cast<size_t>(dataEnd - data) < headerSize)
+	{
+		return nullptr;
+	}
+	data += headerSize;
+
+	for (size_t i = 0; i < bufferSize; i += kByteGroupSize)
+	{
+		if (static_cast<size_t>(dataEnd - data) < kByteGroupDecodeLimit)
+		{
+			return nullptr;
+		}
+
+		size_t headerOffset = i / kByteGroupSize;
+		int bitslog2 = (header[headerOffset / 4] >> ((headerOffset % 4) * 2)) & 3;
+		data = DecodeBytesGroupSse2(data, buffer + i, bitslog2);
+	}
+
+	return data;
+}
+#endif
+
+#if WL_SIMD_AVX2
+/**
+ * @brief pshufb masks that gather the escaped bytes of 8 values from the bytes after the packed values
+ */
+struct ByteGroupShuffleTable
+{
+	alignas(16) uint8_t shuffle[256][8];
+	uint8_t count[256];
+
+	ByteGroupShuffleTable()
+	{
+		for (uint32_t mask = 0; mask < 256; ++mask)
+		{
+			uint8_t escaped = 0;
+			for (uint32_t i = 0; i < 8; ++i)
+			{
+				uint32_t isEscaped = (mask >> i) & 1;
+				shuffle[mask][i] = isEscaped ? escaped : 0x80;
+				escaped = static_cast<uint8_t>(escaped + isEscaped);
+			}
+			count[mask] = escaped;
+		}
+	}
+};
+
+static const ByteGroupShuffleTable s_ByteGroupShuffle;
+
+WL_TARGET_AVX2 static const uint8_t* DecodeBytesGroupAvx2(const uint8_t* data, uint8_t* buffer, int bitslog2)
+{
+	switch (bitslog2)
+	{
+	case 0:
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), _mm_setzero_si128());
+		return data;
+	case 1:
+	case 2:
+	{
+		__m128i sel;
+		__m128i escape;
+		const uint8_t* escaped;
+		if (bitslog2 == 1)
+		{
+			int32_t packed;
+			std::memcpy(&packed, data, sizeof(packed));
+			__m128i sel2 = _mm_cvtsi32_si128(packed);
+			__m128i sel22 = _mm_unpacklo_epi8(_mm_srli_epi16(sel2, 4), sel2);
+			__m128i sel2222 = _mm_unpacklo_epi8(_mm_srli_epi16(sel22, 2), sel22);
+			sel = _mm_and_si128(sel2222, _mm_set1_epi8(3));
+			escape = _mm_set1_epi8(3);
+			escaped = data + 4;
+		}
+		else
+		{
+			__m128i sel4 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+			__m128i sel44 = _mm_unpacklo_epi8(_mm_srli_epi16(sel4, 4), sel4);
+			sel = _mm_and_si128(sel44, _mm_set1_epi8(15));
+			escape = _mm_set1_epi8(15);
+			escaped = data + 8;
+		}
+
+		// Reading 16 escaped bytes stays inside kByteGroupDecodeLimit
+		__m128i rest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(escaped));
+		__m128i mask = _mm_cmpeq_epi8(sel, escape);
+		uint32_t mask16 = static_cast<uint32_t>(_mm_movemask_epi8(mask));
+		uint32_t mask0 = mask16 & 255;
+		uint32_t mask1 = mask16 >> 8;
+
+		__m128i shuffle0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s_ByteGroupShuffle.shuffle[mask0]));
+		__m128i shuffle1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(s_ByteGroupShuffle.shuffle[mask1]));
+		shuffle1 = _mm_add_epi8(shuffle1, _mm_set1_epi8(static_cast<char>(s_ByteGroupShuffle.count[mask0])));
+
+		__m128i gathered = _mm_shuffle_epi8(rest, _mm_unpacklo_epi64(shuffle0, shuffle1));
+		__m128i result = _mm_or_si128(gathered, _mm_andnot_si128(mask, sel));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), result);
+
+		return escaped + _mm_popcnt_u32(mask16);
+	}
+	default:
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buffer), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+		return data + kByteGroupSize;
+	}
+}
+
+WL_TARGET_AVX2 static const uint8_t* DecodeBytesAvx2(const uint8_t* data, const uint8_t* dataEnd, uint8_t* buffer, size_t bufferSize)
+{
+	const uint8_t* header = data;
+	size_t headerSize = (bufferSize / kByteGroupSize + 3) / 4;
+	if (static_cast<size_t>(dataEnd - data) < headerSize)
+	{
+		return nullptr;
+	}
+	data += headerSize;
+
+	for (size_t i = 0; i < bufferSize; i += kByteGroupSize)
+	{
+		if (static_cast<size_t>(dataEnd - data) < kByteGroupDecodeLimit)
+		{
+			return nullptr;
+		}
+
+		size_t headerOffset = i / kByteGroupSize;
+		int bitslog2 = (header[headerOffset / 4] >> ((headerOffset % 4) * 2)) & 3;
+		data = DecodeBytesGroupAvx2(data, buffer + i, bitslog2);
+	}
+
+	return data;
+}
+#endif
+
+#if WL_SIMD_SSE2
+inline __m128i Unzigzag8Sse2(__m128i v)
+{
+	__m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi8(1)));
+	__m128i magnitude = _mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi8(127));
+	return _mm_xor_si128(sign, magnitude);
+}
+
+inline void StoreVertexWord(uint8_t* output, __m128i value)
+{
+	int32_t word = _mm_cvtsi128_si32(value);
+	std::memcpy(output, &word, sizeof(word));
+}
+
+/**
+ * @brief Decodes 4 byte channels at once and runs the delta prefix sum on whole 32-bit vertex words
+ */
+static const uint8_t* DecodeVertexBlockSse2(const uint8_t* data, const uint8_t* dataEnd, uint8_t* vertexData, size_t vertexCount, size_t vertexSize, uint8_t* lastVertex, bool avx2)
+{
+	alignas(16) uint8_t buffer[kVertexBlockMaxSize * 4];
+	alignas(16) uint8_t transposed[kVertexBlockSizeBytes];
+
+	size_t vertexCountAligned = (vertexCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+
+	for (size_t k = 0; k < vertexSize; k += 4)
+	{
+		for (size_t j = 0; j < 4; ++j)
+		{
+#if WL_SIMD_AVX2
+			data = avx2 ? DecodeBytesAvx2(data, dataEnd, buffer + j * vertexCountAligned, vertexCountAligned)
+				: DecodeBytesSse2(data, dataEnd, buffer + j * vertexCountAligned, vertexCountAligned);
+#else
+			data = DecodeBytesSse2(data, dataEnd, buffer + j * vertexCountAligned, vertexCountAligned);
+#endif
+			if (!data)
+			{
+				return nullptr;
+			}
+		}
+
+		int32_t previous;
+		std::memcpy(&previous, lastVertex + k, sizeof(previous));
+		__m128i p = _mm_cvtsi32_si128(previous);
+
+		// Padding vertices past vertexCount are decoded too, the block buffers are sized for the aligned count
+		uint8_t* output = transposed + k;
+		for (size_t i = 0; i < vertexCount; i += kByteGroupSize)
+		{
+			__m128i r0 = Unzigzag8Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer + i + 0 * vertexCountAligned)));
+			__m128i r1 = Unzigzag8Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer + i + 1 * vertexCountAligned)));
+			__m128i r2 = Unzigzag8Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer + i + 2 * vertexCountAligned)));
+			__m128i r3 = Unzigzag8Sse2(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer + i + 3 * vertexCountAligned)));
+
+			// Transpose 4 channels of 16 bytes into 16 vertices of 4 bytes
+			__m128i t0 = _mm_unpacklo_epi8(r0, r1);
+			__m128i t1 = _mm_unpackhi_epi8(r0, r1);
+			__m128i t2 = _mm_unpacklo_epi8(r2, r3);
+			__m128i t3 = _mm_unpackhi_epi8(r2, r3);
+
+			__m128i vertices[4] = {
+				_mm_unpacklo_epi16(t0, t2),
+				_mm_unpackhi_epi16(t0, t2),
+				_mm_unpacklo_epi16(t1, t3),
+				_mm_unpackhi_epi16(t1, t3) };
+
+			for (size_t v = 0; v < 4; ++v)
+			{
+				p = _mm_add_epi8(p, vertices[v]);
+				StoreVertexWord(output, p);
+				output += vertexSize;
+
+				p = _mm_add_epi8(p, _mm_shuffle_epi32(vertices[v], 1));
+				StoreVertexWord(output, p);
+				output += vertexSize;
+
+				p = _mm_add_epi8(p, _mm_shuffle_epi32(vertices[v], 2));
+				StoreVertexWord(output, p);
+				output += vertexSize;
+
+				p = _mm_add_epi8(p, _mm_shuffle_epi32(vertices[v], 3));
+				StoreVertexWord(output, p);
+				output += vertexSize;
+			}
+		}
+	}
+
+	std::memcpy(vertexData, transposed, vertexCount * vertexSize);
+	std::memcpy(lastVertex, &transposed[vertexSize * (vertexCount - 1)], vertexSize);
+
+	return data;
+}
+#endif
+
+// Filters, scalar
+
+template<typename T>
+static void DecodeFilterOctahedralScalar(T* data, size_t begin, size_t count)
+{
+	const float maximum = float((1 << (sizeof(T) * 8 - 1)) - 1);
+
+	for (size_t i = begin; i < count; ++i)
+	{
+		// z is stored with the same scale as x and y, reconstruct it and unfold z < 0
+		float x = float(data[i * 4 + 0]);
+		float y = float(data[i * 4 + 1]);
+		float z = float(data[i * 4 + 2]) - std::fabs(x) - std::fabs(y);
+
+		float t = (z >= 0.0f) ? 0.0f : z;
+		x += (x >= 0.0f) ? t : -t;
+		y += (y >= 0.0f) ? t : -t;
+
+		float l = std::sqrt(x * x + y * y + z * z);
+		float s = maximum / l;
+
+		data[i * 4 + 0] = T(int(x * s + (x >= 0.0f ? 0.5f : -0.5f)));
+		data[i * 4 + 1] = T(int(y * s + (y >= 0.0f ? 0.5f : -0.5f)));
+		data[i * 4 + 2] = T(int(z * s + (z >= 0.0f ? 0.5f : -0.5f)));
+	}
+}
+
+static void DecodeFilterQuaternionScalar(int16_t* data, size_t begin, size_t count)
+{
+	const float scale = 1.0f / std::sqrt(2.0f);
+
+	for (size_t i = begin; i < count; ++i)
+	{
+		// The low 2 bits of w name the dropped largest component, the rest is the scale of the other three
+		int sf = data[i * 4 + 3] | 3;
+		float ss = scale / float(sf);
+
+		float x = float(data[i * 4 + 0]) * ss;
+		float y = float(data[i * 4 + 1]) * ss;
+		float z = float(data[i * 4 + 2]) * ss;
+
+		float ww = 1.0f - x * x - y * y - z * z;
+		float w = std::sqrt(ww >= 0.0f ? ww : 0.0f);
+
+		int xf = int(x * 32767.0f + (x >= 0.0f ? 0.5f : -0.5f));
+		int yf = int(y * 32767.0f + (y >= 0.0f ? 0.5f : -0.5f));
+		int zf = int(z * 32767.0f + (z >= 0.0f ? 0.5f : -0.5f));
+		int wf = int(w * 32767.0f + 0.5f);
+
+		int qc = data[i * 4 + 3] & 3;
+
+		data[i * 4 + ((qc + 1) & 3)] = int16_t(xf);
+		data[i * 4 + ((qc + 2) & 3)] = int16_t(yf);
+		data[i * 4 + ((qc + 3) & 3)] = int16_t(zf);
+		data[i * 4 + ((qc + 0) & 3)] = int16_t(wf);
+	}
+}
+
+static void DecodeFilterExponentialScalar(uint32_t* data, size_t begin, size_t count)
+{
+	for (size_t i = begin; i < count; ++i)
+	{
+		// 24-bit signed mantissa, 8-bit signed exponent
+		uint32_t v = data[i];
+		int m = int(v << 8) >> 8;
+		int e = int(v) >> 24;
+
+		// ldexp(float(m), e) without the libm call
+		uint32_t bits = uint32_t(e + 127) << 23;
+		float f;
+		std::memcpy(&f, &bits, sizeof(f));
+		f *= float(m);
+		std::memcpy(&data[i], &f, sizeof(f));
+	}
+}
+
+// Filters, SIMD. Same operations in the same order as the scalar versions, so every path writes the same bytes.
+
+#if WL_SIMD_SSE2
+inline __m128 SelectSse2(__m128 condition, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(condition, a), _mm_andnot_ps(condition, b));
+}
+
+/**
+ * @brief Octahedral decode of 4 vertices, the int32 lanes hold the sign extended components
+ */
+inline void DecodeOctahedralSse2(__m128i xi, __m128i yi, __m128i zi, float maximum, __m128i& xr, __m128i& yr, __m128i& zr)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 minusHalf = _mm_set1_ps(-0.5f);
+
+	__m128 x = _mm_cvtepi32_ps(xi);
+	__m128 y = _mm_cvtepi32_ps(yi);
+	__m128 z = _mm_sub_ps(_mm_sub_ps(_mm_cvtepi32_ps(zi), _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+
+	__m128 t = SelectSse2(_mm_cmpge_ps(z, zero), zero, z);
+	__m128 xPositive = _mm_cmpge_ps(x, zero);
+	__m128 yPositive = _mm_cmpge_ps(y, zero);
+	x = _mm_add_ps(x, SelectSse2(xPositive, t, _mm_xor_ps(t, signMask)));
+	y = _mm_add_ps(y, SelectSse2(yPositive, t, _mm_xor_ps(t, signMask)));
+
+	__m128 l = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+	__m128 s = _mm_div_ps(_mm_set1_ps(maximum), l);
+
+	xPositive = _mm_cmpge_ps(x, zero);
+	yPositive = _mm_cmpge_ps(y, zero);
+	__m128 zPositive = _mm_cmpge_ps(z, zero);
+	xr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, s), SelectSse2(xPositive, half, minusHalf)));
+	yr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(y, s), SelectSse2(yPositive, half, minusHalf)));
+	zr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(z, s), SelectSse2(zPositive, half, minusHalf)));
+}
+
+static size_t DecodeFilterOctahedral8Sse2(int8_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i n4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i * 4]));
+
+		__m128i xr, yr, zr;
+		DecodeOctahedralSse2(_mm_srai_epi32(_mm_slli_epi32(n4, 24), 24), _mm_srai_epi32(_mm_slli_epi32(n4, 16), 24), _mm_srai_epi32(_mm_slli_epi32(n4, 8), 24), 127.0f, xr, yr, zr);
+
+		const __m128i byteMask = _mm_set1_epi32(0xff);
+		__m128i result = _mm_and_si128(n4, _mm_set1_epi32(0xff000000));
+		result = _mm_or_si128(result, _mm_and_si128(xr, byteMask));
+		result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(yr, byteMask), 8));
+		result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(zr, byteMask), 16));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&data[i * 4]), result);
+	}
+	return i;
+}
+
+static size_t DecodeFilterOctahedral16Sse2(int16_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 n4_0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[(i + 0) * 4])));
+		__m128 n4_1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[(i + 2) * 4])));
+
+		// One vertex per 32-bit lane, xy and zw
+		__m128i xy = _mm_castps_si128(_mm_shuffle_ps(n4_0, n4_1, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i zw = _mm_castps_si128(_mm_shuffle_ps(n4_0, n4_1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		__m128i xr, yr, zr;
+		DecodeOctahedralSse2(_mm_srai_epi32(_mm_slli_epi32(xy, 16), 16), _mm_srai_epi32(xy, 16), _mm_srai_epi32(_mm_slli_epi32(zw, 16), 16), 32767.0f, xr, yr, zr);
+
+		const __m128i wordMask = _mm_set1_epi32(0xffff);
+		__m128i xyResult = _mm_or_si128(_mm_and_si128(xr, wordMask), _mm_slli_epi32(yr, 16));
+		__m128i zwResult = _mm_or_si128(_mm_and_si128(zr, wordMask), _mm_andnot_si128(wordMask, zw));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&data[(i + 0) * 4]), _mm_unpacklo_epi32(xyResult, zwResult));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&data[(i + 2) * 4]), _mm_unpackhi_epi32(xyResult, zwResult));
+	}
+	return i;
+}
+
+static size_t DecodeFilterQuaternionSse2(int16_t* data, size_t count)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 half = _mm_set1_ps(0.5f);
+	const __m128 minusHalf = _mm_set1_ps(-0.5f);
+	const __m128 maximum = _mm_set1_ps(32767.0f);
+	const __m128i wordMask = _mm_set1_epi32(0xffff);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 q4_0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[(i + 0) * 4])));
+		__m128 q4_1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[(i + 2) * 4])));
+
+		__m128i xy = _mm_castps_si128(_mm_shuffle_ps(q4_0, q4_1, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i zc = _mm_castps_si128(_mm_shuffle_ps(q4_0, q4_1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		__m128i ci = _mm_srai_epi32(zc, 16);
+		__m128 ss = _mm_div_ps(_mm_set1_ps(1.0f / std::sqrt(2.0f)), _mm_cvtepi32_ps(_mm_or_si128(ci, _mm_set1_epi32(3))));
+
+		__m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(xy, 16), 16)), ss);
+		__m128 y = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(xy, 16)), ss);
+		__m128 z = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(zc, 16), 16)), ss);
+
+		__m128 ww = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 w = _mm_sqrt_ps(SelectSse2(_mm_cmpge_ps(ww, zero), ww, zero));
+
+		__m128i xr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(x, maximum), SelectSse2(_mm_cmpge_ps(x, zero), half, minusHalf)));
+		__m128i yr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(y, maximum), SelectSse2(_mm_cmpge_ps(y, zero), half, minusHalf)));
+		__m128i zr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(z, maximum), SelectSse2(_mm_cmpge_ps(z, zero), half, minusHalf)));
+		__m128i wr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(w, maximum), half));
+
+		// Pack every vertex as w x y z from the low word up, rotating by the dropped component puts w in its slot
+		__m128i wx = _mm_or_si128(_mm_and_si128(wr, wordMask), _mm_slli_epi32(xr, 16));
+		__m128i yz = _mm_or_si128(_mm_and_si128(yr, wordMask), _mm_slli_epi32(zr, 16));
+
+		alignas(16) uint64_t packed[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(&packed[0]), _mm_unpacklo_epi32(wx, yz));
+		_mm_store_si128(reinterpret_cast<__m128i*>(&packed[2]), _mm_unpackhi_epi32(wx, yz));
+
+		for (size_t k = 0; k < 4; ++k)
+		{
+			uint64_t rotated = RotateLeft64(packed[k], static_cast<uint32_t>(data[(i + k) * 4 + 3] & 3) * 16);
+			std::memcpy(&data[(i + k) * 4], &rotated, sizeof(rotated));
+		}
+	}
+	return i;
+}
+
+static size_t DecodeFilterExponentialSse2(uint32_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&data[i]));
+
+		__m128i m = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+		__m128i e = _mm_srai_epi32(v, 24);
+		__m128 exponent = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(127)), 23));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&data[i]), _mm_castps_si128(_mm_mul_ps(exponent, _mm_cvtepi32_ps(m))));
+	}
+	return i;
+}
+#endif
+
+#if WL_SIMD_AVX2
+WL_TARGET_AVX2 inline __m256 SelectAvx2(__m256 condition, __m256 a, __m256 b)
+{
+	return _mm256_blendv_ps(b, a, condition);
+}
+
+WL_TARGET_AVX2 inline void DecodeOctahedralAvx2(__m256i xi, __m256i yi, __m256i zi, float maximum, __m256i& xr, __m256i& yr, __m256i& zr)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 minusHalf = _mm256_set1_ps(-0.5f);
+
+	__m256 x = _mm256_cvtepi32_ps(xi);
+	__m256 y = _mm256_cvtepi32_ps(yi);
+	__m256 z = _mm256_sub_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(zi), _mm256_andnot_ps(signMask, x)), _mm256_andnot_ps(signMask, y));
+
+	__m256 t = SelectAvx2(_mm256_cmp_ps(z, zero, _CMP_GE_OQ), zero, z);
+	__m256 xPositive = _mm256_cmp_ps(x, zero, _CMP_GE_OQ);
+	__m256 yPositive = _mm256_cmp_ps(y, zero, _CMP_GE_OQ);
+	x = _mm256_add_ps(x, SelectAvx2(xPositive, t, _mm256_xor_ps(t, signMask)));
+	y = _mm256_add_ps(y, SelectAvx2(yPositive, t, _mm256_xor_ps(t, signMask)));
+
+	__m256 l = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+	__m256 s = _mm256_div_ps(_mm256_set1_ps(maximum), l);
+
+	xPositive = _mm256_cmp_ps(x, zero, _CMP_GE_OQ);
+	yPositive = _mm256_cmp_ps(y, zero, _CMP_GE_OQ);
+	__m256 zPositive = _mm256_cmp_ps(z, zero, _CMP_GE_OQ);
+	xr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(x, s), SelectAvx2(xPositive, half, minusHalf)));
+	yr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(y, s), SelectAvx2(yPositive, half, minusHalf)));
+	zr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(z, s), SelectAvx2(zPositive, half, minusHalf)));
+}
+
+WL_TARGET_AVX2 static size_t DecodeFilterOctahedral8Avx2(int8_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i n8 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[i * 4]));
+
+		__m256i xr, yr, zr;
+		DecodeOctahedralAvx2(_mm256_srai_epi32(_mm256_slli_epi32(n8, 24), 24), _mm256_srai_epi32(_mm256_slli_epi32(n8, 16), 24), _mm256_srai_epi32(_mm256_slli_epi32(n8, 8), 24), 127.0f, xr, yr, zr);
+
+		const __m256i byteMask = _mm256_set1_epi32(0xff);
+		__m256i result = _mm256_and_si256(n8, _mm256_set1_epi32(static_cast<int>(0xff000000)));
+		result = _mm256_or_si256(result, _mm256_and_si256(xr, byteMask));
+		result = _mm256_or_si256(result, _mm256_slli_epi32(_mm256_and_si256(yr, byteMask), 8));
+		result = _mm256_or_si256(result, _mm256_slli_epi32(_mm256_and_si256(zr, byteMask), 16));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&data[i * 4]), result);
+	}
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t DecodeFilterOctahedral16Avx2(int16_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// The shuffles work per 128-bit lane, unpacking afterwards restores the vertex order of each load
+		__m256 n8_0 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[(i + 0) * 4])));
+		__m256 n8_1 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[(i + 4) * 4])));
+
+		__m256i xy = _mm256_castps_si256(_mm256_shuffle_ps(n8_0, n8_1, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m256i zw = _mm256_castps_si256(_mm256_shuffle_ps(n8_0, n8_1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		__m256i xr, yr, zr;
+		DecodeOctahedralAvx2(_mm256_srai_epi32(_mm256_slli_epi32(xy, 16), 16), _mm256_srai_epi32(xy, 16), _mm256_srai_epi32(_mm256_slli_epi32(zw, 16), 16), 32767.0f, xr, yr, zr);
+
+		const __m256i wordMask = _mm256_set1_epi32(0xffff);
+		__m256i xyResult = _mm256_or_si256(_mm256_and_si256(xr, wordMask), _mm256_slli_epi32(yr, 16));
+		__m256i zwResult = _mm256_or_si256(_mm256_and_si256(zr, wordMask), _mm256_andnot_si256(wordMask, zw));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&data[(i + 0) * 4]), _mm256_unpacklo_epi32(xyResult, zwResult));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&data[(i + 4) * 4]), _mm256_unpackhi_epi32(xyResult, zwResult));
+	}
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t DecodeFilterQuaternionAvx2(int16_t* data, size_t count)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 minusHalf = _mm256_set1_ps(-0.5f);
+	const __m256 maximum = _mm256_set1_ps(32767.0f);
+	const __m256i wordMask = _mm256_set1_epi32(0xffff);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256 q8_0 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[(i + 0) * 4])));
+		__m256 q8_1 = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[(i + 4) * 4])));
+
+		__m256i xy = _mm256_castps_si256(_mm256_shuffle_ps(q8_0, q8_1, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m256i zc = _mm256_castps_si256(_mm256_shuffle_ps(q8_0, q8_1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		__m256i ci = _mm256_srai_epi32(zc, 16);
+		__m256 ss = _mm256_div_ps(_mm256_set1_ps(1.0f / std::sqrt(2.0f)), _mm256_cvtepi32_ps(_mm256_or_si256(ci, _mm256_set1_epi32(3))));
+
+		__m256 x = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(xy, 16), 16)), ss);
+		__m256 y = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(xy, 16)), ss);
+		__m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(zc, 16), 16)), ss);
+
+		__m256 ww = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		__m256 w = _mm256_sqrt_ps(SelectAvx2(_mm256_cmp_ps(ww, zero, _CMP_GE_OQ), ww, zero));
+
+		__m256i xr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(x, maximum), SelectAvx2(_mm256_cmp_ps(x, zero, _CMP_GE_OQ), half, minusHalf)));
+		__m256i yr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(y, maximum), SelectAvx2(_mm256_cmp_ps(y, zero, _CMP_GE_OQ), half, minusHalf)));
+		__m256i zr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(z, maximum), SelectAvx2(_mm256_cmp_ps(z, zero, _CMP_GE_OQ), half, minusHalf)));
+		__m256i wr = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(w, maximum), half));
+
+		__m256i wx = _mm256_or_si256(_mm256_and_si256(wr, wordMask), _mm256_slli_epi32(xr, 16));
+		__m256i yz = _mm256_or_si256(_mm256_and_si256(yr, wordMask), _mm256_slli_epi32(zr, 16));
+
+		alignas(32) uint64_t packed[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&packed[0]), _mm256_unpacklo_epi32(wx, yz));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&packed[4]), _mm256_unpackhi_epi32(wx, yz));
+
+		for (size_t k = 0; k < 8; ++k)
+		{
+			uint64_t rotated = RotateLeft64(packed[k], static_cast<uint32_t>(data[(i + k) * 4 + 3] & 3) * 16);
+			std::memcpy(&data[(i + k) * 4], &rotated, sizeof(rotated));
+		}
+	}
+	return i;
+}
+
+WL_TARGET_AVX2 static size_t DecodeFilterExponentialAvx2(uint32_t* data, size_t count)
+{
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&data[i]));
+
+		__m256i m = _mm256_srai_epi32(_mm256_slli_epi32(v, 8), 8);
+		__m256i e = _mm256_srai_epi32(v, 24);
+		__m256 exponent = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(127)), 23));
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&data[i]), _mm256_castps_si256(_mm256_mul_ps(exponent, _mm256_cvtepi32_ps(m))));
+	}
+	return i;
+}
+#endif
+
+// Index codecs
+
+struct IndexWriter
+{
+	void* destination;
+	size_t indexSize;
+
+	inline void Write(size_t offset, uint32_t a, uint32_t b, uint32_t c) const
+	{
+		if (indexSize == 2)
+		{
+			uint16_t* indices = static_cast<uint16_t*>(destination) + offset;
+			indices[0] = static_cast<uint16_t>(a);
+			indices[1] = static_cast<uint16_t>(b);
+			indices[2] = static_cast<uint16_t>(c);
+		}
+		else
+		{
+			uint32_t* indices = static_cast<uint32_t*>(destination) + offset;
+			indices[0] = a;
+			indices[1] = b;
+			indices[2] = c;
+		}
+	}
+};
+
+inline uint32_t DecodeVByte(const uint8_t*& data)
+{
+	uint8_t lead = *data++;
+	if (lead < 128)
+	{
+		return lead;
+	}
+
+	// 7 bits per byte, little endian, at most 5 bytes
+	uint32_t result = lead & 127;
+	uint32_t shift = 7;
+	for (int i = 0; i < 4; ++i)
+	{
+		uint8_t group = *data++;
+		result |= uint32_t(group & 127) << shift;
+		shift += 7;
+
+		if (group < 128)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+inline uint32_t DecodeIndex(const uint8_t*& data, uint32_t last)
+{
+	uint32_t v = DecodeVByte(data);
+	uint32_t d = (v >> 1) ^ (0u - (v & 1));
+	return last + d;
+}
+
+inline void PushEdgeFifo(uint32_t fifo[16][2], uint32_t a, uint32_t b, size_t& offset)
+{
+	fifo[offset][0] = a;
+	fifo[offset][1] = b;
+	offset = (offset + 1) & 15;
+}
+
+inline void PushVertexFifo(uint32_t fifo[16], uint32_t v, size_t& offset, int condition = 1)
+{
+	fifo[offset] = v;
+	offset = (offset + condition) & 15;
+}
+
+bool MeshoptDecoder::DecodeVertexBuffer(void* destination, size_t vertexCount, size_t vertexSize, const uint8_t* source, size_t sourceSize)
+{
+	if (vertexSize == 0 || vertexSize > kMaxVertexSize || vertexSize % 4 != 0)
+	{
+		return false;
+	}
+
+	const uint8_t* data = source;
+	const uint8_t* dataEnd = source + sourceSize;
+	if (sourceSize < 1 + vertexSize)
+	{
+		return false;
+	}
+
+	// Only version 0 of the vertex codec exists
+	uint8_t header = *data++;
+	if ((header & 0xf0) != kVertexHeader || (header & 0x0f) > 0)
+	{
+		return false;
+	}
+
+	// The tail holds the first vertex, which the deltas of the first block start from
+	uint8_t lastVertex[kMaxVertexSize];
+	size_t tailSize = vertexSize < kTailMaxSize ? kTailMaxSize : vertexSize;
+	if (static_cast<size_t>(dataEnd - data) < tailSize)
+	{
+		return false;
+	}
+	std::memcpy(lastVertex, dataEnd - vertexSize, vertexSize);
+
+	const SimdLevel level = GetSimdLevel();
+	uint8_t* vertexData = static_cast<uint8_t*>(destination);
+	size_t blockSize = GetVertexBlockSize(vertexSize);
+
+	for (size_t vertexOffset = 0; vertexOffset < vertexCount; vertexOffset += blockSize)
+	{
+		size_t count = vertexOffset + blockSize < vertexCount ? blockSize : vertexCount - vertexOffset;
+		uint8_t* output = vertexData + vertexOffset * vertexSize;
+
+#if WL_SIMD_SSE2
+		if (level != SimdLevel::Scalar)
+		{
+			data = DecodeVertexBlockSse2(data, dataEnd, output, count, vertexSize, lastVertex, level == SimdLevel::AVX2);
+		}
+		else
+#endif
+		{
+			data = DecodeVertexBlockScalar(data, dataEnd, output, count, vertexSize, lastVertex);
+		}
+
+		if (!data)
+		{
+			return false;
+		}
+	}
+
+	return static_cast<size_t>(dataEnd - data) == tailSize;
+}
+
+bool MeshoptDecoder::DecodeIndexBuffer(void* destination, size_t indexCount, size_t indexSize, const uint8_t* source, size_t sourceSize)
+{
+	if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4))
+	{
+		return false;
+	}
+
+	// Header, one code byte per triangle and the 16 byte auxiliary code table at the end
+	if (sourceSize < 1 + indexCount / 3 + 16)
+	{
+		return false;
+	}
+
+	if ((source[0] & 0xf0) != kIndexHeader)
+	{
+		return false;
+	}
+
+	int version = source[0] & 0x0f;
+	if (version > 1)
+	{
+		return false;
+	}
+
+	uint32_t edgeFifo[16][2];
+	uint32_t vertexFifo[16];
+	std::memset(edgeFifo, -1, sizeof(edgeFifo));
+	std::memset(vertexFifo, -1, sizeof(vertexFifo));
+
+	size_t edgeFifoOffset = 0;
+	size_t vertexFifoOffset = 0;
+
+	uint32_t next = 0;
+	uint32_t last = 0;
+
+	const int fecMax = version >= 1 ? 13 : 15;
+
+	const uint8_t* code = source + 1;
+	const uint8_t* data = code + indexCount / 3;
+	const uint8_t* dataSafeEnd = source + sourceSize - 16;
+	const uint8_t* codeAuxTable = dataSafeEnd;
+
+	const IndexWriter writer = { destination, indexSize };
+
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		// Every triangle reads at most 16 bytes of data, which the code table after it covers
+		if (data > dataSafeEnd)
+		{
+			return false;
+		}
+
+		uint8_t codeTri = *code++;
+
+		if (codeTri < 0xf0)
+		{
+			// Edge from the edge FIFO plus a new, cached or free vertex
+			int fe = codeTri >> 4;
+			uint32_t a = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][0];
+			uint32_t b = edgeFifo[(edgeFifoOffset - 1 - fe) & 15][1];
+
+			int fec = codeTri & 15;
+			if (fec < fecMax)
+			{
+				uint32_t cf = vertexFifo[(vertexFifoOffset - 1 - fec) & 15];
+				uint32_t c = (fec == 0) ? next : cf;
+
+				int fec0 = fec == 0;
+				next += fec0;
+
+				writer.Write(i, a, b, c);
+
+				PushVertexFifo(vertexFifo, c, vertexFifoOffset, fec0);
+				PushEdgeFifo(edgeFifo, c, b, edgeFifoOffset);
+				PushEdgeFifo(edgeFifo, a, c, edgeFifoOffset);
+			}
+			else
+			{
+				// 13 and 14 are last - 1 and last + 1, 15 a delta coded free index
+				uint32_t c = (fec != 15) ? last + (fec - (fec ^ 3)) : DecodeIndex(data, last);
+				last = c;
+
+				writer.Write(i, a, b, c);
+
+				PushVertexFifo(vertexFifo, c, vertexFifoOffset);
+				PushEdgeFifo(edgeFifo, c, b, edgeFifoOffset);
+				PushEdgeFifo(edgeFifo, a, c, edgeFifoOffset);
+			}
+		}
+		else if (codeTri < 0xfe)
+		{
+			// Triangle starting with a new vertex, the other two come from the code table
+			uint8_t codeAux = codeAuxTable[codeTri & 15];
+
+			int feb = codeAux >> 4;
+			int fec = codeAux & 15;
+
+			uint32_t a = next++;
+
+			uint32_t bf = vertexFifo[(vertexFifoOffset - feb) & 15];
+			uint32_t b = (feb == 0) ? next : bf;
+
+			int feb0 = feb == 0;
+			next += feb0;
+
+			uint32_t cf = vertexFifo[(vertexFifoOffset - fec) & 15];
+			uint32_t c = (fec == 0) ? next : cf;
+
+			int fec0 = fec == 0;
+			next += fec0;
+
+			writer.Write(i, a, b, c);
+
+			PushVertexFifo(vertexFifo, a, vertexFifoOffset);
+			PushVertexFifo(vertexFifo, b, vertexFifoOffset, feb0);
+			PushVertexFifo(vertexFifo, c, vertexFifoOffset, fec0);
+
+			PushEdgeFifo(edgeFifo, b, a, edgeFifoOffset);
+			PushEdgeFifo(edgeFifo, c, b, edgeFifoOffset);
+			PushEdgeFifo(edgeFifo, a, c, edgeFifoOffset);
+		}
+		else
+		{
+			// Full triangle, the codes of b and c follow in the data stream
+			uint8_t codeAux = *data++;
+
+			int fea = codeTri == 0xfe ? 0 : 15;
+			int feb = codeAux >> 4;
+			int fec = codeAux & 15;
+
+			// An all zero code restarts the new vertex counter
+			if (codeAux == 0)
+			{
+				next = 0;
+			}
+
+			uint32_t a = (fea == 0) ? next++ : 0;
+			uint32_t b = (feb == 0) ? next++ : vertexFifo[(vertexFifoOffset - feb) & 15];
+			uint32_t c = (fec == 0) ? next++ : vertexFifo[(vertexFifoOffset - fec) & 15];
+
+			if (fea == 15)
+			{
+				last = a = DecodeIndex(data, last);
+			}
+
+			if (feb == 15)
+			{
+				last = b = DecodeIndex(data, last);
+			}
+
+			if (fec == 15)
+			{
+				last = c = DecodeIndex(data, last);
+			}
+
+			writer.Write(i, a, b, c);
+
+			PushVertexFifo(vertexFifo, a, vertexFifoOffset);
+			PushVertexFifo(vertexFifo, b, vertexFifoOffset, (feb == 0) | (feb == 15));
+			PushVertexFifo(vertexFifo, c, vertexFifoOffset, (fec == 0) | (fec == 15));
+
+			PushEdgeFifo(edgeFifo, b, a, edgeFifoOffset);
+			PushEdgeFifo(edgeFifo, c, b, edgeFifoOffset);
+			PushEdgeFifo(edgeFifo, a, c, edgeFifoOffset);
+		}
+	}
+
+	return data == dataSafeEnd;
+}
+
+bool MeshoptDecoder::DecodeIndexSequence(void* destination, size_t indexCount, size_t indexSize, const uint8_t* source, size_t sourceSize)
+{
+	if (indexSize != 2 && indexSize != 4)
+	{
+		return false;
+	}
+
+	// Header, at least one byte per index and 4 bytes of padding
+	if (sourceSize < 1 + indexCount + 4)
+	{
+		return false;
+	}
+
+	if ((source[0] & 0xf0) != kSequenceHeader || (source[0] & 0x0f) > 1)
+	{
+		return false;
+	}
+
+	const uint8_t* data = source + 1;
+	const uint8_t* dataSafeEnd = source + sourceSize - 4;
+
+	// Two baselines, the low bit of every code picks the one the delta applies to
+	uint32_t last[2] = {};
+
+	for (size_t i = 0; i < indexCount; ++i)
+	{
+		if (data >= dataSafeEnd)
+		{
+			return false;
+		}
+
+		uint32_t v = DecodeVByte(data);
+
+		uint32_t current = v & 1;
+		v >>= 1;
+
+		uint32_t d = (v >> 1) ^ (0u - (v & 1));
+		uint32_t index = last[current] + d;
+		last[current] = index;
+
+		if (indexSize == 2)
+		{
+			static_cast<uint16_t*>(destination)[i] = static_cast<uint16_t>(index);
+		}
+		else
+		{
+			static_cast<uint32_t*>(destination)[i] = index;
+		}
+	}
+
+	return data == dataSafeEnd;
+}
+
+void MeshoptDecoder::DecodeFilterOctahedral(void* data, size_t count, size_t byteStride)
+{
+	const SimdLevel level = GetSimdLevel();
+	size_t decoded = 0;
+
+	if (byteStride == 4)
+	{
+		int8_t* values = static_cast<int8_t*>(data);
+#if WL_SIMD_AVX2
+		if (level == SimdLevel::AVX2)
+		{
+			decoded = DecodeFilterOctahedral8Avx2(values, count);
+		}
+#endif
+#if WL_SIMD_SSE2
+		if (level != SimdLevel::Scalar)
+		{
+			decoded += DecodeFilterOctahedral8Sse2(values + decoded * 4, count - decoded);
+		}
+#endif
+		DecodeFilterOctahedralScalar(values, decoded, count);
+	}
+	else if (byteStride == 8)
+	{
+		int16_t* values = static_cast<int16_t*>(data);
+#if WL_SIMD_AVX2
+		if (level == SimdLevel::AVX2)
+		{
+			decoded = DecodeFilterOctahedral16Avx2(values, count);
+		}
+#endif
+#if WL_SIMD_SSE2
+		if (level != SimdLevel::Scalar)
+		{
+			decoded += DecodeFilterOctahedral16Sse2(values + decoded * 4, count - decoded);
+		}
+#endif
+		DecodeFilterOctahedralScalar(values, decoded, count);
+	}
+}
+
+void MeshoptDecoder::DecodeFilterQuaternion(void* data, size_t count, size_t byteStride)
+{
+	if (byteStride != 8)
+	{
+		return;
+	}
+
+	const SimdLevel level = GetSimdLevel();
+	int16_t* values = static_cast<int16_t*>(data);
+	size_t decoded = 0;
+
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		decoded = DecodeFilterQuaternionAvx2(values, count);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		decoded += DecodeFilterQuaternionSse2(values + decoded * 4, count - decoded);
+	}
+#endif
+	DecodeFilterQuaternionScalar(values, decoded, count);
+}
+
+void MeshoptDecoder::DecodeFilterExponential(void* data, size_t count, size_t byteStride)
+{
+	if (byteStride % 4 != 0)
+	{
+		return;
+	}
+
+	// Every 32-bit component is filtered on its own
+	const SimdLevel level = GetSimdLevel();
+	uint32_t* values = static_cast<uint32_t*>(data);
+	const size_t valueCount = count * (byteStride / 4);
+	size_t decoded = 0;
+
+#if WL_SIMD_AVX2
+	if (level == SimdLevel::AVX2)
+	{
+		decoded = DecodeFilterExponentialAvx2(values, valueCount);
+	}
+#endif
+#if WL_SIMD_SSE2
+	if (level != SimdLevel::Scalar)
+	{
+		decoded += DecodeFilterExponentialSse2(values + decoded, valueCount - decoded);
+	}
+#endif
+	DecodeFilterExponentialScalar(values, decoded, valueCount);
+}
+
+bool MeshoptDecoder::Decode(void* destination, size_t count, size_t byteStride, const uint8_t* source, size_t sourceSize, MeshoptMode mode, MeshoptFilter filter)
+{
+	switch (mode)
+	{
+	case MeshoptMode::Attributes:
+		if (!DecodeVertexBuffer(destination, count, byteStride, source, sourceSize))
+		{
+			return false;
+		}
+
+		switch (filter)
+		{
+		case MeshoptFilter::Octahedral:
+			DecodeFilterOctahedral(destination, count, byteStride);
+			break;
+		case MeshoptFilter::Quaternion:
+			DecodeFilterQuaternion(destination, count, byteStride);
+			break;
+		case MeshoptFilter::Exponential:
+			DecodeFilterExponential(destination, count, byteStride);
+			break;
+		default:
+			break;
+		}
+		return true;
+	case MeshoptMode::Triangles:
+		return DecodeIndexBuffer(destination, count, byteStride, source, sourceSize);
+	case MeshoptMode::Indices:
+		return DecodeIndexSequence(destination, count, byteStride, source, sourceSize);
+	default:
+		return false;
+	}
+}
+
+SimdLevel MeshoptDecoder::GetSimdLevel()
+{
+	SimdLevel supported = CpuFeatures::GetSimdLevel();
+	SimdLevel cap = static_cast<SimdLevel>(s_SimdLevelCap.load(std::memory_order_relaxed));
+	return static_cast<uint32_t>(cap) < static_cast<uint32_t>(supported) ? cap : supported;
+}
+
+void MeshoptDecoder::SetSimdLevel(SimdLevel level)
+{
+	s_SimdLevelCap.store(static_cast<uint32_t>(level), std::memory_order_relaxed);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Framework/CpuFeatures.h"
+
+/**
+ * @brief Layout of a bufferView compressed with EXT_meshopt_compression
+ */
+enum class MeshoptMode : uint32_t
+{
+	Attributes,
+	Triangles,
+	Indices,
+};
+
+/**
+ * @brief Filter applied to ATTRIBUTES data after the vertex codec
+ */
+enum class MeshoptFilter : uint32_t
+{
+	None,
+	Octahedral,
+	Quaternion,
+	Exponential,
+};
+
+/**
+ * @brief Decoders for the meshoptimizer vertex/index codecs and filters used by EXT_meshopt_compression
+ * Every function has a scalar, SSE2 and AVX2 path producing the same bytes. The path follows
+ * CpuFeatures::GetSimdLevel() unless SetSimdLevel() lowers it, which is how the paths are compared.
+ */
+class MeshoptDecoder
+{
+public:
+	/**
+	 * @brief Decodes count elements of byteStride bytes into destination, false when the source is malformed
+	 */
+	static bool Decode(void* destination, size_t count, size_t byteStride, const uint8_t* source, size_t sourceSize, MeshoptMode mode, MeshoptFilter filter);
+
+	static bool DecodeVertexBuffer(void* destination, size_t vertexCount, size_t vertexSize, const uint8_t* source, size_t sourceSize);
+
+	/**
+	 * @brief Triangle list codec, indexSize is 2 or 4
+	 */
+	static bool DecodeIndexBuffer(void* destination, size_t indexCount, size_t indexSize, const uint8_t* source, size_t sourceSize);
+
+	/**
+	 * @brief Index sequence codec for non triangle list indices, indexSize is 2 or 4
+	 */
+	static bool DecodeIndexSequence(void* destination, size_t indexCount, size_t indexSize, const uint8_t* source, size_t sourceSize);
+
+	/**
+	 * @brief Filters run in place on the output of DecodeVertexBuffer
+	 */
+	static void DecodeFilterOctahedral(void* data, size_t count, size_t byteStride);
+	static void DecodeFilterQuaternion(void* data, size_t count, size_t byteStride);
+	static void DecodeFilterExponential(void* data, size_t count, size_t byteStride);
+
+	static SimdLevel GetSimdLevel();
+
+	/**
+	 * @brief Caps the decoder paths at level, the CPU support still applies
+	 */
+	static void SetSimdLevel(SimdLevel level);
+
+private:
+	MeshoptDecoder() {};
+	~MeshoptDecoder() {};
+};
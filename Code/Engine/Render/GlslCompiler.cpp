@@ -158,6 +158,42 @@ inline EShLanguage FindShaderLanguage(VkShaderStageFlagBits stage)
 	}
 }
 
+bool GlslCompiler::GetShaderStage(const std::string& path, VkShaderStageFlagBits& stage)
+{
+	// Extract extension name from the glsl shader file
+	const std::string fileExt = path.substr(path.find_last_of(".") + 1);
+	if (fileExt == "vert")
+	{
+		stage = VK_SHADER_STAGE_VERTEX_BIT;
+	}
+	else if (fileExt == "frag")
+	{
+		stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+	else if (fileExt == "comp")
+	{
+		stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+	else if (fileExt == "geom")
+	{
+		stage = VK_SHADER_STAGE_GEOMETRY_BIT;
+	}
+	else if (fileExt == "tesc")
+	{
+		stage = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+	}
+	else if (fileExt == "tese")
+	{
+		stage = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+	}
+	else
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool GlslCompiler::CompilerToSpriv(VkShaderStageFlagBits stage, const std::vector<uint8_t>& glslSource, const std::string& entryPoint,
 	const ShaderVariant& shaderVariant, std::vector<std::uint32_t>& spirv, std::string& infoLog)
 {
@@ -9,6 +9,11 @@
 class GlslCompiler
 {
 public:
+	/**
+	 * @brief Stage of a GLSL file from its extension (.vert, .frag, .comp, .geom, .tesc, .tese), false for anything else
+	 */
+	static bool GetShaderStage(const std::string& path, VkShaderStageFlagBits& stage);
+
 	static bool CompilerToSpriv(VkShaderStageFlagBits stage, const std::vector<uint8_t>& glslSource, const std::string& entryPoint,
 		const ShaderVariant& shaderVariant, std::vector<std::uint32_t>& spirv, std::string& infoLog);
 private:
@@ -0,0 +1,86 @@
+#include "MaterialTable.h"
+
+#include <cstring>
+
+#include "Framework/Hash.h"
+
+inline uint64_t HashFloats(const float* values, size_t count, uint64_t seed)
+{
+	return HashBytes(values, count * sizeof(float), seed);
+}
+
+MaterialTable& MaterialTable::GetInstance()
+{
+	static MaterialTable s_Instance;
+	return s_Instance;
+}
+
+MaterialTable::MaterialTable()
+{
+	m_Default = Add(Material(""));
+}
+
+MaterialHandle MaterialTable::Add(Material&& material)
+{
+	const uint64_t hash = Hash(material);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto range = m_Lookup.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (IsEqual(*m_Materials.Get(it->second), material))
+		{
+			return it->second;
+		}
+	}
+
+	const MaterialHandle handle = m_Materials.Create(std::move(material));
+	m_Lookup.emplace(hash, handle);
+
+	return handle;
+}
+
+const Material& MaterialTable::Get(MaterialHandle handle) const
+{
+	const Material* material = m_Materials.Get(handle);
+	return material ? *material : *m_Materials.Get(m_Default);
+}
+
+uint32_t MaterialTable::GetCount() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Materials.GetCount();
+}
+
+uint64_t MaterialTable::Hash(const Material& material)
+{
+	uint64_t hash = HashFloats(&material.baseColorFactor[0], 4, 0);
+	hash = HashFloats(&material.emissive[0], 3, hash);
+	hash = HashFloats(&material.metallicFactor, 1, hash);
+	hash = HashFloats(&material.roughnessFactor, 1, hash);
+	hash = HashFloats(&material.alphaCutoff, 1, hash);
+	hash = HashCombine(hash, static_cast<uint64_t>(material.alphaMode));
+	hash = HashCombine(hash, material.doubleSided ? 1 : 0);
+
+	// The texture map has no fixed order, so its entries are combined order independently
+	uint64_t textures = 0;
+	for (auto& texture : material.textures)
+	{
+		textures += HashCombine(HashBytes(texture.first.data(), texture.first.size()), reinterpret_cast<uintptr_t>(texture.second));
+	}
+
+	return HashCombine(hash, textures);
+}
+
+bool MaterialTable::IsEqual(const Material& a, const Material& b)
+{
+	return std::memcmp(&a.baseColorFactor[0], &b.baseColorFactor[0], sizeof(float) * 4) == 0 &&
+		std::memcmp(&a.emissive[0], &b.emissive[0], sizeof(float) * 3) == 0 &&
+		std::memcmp(&a.metallicFactor, &b.metallicFactor, sizeof(float)) == 0 &&
+		std::memcmp(&a.roughnessFactor, &b.roughnessFactor, sizeof(float)) == 0 &&
+		std::memcmp(&a.alphaCutoff, &b.alphaCutoff, sizeof(float)) == 0 &&
+		a.alphaMode == b.alphaMode &&
+		a.doubleSided == b.doubleSided &&
+		a.textures == b.textures;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "Framework/HandlePool.h"
+#include "Render/Material.h"
+
+/**
+ * @brief Material in the MaterialTable, equal handles mean equal materials
+ * The renderer sorts and batches draws by the id without touching the materials.
+ */
+using MaterialHandle = Handle<Material>;
+
+/**
+ * @brief One copy of every distinct material of all loaded files, deduplicated by value
+ * Materials live in a HandlePool whose chunks never move, so Get() can run on the main thread while loads add
+ * materials on the job pool. Materials stay until the table is destroyed.
+ */
+class MaterialTable
+{
+public:
+	static MaterialTable& GetInstance();
+
+	/**
+	 * @brief Handle of the stored material equal to material, adding it when there is none yet
+	 */
+	MaterialHandle Add(Material&& material);
+
+	/**
+	 * @brief Material with the default glTF values, used by primitives without a material
+	 */
+	inline MaterialHandle GetDefault() const { return m_Default; }
+
+	/**
+	 * @brief Material of handle, the default material for the null handle
+	 */
+	const Material& Get(MaterialHandle handle) const;
+
+	uint32_t GetCount() const;
+
+	static uint64_t Hash(const Material& material);
+	static bool IsEqual(const Material& a, const Material& b);
+
+private:
+	MaterialTable();
+	~MaterialTable() {};
+
+	mutable std::mutex m_Mutex;
+	HandlePool<Material> m_Materials;
+	std::unordered_multimap<uint64_t, MaterialHandle> m_Lookup;
+
+	MaterialHandle m_Default;
+};
@@ -0,0 +1,157 @@
+
+#include "VertexLayout.h"
+
+#include "Scene/Mesh.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <unordered_map>
+
+VertexSemantic GetVertexSemantic(const std::string& name)
+{
+	static const std::unordered_map<std::string, VertexSemantic> semantics = {
+		{"position", VertexSemantic::Position},
+		{"normal", VertexSemantic::Normal},
+		{"tangent", VertexSemantic::Tangent},
+		{"texcoord_0", VertexSemantic::Texcoord0},
+		{"texcoord_1", VertexSemantic::Texcoord1},
+		{"color_0", VertexSemantic::Color0},
+		{"joints_0", VertexSemantic::Joints0},
+		{"weights_0", VertexSemantic::Weights0} };
+
+	auto it = semantics.find(name);
+	return it != semantics.end() ? it->second : VertexSemantic::Count;
+}
+
+uint32_t VertexLayout::GetLocation(const std::string& name) const
+{
+	VertexSemantic semantic = GetVertexSemantic(name);
+	if (semantic != VertexSemantic::Count)
+	{
+		return HasSemantic(semantic) ? static_cast<uint32_t>(semantic) : ~0u;
+	}
+
+	auto it = std::find(extraAttributes.begin(), extraAttributes.end(), name);
+	return it != extraAttributes.end() ? static_cast<uint32_t>(VertexSemantic::Count) + static_cast<uint32_t>(it - extraAttributes.begin()) : ~0u;
+}
+
+/**
+ * @brief One attribute of the interleaved stream
+ */
+struct InterleavedAttribute
+{
+	uint32_t location;
+	AccessorView* view;
+	uint32_t offset;
+};
+
+VertexLayout VertexLayoutBuilder::Build(SubMesh& subMesh)
+{
+	VertexLayout layout;
+
+	const uint32_t semanticCount = static_cast<uint32_t>(VertexSemantic::Count);
+	std::array<AccessorView*, static_cast<size_t>(VertexSemantic::Count)> views{};
+	std::vector<std::pair<std::string, AccessorView*>> extraViews;
+
+	for (auto& vertexBuffer : subMesh.vertexBuffers)
+	{
+		if (!vertexBuffer.second.IsValid() || GetFormatSize(vertexBuffer.second.format) == 0)
+		{
+			layout.droppedAttributes.push_back(vertexBuffer.first);
+			continue;
+		}
+
+		VertexSemantic semantic = GetVertexSemantic(vertexBuffer.first);
+		if (semantic != VertexSemantic::Count)
+		{
+			views[static_cast<uint32_t>(semantic)] = &vertexBuffer.second;
+		}
+		else
+		{
+			extraViews.emplace_back(vertexBuffer.first, &vertexBuffer.second);
+		}
+	}
+	std::sort(layout.droppedAttributes.begin(), layout.droppedAttributes.end());
+
+	// vertexBuffers has no order of its own, sorting the names keeps the locations stable between loads
+	std::sort(extraViews.begin(), extraViews.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	const uint32_t vertexCount = subMesh.vertexCount;
+
+	if (AccessorView* position = views[static_cast<uint32_t>(VertexSemantic::Position)])
+	{
+		if (!position->IsTightlyPacked())
+		{
+			*position = AccessorView::FromData(position->CopyPacked(), GetFormatSize(position->format), position->count, position->format);
+		}
+
+		layout.positionStream = *position;
+		layout.semanticMask |= 1u << static_cast<uint32_t>(VertexSemantic::Position);
+
+		layout.bindings.push_back({ VertexLayout::kPositionBinding, layout.positionStream.stride, VK_VERTEX_INPUT_RATE_VERTEX });
+		layout.attributes.push_back({ static_cast<uint32_t>(VertexSemantic::Position), VertexLayout::kPositionBinding, position->format, 0 });
+	}
+
+	// Every attribute starts on a 4 byte boundary, which all vertex formats accept
+	std::vector<InterleavedAttribute> interleavedAttributes;
+	for (uint32_t semantic = 1; semantic < semanticCount; ++semantic)
+	{
+		if (views[semantic])
+		{
+			interleavedAttributes.push_back({ semantic, views[semantic], 0 });
+		}
+	}
+	for (auto& extraView : extraViews)
+	{
+		interleavedAttributes.push_back({ semanticCount + static_cast<uint32_t>(layout.extraAttributes.size()), extraView.second, 0 });
+		layout.extraAttributes.push_back(extraView.first);
+	}
+
+	uint32_t stride = 0;
+	for (InterleavedAttribute& attribute : interleavedAttributes)
+	{
+		attribute.offset = stride;
+		stride += (GetFormatSize(attribute.view->format) + 3) & ~3u;
+	}
+
+	if (stride == 0)
+	{
+		return layout;
+	}
+
+	std::vector<uint8_t> interleaved(static_cast<size_t>(vertexCount) * stride, 0);
+	for (const InterleavedAttribute& attribute : interleavedAttributes)
+	{
+		const AccessorView* view = attribute.view;
+		const uint32_t elementSize = GetFormatSize(view->format);
+		const uint32_t count = std::min(vertexCount, view->count);
+		uint8_t* dst = interleaved.data() + attribute.offset;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			std::memcpy(dst + static_cast<size_t>(i) * stride, view->At(i), elementSize);
+		}
+
+		if (attribute.location < semanticCount)
+		{
+			layout.semanticMask |= 1u << attribute.location;
+		}
+		layout.attributes.push_back({ attribute.location, VertexLayout::kAttributeBinding, view->format, attribute.offset });
+	}
+
+	layout.octahedralMask = subMesh.octahedralMask & layout.semanticMask;
+	layout.attributeStream = AccessorView::FromData(std::move(interleaved), stride, vertexCount, VK_FORMAT_UNDEFINED);
+	layout.bindings.push_back({ VertexLayout::kAttributeBinding, stride, VK_VERTEX_INPUT_RATE_VERTEX });
+
+	// The source views now alias the interleaved copy, so the buffers they came from are released
+	for (const InterleavedAttribute& attribute : interleavedAttributes)
+	{
+		AccessorView packed = layout.attributeStream;
+		packed.offset += attribute.offset;
+		packed.count = std::min(vertexCount, attribute.view->count);
+		packed.format = attribute.view->format;
+		*attribute.view = std::move(packed);
+	}
+
+	return layout;
+}
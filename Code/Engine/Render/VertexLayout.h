@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <volk.h>
+
+#include "Scene/AccessorView.h"
+
+struct SubMesh;
+
+/**
+ * @brief Vertex attributes the renderer knows about, the value is also the shader input location
+ */
+enum class VertexSemantic : uint32_t
+{
+	Position  = 0,
+	Normal    = 1,
+	Tangent   = 2,
+	Texcoord0 = 3,
+	Texcoord1 = 4,
+	Color0    = 5,
+	Joints0   = 6,
+	Weights0  = 7,
+	Count
+};
+
+/**
+ * @brief Maps a lowercase glTF attribute name to its semantic, VertexSemantic::Count when it is unknown
+ */
+VertexSemantic GetVertexSemantic(const std::string& name);
+
+/**
+ * @brief Two stream vertex layout of a SubMesh
+ * Binding 0 only holds tightly packed positions so depth and shadow passes fetch nothing else,
+ * binding 1 interleaves every other attribute. Attribute locations are the VertexSemantic values, attributes
+ * without a semantic follow at VertexSemantic::Count and up in the order of extraAttributes.
+ */
+struct VertexLayout
+{
+	static const uint32_t kPositionBinding = 0;
+	static const uint32_t kAttributeBinding = 1;
+
+	AccessorView positionStream;
+	AccessorView attributeStream;
+
+	std::vector<VkVertexInputBindingDescription> bindings;
+	std::vector<VkVertexInputAttributeDescription> attributes;
+
+	/// Bit (1 << semantic) is set for every semantic present in the layout
+	uint32_t semanticMask = 0;
+	/// Bit (1 << semantic) is set for semantics the vertex shader has to decode from octahedral xy
+	uint32_t octahedralMask = 0;
+
+	/// Interleaved attributes without a VertexSemantic, such as texcoord_2 or color_1, sorted by name
+	std::vector<std::string> extraAttributes;
+	/// Attributes left out of both streams because their view is invalid or its format has no size
+	std::vector<std::string> droppedAttributes;
+
+	inline bool HasSemantic(VertexSemantic semantic) const { return (semanticMask & (1u << static_cast<uint32_t>(semantic))) != 0; }
+
+	/**
+	 * @brief Shader input location of a lowercase glTF attribute name, ~0u when the layout does not hold it
+	 */
+	uint32_t GetLocation(const std::string& name) const;
+};
+
+class VertexLayoutBuilder
+{
+public:
+	/**
+	 * @brief Packs the SubMesh attribute views into the position and interleaved streams
+	 * Positions that are already tightly packed are referenced in place, only the interleaved stream is copied.
+	 * The SubMesh views are pointed at the streams afterwards, so the source buffers are not kept alive next to the copy.
+	 */
+	static VertexLayout Build(SubMesh& subMesh);
+
+private:
+	VertexLayoutBuilder() {};
+	~VertexLayoutBuilder() {};
+};
@@ -700,34 +700,10 @@ VkShaderModule GfxDeviceVulkan::LoadShaderModule(const char* path)
 {
 	auto& buffer = FileSystem::LoadFile(path);
 
-	std::string fileExt = path;
-	// Extract extension name from the glsl shader file
-	fileExt = fileExt.substr(fileExt.find_last_of(".") + 1);
-
 	VkShaderStageFlagBits shaderStageBits;
-	if (fileExt == "vert")
-	{
-		shaderStageBits = VK_SHADER_STAGE_VERTEX_BIT;
-	}
-	else if (fileExt == "frag")
-	{
-		shaderStageBits = VK_SHADER_STAGE_FRAGMENT_BIT;
-	}
-	else if (fileExt == "comp")
-	{
-		shaderStageBits = VK_SHADER_STAGE_COMPUTE_BIT;
-	}
-	else if (fileExt == "geom")
-	{
-		shaderStageBits = VK_SHADER_STAGE_GEOMETRY_BIT;
-	}
-	else if (fileExt == "tesc")
+	if (!GlslCompiler::GetShaderStage(path, shaderStageBits))
 	{
-		shaderStageBits = VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
-	}
-	else if (fileExt == "tese")
-	{
-		shaderStageBits = VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+		return VK_NULL_HANDLE;
 	}
 
 	std::vector<uint32_t> spriv;
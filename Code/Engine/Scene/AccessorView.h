@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include <volk.h>
+
+/**
+ * @brief Size in bytes of a single element of the given vertex/index format
+ */
+uint32_t GetFormatSize(VkFormat format);
+
+/**
+ * @brief Non-owning view of a strided attribute or index stream
+ * The backing memory (a glTF buffer, a mapped file or a repacked copy) is kept alive by owner,
+ * so a view stays valid for as long as it is referenced, without copying the data.
+ */
+struct AccessorView
+{
+	std::shared_ptr<const void> owner;
+	const uint8_t* buffer{ nullptr };
+
+	size_t offset = 0;
+	uint32_t stride = 0;
+	uint32_t count = 0;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+
+	inline bool IsValid() const { return buffer != nullptr; }
+
+	inline const uint8_t* Data() const { return buffer + offset; }
+
+	inline const uint8_t* At(uint32_t index) const { return buffer + offset + static_cast<size_t>(index) * stride; }
+
+	inline size_t ByteSize() const { return static_cast<size_t>(count) * stride; }
+
+	inline bool IsTightlyPacked() const { return stride == GetFormatSize(format); }
+
+	/**
+	 * @brief Copies the elements into a tightly packed vector, only needed when the data has to be repacked
+	 */
+	std::vector<uint8_t> CopyPacked() const;
+
+	/**
+	 * @brief Creates a view that owns data, used for streams that had to be repacked
+	 */
+	static AccessorView FromData(std::vector<uint8_t>&& data, uint32_t stride, uint32_t count, VkFormat format);
+};
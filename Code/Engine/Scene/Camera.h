@@ -7,6 +7,8 @@
 class Camera : public Component
 {
 public:
+	static constexpr ComponentType kComponentType = ComponentType::Camera;
+
 	Camera() {};
 	~Camera() {};
 
@@ -1,6 +1,28 @@
-
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * @brief Compile time id of every component class, indexes the component pools and the archetype columns
+ */
+enum class ComponentType : uint8_t
+{
+	Transform,
+	Camera,
+	Light,
+	MeshRenderer,
+	MeshDeformer,
+	Count
+};
+
+static const uint32_t kComponentTypeCount = static_cast<uint32_t>(ComponentType::Count);
+
+/// One bit per ComponentType, the component set of an entity
+using ComponentMask = uint32_t;
+
+static_assert(kComponentTypeCount <= sizeof(ComponentMask) * 8, "ComponentMask has too few bits");
+
 class Component
 {
 public:
@@ -10,3 +32,16 @@ public:
 private:
 
 };
+
+template<typename T>
+constexpr uint32_t GetComponentTypeIndex()
+{
+	static_assert(std::is_base_of<Component, T>::value && !std::is_same<Component, T>::value, "T must be a component class");
+	return static_cast<uint32_t>(T::kComponentType);
+}
+
+template<typename T>
+constexpr ComponentMask GetComponentTypeMask()
+{
+	return ComponentMask(1) << GetComponentTypeIndex<T>();
+}
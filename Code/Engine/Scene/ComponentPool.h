@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Framework/HandlePool.h"
+#include "Scene/Component.h"
+
+class ComponentPoolBase
+{
+public:
+	virtual ~ComponentPoolBase() {};
+
+	/**
+	 * @brief Component of a handle id, null when it is stale
+	 */
+	virtual Component* GetComponent(uint32_t id) = 0;
+	virtual void Destroy(uint32_t id) = 0;
+};
+
+/**
+ * @brief Every component of one type, packed in the fixed size chunks of a HandlePool
+ * Chunks never move, so a component keeps its address for its whole life and the raw pointers the scene holds
+ * (transform parents, deformer nodes) stay valid. The archetypes store the handle ids, so a handle kept past the
+ * component is recognized as stale instead of reaching the component that reuses its slot.
+ */
+template<typename T>
+class ComponentPool : public ComponentPoolBase
+{
+public:
+	ComponentPool() {}
+	~ComponentPool() override {}
+
+	inline Handle<T> Create() { return m_Pool.Create(); }
+
+	void Destroy(uint32_t id) override { m_Pool.Destroy(Handle<T>(id)); }
+
+	inline T* Get(Handle<T> handle) const { return m_Pool.Get(handle); }
+
+	Component* GetComponent(uint32_t id) override { return m_Pool.Get(Handle<T>(id)); }
+
+	/**
+	 * @brief Live components
+	 */
+	inline uint32_t GetCount() const { return m_Pool.GetCount(); }
+
+	/**
+	 * @brief Calls function(T&) for every live component in slot order, a chunk at a time
+	 */
+	template<typename F>
+	void ForEach(F&& function) { m_Pool.ForEach(std::forward<F>(function)); }
+
+private:
+	HandlePool<T> m_Pool;
+};
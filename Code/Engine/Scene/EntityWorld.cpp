@@ -0,0 +1,167 @@
+#include "EntityWorld.h"
+
+#include "Apps/BaseInclude.h"
+#include "Scene/Transform.h"
+#include "Scene/TransformHierarchy.h"
+#include "Scene/Camera.h"
+#include "Scene/Light.h"
+#include "Scene/MeshRenderer.h"
+#include "Animation/MeshDeformer.h"
+
+template<typename T>
+static void CreatePool(std::unique_ptr<ComponentPoolBase>* pools)
+{
+	pools[GetComponentTypeIndex<T>()].reset(WL_NEW(ComponentPool<T>));
+}
+
+EntityWorld& EntityWorld::GetInstance()
+{
+	static EntityWorld s_Instance;
+	return s_Instance;
+}
+
+EntityWorld::EntityWorld()
+{
+	// Transforms leave the hierarchy when the pools destroy them, so it has to be destroyed after the pools
+	TransformHierarchy::GetInstance();
+
+	CreatePool<Transform>(m_Pools);
+	CreatePool<Camera>(m_Pools);
+	CreatePool<Light>(m_Pools);
+	CreatePool<MeshRenderer>(m_Pools);
+	CreatePool<MeshDeformer>(m_Pools);
+
+	// Archetype 0 holds the entities without components
+	FindArchetype(0);
+}
+
+EntityId EntityWorld::CreateEntity()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	EntityId entity;
+	if (!m_FreeEntities.empty())
+	{
+		entity = m_FreeEntities.back();
+		m_FreeEntities.pop_back();
+	}
+	else
+	{
+		entity = static_cast<EntityId>(m_Entities.size());
+		m_Entities.emplace_back();
+	}
+
+	Archetype& archetype = m_Archetypes[0];
+	m_Entities[entity] = { 0, static_cast<uint32_t>(archetype.entities.size()) };
+	archetype.entities.push_back(entity);
+	return entity;
+}
+
+void EntityWorld::DestroyEntity(EntityId entity)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	const EntityRecord record = m_Entities[entity];
+	const Archetype& archetype = m_Archetypes[record.archetype];
+	for (uint32_t type = 0; type < kComponentTypeCount; ++type)
+	{
+		if (archetype.mask & (ComponentMask(1) << type))
+		{
+			m_Pools[type]->Destroy(archetype.columns[type][record.row]);
+		}
+	}
+
+	RemoveRow(record.archetype, record.row);
+	m_FreeEntities.push_back(entity);
+}
+
+ComponentMask EntityWorld::GetComponentMask(EntityId entity)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Archetypes[m_Entities[entity].archetype].mask;
+}
+
+uint32_t EntityWorld::FindArchetype(ComponentMask mask)
+{
+	auto it = m_ArchetypeIndices.find(mask);
+	if (it != m_ArchetypeIndices.end())
+	{
+		return it->second;
+	}
+
+	const uint32_t index = static_cast<uint32_t>(m_Archetypes.size());
+	m_Archetypes.emplace_back();
+	m_Archetypes.back().mask = mask;
+	m_ArchetypeIndices.emplace(mask, index);
+	return index;
+}
+
+uint32_t EntityWorld::MoveEntity(EntityId entity, ComponentMask mask)
+{
+	const EntityRecord record = m_Entities[entity];
+	const uint32_t targetIndex = FindArchetype(mask);
+
+	// FindArchetype may have grown m_Archetypes, take the references afterwards
+	Archetype& source = m_Archetypes[record.archetype];
+	Archetype& target = m_Archetypes[targetIndex];
+	const ComponentMask common = source.mask & mask;
+	const uint32_t row = static_cast<uint32_t>(target.entities.size());
+	target.entities.push_back(entity);
+	for (uint32_t type = 0; type < kComponentTypeCount; ++type)
+	{
+		if (common & (ComponentMask(1) << type))
+		{
+			target.columns[type].push_back(source.columns[type][record.row]);
+		}
+	}
+
+	RemoveRow(record.archetype, record.row);
+	m_Entities[entity] = { targetIndex, row };
+	return row;
+}
+
+void EntityWorld::AddColumn(EntityId entity, uint32_t type, uint32_t id)
+{
+	const ComponentMask mask = m_Archetypes[m_Entities[entity].archetype].mask;
+	MoveEntity(entity, mask | (ComponentMask(1) << type));
+	m_Archetypes[m_Entities[entity].archetype].columns[type].push_back(id);
+}
+
+bool EntityWorld::RemoveColumn(EntityId entity, uint32_t type)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	const EntityRecord record = m_Entities[entity];
+	const Archetype& archetype = m_Archetypes[record.archetype];
+	const ComponentMask bit = ComponentMask(1) << type;
+	if (!(archetype.mask & bit))
+	{
+		return false;
+	}
+
+	m_Pools[type]->Destroy(archetype.columns[type][record.row]);
+	MoveEntity(entity, archetype.mask & ~bit);
+	return true;
+}
+
+void EntityWorld::RemoveRow(uint32_t archetypeIndex, uint32_t row)
+{
+	Archetype& archetype = m_Archetypes[archetypeIndex];
+	const uint32_t last = static_cast<uint32_t>(archetype.entities.size() - 1);
+	if (row != last)
+	{
+		archetype.entities[row] = archetype.entities[last];
+		m_Entities[archetype.entities[row]].row = row;
+	}
+	archetype.entities.pop_back();
+
+	for (uint32_t type = 0; type < kComponentTypeCount; ++type)
+	{
+		if (archetype.mask & (ComponentMask(1) << type))
+		{
+			std::vector<uint32_t>& column = archetype.columns[type];
+			column[row] = column[last];
+			column.pop_back();
+		}
+	}
+}
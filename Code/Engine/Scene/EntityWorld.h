@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Scene/Component.h"
+#include "Scene/ComponentPool.h"
+
+using EntityId = uint32_t;
+
+static const EntityId kInvalidEntity = 0xFFFFFFFF;
+
+/**
+ * @brief Every entity with one component set
+ * Rows are entities, columns hold the pool handle id of each component type of the set; the columns of the types
+ * outside the set stay empty.
+ */
+struct Archetype
+{
+	ComponentMask mask{ 0 };
+	std::vector<EntityId> entities;
+	std::vector<uint32_t> columns[kComponentTypeCount];
+};
+
+/**
+ * @brief Component storage of every GameObject
+ * Components live in one pool per type and entities are grouped into archetypes by their component set, so a
+ * system visits exactly the entities that have the components it needs and reads each of them from a dense pool.
+ * Adding a component moves the entity to another archetype, which only moves handles, never components.
+ * Creating and destroying entities and components is thread safe, ForEach must not run concurrently with them.
+ */
+class EntityWorld
+{
+public:
+	static EntityWorld& GetInstance();
+
+	EntityId CreateEntity();
+
+	/**
+	 * @brief Destroys the entity with its components, the id is reused by a later CreateEntity
+	 */
+	void DestroyEntity(EntityId entity);
+
+	/**
+	 * @brief Adds a component of type T, or returns the one the entity already has
+	 */
+	template<typename T>
+	T* AddComponent(EntityId entity)
+	{
+		const uint32_t type = GetComponentTypeIndex<T>();
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const EntityRecord& record = m_Entities[entity];
+		const Archetype& archetype = m_Archetypes[record.archetype];
+		if (archetype.mask & GetComponentTypeMask<T>())
+		{
+			return GetPool<T>().Get(Handle<T>(archetype.columns[type][record.row]));
+		}
+
+		const Handle<T> handle = GetPool<T>().Create();
+		AddColumn(entity, type, handle.id);
+		return GetPool<T>().Get(handle);
+	}
+
+	/**
+	 * @brief Destroys the component of type T of the entity, false when it has none
+	 */
+	template<typename T>
+	bool RemoveComponent(EntityId entity)
+	{
+		return RemoveColumn(entity, GetComponentTypeIndex<T>());
+	}
+
+	ComponentMask GetComponentMask(EntityId entity);
+
+	/**
+	 * @brief Handle of the component of type T of the entity, null when it has none
+	 */
+	template<typename T>
+	Handle<T> GetComponentHandle(EntityId entity)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const EntityRecord& record = m_Entities[entity];
+		const Archetype& archetype = m_Archetypes[record.archetype];
+		if (!(archetype.mask & GetComponentTypeMask<T>()))
+		{
+			return Handle<T>();
+		}
+		return Handle<T>(archetype.columns[GetComponentTypeIndex<T>()][record.row]);
+	}
+
+	/**
+	 * @brief Component of handle, null when it was destroyed
+	 */
+	template<typename T>
+	inline T* GetComponent(Handle<T> handle) { return GetPool<T>().Get(handle); }
+
+	template<typename T>
+	inline ComponentPool<T>& GetPool() { return static_cast<ComponentPool<T>&>(*m_Pools[GetComponentTypeIndex<T>()]); }
+
+	inline const std::vector<Archetype>& GetArchetypes() const { return m_Archetypes; }
+
+	/**
+	 * @brief Calls function(EntityId, T&...) for every entity that has all of the components T, archetype by archetype
+	 */
+	template<typename... T, typename F>
+	void ForEach(F&& function)
+	{
+		const ComponentMask required = (GetComponentTypeMask<T>() | ...);
+		for (Archetype& archetype : m_Archetypes)
+		{
+			if ((archetype.mask & required) != required)
+			{
+				continue;
+			}
+
+			const size_t count = archetype.entities.size();
+			for (size_t row = 0; row < count; ++row)
+			{
+				function(archetype.entities[row], *GetPool<T>().Get(Handle<T>(archetype.columns[GetComponentTypeIndex<T>()][row]))...);
+			}
+		}
+	}
+
+private:
+	EntityWorld();
+	~EntityWorld() {};
+
+	struct EntityRecord
+	{
+		uint32_t archetype;
+		uint32_t row;
+	};
+
+	uint32_t FindArchetype(ComponentMask mask);
+
+	/**
+	 * @brief Moves the entity to the archetype of another component set, carrying the handles of the types both sets
+	 * have; the caller fills the columns of the types only the new set has. Returns the row of the entity.
+	 */
+	uint32_t MoveEntity(EntityId entity, ComponentMask mask);
+
+	/**
+	 * @brief Moves the entity to the archetype of its set plus type, id is the handle of its new component of that type
+	 */
+	void AddColumn(EntityId entity, uint32_t type, uint32_t id);
+
+	bool RemoveColumn(EntityId entity, uint32_t type);
+
+	/**
+	 * @brief Swap removes a row, the entity of the last row takes its place
+	 */
+	void RemoveRow(uint32_t archetypeIndex, uint32_t row);
+
+	std::mutex m_Mutex;
+	std::vector<EntityRecord> m_Entities;
+	std::vector<EntityId> m_FreeEntities;
+	std::vector<Archetype> m_Archetypes;
+	std::unordered_map<ComponentMask, uint32_t> m_ArchetypeIndices;
+	std::unique_ptr<ComponentPoolBase> m_Pools[kComponentTypeCount];
+};
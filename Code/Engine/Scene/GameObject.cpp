@@ -1,9 +1,61 @@
-
 #include "Scene/GameObject.h"
 
-GameObject::GameObject(const std::string& name)
+#include <mutex>
+
+// Loads create the nodes of their scenes on the job pool
+static std::mutex s_PoolMutex;
+
+static HandlePool<GameObject>& GetGameObjectPool()
+{
+	// GameObjects destroy their entities, so the world has to be destroyed after the pool
+	EntityWorld::GetInstance();
+
+	static HandlePool<GameObject> s_Pool;
+	return s_Pool;
+}
+
+GameObjectHandle GameObject::Create(const std::string& name)
+{
+	HandlePool<GameObject>& pool = GetGameObjectPool();
+
+	std::lock_guard<std::mutex> lock(s_PoolMutex);
+	GameObjectHandle handle = pool.Create(name);
+	pool.Get(handle)->m_Handle = handle;
+	return handle;
+}
+
+bool GameObject::Destroy(GameObjectHandle handle)
+{
+	HandlePool<GameObject>& pool = GetGameObjectPool();
+
+	std::lock_guard<std::mutex> lock(s_PoolMutex);
+	return pool.Destroy(handle);
+}
+
+GameObject* GameObject::Get(GameObjectHandle handle)
 {
+	return GetGameObjectPool().Get(handle);
+}
 
+uint32_t GameObject::GetCount()
+{
+	HandlePool<GameObject>& pool = GetGameObjectPool();
+
+	std::lock_guard<std::mutex> lock(s_PoolMutex);
+	return pool.GetCount();
 }
 
+GameObject::GameObject(const std::string& name) :
+	m_Name{ name },
+	m_Entity{ EntityWorld::GetInstance().CreateEntity() }
+{
+
+}
+
+GameObject::~GameObject()
+{
+	EntityWorld::GetInstance().DestroyEntity(m_Entity);
+}
+
+
 
@@ -1,4 +1,3 @@
-
 #pragma once
 
 #include <string>
@@ -6,49 +5,113 @@
 #include <type_traits>
 
 #include "Apps/BaseInclude.h"
+#include "Framework/HandlePool.h"
+#include "Scene/EntityWorld.h"
+
+class GameObject;
 
-class Component;
+using GameObjectHandle = Handle<GameObject>;
 
+/**
+ * @brief Thin handle of an entity of the EntityWorld
+ * The components live in the pools of the world, the GameObject keeps a pointer per component type and a bit
+ * per type it has, so lookups are one array read or one bit test and need no RTTI.
+ * GameObjects live in one HandlePool, Create and Destroy are the only way to make and free them.
+ */
 class GameObject
 {
 public:
-	GameObject(const std::string& name);
-	//~GameObject();
-	virtual ~GameObject() = default;
+	static GameObjectHandle Create(const std::string& name);
+
+	/**
+	 * @brief Destroys the GameObject with its entity and components, false when the handle is stale
+	 */
+	static bool Destroy(GameObjectHandle handle);
+
+	/**
+	 * @brief GameObject of handle, null when it was destroyed
+	 */
+	static GameObject* Get(GameObjectHandle handle);
+
+	/**
+	 * @brief Number of live GameObjects
+	 */
+	static uint32_t GetCount();
+
+	GameObject(const GameObject&) = delete;
+	GameObject& operator=(const GameObject&) = delete;
 
+	inline GameObjectHandle GetHandle() const { return m_Handle; }
+
+	inline const std::string& GetName() const { return m_Name; }
+
+	inline EntityId GetEntity() const { return m_Entity; }
+
+	/**
+	 * @brief Adds a component of type T, a GameObject has at most one of each type so an existing one is returned
+	 */
 	template<typename T>
 	T* AddComponent()
 	{
-		T* t = WL_NEW(T);
-		m_Components.push_back(t);
+		T* t = EntityWorld::GetInstance().AddComponent<T>(m_Entity);
+		m_Components[GetComponentTypeIndex<T>()] = t;
+		m_ComponentMask |= GetComponentTypeMask<T>();
 		return t;
 	}
 
+	/**
+	 * @brief Destroys the component of type T, pointers to it dangle afterwards
+	 */
 	template<typename T>
-	T* GetComponent()
+	bool RemoveComponent()
 	{
-		auto it = m_Components.begin();
-		for (; it != m_Components.end(); ++it)
+		if (!HasComponent<T>())
 		{
-			Component* c = *it;
-			if constexpr (std::is_same<Component, T>::value)
-			{
-				ASSERT(false);
-				return nullptr;
-			}
-			else
-			{
-				T* actualType = dynamic_cast<T*>(c);
-				if (actualType)
-				{
-					return actualType;
-				}
-			}
+			return false;
 		}
 
-		return nullptr;
+		m_Components[GetComponentTypeIndex<T>()] = nullptr;
+		m_ComponentMask &= ~GetComponentTypeMask<T>();
+		return EntityWorld::GetInstance().RemoveComponent<T>(m_Entity);
+	}
+
+	template<typename T>
+	inline bool HasComponent() const { return (m_ComponentMask & GetComponentTypeMask<T>()) != 0; }
+
+	inline ComponentMask GetComponentMask() const { return m_ComponentMask; }
+
+	/**
+	 * @brief Handle of the component of type T, it goes stale when the component is removed
+	 */
+	template<typename T>
+	inline Handle<T> GetComponentHandle() const { return EntityWorld::GetInstance().GetComponentHandle<T>(m_Entity); }
+
+	template<typename T>
+	T* GetComponent()
+	{
+		if constexpr (std::is_same<Component, T>::value)
+		{
+			ASSERT(false);
+			return nullptr;
+		}
+		else
+		{
+			return static_cast<T*>(m_Components[GetComponentTypeIndex<T>()]);
+		}
 	}
 
 private:
-	std::vector<Component*> m_Components;
+	friend class HandlePool<GameObject>;
+
+	GameObject(const std::string& name);
+	/**
+	 * @brief Destroys the entity and its components, they belong to the node that added them
+	 */
+	virtual ~GameObject();
+
+	std::string m_Name;
+	GameObjectHandle m_Handle;
+	EntityId m_Entity;
+	ComponentMask m_ComponentMask{ 0 };
+	Component* m_Components[kComponentTypeCount] = {};
 };
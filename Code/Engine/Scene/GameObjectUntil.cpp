@@ -3,6 +3,6 @@
 
 GameObject* CreateGameObject(const std::string& name)
 {
-	return WL_NEW(GameObject)(name);
+	return GameObject::Get(GameObject::Create(name));
 }
 
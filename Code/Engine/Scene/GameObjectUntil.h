@@ -7,4 +7,7 @@
 #include "Apps/BaseInclude.h"
 
 //GameObject* CreateLight(Scene* scene, );
+/**
+ * @brief Creates a GameObject in the pool, GetHandle() of the result is what a Scene stores
+ */
 GameObject* CreateGameObject(const std::string& name);
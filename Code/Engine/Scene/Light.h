@@ -25,6 +25,8 @@ struct LightProperties
 class Light : public Component
 {
 public:
+	static constexpr ComponentType kComponentType = ComponentType::Light;
+
 	Light() {};
 	~Light() {};
 
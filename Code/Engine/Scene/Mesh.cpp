@@ -1,7 +1,28 @@
 
 #include "Mesh.h"
 
+#include <algorithm>
+
 Mesh::Mesh()
 {
 
 }
+
+uint32_t Mesh::SelectLod(size_t subMeshIndex, float distance, float projectionScale, float pixelThreshold) const
+{
+	const SubMesh& subMesh = submeshes[subMeshIndex];
+
+	// Errors only grow along the chain, so the first LOD that is too coarse ends the search
+	uint32_t lod = 0;
+	for (uint32_t i = 1; i < subMesh.GetLodCount(); ++i)
+	{
+		float pixelError = subMesh.GetLodError(i) * projectionScale / std::max(distance, 1e-6f);
+		if (pixelError > pixelThreshold)
+		{
+			break;
+		}
+		lod = i;
+	}
+
+	return lod;
+}
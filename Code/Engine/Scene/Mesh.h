@@ -1,11 +1,16 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
 #include <unordered_map>
 
 #include <volk.h>
 
-class Material;
+#include "Scene/AccessorView.h"
+#include "Render/VertexLayout.h"
+#include "Geometry/Meshlet.h"
+#include "Render/MaterialTable.h"
 
 struct VertexAttribute
 {
@@ -15,13 +20,56 @@ struct VertexAttribute
 	uint32_t offset = 0;
 };
 
+/**
+ * @brief Reduced index buffer of a SubMesh, it indexes the same vertex streams as the full resolution one
+ */
+struct SubMeshLod
+{
+	AccessorView indexBuffer;
+	uint32_t indexCount = 0;
+	/// Object space distance the LOD may deviate from the full resolution surface
+	float error = 0.0f;
+};
+
+/**
+ * @brief Name of the vertex stream holding the attribute deltas of a morph target, attribute is "position", "normal" or "tangent"
+ */
+inline std::string GetMorphStreamName(uint32_t target, const char* attribute)
+{
+	return "morph" + std::to_string(target) + "_" + attribute;
+}
+
 struct SubMesh
 {
-	uint32_t vertexCount;
-	uint32_t vertexIndices;
-	VkIndexType indexType;
-	const Material* material{ nullptr };
-	std::unordered_map<std::string, std::vector<uint8_t>> vertexBuffers;
+	uint32_t vertexCount = 0;
+	uint32_t vertexIndices = 0;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+	MaterialHandle material;
+	std::unordered_map<std::string, AccessorView> vertexBuffers;
+	AccessorView indexBuffer;
+
+	/// Stream split layout the renderer binds, rebuild it after changing vertexBuffers
+	VertexLayout layout;
+
+	/// Bit (1 << VertexSemantic) is set for attributes stored octahedral encoded
+	uint32_t octahedralMask = 0;
+
+	/// Clusters for meshlet culling, empty when the importer did not build them
+	MeshletData meshlets;
+
+	/// LOD 1 and coarser, LOD 0 is indexBuffer itself
+	std::vector<SubMeshLod> lods;
+
+	/// Morph targets, their deltas are vertex streams named by GetMorphStreamName so vertex remaps keep them in sync
+	uint32_t morphTargetCount = 0;
+
+	inline uint32_t GetLodCount() const { return static_cast<uint32_t>(lods.size()) + 1; }
+
+	inline const AccessorView& GetLodIndexBuffer(uint32_t lod) const { return lod == 0 ? indexBuffer : lods[lod - 1].indexBuffer; }
+
+	inline uint32_t GetLodIndexCount(uint32_t lod) const { return lod == 0 ? vertexIndices : lods[lod - 1].indexCount; }
+
+	inline float GetLodError(uint32_t lod) const { return lod == 0 ? 0.0f : lods[lod - 1].error; }
 
 	inline void SetAttribute(const std::string& name, const VertexAttribute& attribute)
 	{
@@ -42,6 +90,20 @@ public:
 	{
 		submeshes.push_back(submesh);
 	}
+
+	inline void AddSubmesh(SubMesh&& submesh)
+	{
+		submeshes.push_back(std::move(submesh));
+	}
+
+	inline const std::vector<SubMesh>& GetSubmeshes() const { return submeshes; }
+
+	/**
+	 * @brief Coarsest LOD of a submesh whose error projects to at most pixelThreshold pixels
+	 * distance is from the camera to the mesh in object space units, projectionScale is
+	 * viewportHeight / (2 * tan(fieldOfView / 2)).
+	 */
+	uint32_t SelectLod(size_t subMeshIndex, float distance, float projectionScale, float pixelThreshold = 1.0f) const;
 private:
 
 	std::vector<SubMesh> submeshes;
@@ -0,0 +1,127 @@
+#include "MeshRegistry.h"
+
+MeshRegistry& MeshRegistry::GetInstance()
+{
+	static MeshRegistry s_Instance;
+	return s_Instance;
+}
+
+std::string MeshRegistry::GetSourceKey(const std::string& path, uint32_t meshIndex, uint64_t settingsHash)
+{
+	return path + '#' + std::to_string(meshIndex) + '#' + std::to_string(settingsHash);
+}
+
+MeshHandle MeshRegistry::Create(Mesh&& mesh)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	MeshHandle handle = m_Meshes.Create(std::move(mesh));
+	if (handle.GetIndex() >= m_Records.size())
+	{
+		m_Records.resize(handle.GetIndex() + 1);
+	}
+
+	m_Records[handle.GetIndex()] = MeshRecord();
+	m_Records[handle.GetIndex()].references = 1;
+	return handle;
+}
+
+MeshHandle MeshRegistry::FindSource(const std::string& path, uint32_t meshIndex, uint64_t settingsHash)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto it = m_Sources.find(GetSourceKey(path, meshIndex, settingsHash));
+	return it != m_Sources.end() ? AddReference(it->second) : MeshHandle();
+}
+
+MeshHandle MeshRegistry::FindContent(const MeshContentKey& content)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto it = m_Contents.find(content.hash);
+	return it != m_Contents.end() && m_Records[it->second.GetIndex()].content == content ? AddReference(it->second) : MeshHandle();
+}
+
+MeshHandle MeshRegistry::Register(const std::string& path, uint32_t meshIndex, uint64_t settingsHash, const MeshContentKey& content, MeshHandle mesh)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	MeshHandle registered = mesh;
+	auto it = m_Contents.find(content.hash);
+	if (it == m_Contents.end())
+	{
+		m_Contents.emplace(content.hash, mesh);
+		m_Records[mesh.GetIndex()].content = content;
+		m_Records[mesh.GetIndex()].hasContent = true;
+	}
+	else if (it->second != mesh && m_Records[it->second.GetIndex()].content == content)
+	{
+		registered = AddReference(it->second);
+		ReleaseLocked(mesh);
+	}
+
+	// A load racing for the same source may have registered it already, the last one wins
+	std::string source = GetSourceKey(path, meshIndex, settingsHash);
+	m_Sources[source] = registered;
+	m_Records[registered.GetIndex()].sources.push_back(std::move(source));
+
+	return registered;
+}
+
+MeshHandle MeshRegistry::Share(MeshHandle mesh)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	return m_Meshes.IsAlive(mesh) ? AddReference(mesh) : MeshHandle();
+}
+
+void MeshRegistry::Release(MeshHandle mesh)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	ReleaseLocked(mesh);
+}
+
+uint32_t MeshRegistry::GetCount()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Meshes.GetCount();
+}
+
+MeshHandle MeshRegistry::AddReference(MeshHandle mesh)
+{
+	m_Records[mesh.GetIndex()].references++;
+	return mesh;
+}
+
+void MeshRegistry::ReleaseLocked(MeshHandle mesh)
+{
+	if (!m_Meshes.IsAlive(mesh))
+	{
+		return;
+	}
+
+	MeshRecord& record = m_Records[mesh.GetIndex()];
+	if (--record.references > 0)
+	{
+		return;
+	}
+
+	// Keys taken over by another mesh stay
+	for (const std::string& source : record.sources)
+	{
+		auto it = m_Sources.find(source);
+		if (it != m_Sources.end() && it->second == mesh)
+		{
+			m_Sources.erase(it);
+		}
+	}
+
+	if (record.hasContent)
+	{
+		m_Contents.erase(record.content.hash);
+	}
+
+	record = MeshRecord();
+	m_Meshes.Destroy(mesh);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Framework/HandlePool.h"
+#include "Scene/Mesh.h"
+
+/**
+ * @brief Mesh in the MeshRegistry, shared by every MeshRenderer drawing it
+ */
+using MeshHandle = Handle<Mesh>;
+
+/**
+ * @brief Identity of the source content a mesh was decoded from
+ * The hash finds the candidate, the second hash with an independent seed and the byte count confirm it, so sharing
+ * a mesh that is not the same takes two 64-bit collisions on content of the same size.
+ */
+struct MeshContentKey
+{
+	uint64_t hash{ 0 };
+	uint64_t verify{ 0 };
+	/// Bytes of accessor data the hashes cover
+	uint64_t size{ 0 };
+
+	inline bool operator==(const MeshContentKey& other) const { return hash == other.hash && verify == other.verify && size == other.size; }
+	inline bool operator!=(const MeshContentKey& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Owner of every decoded Mesh, shared by the nodes instancing it within a file and across files
+ * A mesh is found by its source (file, glTF mesh index and import settings hash) without touching the data,
+ * or by its source content when another file holds the same mesh. Meshes are counted by the scenes
+ * using them: Create, the Find functions and Register return a handle with one reference for the caller, who
+ * hands it to Scene::AddMesh or gives it back with Release. The last reference destroys the mesh, its handles
+ * go stale and its keys are removed. All functions are thread safe.
+ */
+class MeshRegistry
+{
+public:
+	static MeshRegistry& GetInstance();
+
+	/**
+	 * @brief Stores mesh without a key, Register makes it shareable
+	 */
+	MeshHandle Create(Mesh&& mesh);
+
+	MeshHandle FindSource(const std::string& path, uint32_t meshIndex, uint64_t settingsHash);
+	MeshHandle FindContent(const MeshContentKey& content);
+
+	/**
+	 * @brief Registers mesh under both keys and returns the mesh to use
+	 * When another load registered a mesh for the same content first, that one is returned and the reference to
+	 * mesh is released instead. A mesh whose content hash is taken by other content is only found by its source.
+	 */
+	MeshHandle Register(const std::string& path, uint32_t meshIndex, uint64_t settingsHash, const MeshContentKey& content, MeshHandle mesh);
+
+	/**
+	 * @brief Another reference to mesh for a second owner, invalid when the handle is stale
+	 */
+	MeshHandle Share(MeshHandle mesh);
+
+	/**
+	 * @brief Mesh of handle, null when it was destroyed
+	 * Takes no lock, the reference the caller holds keeps the mesh alive while it is used.
+	 */
+	inline Mesh* Get(MeshHandle mesh) const { return m_Meshes.Get(mesh); }
+
+	/**
+	 * @brief Gives back one reference, stale handles are ignored
+	 */
+	void Release(MeshHandle mesh);
+
+	/**
+	 * @brief Number of meshes that are still alive
+	 */
+	uint32_t GetCount();
+
+private:
+	/**
+	 * @brief References and keys of the mesh in one slot of m_Meshes
+	 */
+	struct MeshRecord
+	{
+		uint32_t references{ 0 };
+		std::vector<std::string> sources;
+		MeshContentKey content;
+		bool hasContent{ false };
+	};
+
+	MeshRegistry() {};
+	~MeshRegistry() {};
+
+	static std::string GetSourceKey(const std::string& path, uint32_t meshIndex, uint64_t settingsHash);
+
+	MeshHandle AddReference(MeshHandle mesh);
+	void ReleaseLocked(MeshHandle mesh);
+
+	std::mutex m_Mutex;
+	HandlePool<Mesh> m_Meshes;
+	std::vector<MeshRecord> m_Records;
+	std::unordered_map<std::string, MeshHandle> m_Sources;
+	std::unordered_map<uint64_t, MeshHandle> m_Contents;
+};
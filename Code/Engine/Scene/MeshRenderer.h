@@ -3,17 +3,28 @@
 
 
 #include "Scene/Component.h"
-
-class Mesh;
+#include "Scene/MeshRegistry.h"
 
 class MeshRenderer : public Component
 {
 public:
-	MeshRenderer() { mesh = nullptr; }
+	static constexpr ComponentType kComponentType = ComponentType::MeshRenderer;
+
+	MeshRenderer() {}
 	~MeshRenderer () {};
 
-	inline void SetMesh(Mesh* mesh) { this->mesh = mesh; }
+	/**
+	 * @brief Mesh to draw, the scene of the node holds the reference that keeps it alive
+	 */
+	inline void SetMesh(MeshHandle mesh) { this->mesh = mesh; }
+
+	/**
+	 * @brief Mesh to draw, null when there is none or it was released
+	 */
+	inline Mesh* GetMesh() const { return MeshRegistry::GetInstance().Get(mesh); }
+
+	inline MeshHandle GetMeshHandle() const { return mesh; }
 
 private:
-	Mesh* mesh;
+	MeshHandle mesh;
 };
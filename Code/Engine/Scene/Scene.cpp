@@ -1,6 +1,21 @@
 
 #include "Scene.h"
 
+Scene::~Scene()
+{
+	// Nodes first, their renderers and deformers refer to the meshes
+	for (GameObjectHandle node : m_GameObjects)
+	{
+		GameObject::Destroy(node);
+	}
+
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	for (MeshHandle mesh : m_Meshes)
+	{
+		registry.Release(mesh);
+	}
+}
+
 GameObject* Scene::FindNode(const std::string& name)
 {
 	return nullptr;
@@ -5,25 +5,58 @@
 #include <string>
 
 #include "Scene/GameObject.h"
+#include "Scene/MeshRegistry.h"
 
 class Transform;
+class AnimationClip;
+class CompressedClip;
 
 class Scene
 {
 public:
 	Scene() = default;
+	Scene(const Scene&) = delete;
+	Scene& operator=(const Scene&) = delete;
 
-	inline void AddNode(GameObject* node) { m_GameObjects.emplace_back(node); };
+	/**
+	 * @brief Destroys the nodes and releases the meshes, a scene owns every node added to it
+	 * Nodes destroyed earlier are skipped, their handles are stale by then.
+	 */
+	~Scene();
 
-	inline void SetNodes(std::vector<GameObject*>& nodes) { m_GameObjects = nodes; }
+	inline void AddNode(GameObjectHandle node) { m_GameObjects.push_back(node); };
 
-	inline void SetRootNode(GameObject* go) { m_RootNode = go; }
-	inline GameObject* GetRootNode() { return m_RootNode; };
+	inline void SetNodes(std::vector<GameObjectHandle>&& nodes) { m_GameObjects = std::move(nodes); }
+
+	inline const std::vector<GameObjectHandle>& GetNodes() const { return m_GameObjects; }
+
+	inline void SetRootNode(GameObjectHandle go) { m_RootNode = go; }
+	inline GameObjectHandle GetRootNodeHandle() const { return m_RootNode; }
+
+	/**
+	 * @brief Root GameObject, null when there is none or it was destroyed
+	 */
+	inline GameObject* GetRootNode() const { return GameObject::Get(m_RootNode); };
 
 	GameObject* FindNode(const std::string& name);
+
+	/**
+	 * @brief Takes over one reference to mesh from the caller, released with the scene
+	 */
+	inline void AddMesh(MeshHandle mesh) { m_Meshes.push_back(mesh); }
+	inline const std::vector<MeshHandle>& GetMeshes() const { return m_Meshes; }
+
+	inline void AddAnimation(const std::shared_ptr<AnimationClip>& clip) { m_Animations.push_back(clip); }
+	inline const std::vector<std::shared_ptr<AnimationClip>>& GetAnimations() const { return m_Animations; }
+
+	inline void AddCompressedAnimation(const std::shared_ptr<CompressedClip>& clip) { m_CompressedAnimations.push_back(clip); }
+	inline const std::vector<std::shared_ptr<CompressedClip>>& GetCompressedAnimations() const { return m_CompressedAnimations; }
 protected:
 private:
-	std::vector<GameObject*> m_GameObjects;
+	std::vector<GameObjectHandle> m_GameObjects;
+	std::vector<MeshHandle> m_Meshes;
+	std::vector<std::shared_ptr<AnimationClip>> m_Animations;
+	std::vector<std::shared_ptr<CompressedClip>> m_CompressedAnimations;
 
-	GameObject* m_RootNode;
-};
\ No newline at end of file
+	GameObjectHandle m_RootNode;
+};
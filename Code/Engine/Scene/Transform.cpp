@@ -1,41 +1,119 @@
-
 #include "Transform.h"
 
+#include <mutex>
+#include <shared_mutex>
+
 #include <glm/gtx/matrix_decompose.hpp>
 
+#include "Scene/TransformHierarchy.h"
+
+Transform::Transform()
+	: m_Row(TransformHierarchy::GetInstance().Add(this))
+{
+}
+
+Transform::~Transform()
+{
+	TransformHierarchy::GetInstance().Remove(m_Row);
+}
+
 void Transform::SetParent(Transform* transform)
 {
-	parent = transform;
-	updateWorldMatrix = true;
+	TransformHierarchy::GetInstance().SetParent(m_Row, transform ? transform->m_Row : TransformHierarchy::kInvalidRow);
+}
+
+Transform* Transform::GetParent() const
+{
+	const TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	const uint32_t parent = hierarchy.m_Parent[m_Row];
+	return parent != TransformHierarchy::kInvalidRow ? hierarchy.m_Owner[parent] : nullptr;
+}
+
+void Transform::SetTranslation(const glm::vec3& translation)
+{
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	std::shared_lock<std::shared_mutex> lock(hierarchy.m_Mutex);
+	hierarchy.m_Translation[m_Row] = translation;
+	hierarchy.MarkDirty(m_Row);
+}
+
+void Transform::SetRotation(const glm::quat& rotation)
+{
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	std::shared_lock<std::shared_mutex> lock(hierarchy.m_Mutex);
+	hierarchy.m_Rotation[m_Row] = rotation;
+	hierarchy.MarkDirty(m_Row);
+}
+
+void Transform::SetScale(const glm::vec3& scale)
+{
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	std::shared_lock<std::shared_mutex> lock(hierarchy.m_Mutex);
+	hierarchy.m_Scale[m_Row] = scale;
+	hierarchy.MarkDirty(m_Row);
+}
+
+const glm::vec3& Transform::GetTranslation() const
+{
+	return TransformHierarchy::GetInstance().m_Translation[m_Row];
+}
+
+const glm::quat& Transform::GetRotation() const
+{
+	return TransformHierarchy::GetInstance().m_Rotation[m_Row];
+}
+
+const glm::vec3& Transform::GetScale() const
+{
+	return TransformHierarchy::GetInstance().m_Scale[m_Row];
 }
 
 void Transform::SetMatrix(const glm::mat4& matrix)
 {
+	glm::vec3 translation;
+	glm::quat rotation;
+	glm::vec3 scale;
 	glm::vec3 skew;
 	glm::vec4 perspective;
 	glm::decompose(matrix, scale, rotation, translation, skew, perspective);
-	rotation = glm::conjugate(rotation);
+
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	std::shared_lock<std::shared_mutex> lock(hierarchy.m_Mutex);
+	hierarchy.m_Translation[m_Row] = translation;
+	hierarchy.m_Rotation[m_Row] = glm::conjugate(rotation);
+	hierarchy.m_Scale[m_Row] = scale;
+	hierarchy.MarkDirty(m_Row);
 }
 
-glm::mat4 Transform::GetWorldMatrix()
+glm::mat4 Transform::GetWorldMatrix() const
 {
-	UpdateWorldTransform();
+	// An update running on another thread writes the cached matrices, the parent chain does not need them
+	std::shared_lock<std::shared_mutex> lock(TransformHierarchy::GetInstance().m_Mutex, std::try_to_lock);
+	return lock.owns_lock() ? GetCachedWorldMatrix() : ComputeWorldMatrix();
+}
 
-	return worldMatrix;
+glm::mat4 Transform::ComputeWorldMatrix() const
+{
+	const Transform* parent = GetParent();
+	return parent ? parent->ComputeWorldMatrix() * GetMatrix() : GetMatrix();
 }
 
-void Transform::UpdateWorldTransform()
+glm::mat4 Transform::GetCachedWorldMatrix() const
 {
-	if (!updateWorldMatrix)
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+
+	bool current = true;
+	for (const Transform* transform = this; transform && current; transform = transform->GetParent())
 	{
-		return;
+		current = hierarchy.m_Dirty[transform->m_Row].load(std::memory_order_acquire) == 0;
 	}
 
-	worldMatrix = GetMatrix();
-	if (parent)
+	if (current)
 	{
-		worldMatrix = parent->GetWorldMatrix() * worldMatrix;
+		return hierarchy.m_World[m_Row].ToMat4();
 	}
 
-	updateWorldMatrix = false;
+	// Same association as TransformHierarchy::Update, so both give the same matrix
+	const Transform* parent = GetParent();
+	return parent ? parent->GetCachedWorldMatrix() * GetMatrix() : GetMatrix();
 }
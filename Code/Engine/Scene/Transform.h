@@ -1,50 +1,75 @@
-
 #pragma once
 
 #include "Scene/Component.h"
 #include "Framework/GlmCommon.h"
 #include <glm/gtx/quaternion.hpp>
 
+/**
+ * @brief Handle of one row of the TransformHierarchy, which holds the local and world transforms
+ */
 class Transform : public Component
 {
 public:
+	static constexpr ComponentType kComponentType = ComponentType::Transform;
+
+	Transform();
+	~Transform();
+
+	Transform(const Transform&) = delete;
+	Transform& operator=(const Transform&) = delete;
+
 	void SetParent(Transform* transform);
 
-	inline void SetTranslation(const glm::vec3& translation) { this->translation = translation; }
+	Transform* GetParent() const;
+
+	void SetTranslation(const glm::vec3& translation);
 
-	inline void SetRotation(const glm::quat& rotation) { }
+	void SetRotation(const glm::quat& rotation);
 
-	inline void SetScale(const glm::vec3& scale) { this->scale = scale; }
+	void SetScale(const glm::vec3& scale);
 
-	inline const glm::vec3& GetTranslation() const { return translation; }
+	const glm::vec3& GetTranslation() const;
 
-	inline const glm::quat& GetRotation() const { ; }
+	const glm::quat& GetRotation() const;
 
-	inline const glm::vec3& GetScale() const { return scale; }
+	const glm::vec3& GetScale() const;
 
 	void SetMatrix(const glm::mat4& matrix);
 
 	inline glm::mat4 GetMatrix() const 
 	{
-		return glm::translate(glm::mat4(1.0), translation) *
-			glm::mat4_cast(rotation) *
-			glm::scale(glm::mat4(1.0), scale);
+		return ComposeMatrix(GetTranslation(), GetRotation(), GetScale());
 	}
 
-	glm::mat4 GetWorldMatrix();
-
-	void UpdateWorldTransform();
+	/**
+	 * @brief The world matrix of the last TransformHierarchy::Update, computed from the parent chain instead when
+	 * the transform or one of its ancestors changed since, or while an update runs on another thread
+	 */
+	glm::mat4 GetWorldMatrix() const;
+
+	/**
+	 * @brief The world matrix multiplied up the parent chain from the local transforms, the cached one is not read
+	 */
+	glm::mat4 ComputeWorldMatrix() const;
+
+	/**
+	 * @brief translate(translation) * mat4_cast(rotation) * scale(scale), without the multiplications by zero
+	 */
+	static inline glm::mat4 ComposeMatrix(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		glm::mat4 matrix = glm::mat4_cast(rotation);
+		matrix[0] *= scale.x;
+		matrix[1] *= scale.y;
+		matrix[2] *= scale.z;
+		matrix[3] = glm::vec4(translation, 1.0f);
+		return matrix;
+	}
 
 private:
-	glm::vec3 translation = glm::vec3(0.0, 0.0, 0.0);
-
-	glm::quat rotation = glm::quat(1.0, 0.0, 0.0, 0.0);
-
-	glm::vec3 scale = glm::vec3(1.0, 1.0, 1.0);
-
-	glm::mat4 worldMatrix = glm::mat4(1.0);
-
-	bool updateWorldMatrix = false;
+	/**
+	 * @brief GetWorldMatrix with the hierarchy lock held shared
+	 */
+	glm::mat4 GetCachedWorldMatrix() const;
 
-	Transform* parent;
-};
\ No newline at end of file
+	uint32_t m_Row;
+};
@@ -0,0 +1,387 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Apps/BaseInclude.h"
+#include "Framework/JobSystem.h"
+#include "Math/SimdMath.h"
+#include "Scene/Transform.h"
+
+template<typename T>
+void TransformHierarchy::Column<T>::Reserve(uint32_t rowCount)
+{
+	const uint32_t chunkCount = (rowCount + kChunkSize - 1) >> kChunkShift;
+	if (chunkCount > kMaxChunks)
+	{
+		throw std::runtime_error("Too many transforms");
+	}
+
+	for (; m_ChunkCount < chunkCount; ++m_ChunkCount)
+	{
+		m_Chunks[m_ChunkCount].reset(WL_NEW(T[kChunkSize]));
+	}
+}
+
+TransformHierarchy& TransformHierarchy::GetInstance()
+{
+	static TransformHierarchy s_Instance;
+	return s_Instance;
+}
+
+uint32_t TransformHierarchy::Add(Transform* owner)
+{
+	std::lock_guard<std::shared_mutex> lock(m_Mutex);
+
+	uint32_t row;
+	if (!m_FreeRows.empty())
+	{
+		row = m_FreeRows.back();
+		m_FreeRows.pop_back();
+	}
+	else
+	{
+		row = m_RowCount;
+		m_Translation.Reserve(row + 1);
+		m_Rotation.Reserve(row + 1);
+		m_Scale.Reserve(row + 1);
+		m_World.Reserve(row + 1);
+		m_Parent.Reserve(row + 1);
+		m_FirstChild.Reserve(row + 1);
+		m_NextSibling.Reserve(row + 1);
+		m_PreviousSibling.Reserve(row + 1);
+		m_Owner.Reserve(row + 1);
+		m_Dirty.Reserve(row + 1);
+		m_RowCount++;
+	}
+
+	m_Translation[row] = glm::vec3(0.0f);
+	m_Rotation[row] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	m_Scale[row] = glm::vec3(1.0f);
+	m_World[row] = Affine3x4::FromMat4(glm::mat4(1.0f));
+	m_Parent[row] = kInvalidRow;
+	m_FirstChild[row] = kInvalidRow;
+	m_NextSibling[row] = kInvalidRow;
+	m_PreviousSibling[row] = kInvalidRow;
+	m_Owner[row] = owner;
+	m_Dirty[row].store(1, std::memory_order_relaxed);
+	m_OrderValid = false;
+	return row;
+}
+
+void TransformHierarchy::Remove(uint32_t row)
+{
+	std::lock_guard<std::shared_mutex> lock(m_Mutex);
+
+	Unlink(row);
+
+	// The children become roots, left pointing at the row they would follow the transform that reuses it
+	for (uint32_t child = m_FirstChild[row]; child != kInvalidRow;)
+	{
+		const uint32_t next = m_NextSibling[child];
+		m_Parent[child] = kInvalidRow;
+		m_NextSibling[child] = kInvalidRow;
+		m_PreviousSibling[child] = kInvalidRow;
+		MarkDirty(child);
+		child = next;
+	}
+	m_FirstChild[row] = kInvalidRow;
+
+	m_Owner[row] = nullptr;
+	m_FreeRows.push_back(row);
+	m_OrderValid = false;
+}
+
+void TransformHierarchy::SetParent(uint32_t row, uint32_t parentRow)
+{
+	std::lock_guard<std::shared_mutex> lock(m_Mutex);
+
+	Unlink(row);
+	Link(row, parentRow);
+	MarkDirty(row);
+	m_OrderValid = false;
+}
+
+void TransformHierarchy::Link(uint32_t row, uint32_t parentRow)
+{
+	m_Parent[row] = parentRow;
+	if (parentRow == kInvalidRow)
+	{
+		return;
+	}
+
+	const uint32_t next = m_FirstChild[parentRow];
+	m_NextSibling[row] = next;
+	m_PreviousSibling[row] = kInvalidRow;
+	if (next != kInvalidRow)
+	{
+		m_PreviousSibling[next] = row;
+	}
+	m_FirstChild[parentRow] = row;
+}
+
+void TransformHierarchy::Unlink(uint32_t row)
+{
+	const uint32_t parent = m_Parent[row];
+	if (parent == kInvalidRow)
+	{
+		return;
+	}
+
+	const uint32_t previous = m_PreviousSibling[row];
+	const uint32_t next = m_NextSibling[row];
+	if (previous != kInvalidRow)
+	{
+		m_NextSibling[previous] = next;
+	}
+	else
+	{
+		m_FirstChild[parent] = next;
+	}
+
+	if (next != kInvalidRow)
+	{
+		m_PreviousSibling[next] = previous;
+	}
+
+	m_Parent[row] = kInvalidRow;
+	m_NextSibling[row] = kInvalidRow;
+	m_PreviousSibling[row] = kInvalidRow;
+}
+
+void TransformHierarchy::Rebuild()
+{
+	// Children of every row, grouped by parent in row order
+	std::vector<uint32_t> childStart(m_RowCount + 1, 0);
+	std::vector<uint32_t> roots;
+	for (uint32_t row = 0; row < m_RowCount; ++row)
+	{
+		if (!m_Owner[row])
+		{
+			continue;
+		}
+
+		const uint32_t parent = m_Parent[row];
+		if (parent != kInvalidRow && m_Owner[parent])
+		{
+			childStart[parent + 1]++;
+		}
+		else
+		{
+			roots.push_back(row);
+		}
+	}
+
+	for (uint32_t row = 0; row < m_RowCount; ++row)
+	{
+		childStart[row + 1] += childStart[row];
+	}
+
+	std::vector<uint32_t> children(childStart[m_RowCount]);
+	std::vector<uint32_t> childFill(childStart.begin(), childStart.end() - 1);
+	for (uint32_t row = 0; row < m_RowCount; ++row)
+	{
+		const uint32_t parent = m_Parent[row];
+		if (m_Owner[row] && parent != kInvalidRow && m_Owner[parent])
+		{
+			children[childFill[parent]++] = row;
+		}
+	}
+
+	// Depth first, so every subtree is one range [position, subtreeEnd)
+	std::vector<uint32_t> positions(m_RowCount, kInvalidRow);
+	std::vector<uint32_t> stack(roots.rbegin(), roots.rend());
+	m_Order.clear();
+	m_OrderParent.clear();
+	while (!stack.empty())
+	{
+		const uint32_t row = stack.back();
+		stack.pop_back();
+
+		const uint32_t parent = m_Parent[row];
+		positions[row] = static_cast<uint32_t>(m_Order.size());
+		m_Order.push_back(row);
+		m_OrderParent.push_back(parent != kInvalidRow && m_Owner[parent] ? positions[parent] : kInvalidRow);
+
+		for (uint32_t child = childStart[row + 1]; child > childStart[row]; --child)
+		{
+			stack.push_back(children[child - 1]);
+		}
+	}
+
+	const uint32_t count = static_cast<uint32_t>(m_Order.size());
+	std::vector<uint32_t> subtreeEnd(count);
+	for (uint32_t position = count; position-- > 0;)
+	{
+		subtreeEnd[position] = std::max(subtreeEnd[position], position + 1);
+		const uint32_t parent = m_OrderParent[position];
+		if (parent != kInvalidRow)
+		{
+			subtreeEnd[parent] = std::max(subtreeEnd[parent], subtreeEnd[position]);
+		}
+	}
+
+	// Adjacent whole subtrees are independent of each other, pack them into partitions
+	m_Spine.clear();
+	m_Partitions.clear();
+	bool open = false;
+	for (uint32_t position = 0; position < count;)
+	{
+		const uint32_t end = subtreeEnd[position];
+		if (end - position > kPartitionSize)
+		{
+			m_Spine.push_back(position);
+			open = false;
+			position++;
+			continue;
+		}
+
+		if (open && end - m_Partitions.back().begin <= kPartitionSize)
+		{
+			m_Partitions.back().end = end;
+		}
+		else
+		{
+			m_Partitions.push_back({ position, end });
+			open = true;
+		}
+		position = end;
+	}
+
+	m_Changed.assign(count, 0);
+	for (uint32_t row : m_Order)
+	{
+		MarkDirty(row);
+	}
+
+	m_OrderValid = true;
+}
+
+uint32_t TransformHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+{
+	glm::vec3 translations[kUpdateBatchSize];
+	glm::quat rotations[kUpdateBatchSize];
+	glm::vec3 scales[kUpdateBatchSize];
+	Affine3x4 locals[kUpdateBatchSize];
+	Affine3x4 parents[kUpdateBatchSize];
+	Affine3x4 children[kUpdateBatchSize];
+	uint32_t positions[kUpdateBatchSize];
+	uint32_t pendingRows[kUpdateBatchSize];
+
+	uint32_t updated = 0;
+	for (uint32_t batchBegin = begin; batchBegin < end; batchBegin += kUpdateBatchSize)
+	{
+		const uint32_t batchEnd = std::min(end, batchBegin + kUpdateBatchSize);
+
+		uint32_t changedCount = 0;
+		for (uint32_t position = batchBegin; position < batchEnd; ++position)
+		{
+			const uint32_t row = m_Order[position];
+			const uint32_t parent = m_OrderParent[position];
+
+			bool changed = m_Dirty[row].load(std::memory_order_relaxed) != 0 && m_Dirty[row].exchange(0, std::memory_order_acquire) != 0;
+			changed = changed || (parent != kInvalidRow && m_Changed[parent]);
+			m_Changed[position] = changed;
+			if (!changed)
+			{
+				continue;
+			}
+
+			translations[changedCount] = m_Translation[row];
+			rotations[changedCount] = m_Rotation[row];
+			scales[changedCount] = m_Scale[row];
+			positions[changedCount] = position;
+			changedCount++;
+		}
+
+		SimdMath::ComposeAffine(translations, rotations, scales, locals, changedCount);
+
+		// Children whose parent is already final are multiplied in one call, a child of a pending transform (the
+		// next one down a chain) flushes the pending ones first
+		uint32_t pendingCount = 0;
+		uint32_t pendingBegin = 0;
+		auto flush = [&]()
+		{
+			SimdMath::MultiplyAffine(parents, children, children, pendingCount);
+			for (uint32_t k = 0; k < pendingCount; ++k)
+			{
+				m_World[pendingRows[k]] = children[k];
+			}
+			pendingCount = 0;
+		};
+
+		for (uint32_t i = 0; i < changedCount; ++i)
+		{
+			const uint32_t row = m_Order[positions[i]];
+			const uint32_t parent = m_OrderParent[positions[i]];
+			if (parent == kInvalidRow)
+			{
+				m_World[row] = locals[i];
+				continue;
+			}
+
+			if (pendingCount != 0 && parent >= pendingBegin && m_Changed[parent] && m_OrderParent[parent] != kInvalidRow)
+			{
+				flush();
+			}
+
+			if (pendingCount == 0)
+			{
+				pendingBegin = positions[i];
+			}
+
+			parents[pendingCount] = m_World[m_Order[parent]];
+			children[pendingCount] = locals[i];
+			pendingRows[pendingCount] = row;
+			pendingCount++;
+		}
+		flush();
+
+		updated += changedCount;
+	}
+
+	return updated;
+}
+
+TransformUpdateStatistics TransformHierarchy::Update()
+{
+	// Held until the end, the partitions read local transforms and parents other threads would write. Wait in the
+	// ParallelFor below only runs jobs of its own group, so this thread never runs a job that edits a transform.
+	std::lock_guard<std::shared_mutex> lock(m_Mutex);
+
+	TransformUpdateStatistics statistics;
+	if (!m_OrderValid)
+	{
+		Rebuild();
+		statistics.rebuilt = true;
+	}
+
+	// The spine is in order and its parents are spine transforms as well, consecutive positions go in one range
+	for (size_t i = 0; i < m_Spine.size();)
+	{
+		size_t next = i + 1;
+		while (next < m_Spine.size() && m_Spine[next] == m_Spine[next - 1] + 1)
+		{
+			next++;
+		}
+
+		statistics.updatedCount += UpdateRange(m_Spine[i], m_Spine[next - 1] + 1);
+		i = next;
+	}
+
+	std::atomic<uint32_t> updatedCount{ 0 };
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(m_Partitions.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			uint32_t updated = 0;
+			for (uint32_t partition = begin; partition < end; ++partition)
+			{
+				updated += UpdateRange(m_Partitions[partition].begin, m_Partitions[partition].end);
+			}
+			updatedCount += updated;
+		});
+
+	statistics.transformCount = static_cast<uint32_t>(m_Order.size());
+	statistics.updatedCount += updatedCount;
+	statistics.partitionCount = static_cast<uint32_t>(m_Partitions.size());
+	return statistics;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include "Framework/GlmCommon.h"
+#include "Math/SimdMath.h"
+#include <glm/gtx/quaternion.hpp>
+
+class Transform;
+
+struct TransformUpdateStatistics
+{
+	/// Transforms in the hierarchy order
+	uint32_t transformCount{ 0 };
+	/// Transforms whose world matrix was recomputed, the moved ones and everything below them
+	uint32_t updatedCount{ 0 };
+	/// Subtree ranges the parallel pass was split into
+	uint32_t partitionCount{ 0 };
+	/// The order was rebuilt because transforms were added, removed or reparented
+	bool rebuilt{ false };
+};
+
+/**
+ * @brief Local and world transforms of every Transform component in flat arrays, one array per field
+ * A Transform is a row index into the arrays. Rows never move, worker threads write the transforms of the scenes
+ * they build while the main thread updates, so the parent before child order is an index array built on top; the
+ * importers create parents before children, so the rows are mostly in that order already.
+ * Setting a local transform only flags its row. Update walks the order and recomputes the world matrix of every
+ * flagged transform and of everything below it, the ancestors of large subtrees first and then the subtrees in
+ * parallel on the job pool.
+ * Destroying a transform detaches its children, they become roots and keep their local transform.
+ * Worker threads build the scenes they load while the main thread updates, so Update holds the lock exclusively from
+ * start to end: adding, removing and reparenting take it exclusively and writing a local transform takes it shared,
+ * so those wait for the update. Every transform is written by one thread at a time, the worker building its scene
+ * until the scene is handed over and the main thread (and the jobs it waits on) afterwards.
+ */
+class TransformHierarchy
+{
+public:
+	static constexpr uint32_t kInvalidRow = 0xFFFFFFFF;
+	/// Transforms one job updates at most, larger subtrees are split below their root
+	static constexpr uint32_t kPartitionSize = 2048;
+	/// Transforms UpdateRange composes and multiplies per SimdMath call at most
+	static constexpr uint32_t kUpdateBatchSize = 64;
+
+	static TransformHierarchy& GetInstance();
+
+	/**
+	 * @brief Brings every world matrix up to date, called once per frame by the player loop
+	 * Threads building scenes meanwhile block in their transform edits until it returns.
+	 */
+	TransformUpdateStatistics Update();
+
+	inline uint32_t GetRowCount() const { return m_RowCount; }
+
+private:
+	friend class Transform;
+
+	template<typename T>
+	class Column
+	{
+	public:
+		static const uint32_t kChunkShift = 12;
+		static const uint32_t kChunkSize = 1u << kChunkShift;
+		static const uint32_t kMaxChunks = 4096;
+
+		inline T& operator[](uint32_t row) { return m_Chunks[row >> kChunkShift][row & (kChunkSize - 1)]; }
+		inline const T& operator[](uint32_t row) const { return m_Chunks[row >> kChunkShift][row & (kChunkSize - 1)]; }
+
+		/**
+		 * @brief Allocates the chunks up to rowCount, the chunk table is fixed so rows never move
+		 */
+		void Reserve(uint32_t rowCount);
+
+	private:
+		std::unique_ptr<T[]> m_Chunks[kMaxChunks];
+		uint32_t m_ChunkCount{ 0 };
+	};
+
+	/**
+	 * @brief Range of the order one job updates, every parent in it is in the range or a spine transform
+	 */
+	struct Partition
+	{
+		uint32_t begin;
+		uint32_t end;
+	};
+
+	TransformHierarchy() {};
+	~TransformHierarchy() {};
+
+	uint32_t Add(Transform* owner);
+	void Remove(uint32_t row);
+	void SetParent(uint32_t row, uint32_t parentRow);
+
+	/**
+	 * @brief Adds row to the child list of parentRow, or makes it a root, under the lock
+	 */
+	void Link(uint32_t row, uint32_t parentRow);
+	void Unlink(uint32_t row);
+
+	inline void MarkDirty(uint32_t row) { m_Dirty[row].store(1, std::memory_order_release); }
+
+	/**
+	 * @brief Sorts the live rows parent before child (depth first, so subtrees are contiguous) and splits the order
+	 * into the spine, the roots of the subtrees larger than a partition, and partitions of whole subtrees
+	 */
+	void Rebuild();
+
+	/**
+	 * @brief Recomputes the dirty transforms of order positions [begin, end), returns how many
+	 * The local matrices of a batch are composed in one SimdMath call, the products with the parents in runs of
+	 * transforms whose parent is already up to date.
+	 */
+	uint32_t UpdateRange(uint32_t begin, uint32_t end);
+
+	Column<glm::vec3> m_Translation;
+	Column<glm::quat> m_Rotation;
+	Column<glm::vec3> m_Scale;
+	Column<Affine3x4> m_World;
+	Column<uint32_t> m_Parent;
+	/// Child lists, so removing a transform finds its children without a scan
+	Column<uint32_t> m_FirstChild;
+	Column<uint32_t> m_NextSibling;
+	Column<uint32_t> m_PreviousSibling;
+	Column<Transform*> m_Owner;
+	Column<std::atomic<uint8_t>> m_Dirty;
+
+	std::shared_mutex m_Mutex;
+	uint32_t m_RowCount{ 0 };
+	std::vector<uint32_t> m_FreeRows;
+	bool m_OrderValid{ false };
+
+	/// Row of every order position and the order position of its parent
+	std::vector<uint32_t> m_Order;
+	std::vector<uint32_t> m_OrderParent;
+	/// Whether the world matrix of an order position changed in the running update, read by its children
+	std::vector<uint8_t> m_Changed;
+	std::vector<uint32_t> m_Spine;
+	std::vector<Partition> m_Partitions;
+};
@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/FileSystem.h"
+#include "Framework/JobSystem.h"
+#include "ModelReader/AssetCache.h"
+#include "ModelReader/GltfReader.h"
+#include "Render/GlslCompiler.h"
+
+/**
+ * @brief Command line of one cook run
+ */
+struct CookOptions
+{
+	std::string sourceDirectory;
+	std::string outputDirectory;
+	std::string reportPath;
+	/// 0 uses one thread per hardware core
+	uint32_t threadCount = 0;
+	/// Drop the cache and cook every asset again
+	bool force = false;
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+};
+
+/**
+ * @brief Result of compiling one GLSL file
+ */
+struct ShaderCookTiming
+{
+	std::string path;
+	bool succeeded{ false };
+	size_t spirvWords{ 0 };
+	double seconds{ 0.0 };
+};
+
+struct ShaderCookStatistics
+{
+	uint32_t shaderCount{ 0 };
+	uint32_t failedCount{ 0 };
+	double seconds{ 0.0 };
+	std::vector<ShaderCookTiming> timings;
+};
+
+static void PrintUsage()
+{
+	std::cout << "Usage: AssetCook <source directory> <output directory> [options]\n"
+		<< "  --report <file>        Write a JSON timing report\n"
+		<< "  --threads <count>      Worker threads, all cores by default\n"
+		<< "  --force                Drop the cache and cook every asset, not only the ones whose inputs changed\n"
+		<< "  --quantize             Quantize vertex attributes\n"
+		<< "  --compress-animations  Compress animation clips\n"
+		<< "  --no-optimize          Skip vertex cache, overdraw and fetch optimization\n"
+		<< "  --no-meshlets          Skip meshlet generation\n"
+		<< "  --no-lods              Skip LOD generation\n"
+		<< "  --log                  Print import statistics of every asset" << std::endl;
+}
+
+static bool ParseOptions(int argc, char** argv, CookOptions& options)
+{
+	std::vector<std::string> positional;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--report" && i + 1 < argc)
+		{
+			options.reportPath = argv[++i];
+		}
+		else if (argument == "--threads" && i + 1 < argc)
+		{
+			options.threadCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--force")
+		{
+			options.force = true;
+		}
+		else if (argument == "--quantize")
+		{
+			options.settings.quantizeVertices = true;
+		}
+		else if (argument == "--compress-animations")
+		{
+			options.settings.compressAnimations = true;
+		}
+		else if (argument == "--no-optimize")
+		{
+			options.settings.optimizeMeshes = false;
+		}
+		else if (argument == "--no-meshlets")
+		{
+			options.settings.buildMeshlets = false;
+		}
+		else if (argument == "--no-lods")
+		{
+			options.settings.generateLods = false;
+		}
+		else if (argument == "--log")
+		{
+			options.settings.logStatistics = true;
+		}
+		else if (argument.compare(0, 2, "--") == 0)
+		{
+			std::cout << "Unknown option " << argument << std::endl;
+			return false;
+		}
+		else
+		{
+			positional.push_back(argument);
+		}
+	}
+
+	if (positional.size() != 2)
+	{
+		return false;
+	}
+
+	options.sourceDirectory = positional[0];
+	options.outputDirectory = positional[1];
+	return true;
+}
+
+static std::string GetRelativePath(const std::string& path, std::string directory)
+{
+	std::replace(directory.begin(), directory.end(), '\\', '/');
+	while (!directory.empty() && directory.back() == '/')
+	{
+		directory.pop_back();
+	}
+
+	if (path.size() > directory.size() && path.compare(0, directory.size(), directory) == 0 && path[directory.size()] == '/')
+	{
+		return path.substr(directory.size() + 1);
+	}
+
+	return path.substr(path.find_last_of('/') + 1);
+}
+
+/**
+ * @brief Compiles every GLSL file below the source directory to <output>/shaders/<relative path>.spv
+ */
+static ShaderCookStatistics CookShaders(const CookOptions& options)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+
+	std::vector<std::string> shaders;
+	std::vector<VkShaderStageFlagBits> stages;
+	for (const std::string& path : FileSystem::ListFiles(options.sourceDirectory))
+	{
+		VkShaderStageFlagBits stage;
+		if (GlslCompiler::GetShaderStage(path, stage))
+		{
+			shaders.push_back(path);
+			stages.push_back(stage);
+		}
+	}
+
+	ShaderCookStatistics statistics;
+	statistics.shaderCount = static_cast<uint32_t>(shaders.size());
+	statistics.timings.resize(shaders.size());
+
+	std::atomic<uint32_t> failedCount{ 0 };
+	JobSystem::GetInstance().ParallelFor(static_cast<uint32_t>(shaders.size()), 1, [&](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				ShaderCookTiming& timing = statistics.timings[i];
+				timing.path = shaders[i];
+				const auto shaderStart = std::chrono::high_resolution_clock::now();
+
+				std::vector<uint32_t> spirv;
+				std::string infoLog;
+				const std::string outputPath = options.outputDirectory + "/shaders/" + GetRelativePath(shaders[i], options.sourceDirectory) + ".spv";
+				try
+				{
+					timing.succeeded = GlslCompiler::CompilerToSpriv(stages[i], FileSystem::LoadFile(shaders[i]), "main", {}, spirv, infoLog);
+				}
+				catch (const std::exception& e)
+				{
+					infoLog = e.what();
+				}
+
+				if (timing.succeeded)
+				{
+					FileSystem::MakeDirectories(outputPath.substr(0, outputPath.find_last_of('/')));
+					std::ofstream stream(outputPath, std::ios::out | std::ios::binary | std::ios::trunc);
+					stream.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+					timing.succeeded = stream.good();
+					timing.spirvWords = spirv.size();
+				}
+
+				if (!timing.succeeded)
+				{
+					std::cout << "Failed to compile " << shaders[i] << ":\n" << infoLog << std::endl;
+					failedCount++;
+				}
+
+				timing.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - shaderStart).count();
+			}
+		});
+
+	statistics.failedCount = failedCount;
+	statistics.seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return statistics;
+}
+
+static const char* GetResultName(AssetCookResult result)
+{
+	switch (result)
+	{
+	case AssetCookResult::Cooked:
+		return "cooked";
+	case AssetCookResult::NotCookable:
+		return "notCookable";
+	default:
+		return "failed";
+	}
+}
+
+/**
+ * @brief One line per imported asset, what the mesh passes, the mesh sharing and the decoders did
+ */
+static void PrintImportStatistics(const AssetCookStatistics& scenes)
+{
+	for (const AssetCookTiming& timing : scenes.timings)
+	{
+		const GltfBuildStatistics& build = timing.buildStatistics;
+		std::cout << timing.path << ": " << build.instances << " instances of " << build.usedMeshes << " meshes, " << build.decodedMeshes << " decoded"
+			<< ", ACMR " << build.GetAcmrBefore() << " -> " << build.GetAcmrAfter() << ", " << build.lodCount << " LODs, " << build.meshletCount << " meshlets";
+		if (timing.decodeStatistics.bufferViews > 0)
+		{
+			std::cout << ", meshopt " << timing.decodeStatistics.compressedBytes << " -> " << timing.decodeStatistics.decodedBytes << " bytes";
+		}
+		if (build.animations.compressedKeys > 0)
+		{
+			std::cout << ", animation keys " << build.animations.uncompressedKeys << " -> " << build.animations.compressedKeys
+				<< " (" << build.animations.GetRatio() << "x)";
+		}
+		std::cout << std::endl;
+	}
+}
+
+static bool WriteReport(const std::string& path, const CookOptions& options, const AssetCookStatistics& scenes, const ShaderCookStatistics& shaders, double totalSeconds)
+{
+	nlohmann::json report;
+	report["threads"] = JobSystem::GetInstance().GetThreadCount();
+	report["totalSeconds"] = totalSeconds;
+
+	double parseSeconds = 0.0;
+	double buildSeconds = 0.0;
+	double writeSeconds = 0.0;
+	nlohmann::json sceneFiles = nlohmann::json::array();
+	for (const AssetCookTiming& timing : scenes.timings)
+	{
+		parseSeconds += timing.parseSeconds;
+		buildSeconds += timing.buildSeconds;
+		writeSeconds += timing.writeSeconds;
+		const GltfBuildStatistics& build = timing.buildStatistics;
+		sceneFiles.push_back({ { "path", timing.path }, { "result", GetResultName(timing.result) },
+			{ "parseSeconds", timing.parseSeconds }, { "buildSeconds", timing.buildSeconds }, { "writeSeconds", timing.writeSeconds },
+			{ "meshes", { { "instances", build.instances }, { "used", build.usedMeshes }, { "decoded", build.decodedMeshes }, { "primitives", build.decodedPrimitives },
+				{ "acmrBefore", build.GetAcmrBefore() }, { "acmrAfter", build.GetAcmrAfter() }, { "lods", build.lodCount }, { "meshlets", build.meshletCount } } },
+			{ "decodedBytes", timing.decodeStatistics.decodedBytes },
+			{ "animationBytes", { { "uncompressed", build.animations.uncompressedBytes }, { "compressed", build.animations.compressedBytes } } } });
+	}
+
+	report["scenes"] = {
+		{ "assets", scenes.assetCount },
+		{ "dirty", scenes.dirtyCount },
+		{ "cooked", scenes.cookedCount },
+		// Imported without errors, but nothing was written: animated and skinned scenes have no cooked form
+		{ "notCookable", scenes.notCookableCount },
+		{ "failed", scenes.failedCount },
+		{ "hashedFiles", scenes.hashedFiles },
+		{ "scanSeconds", scenes.scanSeconds },
+		{ "cookSeconds", scenes.cookSeconds },
+		// Summed over all threads, compare with cookSeconds for the parallel speedup
+		{ "stageSeconds", { { "parse", parseSeconds }, { "build", buildSeconds }, { "write", writeSeconds } } },
+		{ "files", sceneFiles }
+	};
+
+	double compileSeconds = 0.0;
+	nlohmann::json shaderFiles = nlohmann::json::array();
+	for (const ShaderCookTiming& timing : shaders.timings)
+	{
+		compileSeconds += timing.seconds;
+		shaderFiles.push_back({ { "path", timing.path }, { "succeeded", timing.succeeded }, { "spirvWords", timing.spirvWords }, { "seconds", timing.seconds } });
+	}
+
+	report["shaders"] = {
+		{ "count", shaders.shaderCount },
+		{ "failed", shaders.failedCount },
+		{ "seconds", shaders.seconds },
+		{ "compileSeconds", compileSeconds },
+		{ "files", shaderFiles }
+	};
+
+	report["settings"] = {
+		{ "force", options.force },
+		{ "optimizeMeshes", options.settings.optimizeMeshes },
+		{ "buildMeshlets", options.settings.buildMeshlets },
+		{ "generateLods", options.settings.generateLods },
+		{ "quantizeVertices", options.settings.quantizeVertices },
+		{ "compressAnimations", options.settings.compressAnimations }
+	};
+
+	std::ofstream stream(path, std::ios::out | std::ios::trunc);
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	stream << report.dump(2) << std::endl;
+	return stream.good();
+}
+
+int main(int argc, char** argv)
+{
+	CookOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	JobSystem::Initialized(options.threadCount);
+
+	if (!FileSystem::MakeDirectories(options.outputDirectory))
+	{
+		std::cout << "Cannot create " << options.outputDirectory << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	AssetCache cache(options.outputDirectory + "/scenes");
+	if (options.force)
+	{
+		for (const std::string& path : FileSystem::ListFiles(cache.GetDirectory()))
+		{
+			FileSystem::RemoveFile(path);
+		}
+	}
+	cache.LoadManifest();
+
+	const AssetCookStatistics scenes = cache.Cook(options.sourceDirectory, options.settings);
+	if (options.settings.logStatistics)
+	{
+		PrintImportStatistics(scenes);
+	}
+	const ShaderCookStatistics shaders = CookShaders(options);
+	const double totalSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	std::cout << "Scenes: " << scenes.cookedCount << " cooked, " << scenes.notCookableCount << " not cookable (no output), " << scenes.failedCount << " failed, "
+		<< scenes.assetCount - scenes.dirtyCount << " up to date (" << scenes.scanSeconds + scenes.cookSeconds << " s)" << std::endl;
+	std::cout << "Shaders: " << shaders.shaderCount - shaders.failedCount << " compiled, " << shaders.failedCount << " failed ("
+		<< shaders.seconds << " s)" << std::endl;
+	std::cout << "Total: " << totalSeconds << " s on " << JobSystem::GetInstance().GetThreadCount() << " threads" << std::endl;
+
+	if (!options.reportPath.empty() && !WriteReport(options.reportPath, options, scenes, shaders, totalSeconds))
+	{
+		std::cout << "Cannot write " << options.reportPath << std::endl;
+	}
+
+	JobSystem::Terminate();
+	return scenes.failedCount == 0 && shaders.failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
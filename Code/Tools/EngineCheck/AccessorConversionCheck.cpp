@@ -0,0 +1,113 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ModelReader/AccessorConversion.h"
+
+static void CheckConversions(size_t count, std::mt19937& random)
+{
+	std::vector<uint8_t> indices8(count);
+	for (uint8_t& index : indices8)
+	{
+		index = static_cast<uint8_t>(random());
+	}
+	std::vector<uint32_t> indices32(count);
+	for (uint32_t& index : indices32)
+	{
+		index = random() % 65536;
+	}
+
+	// One byte in front, so the sparse indices start unaligned
+	std::vector<uint8_t> sparse(count * 4 + 1);
+	for (uint8_t& value : sparse)
+	{
+		value = static_cast<uint8_t>(random());
+	}
+
+	for (SimdLevel level : GetSupportedSimdLevels())
+	{
+		AccessorConversion::SetSimdLevel(level);
+
+		std::vector<uint16_t> widened(count);
+		AccessorConversion::WidenIndices8To16(indices8.data(), widened.data(), count);
+		CHECK(std::equal(widened.begin(), widened.end(), indices8.begin()));
+
+		std::vector<uint16_t> narrowed(count);
+		CHECK(AccessorConversion::NarrowIndices32To16(indices32.data(), narrowed.data(), count));
+		CHECK(std::equal(narrowed.begin(), narrowed.end(), indices32.begin()));
+
+		// A single index that does not fit fails the whole buffer, wherever it is
+		if (count > 0)
+		{
+			std::vector<uint32_t> tooLarge = indices32;
+			tooLarge[random() % count] = 65536 + random() % 100;
+			CHECK(!AccessorConversion::NarrowIndices32To16(tooLarge.data(), narrowed.data(), count));
+		}
+
+		for (uint32_t componentSize : { 1u, 2u, 4u })
+		{
+			std::vector<uint32_t> read(count);
+			const uint32_t largest = AccessorConversion::ReadSparseIndices(sparse.data() + 1, componentSize, read.data(), count);
+
+			uint32_t expectedLargest = 0;
+			bool matches = true;
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t expected = 0;
+				std::memcpy(&expected, sparse.data() + 1 + i * componentSize, componentSize);
+				matches = matches && read[i] == expected;
+				expectedLargest = std::max(expectedLargest, expected);
+			}
+			CHECK(matches);
+			CHECK(largest == expectedLargest);
+		}
+	}
+}
+
+void CheckAccessorConversion()
+{
+	const SimdLevel initialLevel = AccessorConversion::GetSimdLevel();
+	std::mt19937 random(1);
+
+	// Counts around the SSE2 and AVX2 widths, so the scalar tails are covered as well
+	for (size_t count : { 0, 1, 7, 15, 16, 17, 31, 33, 100, 1000, 1001 })
+	{
+		CheckConversions(count, random);
+	}
+
+	// Sparse values overwrite exactly the listed elements
+	std::vector<uint32_t> elements(64, 7);
+	const std::vector<uint32_t> sparseIndices = { 3, 17, 63 };
+	const std::vector<uint32_t> sparseValues = { 100, 200, 300 };
+	AccessorConversion::ApplySparseValues(reinterpret_cast<uint8_t*>(elements.data()), sizeof(uint32_t), sparseIndices.data(),
+		reinterpret_cast<const uint8_t*>(sparseValues.data()), sparseIndices.size());
+	CHECK(elements[3] == 100 && elements[17] == 200 && elements[63] == 300);
+	CHECK(std::count(elements.begin(), elements.end(), 7u) == 61);
+
+	const size_t count = 1 << 24;
+	std::vector<uint8_t> indices8(count);
+	std::vector<uint32_t> indices32(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		indices8[i] = static_cast<uint8_t>(random());
+		indices32[i] = random() % 65536;
+	}
+	std::vector<uint16_t> indices16(count);
+	std::vector<uint32_t> sparse(count);
+
+	for (SimdLevel level : GetSupportedSimdLevels())
+	{
+		AccessorConversion::SetSimdLevel(level);
+		const double widenSeconds = MeasureSeconds([&] { AccessorConversion::WidenIndices8To16(indices8.data(), indices16.data(), count); });
+		const double narrowSeconds = MeasureSeconds([&] { AccessorConversion::NarrowIndices32To16(indices32.data(), indices16.data(), count); });
+		const double sparseSeconds = MeasureSeconds([&] { AccessorConversion::ReadSparseIndices(reinterpret_cast<const uint8_t*>(indices16.data()), 2, sparse.data(), count); });
+		std::cout << "  " << GetSimdLevelName(level) << ": widen " << count * 3 / widenSeconds * 1e-9 << " GB/s, narrow " << count * 6 / narrowSeconds * 1e-9
+			<< " GB/s, sparse 16-bit " << count * 6 / sparseSeconds * 1e-9 << " GB/s" << std::endl;
+	}
+
+	AccessorConversion::SetSimdLevel(initialLevel);
+}
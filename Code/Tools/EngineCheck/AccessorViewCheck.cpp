@@ -0,0 +1,113 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+static void CheckStridedView()
+{
+	// Two interleaved vec3 streams in one shared buffer, the views only point into it
+	const uint32_t count = 100;
+	std::vector<float> interleaved(count * 6);
+	for (uint32_t i = 0; i < interleaved.size(); ++i)
+	{
+		interleaved[i] = static_cast<float>(i);
+	}
+	std::vector<uint8_t> bytes(interleaved.size() * sizeof(float));
+	std::memcpy(bytes.data(), interleaved.data(), bytes.size());
+	const AccessorView shared = AccessorView::FromData(std::move(bytes), 6 * sizeof(float), count, VK_FORMAT_R32G32B32_SFLOAT);
+
+	AccessorView second = shared;
+	second.offset += 3 * sizeof(float);
+	CHECK(second.owner == shared.owner);
+	CHECK(!second.IsTightlyPacked());
+	CHECK(second.At(7) == shared.Data() + 7 * 6 * sizeof(float) + 3 * sizeof(float));
+	CHECK(second.ByteSize() == count * 6 * sizeof(float));
+
+	const std::vector<uint8_t> packed = second.CopyPacked();
+	CHECK(packed.size() == count * 3 * sizeof(float));
+	const float* values = reinterpret_cast<const float*>(packed.data());
+	bool matches = packed.size() == count * 3 * sizeof(float);
+	for (uint32_t i = 0; matches && i < count * 3; ++i)
+	{
+		matches = values[i] == interleaved[(i / 3) * 6 + 3 + i % 3];
+	}
+	CHECK(matches);
+
+	// A repacked view owns its copy and outlives the vector it was made from
+	const AccessorView copy = AccessorView::FromData(std::vector<uint8_t>(packed), 3 * sizeof(float), count, VK_FORMAT_R32G32B32_SFLOAT);
+	CHECK(copy.IsValid() && copy.IsTightlyPacked());
+	CHECK(copy.owner != shared.owner);
+	CHECK(std::memcmp(copy.Data(), packed.data(), packed.size()) == 0);
+	CHECK(!AccessorView().IsValid());
+}
+
+void CheckAccessorViews()
+{
+	CheckStridedView();
+
+	const SubMesh source = MakeGridSubMesh(256, 256);
+	const std::string path = MakeCheckDirectory("accessor_views") + "/grid.gltf";
+	CHECK(WriteGltf(path, { &source }));
+
+	// Without the mesh passes, the runtime defaults, the streams reach the SubMesh as they are in the file
+	const GltfImportSettings settings;
+
+	// Peak resident set around the loads, printed next to the size of the buffer they map
+	const size_t peakBefore = GetPeakResidentBytes();
+	Scene* scene = nullptr;
+	const double seconds = MeasureSeconds([&]
+		{
+			if (scene)
+			{
+				WL_DELETE(scene);
+			}
+			scene = GltfReader::LoadSource(path.c_str(), settings);
+		});
+	CHECK(scene != nullptr && scene->GetMeshes().size() == 1);
+	if (!scene || scene->GetMeshes().size() != 1)
+	{
+		return;
+	}
+
+	const Mesh* mesh = MeshRegistry::GetInstance().Get(scene->GetMeshes()[0]);
+	CHECK(mesh && mesh->GetSubmeshes().size() == 1);
+	if (mesh && mesh->GetSubmeshes().size() == 1)
+	{
+		const SubMesh& subMesh = mesh->GetSubmeshes()[0];
+		const auto position = subMesh.vertexBuffers.find("position");
+		CHECK(position != subMesh.vertexBuffers.end());
+
+		// The positions and 16-bit indices point into the glTF buffer instead of copies of it
+		if (position != subMesh.vertexBuffers.end())
+		{
+			CHECK(position->second.IsTightlyPacked());
+			CHECK(position->second.owner && position->second.owner == subMesh.indexBuffer.owner);
+		}
+		CHECK(subMesh.indexType == VK_INDEX_TYPE_UINT16);
+
+		std::vector<glm::vec3> expectedPositions;
+		std::vector<glm::vec3> positions;
+		CHECK(MeshUtils::ReadPositions(source, expectedPositions));
+		CHECK(MeshUtils::ReadPositions(subMesh, positions));
+		CHECK(positions == expectedPositions);
+		CHECK(MeshUtils::ReadIndices(subMesh) == MeshUtils::ReadIndices(source));
+	}
+
+	const size_t peakAfter = GetPeakResidentBytes();
+	CHECK(peakAfter > 0 && peakAfter >= peakBefore);
+
+	const double megabytes = std::filesystem::file_size(path.substr(0, path.size() - 5) + ".bin") * 1e-6;
+	std::cout << "  " << source.vertexCount << " vertices: " << megabytes << " MB buffer loaded at " << megabytes / seconds << " MB/s, peak resident set "
+		<< peakAfter * 1e-6 << " MB (+" << (peakAfter - peakBefore) * 1e-6 << " MB during the loads)" << std::endl;
+
+	WL_DELETE(scene);
+}
@@ -0,0 +1,169 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationSampler.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Transform.h"
+
+/**
+ * @brief Rotation, translation and scale of every target, in target order
+ */
+static std::vector<float> ReadPoses(const std::vector<Transform*>& targets)
+{
+	std::vector<float> poses;
+	poses.reserve(targets.size() * 10);
+	for (const Transform* target : targets)
+	{
+		const glm::quat rotation = target->GetRotation();
+		const glm::vec3 translation = target->GetTranslation();
+		const glm::vec3 scale = target->GetScale();
+		poses.insert(poses.end(), { rotation.x, rotation.y, rotation.z, rotation.w, translation.x, translation.y, translation.z, scale.x, scale.y, scale.z });
+	}
+	return poses;
+}
+
+void CheckAnimationSampler()
+{
+	const uint32_t targetCount = 4000;
+	const uint32_t keyCount = 64;
+	const float keyRate = 30.0f;
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+
+	std::vector<float> times(keyCount);
+	for (uint32_t k = 0; k < keyCount; ++k)
+	{
+		times[k] = k / keyRate;
+	}
+
+	// Every tenth scale channel steps, the rest are linear
+	std::vector<GameObjectHandle> nodes;
+	std::vector<Transform*> targets;
+	auto clip = std::make_shared<AnimationClip>("check");
+	for (uint32_t n = 0; n < targetCount; ++n)
+	{
+		GameObject* go = CreateGameObject("target");
+		nodes.push_back(go->GetHandle());
+		targets.push_back(go->AddComponent<Transform>());
+		const uint32_t target = clip->AddTarget(targets.back());
+
+		std::vector<float> vectors(keyCount * 3);
+		for (float& value : vectors)
+		{
+			value = component(random);
+		}
+		std::vector<float> rotations;
+		for (uint32_t k = 0; k < keyCount; ++k)
+		{
+			const glm::quat rotation = glm::normalize(glm::quat(component(random), component(random), component(random), component(random)));
+			rotations.insert(rotations.end(), { rotation.x, rotation.y, rotation.z, rotation.w });
+		}
+
+		clip->AddChannel(target, AnimationPath::Translation, AnimationInterpolation::Linear, times.data(), keyCount, vectors.data(), 3);
+		clip->AddChannel(target, AnimationPath::Rotation, AnimationInterpolation::Linear, times.data(), keyCount, rotations.data(), 4);
+		clip->AddChannel(target, AnimationPath::Scale, n % 10 == 0 ? AnimationInterpolation::Step : AnimationInterpolation::Linear, times.data(), keyCount, vectors.data(), 3);
+	}
+	clip->Finalize();
+
+	// Every SIMD path writes the values of the scalar one, at the keys, between them and outside the clip
+	const SimdLevel initialLevel = AnimationSampler::GetSimdLevel();
+	const std::vector<SimdLevel> levels = GetSupportedSimdLevels();
+	std::vector<std::vector<float>> poses(levels.size());
+	for (size_t l = 0; l < levels.size(); ++l)
+	{
+		AnimationSampler::SetSimdLevel(levels[l]);
+		AnimationState state(clip);
+		for (float time : { 0.0f, 0.51f, 0.77f, 1.3f, 2.05f, 0.2f, 5.0f })
+		{
+			state.time = time;
+			AnimationSampler::Sample(state);
+			const std::vector<float> pose = ReadPoses(targets);
+			poses[l].insert(poses[l].end(), pose.begin(), pose.end());
+		}
+	}
+	for (size_t l = 1; l < levels.size(); ++l)
+	{
+		CHECK(poses[l] == poses[0]);
+	}
+
+	// Between two keys, translation matches the scalar blend, step channels hold the first key and the
+	// corrected nlerp stays close to slerp
+	const float time = 0.77f;
+	const uint32_t key = static_cast<uint32_t>(time * keyRate);
+	const float t = (time - times[key]) / (times[key + 1] - times[key]);
+	AnimationState state(clip);
+	state.time = time;
+	AnimationSampler::Sample(state);
+
+	float worstTranslation = 0.0f;
+	float worstAngle = 0.0f;
+	bool stepsHold = true;
+	for (const AnimationChannel& channel : clip->GetChannels())
+	{
+		const float* values = clip->GetValues(channel);
+		const Transform* target = clip->GetTargets()[channel.target];
+		if (channel.path == AnimationPath::Translation)
+		{
+			glm::vec3 expected;
+			AnimationSampler::Blend(channel.path, values + key * 3, values + (key + 1) * 3, t, &expected.x);
+			worstTranslation = std::max(worstTranslation, glm::length(target->GetTranslation() - expected));
+		}
+		else if (channel.path == AnimationPath::Rotation)
+		{
+			const glm::quat a(values[key * 4 + 3], values[key * 4], values[key * 4 + 1], values[key * 4 + 2]);
+			glm::quat b(values[key * 4 + 7], values[key * 4 + 4], values[key * 4 + 5], values[key * 4 + 6]);
+			b = glm::dot(a, b) < 0.0f ? -b : b;
+			const float d = std::abs(glm::dot(glm::slerp(a, b, t), target->GetRotation()));
+			worstAngle = std::max(worstAngle, 2.0f * std::acos(std::min(1.0f, d)));
+		}
+		else if (channel.path == AnimationPath::Scale && channel.interpolation == AnimationInterpolation::Step)
+		{
+			stepsHold = stepsHold && target->GetScale() == glm::vec3(values[key * 3], values[key * 3 + 1], values[key * 3 + 2]);
+		}
+	}
+	CHECK(worstTranslation <= 1e-6f);
+	CHECK(worstAngle <= 2e-3f);
+	CHECK(stepsHold);
+
+	const uint32_t channelCount = static_cast<uint32_t>(clip->GetChannels().size());
+	const uint32_t frames = 500;
+	for (SimdLevel level : levels)
+	{
+		AnimationSampler::SetSimdLevel(level);
+		AnimationState playback(clip);
+		const double singleSeconds = MeasureSeconds([&]
+			{
+				for (uint32_t f = 0; f < frames; ++f)
+				{
+					playback.Advance(1.0f / 60.0f);
+					AnimationSampler::Sample(playback);
+				}
+			}, 3);
+		const double parallelSeconds = MeasureSeconds([&]
+			{
+				for (uint32_t f = 0; f < frames; ++f)
+				{
+					playback.Advance(1.0f / 60.0f);
+					AnimationSampler::SampleParallel(playback);
+				}
+			}, 3);
+		std::cout << "  " << GetSimdLevelName(level) << ": " << channelCount * frames / singleSeconds * 1e-6 << " M channels/s, "
+			<< channelCount * frames / parallelSeconds * 1e-6 << " M channels/s parallel" << std::endl;
+	}
+	std::cout << "  largest rotation error against slerp " << worstAngle << " rad" << std::endl;
+
+	AnimationSampler::SetSimdLevel(initialLevel);
+	for (GameObjectHandle node : nodes)
+	{
+		GameObject::Destroy(node);
+	}
+}
@@ -0,0 +1,117 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "ModelReader/AssetCache.h"
+#include "ModelReader/CookedScene.h"
+#include "Scene/Scene.h"
+
+/**
+ * @brief Cooks the sources with a fresh cache on the manifest of the last one, the way the cook tool runs
+ */
+static AssetCookStatistics CookAgain(const std::string& cacheDirectory, const std::string& sourceDirectory, const GltfImportSettings& settings, double& seconds)
+{
+	AssetCache cache(cacheDirectory);
+	cache.LoadManifest();
+	const auto start = std::chrono::high_resolution_clock::now();
+	AssetCookStatistics statistics = cache.Cook(sourceDirectory, settings);
+	seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	return statistics;
+}
+
+static uint32_t CountCookedScenes(const std::string& cacheDirectory)
+{
+	uint32_t count = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(cacheDirectory))
+	{
+		count += entry.path().extension() == COOKED_SCENE_EXTENSION ? 1 : 0;
+	}
+	return count;
+}
+
+/**
+ * @brief Moves the write time of a file, so a rewrite is seen even within the timestamp resolution
+ */
+static void Touch(const std::string& path, int seconds)
+{
+	std::error_code error;
+	std::filesystem::last_write_time(path, std::filesystem::last_write_time(path, error) + std::chrono::seconds(seconds), error);
+}
+
+static void PrintCook(const char* name, const AssetCookStatistics& statistics, double seconds)
+{
+	std::cout << "  " << name << ": " << seconds * 1e3 << " ms, " << statistics.dirtyCount << "/" << statistics.assetCount << " dirty, "
+		<< statistics.cookedCount << " cooked, " << statistics.hashedFiles << " files hashed" << std::endl;
+}
+
+void CheckAssetCache()
+{
+	// Sixteen assets in three folders, the one in copy repeats the first grid so both share one cooked scene
+	const std::string root = MakeCheckDirectory("asset_cache");
+	const std::string sourceDirectory = root + "/assets";
+	const std::string cacheDirectory = root + "/cache";
+	std::filesystem::create_directories(sourceDirectory + "/sub");
+	std::filesystem::create_directories(sourceDirectory + "/copy");
+	std::filesystem::create_directories(cacheDirectory);
+
+	const uint32_t assetCount = 16;
+	std::vector<std::string> sources;
+	for (uint32_t i = 0; i + 1 < assetCount; ++i)
+	{
+		const SubMesh grid = MakeGridSubMesh(32, 32, i + 1);
+		sources.push_back(sourceDirectory + (i % 2 ? "/sub/" : "/") + "grid" + std::to_string(i) + (i % 3 ? ".gltf" : ".glb"));
+		CHECK(WriteGltf(sources.back(), { &grid }));
+	}
+	const SubMesh firstGrid = MakeGridSubMesh(32, 32, 1);
+	CHECK(WriteGltf(sourceDirectory + "/copy/grid0.glb", { &firstGrid }));
+
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+	double seconds = 0.0;
+	AssetCookStatistics statistics = CookAgain(cacheDirectory, sourceDirectory, settings, seconds);
+	CHECK(statistics.assetCount == assetCount && statistics.dirtyCount == assetCount);
+	// Whichever of the two identical assets cooks second may find the scene of the first
+	CHECK(statistics.cookedCount >= assetCount - 1 && statistics.failedCount == 0);
+	CHECK(CountCookedScenes(cacheDirectory) == assetCount - 1);
+	PrintCook("full cook", statistics, seconds);
+
+	// Nothing changed, no input is read again
+	statistics = CookAgain(cacheDirectory, sourceDirectory, settings, seconds);
+	CHECK(statistics.dirtyCount == 0 && statistics.hashedFiles == 0);
+	PrintCook("no change", statistics, seconds);
+
+	// A rewrite with the same content is hashed again but not cooked
+	const SubMesh sameGrid = MakeGridSubMesh(32, 32, 2);
+	CHECK(WriteGltf(sources[1], { &sameGrid }));
+	Touch(sources[1], 2);
+	statistics = CookAgain(cacheDirectory, sourceDirectory, settings, seconds);
+	CHECK(statistics.dirtyCount == 0 && statistics.hashedFiles > 0);
+	PrintCook("same content", statistics, seconds);
+
+	// Other content in a buffer of the same size cooks only that asset
+	const SubMesh otherGrid = MakeGridSubMesh(32, 32, 100);
+	CHECK(WriteGltf(sources[2], { &otherGrid }));
+	Touch(sources[2], 2);
+	Touch(sources[2].substr(0, sources[2].size() - 5) + ".bin", 2);
+	statistics = CookAgain(cacheDirectory, sourceDirectory, settings, seconds);
+	CHECK(statistics.dirtyCount == 1 && statistics.cookedCount == 1);
+	PrintCook("one asset changed", statistics, seconds);
+
+	// A deleted source takes its cooked scene with it
+	std::filesystem::remove(sources[4]);
+	statistics = CookAgain(cacheDirectory, sourceDirectory, settings, seconds);
+	CHECK(statistics.assetCount == assetCount - 1 && statistics.dirtyCount == 0);
+	CHECK(CountCookedScenes(cacheDirectory) == assetCount - 2);
+	PrintCook("one source deleted", statistics, seconds);
+
+	// Loading through the cache maps the cooked scene
+	AssetCache cache(cacheDirectory);
+	CHECK(cache.LoadManifest());
+	Scene* scene = cache.Load(sources[3], settings);
+	CHECK(scene != nullptr && scene->GetMeshes().size() == 1);
+	WL_DELETE(scene);
+}
@@ -0,0 +1,189 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/FileSystem.h"
+
+#ifdef ASSET_COOK_PATH
+
+static const char* kVertexShader = "#version 450\nlayout(location = 0) in vec3 position;\nvoid main() { gl_Position = vec4(position, 1.0); }\n";
+
+static int RunAssetCook(const std::string& arguments)
+{
+	const std::string command = std::string("\"") + ASSET_COOK_PATH + "\" " + arguments;
+	return std::system(command.c_str());
+}
+
+/**
+ * @brief The report of a run, a discarded value when it is missing or not JSON
+ */
+static nlohmann::json LoadReport(const std::string& path)
+{
+	std::vector<uint8_t> text;
+	try
+	{
+		text = FileSystem::LoadFile(path);
+	}
+	catch (const std::exception&)
+	{
+		return nlohmann::json(nlohmann::json::value_t::discarded);
+	}
+	return nlohmann::json::parse(text.begin(), text.end(), nullptr, false);
+}
+
+static bool IsSeconds(const nlohmann::json& value)
+{
+	return value.is_number() && value.get<double>() >= 0.0;
+}
+
+static bool IsCount(const nlohmann::json& value, uint64_t count)
+{
+	return value.is_number_unsigned() && value.get<uint64_t>() == count;
+}
+
+/**
+ * @brief Shape every report has, whatever the run cooked
+ * Takes a copy, missing members read as null there and fail the type checks.
+ */
+static bool HasReportLayout(nlohmann::json report)
+{
+	if (!report.is_object() || !report.contains("scenes") || !report.contains("shaders") || !report.contains("settings"))
+	{
+		return false;
+	}
+
+	nlohmann::json& scenes = report["scenes"];
+	nlohmann::json& shaders = report["shaders"];
+	bool valid = report["threads"].is_number_unsigned() && report["threads"].get<uint32_t>() >= 1 && IsSeconds(report["totalSeconds"]);
+	for (const char* key : { "assets", "dirty", "cooked", "notCookable", "failed", "hashedFiles" })
+	{
+		valid = valid && scenes.contains(key) && scenes[key].is_number_unsigned();
+	}
+	valid = valid && IsSeconds(scenes["scanSeconds"]) && IsSeconds(scenes["cookSeconds"]) && scenes["files"].is_array();
+
+	// Stage seconds are the sums over the files
+	nlohmann::json& stageSeconds = scenes["stageSeconds"];
+	for (const char* stage : { "parse", "build", "write" })
+	{
+		double fileSeconds = 0.0;
+		for (nlohmann::json& file : scenes["files"])
+		{
+			valid = valid && file["path"].is_string() && file["result"].is_string() && IsSeconds(file[std::string(stage) + "Seconds"])
+				&& file["meshes"]["instances"].is_number_unsigned() && IsSeconds(file["meshes"]["acmrBefore"]) && IsSeconds(file["meshes"]["acmrAfter"]);
+			fileSeconds += valid ? file[std::string(stage) + "Seconds"].get<double>() : 0.0;
+		}
+		valid = valid && IsSeconds(stageSeconds[stage]) && std::abs(stageSeconds[stage].get<double>() - fileSeconds) <= 1e-9 + 1e-9 * fileSeconds;
+	}
+
+	valid = valid && shaders["count"].is_number_unsigned() && shaders["failed"].is_number_unsigned() && IsSeconds(shaders["seconds"])
+		&& IsSeconds(shaders["compileSeconds"]) && shaders["files"].is_array() && shaders["files"].size() == shaders["count"].get<size_t>();
+	for (nlohmann::json& file : shaders["files"])
+	{
+		valid = valid && file["path"].is_string() && file["succeeded"].is_boolean() && file["spirvWords"].is_number_unsigned() && IsSeconds(file["seconds"]);
+	}
+
+	for (const char* setting : { "force", "optimizeMeshes", "buildMeshlets", "generateLods", "quantizeVertices", "compressAnimations" })
+	{
+		valid = valid && report["settings"][setting].is_boolean();
+	}
+	return valid;
+}
+
+void CheckAssetCook()
+{
+	const std::string directory = MakeCheckDirectory("asset_cook");
+	const std::string sourceDirectory = directory + "/source";
+	const std::string outputDirectory = directory + "/output";
+	const std::string reportPath = directory + "/report.json";
+	CHECK(FileSystem::MakeDirectories(sourceDirectory));
+
+	const SubMesh first = MakeGridSubMesh(32, 32, 1);
+	const SubMesh second = MakeGridSubMesh(32, 32, 2);
+	CHECK(WriteGltf(sourceDirectory + "/level.gltf", { &first, &second }));
+	CHECK(WriteGltf(sourceDirectory + "/prop.glb", { &second }));
+	CHECK(FileSystem::WriteFile(sourceDirectory + "/simple.vert", kVertexShader, std::strlen(kVertexShader)));
+
+	const std::string paths = "\"" + sourceDirectory + "\" \"" + outputDirectory + "\" --report \"" + reportPath + "\"";
+
+	// A clean cook: every scene and shader is cooked and reported
+	CHECK(RunAssetCook(paths + " --force") == 0);
+	const nlohmann::json cook = LoadReport(reportPath);
+	CHECK(HasReportLayout(cook));
+	if (HasReportLayout(cook))
+	{
+		const nlohmann::json& scenes = cook["scenes"];
+		CHECK(IsCount(scenes["assets"], 2) && IsCount(scenes["dirty"], 2) && IsCount(scenes["cooked"], 2));
+		CHECK(IsCount(scenes["notCookable"], 0) && IsCount(scenes["failed"], 0));
+		CHECK(scenes["files"].size() == 2);
+		uint64_t instances = 0;
+		for (const nlohmann::json& file : scenes["files"])
+		{
+			// The import statistics come back from the reader, every mesh pass of the cooking settings ran
+			const nlohmann::json& meshes = file["meshes"];
+			CHECK(file["result"] == "cooked");
+			CHECK(meshes["acmrAfter"].get<double>() > 0.0 && meshes["acmrAfter"].get<double>() <= meshes["acmrBefore"].get<double>());
+			CHECK(meshes["lods"].get<uint64_t>() > 0 && meshes["meshlets"].get<uint64_t>() > 0);
+			instances += meshes["instances"].get<uint64_t>();
+		}
+		CHECK(instances == 3);
+
+		const nlohmann::json& shaders = cook["shaders"];
+		CHECK(IsCount(shaders["count"], 1) && IsCount(shaders["failed"], 0));
+		if (shaders["files"].size() == 1)
+		{
+			const nlohmann::json& shader = shaders["files"][0];
+			FileInfo info;
+			CHECK(shader["succeeded"] == true && shader["spirvWords"].get<uint64_t>() > 0);
+			CHECK(FileSystem::GetFileInfo(outputDirectory + "/shaders/simple.vert.spv", info) && info.size == shader["spirvWords"].get<uint64_t>() * 4);
+		}
+
+		CHECK(cook["settings"]["force"] == true && cook["settings"]["optimizeMeshes"] == true && cook["settings"]["quantizeVertices"] == false);
+	}
+	CHECK(!FileSystem::ListFiles(outputDirectory + "/scenes").empty());
+
+	// Nothing changed: the cache keeps every scene and the report says so
+	CHECK(RunAssetCook(paths + " --threads 1") == 0);
+	const nlohmann::json incremental = LoadReport(reportPath);
+	CHECK(HasReportLayout(incremental));
+	if (HasReportLayout(incremental))
+	{
+		CHECK(IsCount(incremental["threads"], 1));
+		CHECK(IsCount(incremental["scenes"]["assets"], 2) && IsCount(incremental["scenes"]["dirty"], 0) && IsCount(incremental["scenes"]["cooked"], 0));
+		CHECK(incremental["settings"]["force"] == false);
+	}
+
+	// A shader that does not compile fails the run, the report is still written
+	const char* brokenShader = "#version 450\nvoid main() { gl_Position = undefined; }\n";
+	CHECK(FileSystem::WriteFile(sourceDirectory + "/broken.vert", brokenShader, std::strlen(brokenShader)));
+	CHECK(RunAssetCook(paths) != 0);
+	const nlohmann::json failed = LoadReport(reportPath);
+	CHECK(HasReportLayout(failed));
+	if (HasReportLayout(failed))
+	{
+		CHECK(IsCount(failed["shaders"]["count"], 2) && IsCount(failed["shaders"]["failed"], 1));
+		CHECK(IsCount(failed["scenes"]["failed"], 0));
+	}
+
+	if (HasReportLayout(cook))
+	{
+		std::cout << "  cooked 2 scenes and 1 shader in " << cook["totalSeconds"].get<double>() * 1e3 << " ms on " << cook["threads"].get<uint32_t>()
+			<< " threads, up to date run " << (HasReportLayout(incremental) ? incremental["totalSeconds"].get<double>() * 1e3 : 0.0) << " ms" << std::endl;
+	}
+}
+
+#else
+
+void CheckAssetCook()
+{
+	std::cout << "  skipped, built without the AssetCook target" << std::endl;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Framework/JobSystem.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+static const GltfBatchStage kStages[] = { GltfBatchStage::Read, GltfBatchStage::Parse, GltfBatchStage::Build };
+
+static void DeleteScenes(std::vector<Scene*>& scenes)
+{
+	for (Scene*& scene : scenes)
+	{
+		WL_DELETE(scene);
+	}
+	scenes.clear();
+}
+
+void CheckBatchLoad()
+{
+	// Files of distinct grids, so no file takes its meshes from another one
+	const uint32_t fileCount = 12;
+	const std::string directory = MakeCheckDirectory("batch_load");
+	std::vector<std::string> paths;
+	for (uint32_t i = 0; i < fileCount; ++i)
+	{
+		const SubMesh first = MakeGridSubMesh(96, 96, 2 * i + 1);
+		const SubMesh second = MakeGridSubMesh(96, 96, 2 * i + 2);
+		paths.push_back(directory + "/grids" + std::to_string(i) + (i % 2 ? ".glb" : ".gltf"));
+		CHECK(WriteGltf(paths.back(), { &first, &second }));
+	}
+
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+	settings.useCookedScene = false;
+
+	// The batch loads every file as LoadFile does, the same content ends up in the same registry meshes
+	std::vector<Scene*> serial;
+	for (const std::string& path : paths)
+	{
+		serial.push_back(GltfReader::LoadFile(path.c_str(), settings));
+	}
+	const uint32_t meshCount = MeshRegistry::GetInstance().GetCount();
+	std::vector<Scene*> batch = GltfReader::LoadFiles(paths, settings);
+	CHECK(batch.size() == serial.size());
+	CHECK(MeshRegistry::GetInstance().GetCount() == meshCount);
+	for (size_t i = 0; i < serial.size() && i < batch.size(); ++i)
+	{
+		CHECK(serial[i] && batch[i]);
+		if (serial[i] && batch[i])
+		{
+			CHECK(serial[i]->GetMeshes().size() == 2);
+			CHECK(batch[i]->GetMeshes() == serial[i]->GetMeshes());
+			CHECK(batch[i]->GetNodes().size() == serial[i]->GetNodes().size());
+		}
+	}
+	DeleteScenes(serial);
+	DeleteScenes(batch);
+
+	// A missing file is read, fails to parse and still finishes its stages, so the progress ends at 1
+	std::vector<std::string> batchPaths = paths;
+	batchPaths.insert(batchPaths.begin() + fileCount / 2, directory + "/missing.gltf");
+	GltfBatchHandle load = GltfReader::LoadFilesAsync(batchPaths, settings);
+
+	// Polled from this thread while the workers run the batch, without workers only Wait runs it
+	float lastProgress = 0.0f;
+	bool progressMonotonic = true;
+	while (JobSystem::GetInstance().GetThreadCount() > 1 && !load->IsDone())
+	{
+		const float progress = load->GetProgress();
+		progressMonotonic = progressMonotonic && progress >= lastProgress && progress <= 1.0f;
+		lastProgress = progress;
+		std::this_thread::yield();
+	}
+	load->Wait();
+
+	CHECK(progressMonotonic);
+	CHECK(load->GetProgress() == 1.0f);
+	CHECK(load->GetFileCount() == fileCount + 1);
+	CHECK(load->GetLoadedCount() == fileCount && load->GetFailedCount() == 1);
+	CHECK(load->GetStageCount(GltfBatchStage::Read) == fileCount + 1);
+	CHECK(load->GetStageCount(GltfBatchStage::Parse) == fileCount);
+
+	// Stage seconds add up the files, each file ran its stages one after another within the wall time
+	double longestFile = 0.0;
+	for (GltfBatchStage stage : kStages)
+	{
+		double fileSeconds = 0.0;
+		for (const GltfBatchFile& file : load->GetFiles())
+		{
+			fileSeconds += file.stageSeconds[static_cast<size_t>(stage)];
+		}
+		CHECK(load->GetStageSeconds(stage) > 0.0);
+		CHECK(std::abs(load->GetStageSeconds(stage) - fileSeconds) < 1e-6 * (fileCount + 1));
+	}
+	for (const GltfBatchFile& file : load->GetFiles())
+	{
+		CHECK((file.scene == nullptr) == (file.path == batchPaths[fileCount / 2]));
+		CHECK(!file.cooked);
+		longestFile = std::max(longestFile, file.stageSeconds[0] + file.stageSeconds[1] + file.stageSeconds[2]);
+	}
+	CHECK(load->GetElapsedSeconds() >= longestFile);
+	std::vector<Scene*> scenes = load->GetScenes();
+	DeleteScenes(scenes);
+
+	// Wall time of the pipeline against the loop it replaces, each run decodes every file
+	const double serialSeconds = MeasureSeconds([&]
+		{
+			for (const std::string& path : paths)
+			{
+				serial.push_back(GltfReader::LoadFile(path.c_str(), settings));
+			}
+			DeleteScenes(serial);
+		}, 3);
+	const double batchSeconds = MeasureSeconds([&]
+		{
+			batch = GltfReader::LoadFiles(paths, settings);
+			DeleteScenes(batch);
+		}, 3);
+	CHECK(MeshRegistry::GetInstance().GetCount() == meshCount - 2 * fileCount);
+
+	std::cout << "  " << fileCount << " files: LoadFile loop " << serialSeconds * 1e3 << " ms, LoadFiles " << batchSeconds * 1e3 << " ms ("
+		<< serialSeconds / batchSeconds << "x), stages read " << load->GetStageSeconds(GltfBatchStage::Read) * 1e3 << " ms, parse "
+		<< load->GetStageSeconds(GltfBatchStage::Parse) * 1e3 << " ms, build " << load->GetStageSeconds(GltfBatchStage::Build) * 1e3
+		<< " ms in " << load->GetElapsedSeconds() * 1e3 << " ms" << std::endl;
+}
@@ -0,0 +1,230 @@
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/FileSystem.h"
+#include "Geometry/MeshUtils.h"
+
+SubMesh MakeGridSubMesh(uint32_t columns, uint32_t rows, uint32_t seed)
+{
+	const uint32_t vertexCount = (columns + 1) * (rows + 1);
+
+	std::vector<uint32_t> shuffle(vertexCount);
+	std::iota(shuffle.begin(), shuffle.end(), 0u);
+	std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(seed));
+
+	std::vector<glm::vec3> positions(vertexCount);
+	std::vector<glm::vec3> normals(vertexCount);
+	std::vector<glm::vec2> texcoords(vertexCount);
+	for (uint32_t y = 0; y <= rows; ++y)
+	{
+		for (uint32_t x = 0; x <= columns; ++x)
+		{
+			const float u = static_cast<float>(x) / columns;
+			const float v = static_cast<float>(y) / rows;
+			const float height = 0.05f * std::sin(u * 12.0f) * std::cos(v * 9.0f);
+			const float slopeU = 0.6f * std::cos(u * 12.0f) * std::cos(v * 9.0f) / columns;
+			const float slopeV = -0.45f * std::sin(u * 12.0f) * std::sin(v * 9.0f) / rows;
+
+			const uint32_t vertex = shuffle[y * (columns + 1) + x];
+			positions[vertex] = glm::vec3(u, height, v);
+			normals[vertex] = glm::normalize(glm::vec3(-slopeU * columns, 1.0f, -slopeV * rows));
+			texcoords[vertex] = glm::vec2(u, v);
+		}
+	}
+
+	std::vector<uint32_t> indices;
+	indices.reserve(static_cast<size_t>(columns) * rows * 6);
+	for (uint32_t y = 0; y < rows; ++y)
+	{
+		for (uint32_t x = 0; x < columns; ++x)
+		{
+			const uint32_t v00 = shuffle[y * (columns + 1) + x];
+			const uint32_t v10 = shuffle[y * (columns + 1) + x + 1];
+			const uint32_t v01 = shuffle[(y + 1) * (columns + 1) + x];
+			const uint32_t v11 = shuffle[(y + 1) * (columns + 1) + x + 1];
+			indices.insert(indices.end(), { v00, v01, v10, v10, v01, v11 });
+		}
+	}
+
+	SubMesh subMesh;
+	subMesh.vertexCount = vertexCount;
+	subMesh.vertexIndices = static_cast<uint32_t>(indices.size());
+	subMesh.indexType = VK_INDEX_TYPE_UINT32;
+	subMesh.indexBuffer = MakeAccessorView(indices, VK_FORMAT_R32_UINT);
+	subMesh.vertexBuffers["position"] = MakeAccessorView(positions, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.vertexBuffers["normal"] = MakeAccessorView(normals, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.vertexBuffers["texcoord_0"] = MakeAccessorView(texcoords, VK_FORMAT_R32G32_SFLOAT);
+	return subMesh;
+}
+
+std::string MakeCheckDirectory(const std::string& name)
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "EngineCheck" / name;
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory, error);
+	return directory.generic_string();
+}
+
+/**
+ * @brief glTF accessor type of a float vertex format, nullptr for the formats the writer skips
+ */
+static const char* GetFloatAccessorType(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R32G32_SFLOAT:
+		return "VEC2";
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		return "VEC3";
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		return "VEC4";
+	default:
+		return nullptr;
+	}
+}
+
+bool WriteGltf(const std::string& path, const std::vector<const SubMesh*>& subMeshes)
+{
+	static const uint32_t kComponentFloat = 5126;
+	static const uint32_t kComponentUnsignedShort = 5123;
+	static const uint32_t kComponentUnsignedInt = 5125;
+	static const uint32_t kArrayBuffer = 34962;
+	static const uint32_t kElementArrayBuffer = 34963;
+
+	std::vector<uint8_t> bin;
+	nlohmann::json accessors = nlohmann::json::array();
+	nlohmann::json bufferViews = nlohmann::json::array();
+
+	// Every bufferView starts 4 byte aligned, as the specification requires for its elements
+	auto addData = [&](const void* data, size_t size, uint32_t target)
+	{
+		const size_t offset = bin.size();
+		bin.resize(offset + ((size + 3) & ~size_t(3)), 0);
+		std::memcpy(bin.data() + offset, data, size);
+		bufferViews.push_back({ { "buffer", 0 }, { "byteOffset", offset }, { "byteLength", size }, { "target", target } });
+		return bufferViews.size() - 1;
+	};
+
+	nlohmann::json meshes = nlohmann::json::array();
+	nlohmann::json nodes = nlohmann::json::array();
+	nlohmann::json children = nlohmann::json::array();
+	nodes.push_back({ { "name", "root" } });
+
+	for (const SubMesh* subMesh : subMeshes)
+	{
+		nlohmann::json attributes = nlohmann::json::object();
+		for (const auto& vertexBuffer : subMesh->vertexBuffers)
+		{
+			const char* type = GetFloatAccessorType(vertexBuffer.second.format);
+			if (!type || vertexBuffer.second.count != subMesh->vertexCount)
+			{
+				continue;
+			}
+
+			const std::vector<uint8_t> data = vertexBuffer.second.CopyPacked();
+			nlohmann::json accessor = { { "bufferView", addData(data.data(), data.size(), kArrayBuffer) }, { "componentType", kComponentFloat },
+				{ "count", subMesh->vertexCount }, { "type", type } };
+
+			std::string semantic = vertexBuffer.first;
+			std::transform(semantic.begin(), semantic.end(), semantic.begin(), ::toupper);
+			if (semantic == "POSITION")
+			{
+				std::vector<glm::vec3> positions;
+				MeshUtils::ReadPositions(*subMesh, positions);
+				glm::vec3 minimum = positions.empty() ? glm::vec3(0.0f) : positions[0];
+				glm::vec3 maximum = minimum;
+				for (const glm::vec3& position : positions)
+				{
+					minimum = glm::min(minimum, position);
+					maximum = glm::max(maximum, position);
+				}
+				accessor["min"] = { minimum.x, minimum.y, minimum.z };
+				accessor["max"] = { maximum.x, maximum.y, maximum.z };
+			}
+
+			attributes[semantic] = accessors.size();
+			accessors.push_back(accessor);
+		}
+
+		nlohmann::json primitive = { { "attributes", attributes }, { "mode", 4 } };
+
+		const std::vector<uint32_t> indices = MeshUtils::ReadIndices(*subMesh);
+		if (subMesh->indexBuffer.IsValid() && !indices.empty())
+		{
+			const bool narrow = subMesh->vertexCount <= 0x10000;
+			std::vector<uint16_t> narrowIndices(narrow ? indices.size() : 0);
+			std::copy(indices.begin(), indices.begin() + narrowIndices.size(), narrowIndices.begin());
+
+			const size_t bufferView = narrow ? addData(narrowIndices.data(), narrowIndices.size() * sizeof(uint16_t), kElementArrayBuffer)
+				: addData(indices.data(), indices.size() * sizeof(uint32_t), kElementArrayBuffer);
+			primitive["indices"] = accessors.size();
+			accessors.push_back({ { "bufferView", bufferView }, { "componentType", narrow ? kComponentUnsignedShort : kComponentUnsignedInt },
+				{ "count", indices.size() }, { "type", "SCALAR" } });
+		}
+
+		children.push_back(nodes.size());
+		nodes.push_back({ { "name", "mesh" + std::to_string(meshes.size()) }, { "mesh", meshes.size() } });
+		meshes.push_back({ { "primitives", nlohmann::json::array({ primitive }) } });
+	}
+	nodes[0]["children"] = children;
+
+	const bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".glb") == 0;
+	nlohmann::json buffer = { { "byteLength", bin.size() } };
+	if (!binary)
+	{
+		const std::string binPath = path.substr(0, path.find_last_of('.')) + ".bin";
+		buffer["uri"] = binPath.substr(binPath.find_last_of("/\\") + 1);
+		if (!FileSystem::WriteFile(binPath, bin.data(), bin.size()))
+		{
+			return false;
+		}
+	}
+
+	nlohmann::json document = {
+		{ "asset", { { "version", "2.0" } } },
+		{ "scene", 0 },
+		{ "scenes", nlohmann::json::array({ nlohmann::json{ { "nodes", nlohmann::json::array({ 0 }) } } }) },
+		{ "nodes", nodes },
+		{ "meshes", meshes },
+		{ "accessors", accessors },
+		{ "bufferViews", bufferViews },
+		{ "buffers", nlohmann::json::array({ buffer }) } };
+
+	std::string text = document.dump();
+	if (!binary)
+	{
+		return FileSystem::WriteFile(path, text.data(), text.size());
+	}
+
+	// Header, JSON chunk padded with spaces and BIN chunk padded with zeros, see the GLB layout in the specification
+	text.resize((text.size() + 3) & ~size_t(3), ' ');
+	const uint32_t header[3] = { 0x46546C67, 2, static_cast<uint32_t>(12 + 8 + text.size() + 8 + bin.size()) };
+	const uint32_t jsonChunk[2] = { static_cast<uint32_t>(text.size()), 0x4E4F534A };
+	const uint32_t binChunk[2] = { static_cast<uint32_t>(bin.size()), 0x004E4942 };
+
+	std::vector<uint8_t> file(header[2]);
+	uint8_t* cursor = file.data();
+	auto append = [&](const void* data, size_t size)
+	{
+		std::memcpy(cursor, data, size);
+		cursor += size;
+	};
+	append(header, sizeof(header));
+	append(jsonChunk, sizeof(jsonChunk));
+	append(text.data(), text.size());
+	append(binChunk, sizeof(binChunk));
+	append(bin.data(), bin.size());
+
+	return FileSystem::WriteFile(path, file.data(), file.size());
+}
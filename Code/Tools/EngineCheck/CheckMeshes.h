@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Scene/Mesh.h"
+
+/**
+ * @brief View owning a copy of elements, one element of type T per vertex or index
+ */
+template<typename T>
+AccessorView MakeAccessorView(const std::vector<T>& elements, VkFormat format)
+{
+	std::vector<uint8_t> data(elements.size() * sizeof(T));
+	std::memcpy(data.data(), elements.data(), data.size());
+	return AccessorView::FromData(std::move(data), sizeof(T), static_cast<uint32_t>(elements.size()), format);
+}
+
+/**
+ * @brief Wavy grid of columns x rows quads, float positions, normals and texture coordinates and 32-bit indices
+ * The vertices are shuffled by seed so the mesh passes do not start from an already coherent order.
+ */
+SubMesh MakeGridSubMesh(uint32_t columns, uint32_t rows, uint32_t seed = 1);
+
+/**
+ * @brief Empty directory for the files of one check, below the system temporary directory
+ */
+std::string MakeCheckDirectory(const std::string& name);
+
+/**
+ * @brief Writes one glTF mesh per SubMesh, each instanced by its own node below a root node
+ * A .glb path gets the buffer as BIN chunk, any other path a .bin file next to it. Float attributes are
+ * tightly packed in their own bufferView, indices are 16-bit when every index fits.
+ */
+bool WriteGltf(const std::string& path, const std::vector<const SubMesh*>& subMeshes);
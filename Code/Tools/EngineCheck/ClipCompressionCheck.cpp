@@ -0,0 +1,195 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Animation/AnimationClip.h"
+#include "Animation/AnimationSampler.h"
+#include "Animation/ClipCompressor.h"
+#include "Animation/CompressedClip.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Transform.h"
+
+static glm::mat4 GetChainWorldMatrix(const Transform* transform)
+{
+	glm::mat4 world = transform->GetMatrix();
+	for (const Transform* parent = transform->GetParent(); parent; parent = parent->GetParent())
+	{
+		world = parent->GetMatrix() * world;
+	}
+	return world;
+}
+
+/**
+ * @brief Largest distance between the points one shell distance above every bone, sampled from both clips at the key times
+ */
+static float GetLargestError(const std::shared_ptr<AnimationClip>& clip, const std::shared_ptr<CompressedClip>& compressed, const std::vector<Transform*>& bones,
+	const std::vector<float>& times, float shellDistance)
+{
+	AnimationState reference(clip);
+	AnimationState state(compressed);
+	std::vector<glm::vec3> expected(bones.size());
+	float error = 0.0f;
+	for (float time : times)
+	{
+		reference.time = time;
+		AnimationSampler::Sample(reference);
+		for (size_t b = 0; b < bones.size(); ++b)
+		{
+			expected[b] = glm::vec3(GetChainWorldMatrix(bones[b]) * glm::vec4(0.0f, shellDistance, 0.0f, 1.0f));
+		}
+
+		state.time = time;
+		AnimationSampler::Sample(state);
+		for (size_t b = 0; b < bones.size(); ++b)
+		{
+			const glm::vec3 actual(GetChainWorldMatrix(bones[b]) * glm::vec4(0.0f, shellDistance, 0.0f, 1.0f));
+			error = std::max(error, glm::length(actual - expected[b]));
+		}
+	}
+	return error;
+}
+
+void CheckClipCompression()
+{
+	const uint32_t keyCount = 301;
+	const uint32_t chainLength = 20;
+	const uint32_t boneCount = 120;
+	std::vector<float> times(keyCount);
+	for (uint32_t k = 0; k < keyCount; ++k)
+	{
+		times[k] = k / 30.0f;
+	}
+
+	std::vector<GameObjectHandle> nodes;
+	auto addTransform = [&](Transform* parent)
+	{
+		GameObject* go = CreateGameObject("bone");
+		nodes.push_back(go->GetHandle());
+		Transform* transform = go->AddComponent<Transform>();
+		transform->SetParent(parent);
+		return transform;
+	};
+
+	// Chains of bones swinging around one axis with small translation jitter and constant scale
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+	Transform* root = addTransform(nullptr);
+	std::vector<Transform*> bones;
+	auto clip = std::make_shared<AnimationClip>("chains");
+	const glm::vec3 axis = glm::normalize(glm::vec3(1.0f, 0.3f, 0.2f));
+	for (uint32_t b = 0; b < boneCount; ++b)
+	{
+		bones.push_back(addTransform(b % chainLength == 0 ? root : bones.back()));
+		bones.back()->SetTranslation(glm::vec3(0.0f, 0.1f, 0.0f));
+		const uint32_t target = clip->AddTarget(bones.back());
+
+		const float swing = 0.2f + component(random) * 0.1f;
+		const float jitter = 1.0f + component(random) * 0.5f;
+		const float phase = component(random) * 3.0f;
+		std::vector<float> translations;
+		std::vector<float> rotations;
+		std::vector<float> scales(keyCount * 3, 1.0f);
+		for (float time : times)
+		{
+			const float angle = 0.6f * std::sin(swing * 6.28f * time + phase);
+			const glm::quat rotation = glm::angleAxis(angle, axis);
+			translations.insert(translations.end(), { 0.01f * std::sin(jitter * time + phase), 0.1f, 0.0f });
+			rotations.insert(rotations.end(), { rotation.x, rotation.y, rotation.z, rotation.w });
+		}
+		clip->AddChannel(target, AnimationPath::Translation, AnimationInterpolation::Linear, times.data(), keyCount, translations.data(), 3);
+		clip->AddChannel(target, AnimationPath::Rotation, AnimationInterpolation::Linear, times.data(), keyCount, rotations.data(), 4);
+		clip->AddChannel(target, AnimationPath::Scale, AnimationInterpolation::Linear, times.data(), keyCount, scales.data(), 3);
+	}
+	clip->Finalize();
+
+	// Each channel stays within the tolerance, so a point at the end of a chain stays within the sum along the chain
+	for (float tolerance : { 1e-3f, 1e-4f, 1e-5f })
+	{
+		ClipCompressionSettings settings;
+		settings.tolerance = tolerance;
+		ClipCompressionStatistics statistics;
+		std::shared_ptr<CompressedClip> compressed;
+		const double compressSeconds = MeasureSeconds([&] { compressed = ClipCompressor::Compress(*clip, settings, &statistics); }, 1);
+		CHECK(compressed != nullptr);
+		if (!compressed)
+		{
+			continue;
+		}
+
+		const float error = GetLargestError(clip, compressed, bones, times, settings.shellDistance);
+		CHECK(error <= tolerance * chainLength);
+		CHECK(statistics.compressedKeys < statistics.uncompressedKeys);
+		CHECK(statistics.GetRatio() > 1.0f);
+
+		const uint32_t channelCount = static_cast<uint32_t>(clip->GetChannels().size());
+		const uint32_t frames = 300;
+		AnimationState reference(clip);
+		AnimationState state(compressed);
+		const double referenceSeconds = MeasureSeconds([&]
+			{
+				for (uint32_t f = 0; f < frames; ++f)
+				{
+					reference.Advance(1.0f / 60.0f);
+					AnimationSampler::Sample(reference);
+				}
+			}, 3);
+		const double compressedSeconds = MeasureSeconds([&]
+			{
+				for (uint32_t f = 0; f < frames; ++f)
+				{
+					state.Advance(1.0f / 60.0f);
+					AnimationSampler::Sample(state);
+				}
+			}, 3);
+
+		std::cout << "  tolerance " << tolerance << ": keys " << statistics.uncompressedKeys << " -> " << statistics.compressedKeys << ", " << statistics.GetRatio()
+			<< "x smaller, largest error " << error << ", compressed in " << compressSeconds * 1e3 << " ms, sampling " << referenceSeconds / frames / channelCount * 1e9
+			<< " -> " << compressedSeconds / frames / channelCount * 1e9 << " ns/channel" << std::endl;
+	}
+
+	// A translation range too wide for the quantization keeps its channel at full precision, the narrow one next to it is compressed
+	Transform* wideTarget = addTransform(nullptr);
+	Transform* narrowTarget = addTransform(wideTarget);
+	std::vector<float> wide;
+	std::vector<float> narrow;
+	for (uint32_t k = 0; k < keyCount; ++k)
+	{
+		wide.insert(wide.end(), { 1000.0f * k / keyCount + 0.3f * std::sin(k * 0.7f), 0.0f, 0.0f });
+		narrow.insert(narrow.end(), { 0.01f * std::sin(k * 0.1f), 0.0f, 0.0f });
+	}
+	auto wideClip = std::make_shared<AnimationClip>("wide");
+	wideClip->AddChannel(wideClip->AddTarget(wideTarget), AnimationPath::Translation, AnimationInterpolation::Linear, times.data(), keyCount, wide.data(), 3);
+	wideClip->AddChannel(wideClip->AddTarget(narrowTarget), AnimationPath::Translation, AnimationInterpolation::Linear, times.data(), keyCount, narrow.data(), 3);
+	wideClip->Finalize();
+
+	ClipCompressionSettings settings;
+	ClipCompressionStatistics statistics;
+	const std::shared_ptr<CompressedClip> compressed = ClipCompressor::Compress(*wideClip, settings, &statistics);
+	CHECK(statistics.fullPrecisionChannels == 1);
+
+	AnimationState reference(wideClip);
+	AnimationState state(compressed);
+	float error = 0.0f;
+	for (float time : times)
+	{
+		reference.time = time;
+		AnimationSampler::Sample(reference);
+		const glm::vec3 wideExpected = wideTarget->GetTranslation();
+		const glm::vec3 narrowExpected = narrowTarget->GetTranslation();
+		state.time = time;
+		AnimationSampler::Sample(state);
+		error = std::max({ error, glm::length(wideTarget->GetTranslation() - wideExpected), glm::length(narrowTarget->GetTranslation() - narrowExpected) });
+	}
+	CHECK(error <= settings.tolerance);
+
+	for (GameObjectHandle node : nodes)
+	{
+		GameObject::Destroy(node);
+	}
+}
@@ -0,0 +1,114 @@
+#include "EngineCheck.h"
+
+#include <iostream>
+#include <vector>
+
+#include "Scene/Camera.h"
+#include "Scene/EntityWorld.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Transform.h"
+
+/**
+ * @brief Entities ForEach<Transform, MeshRenderer> visits, checking that each of them has both components
+ */
+static uint32_t CountRenderedEntities()
+{
+	uint32_t count = 0;
+	bool consistent = true;
+	EntityWorld::GetInstance().ForEach<Transform, MeshRenderer>([&](EntityId entity, Transform&, MeshRenderer&)
+		{
+			const ComponentMask mask = EntityWorld::GetInstance().GetComponentMask(entity);
+			consistent = consistent && (mask & GetComponentTypeMask<Transform>()) && (mask & GetComponentTypeMask<MeshRenderer>());
+			count++;
+		});
+	CHECK(consistent);
+	return count;
+}
+
+void CheckComponentPools()
+{
+	EntityWorld& world = EntityWorld::GetInstance();
+	const uint32_t transformBase = world.GetPool<Transform>().GetCount();
+	const uint32_t rendererBase = world.GetPool<MeshRenderer>().GetCount();
+	const uint32_t renderedBase = CountRenderedEntities();
+
+	// Interleaved component sets, the way an importer adds them
+	const uint32_t count = 100000;
+	std::vector<GameObjectHandle> nodes;
+	std::vector<Transform*> transforms;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		GameObject* go = CreateGameObject("node");
+		nodes.push_back(go->GetHandle());
+		if (i % 4 == 0)
+		{
+			go->AddComponent<MeshRenderer>();
+		}
+		transforms.push_back(go->AddComponent<Transform>());
+		transforms.back()->SetTranslation(glm::vec3(static_cast<float>(i), 1.0f, 2.0f));
+		if (i % 100 == 0)
+		{
+			go->AddComponent<Camera>();
+		}
+	}
+	CHECK(world.GetPool<Transform>().GetCount() == transformBase + count);
+	CHECK(world.GetPool<MeshRenderer>().GetCount() == rendererBase + count / 4);
+	CHECK(CountRenderedEntities() == renderedBase + count / 4);
+
+	// Every archetype holds the entities of exactly its component set
+	bool grouped = true;
+	for (const Archetype& archetype : world.GetArchetypes())
+	{
+		for (EntityId entity : archetype.entities)
+		{
+			grouped = grouped && world.GetComponentMask(entity) == archetype.mask;
+		}
+	}
+	CHECK(grouped);
+
+	// Moving an entity to another archetype moves handles, the components stay where they are
+	bool stable = true;
+	std::vector<Handle<MeshRenderer>> removed;
+	for (uint32_t i = 0; i < count; i += 8)
+	{
+		GameObject* go = GameObject::Get(nodes[i]);
+		removed.push_back(go->GetComponentHandle<MeshRenderer>());
+		CHECK(go->RemoveComponent<MeshRenderer>());
+		go->AddComponent<Camera>();
+		stable = stable && go->GetComponent<Transform>() == transforms[i] && transforms[i]->GetTranslation().x == static_cast<float>(i);
+	}
+	CHECK(stable);
+	CHECK(CountRenderedEntities() == renderedBase + count / 8);
+
+	// Handles of removed components go stale instead of pointing at a reused slot
+	bool stale = true;
+	for (Handle<MeshRenderer> handle : removed)
+	{
+		stale = stale && world.GetComponent(handle) == nullptr;
+	}
+	CHECK(stale);
+
+	float sink = 0.0f;
+	const double lookupSeconds = MeasureSeconds([&]
+		{
+			for (GameObjectHandle node : nodes)
+			{
+				sink += GameObject::Get(node)->GetComponent<Transform>()->GetTranslation().x;
+			}
+		});
+	const double poolSeconds = MeasureSeconds([&] { world.GetPool<Transform>().ForEach([&](Transform& transform) { sink += transform.GetTranslation().x; }); });
+	const double querySeconds = MeasureSeconds([&] { world.ForEach<Transform, MeshRenderer>([&](EntityId, Transform& transform, MeshRenderer&) { sink += transform.GetTranslation().x; }); });
+	std::cout << "  " << count << " transforms: GetComponent " << lookupSeconds / count * 1e9 << " ns, pool ForEach " << poolSeconds / count * 1e9
+		<< " ns, Transform+MeshRenderer query " << querySeconds / (count / 8) * 1e9 << " ns per entity (" << (sink != 0.0f ? world.GetArchetypes().size() : 0) << " archetypes)" << std::endl;
+
+	for (GameObjectHandle node : nodes)
+	{
+		CHECK(GameObject::Destroy(node));
+	}
+	CHECK(world.GetPool<Transform>().GetCount() == transformBase);
+	CHECK(world.GetPool<MeshRenderer>().GetCount() == rendererBase);
+	CHECK(CountRenderedEntities() == renderedBase);
+	CHECK(!GameObject::Destroy(nodes[0]));
+}
@@ -0,0 +1,69 @@
+#include "EngineCheck.h"
+
+#include <iostream>
+#include <vector>
+
+#include "Animation/MeshDeformer.h"
+#include "Scene/Camera.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Light.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Transform.h"
+
+static_assert(GetComponentTypeIndex<Transform>() != GetComponentTypeIndex<Camera>(), "component type ids must be distinct");
+static_assert((GetComponentTypeMask<Transform>() | GetComponentTypeMask<Camera>() | GetComponentTypeMask<Light>() | GetComponentTypeMask<MeshRenderer>()
+	| GetComponentTypeMask<MeshDeformer>()) == (ComponentMask(1) << kComponentTypeCount) - 1, "every component type needs its own mask bit");
+
+void CheckComponentTypes()
+{
+	GameObject* go = CreateGameObject("components");
+	const GameObjectHandle handle = go->GetHandle();
+	CHECK(go->GetComponentMask() == 0);
+	CHECK(go->GetComponent<Transform>() == nullptr && !go->HasComponent<Transform>());
+
+	// One component per type, adding it again returns the first one
+	Transform* transform = go->AddComponent<Transform>();
+	CHECK(go->AddComponent<Transform>() == transform);
+	Camera* camera = go->AddComponent<Camera>();
+	CHECK(go->GetComponent<Transform>() == transform && go->GetComponent<Camera>() == camera);
+	CHECK(go->HasComponent<Transform>() && go->HasComponent<Camera>() && !go->HasComponent<Light>());
+	CHECK(go->GetComponentMask() == (GetComponentTypeMask<Transform>() | GetComponentTypeMask<Camera>()));
+
+	// Removal clears the bit and the pointer, the other components stay where they are
+	const Handle<Camera> cameraHandle = go->GetComponentHandle<Camera>();
+	CHECK(EntityWorld::GetInstance().GetComponent(cameraHandle) == camera);
+	CHECK(go->RemoveComponent<Camera>());
+	CHECK(!go->RemoveComponent<Camera>());
+	CHECK(!go->HasComponent<Camera>() && go->GetComponent<Camera>() == nullptr);
+	CHECK(go->GetComponentMask() == GetComponentTypeMask<Transform>());
+	CHECK(go->GetComponent<Transform>() == transform);
+	CHECK(EntityWorld::GetInstance().GetComponent(cameraHandle) == nullptr);
+
+	// A component added back gets a new handle, the old one stays stale
+	go->AddComponent<Camera>();
+	CHECK(EntityWorld::GetInstance().GetComponent(cameraHandle) == nullptr);
+	CHECK(EntityWorld::GetInstance().GetComponent(go->GetComponentHandle<Camera>()) == go->GetComponent<Camera>());
+
+	const uint32_t lookups = 1000000;
+	uintptr_t sink = 0;
+	const double getSeconds = MeasureSeconds([&]
+		{
+			for (uint32_t i = 0; i < lookups; ++i)
+			{
+				sink += reinterpret_cast<uintptr_t>(GameObject::Get(handle)->GetComponent<Camera>());
+			}
+		});
+	const double hasSeconds = MeasureSeconds([&]
+		{
+			for (uint32_t i = 0; i < lookups; ++i)
+			{
+				sink += GameObject::Get(handle)->HasComponent<Light>() ? 1 : 0;
+			}
+		});
+	std::cout << "  GetComponent " << getSeconds / lookups * 1e9 << " ns, HasComponent " << hasSeconds / lookups * 1e9 << " ns per lookup"
+		<< (sink == 0 ? " (no lookup hit)" : "") << std::endl;
+
+	CHECK(GameObject::Destroy(handle));
+	CHECK(GameObject::Get(handle) == nullptr);
+}
@@ -0,0 +1,213 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "Geometry/MeshSimplifier.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/CookedScene.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Scene.h"
+
+/**
+ * @brief Whether both SubMeshes have the same positions, indices, meshlets and LODs
+ */
+static bool IsSameSubMesh(const SubMesh& a, const SubMesh& b)
+{
+	std::vector<glm::vec3> positionsA;
+	std::vector<glm::vec3> positionsB;
+	if (!MeshUtils::ReadPositions(a, positionsA) || !MeshUtils::ReadPositions(b, positionsB) || positionsA != positionsB)
+	{
+		return false;
+	}
+
+	if (a.GetLodCount() != b.GetLodCount() || a.meshlets.GetCount() != b.meshlets.GetCount())
+	{
+		return false;
+	}
+
+	for (uint32_t lod = 0; lod < a.GetLodCount(); ++lod)
+	{
+		if (a.GetLodIndexCount(lod) != b.GetLodIndexCount(lod) || a.GetLodError(lod) != b.GetLodError(lod))
+		{
+			return false;
+		}
+	}
+	return MeshUtils::ReadIndices(a) == MeshUtils::ReadIndices(b);
+}
+
+static bool IsSameScene(const Scene& a, const Scene& b)
+{
+	if (a.GetNodes().size() != b.GetNodes().size() || a.GetMeshes().size() != b.GetMeshes().size())
+	{
+		return false;
+	}
+
+	for (size_t m = 0; m < a.GetMeshes().size(); ++m)
+	{
+		const Mesh* meshA = MeshRegistry::GetInstance().Get(a.GetMeshes()[m]);
+		const Mesh* meshB = MeshRegistry::GetInstance().Get(b.GetMeshes()[m]);
+		if (!meshA || !meshB || meshA->GetSubmeshes().size() != meshB->GetSubmeshes().size())
+		{
+			return false;
+		}
+
+		for (size_t s = 0; s < meshA->GetSubmeshes().size(); ++s)
+		{
+			if (!IsSameSubMesh(meshA->GetSubmeshes()[s], meshB->GetSubmeshes()[s]))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Loads a damaged cooked file, which has to fail or succeed without throwing
+ */
+static bool LoadsWithoutThrowing(const std::string& path, const std::vector<uint8_t>& data, uint64_t sourceHash)
+{
+	FileSystem::WriteFile(path, data.data(), data.size());
+	try
+	{
+		Scene* scene = CookedScene::Load(path, sourceHash);
+		WL_DELETE(scene);
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Cooks a one node scene of subMesh after edit and loads it back, true when the load succeeds
+ */
+static bool LoadsEditedSubMesh(const std::string& path, const SubMesh& subMesh, const std::function<void(SubMesh&)>& edit)
+{
+	SubMesh edited = subMesh;
+	edit(edited);
+	Mesh mesh;
+	mesh.AddSubmesh(std::move(edited));
+
+	Scene* scene = WL_NEW(Scene);
+	const MeshHandle handle = MeshRegistry::GetInstance().Create(std::move(mesh));
+	GameObject* go = CreateGameObject("mesh");
+	go->AddComponent<MeshRenderer>()->SetMesh(handle);
+	scene->AddNode(go->GetHandle());
+	scene->SetRootNode(go->GetHandle());
+	scene->AddMesh(handle);
+
+	const bool written = CookedScene::Write(*scene, 1, path);
+	WL_DELETE(scene);
+
+	Scene* loaded = written ? CookedScene::Load(path, 1) : nullptr;
+	WL_DELETE(loaded);
+	return loaded != nullptr;
+}
+
+/**
+ * @brief Counts and formats that do not fit the streams are rejected, the renderer would draw past them
+ */
+static void CheckCorruptedCounts(const std::string& directory)
+{
+	SubMesh subMesh = MakeGridSubMesh(16, 16);
+	MeshSimplifier::GenerateLods(subMesh, { 0.5f });
+	CHECK(!subMesh.lods.empty());
+
+	const std::string path = directory + "/counts" COOKED_SCENE_EXTENSION;
+	CHECK(LoadsEditedSubMesh(path, subMesh, [](SubMesh&) {}));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited) { edited.vertexCount++; }));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited) { edited.vertexIndices += 3; }));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited) { edited.lods[0].indexCount = edited.lods[0].indexBuffer.count + 3; }));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited) { edited.indexType = VK_INDEX_TYPE_UINT16; }));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited) { edited.indexType = VK_INDEX_TYPE_MAX_ENUM; }));
+	CHECK(!LoadsEditedSubMesh(path, subMesh, [](SubMesh& edited)
+		{
+			edited.vertexBuffers["undefined"] = AccessorView::FromData(std::vector<uint8_t>(1), 0, edited.vertexCount, VK_FORMAT_UNDEFINED);
+		}));
+}
+
+void CheckCookedScene()
+{
+	CheckCorruptedCounts(MakeCheckDirectory("cooked_scene_counts"));
+
+	std::vector<SubMesh> sources;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		sources.push_back(MakeGridSubMesh(128, 128, i + 1));
+	}
+	const std::string directory = MakeCheckDirectory("cooked_scene");
+	const std::string path = directory + "/grids.gltf";
+	CHECK(WriteGltf(path, { &sources[0], &sources[1], &sources[2], &sources[3] }));
+
+	const GltfImportSettings settings = GltfImportSettings::ForCooking();
+	Scene* source = nullptr;
+	const double sourceSeconds = MeasureSeconds([&]
+		{
+			WL_DELETE(source);
+			source = GltfReader::LoadSource(path.c_str(), settings);
+		}, 3);
+	CHECK(source != nullptr);
+	if (!source)
+	{
+		return;
+	}
+
+	// The first LoadFile cooks, the ones after it only map the cooked file
+	Scene* cooked = GltfReader::LoadFile(path.c_str(), settings);
+	CHECK(std::filesystem::exists(path + COOKED_SCENE_EXTENSION));
+	const double cookedSeconds = MeasureSeconds([&]
+		{
+			WL_DELETE(cooked);
+			cooked = GltfReader::LoadFile(path.c_str(), settings);
+		}, 3);
+	CHECK(cooked && IsSameScene(*source, *cooked));
+	WL_DELETE(cooked);
+
+	std::cout << "  source " << sourceSeconds * 1e3 << " ms, cooked " << cookedSeconds * 1e3 << " ms (" << sourceSeconds / cookedSeconds << "x)" << std::endl;
+
+	// A file written for another source is not loaded
+	const std::string cookedPath = directory + "/scene" COOKED_SCENE_EXTENSION;
+	const uint64_t sourceHash = 42;
+	CHECK(CookedScene::Write(*source, sourceHash, cookedPath));
+	Scene* reloaded = CookedScene::Load(cookedPath, sourceHash);
+	CHECK(reloaded && IsSameScene(*source, *reloaded));
+	WL_DELETE(reloaded);
+	CHECK(CookedScene::Load(cookedPath, sourceHash + 1) == nullptr);
+	CHECK(CookedScene::Load(directory + "/missing" COOKED_SCENE_EXTENSION, sourceHash) == nullptr);
+
+	// Truncated and corrupt files load as nullptr at worst, never throw or read outside the mapping
+	const std::vector<uint8_t> good = FileSystem::LoadFile(cookedPath);
+	const std::string damagedPath = directory + "/damaged" COOKED_SCENE_EXTENSION;
+	uint32_t throwingLoads = 0;
+	for (size_t size = 0; size < good.size(); size += 1 + good.size() / 97)
+	{
+		throwingLoads += LoadsWithoutThrowing(damagedPath, std::vector<uint8_t>(good.begin(), good.begin() + size), sourceHash) ? 0 : 1;
+	}
+
+	std::mt19937 random(1);
+	for (uint32_t i = 0; i < 500; ++i)
+	{
+		std::vector<uint8_t> corrupt = good;
+		for (uint32_t flips = 1 + random() % 4; flips > 0; --flips)
+		{
+			corrupt[random() % corrupt.size()] = static_cast<uint8_t>(random());
+		}
+		throwingLoads += LoadsWithoutThrowing(damagedPath, corrupt, sourceHash) ? 0 : 1;
+	}
+	CHECK(throwingLoads == 0);
+
+	WL_DELETE(source);
+}
@@ -0,0 +1,189 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Animation/MeshDeformer.h"
+#include "Animation/Skin.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Transform.h"
+
+struct JointIndices
+{
+	uint16_t joints[4];
+};
+
+/**
+ * @brief World matrix multiplied up the parent chain, the reference for the palette
+ */
+static glm::mat4 GetChainWorldMatrix(const Transform* transform)
+{
+	glm::mat4 world = transform->GetMatrix();
+	for (const Transform* parent = transform->GetParent(); parent; parent = parent->GetParent())
+	{
+		world = parent->GetMatrix() * world;
+	}
+	return world;
+}
+
+/**
+ * @brief Positions, normals and tangents of the last Deform of the first submesh
+ */
+static std::vector<float> ReadDeformed(const MeshDeformer& deformer, uint32_t vertexCount)
+{
+	const DeformedStreams& streams = deformer.GetStreams(0);
+	const float* positions = reinterpret_cast<const float*>(streams.position.Data());
+	const float* normals = reinterpret_cast<const float*>(streams.normal.Data());
+	const float* tangents = reinterpret_cast<const float*>(streams.tangent.Data());
+
+	std::vector<float> deformed(positions, positions + vertexCount * 3);
+	deformed.insert(deformed.end(), normals, normals + vertexCount * 3);
+	deformed.insert(deformed.end(), tangents, tangents + vertexCount * 4);
+	return deformed;
+}
+
+void CheckMeshDeformer()
+{
+	const uint32_t vertexCount = 50000;
+	const uint32_t jointCount = 64;
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+
+	// A binary tree of joints below a root, the mesh node is a sibling of the first joint
+	std::vector<GameObjectHandle> nodes;
+	auto addTransform = [&](Transform* parent)
+	{
+		GameObject* go = CreateGameObject("node");
+		nodes.push_back(go->GetHandle());
+		Transform* transform = go->AddComponent<Transform>();
+		transform->SetParent(parent);
+		return transform;
+	};
+
+	Transform* root = addTransform(nullptr);
+	std::vector<Transform*> joints;
+	std::vector<glm::mat4> inverseBindMatrices;
+	for (uint32_t j = 0; j < jointCount; ++j)
+	{
+		joints.push_back(addTransform(j == 0 ? root : joints[j / 2]));
+		joints.back()->SetTranslation(glm::vec3(component(random), component(random), component(random)));
+		joints.back()->SetRotation(glm::normalize(glm::quat(1.0f + component(random), component(random) * 0.3f, component(random) * 0.3f, component(random) * 0.3f)));
+		inverseBindMatrices.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(component(random), component(random), component(random))));
+	}
+	Transform* node = addTransform(root);
+	node->SetTranslation(glm::vec3(1.0f, 2.0f, 3.0f));
+	GameObject* nodeObject = GameObject::Get(nodes.back());
+
+	// Four influences per vertex and two position morph targets
+	std::vector<glm::vec3> positions(vertexCount);
+	std::vector<glm::vec3> normals(vertexCount);
+	std::vector<glm::vec4> tangents(vertexCount);
+	std::vector<glm::vec4> weights(vertexCount);
+	std::vector<JointIndices> influences(vertexCount);
+	std::vector<glm::vec3> deltas0(vertexCount);
+	std::vector<glm::vec3> deltas1(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		const glm::vec3 normal = glm::normalize(glm::vec3(component(random), component(random), component(random)));
+		positions[v] = glm::vec3(component(random), component(random), component(random));
+		normals[v] = normal;
+		tangents[v] = glm::vec4(normal.y, normal.z, normal.x, 1.0f);
+		deltas0[v] = glm::vec3(component(random), component(random), component(random)) * 0.1f;
+		deltas1[v] = glm::vec3(component(random), component(random), component(random)) * 0.1f;
+
+		float sum = 0.0f;
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			influences[v].joints[k] = static_cast<uint16_t>(random() % jointCount);
+			weights[v][k] = component(random) + 1.0f;
+			sum += weights[v][k];
+		}
+		weights[v] = weights[v] * (1.0f / sum);
+	}
+
+	SubMesh subMesh;
+	subMesh.vertexCount = vertexCount;
+	subMesh.vertexBuffers["position"] = MakeAccessorView(positions, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.vertexBuffers["normal"] = MakeAccessorView(normals, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.vertexBuffers["tangent"] = MakeAccessorView(tangents, VK_FORMAT_R32G32B32A32_SFLOAT);
+	subMesh.vertexBuffers["weights_0"] = MakeAccessorView(weights, VK_FORMAT_R32G32B32A32_SFLOAT);
+	subMesh.vertexBuffers["joints_0"] = MakeAccessorView(influences, VK_FORMAT_R16G16B16A16_UINT);
+	subMesh.vertexBuffers[GetMorphStreamName(0, "position")] = MakeAccessorView(deltas0, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.vertexBuffers[GetMorphStreamName(1, "position")] = MakeAccessorView(deltas1, VK_FORMAT_R32G32B32_SFLOAT);
+	subMesh.morphTargetCount = 2;
+
+	Mesh mesh;
+	mesh.AddSubmesh(std::move(subMesh));
+	const MeshHandle meshHandle = MeshRegistry::GetInstance().Create(std::move(mesh));
+
+	MeshDeformer* deformer = nodeObject->AddComponent<MeshDeformer>();
+	deformer->SetSkin(std::make_shared<Skin>(std::vector<Transform*>(joints), std::vector<glm::mat4>(inverseBindMatrices)));
+	deformer->Bind(meshHandle, node);
+	const std::vector<float> morphWeights = { 0.3f, 0.6f };
+	deformer->SetWeights(morphWeights);
+	const std::vector<MeshDeformer*> deformers = { deformer };
+
+	// Every SIMD path writes the streams of the scalar one
+	const SimdLevel initialLevel = MeshDeformer::GetSimdLevel();
+	const std::vector<SimdLevel> levels = GetSupportedSimdLevels();
+	std::vector<std::vector<float>> deformed;
+	for (SimdLevel level : levels)
+	{
+		MeshDeformer::SetSimdLevel(level);
+		MeshDeformer::Deform(deformers);
+		deformed.push_back(ReadDeformed(*deformer, vertexCount));
+	}
+	for (size_t l = 1; l < levels.size(); ++l)
+	{
+		CHECK(deformed[l] == deformed[0]);
+	}
+
+	// Morphed, then skinned into the space of the node
+	const glm::mat4 nodeInverse = glm::inverse(GetChainWorldMatrix(node));
+	std::vector<glm::mat4> palette;
+	for (uint32_t j = 0; j < jointCount; ++j)
+	{
+		palette.push_back(nodeInverse * GetChainWorldMatrix(joints[j]) * inverseBindMatrices[j]);
+	}
+
+	float worstPosition = 0.0f;
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		const glm::vec4 morphed(positions[v] + morphWeights[0] * deltas0[v] + morphWeights[1] * deltas1[v], 1.0f);
+		glm::vec4 expected(0.0f);
+		for (uint32_t k = 0; k < 4; ++k)
+		{
+			expected += weights[v][k] * (palette[influences[v].joints[k]] * morphed);
+		}
+
+		const glm::vec3 actual(deformed[0][v * 3], deformed[0][v * 3 + 1], deformed[0][v * 3 + 2]);
+		worstPosition = std::max(worstPosition, glm::length(actual - glm::vec3(expected)));
+	}
+	CHECK(worstPosition < 1e-4f);
+
+	for (SimdLevel level : levels)
+	{
+		MeshDeformer::SetSimdLevel(level);
+		deformer->SetWeights(morphWeights);
+		const double morphedSeconds = MeasureSeconds([&] { MeshDeformer::Deform(deformers); });
+		deformer->SetWeights({});
+		const double skinnedSeconds = MeasureSeconds([&] { MeshDeformer::Deform(deformers); });
+		std::cout << "  " << GetSimdLevelName(level) << ": " << vertexCount / morphedSeconds * 1e-6 << " M vertices/s with 2 morph targets, "
+			<< vertexCount / skinnedSeconds * 1e-6 << " M vertices/s skinned only" << std::endl;
+	}
+	std::cout << "  largest position error against the reference " << worstPosition << std::endl;
+
+	MeshDeformer::SetSimdLevel(initialLevel);
+	for (GameObjectHandle handle : nodes)
+	{
+		GameObject::Destroy(handle);
+	}
+	MeshRegistry::GetInstance().Release(meshHandle);
+}
@@ -0,0 +1,165 @@
+#include "EngineCheck.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Framework/JobSystem.h"
+
+#if USE_WINDOWS
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::atomic<uint32_t> CheckContext::s_FailureCount{ 0 };
+
+void CheckContext::Fail(const char* condition, const char* file, int line)
+{
+	s_FailureCount++;
+	std::cout << "  FAILED " << condition << " (" << file << ":" << line << ")" << std::endl;
+}
+
+uint32_t CheckContext::GetFailureCount()
+{
+	return s_FailureCount.load();
+}
+
+size_t GetPeakResidentBytes()
+{
+#if USE_WINDOWS
+	PROCESS_MEMORY_COUNTERS counters{};
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#if defined(__APPLE__)
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	// Linux reports kilobytes
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+std::vector<SimdLevel> GetSupportedSimdLevels()
+{
+	std::vector<SimdLevel> levels;
+	for (uint32_t level = 0; level <= static_cast<uint32_t>(CpuFeatures::GetSimdLevel()); ++level)
+	{
+		levels.push_back(static_cast<SimdLevel>(level));
+	}
+	return levels;
+}
+
+struct EngineCheck
+{
+	const char* name;
+	void (*run)();
+};
+
+static const EngineCheck s_Checks[] = {
+	{ "accessor_conversion", CheckAccessorConversion },
+	{ "accessor_views", CheckAccessorViews },
+	{ "animation_sampler", CheckAnimationSampler },
+	{ "asset_cache", CheckAssetCache },
+	{ "asset_cook", CheckAssetCook },
+	{ "batch_load", CheckBatchLoad },
+	{ "clip_compression", CheckClipCompression },
+	{ "component_pools", CheckComponentPools },
+	{ "component_types", CheckComponentTypes },
+	{ "cooked_scene", CheckCookedScene },
+	{ "glb", CheckGlb },
+	{ "handle_pool", CheckHandlePool },
+	{ "lods", CheckLods },
+	{ "material_table", CheckMaterialTable },
+	{ "mesh_deformer", CheckMeshDeformer },
+	{ "mesh_optimizer", CheckMeshOptimizer },
+	{ "mesh_sharing", CheckMeshSharing },
+	{ "meshlets", CheckMeshlets },
+	{ "meshopt_decoder", CheckMeshoptDecoder },
+	{ "parallel_load", CheckParallelLoad },
+	{ "quantized_gltf", CheckQuantizedGltf },
+	{ "simd_math", CheckSimdMath },
+	{ "streaming_load", CheckStreamingLoad },
+	{ "transform_hierarchy", CheckTransformHierarchy },
+	{ "vertex_layout", CheckVertexLayout },
+	{ "vertex_quantizer", CheckVertexQuantizer },
+};
+
+static void PrintUsage()
+{
+	std::cout << "Usage: EngineCheck [check...] [options]\n"
+		<< "  Runs the named checks, or all of them. Every check verifies its feature and prints its throughput.\n"
+		<< "  --threads <count>  Worker threads, all cores by default\n"
+		<< "  --list             Print the check names" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t threadCount = 0;
+	std::vector<const EngineCheck*> selected;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string argument = argv[i];
+		if (argument == "--threads" && i + 1 < argc)
+		{
+			threadCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--list")
+		{
+			for (const EngineCheck& check : s_Checks)
+			{
+				std::cout << check.name << std::endl;
+			}
+			return 0;
+		}
+		else
+		{
+			const EngineCheck* found = nullptr;
+			for (const EngineCheck& check : s_Checks)
+			{
+				found = argument == check.name ? &check : found;
+			}
+
+			if (!found)
+			{
+				PrintUsage();
+				return 1;
+			}
+			selected.push_back(found);
+		}
+	}
+
+	if (selected.empty())
+	{
+		for (const EngineCheck& check : s_Checks)
+		{
+			selected.push_back(&check);
+		}
+	}
+
+	JobSystem::Initialized(threadCount);
+
+	uint32_t failedChecks = 0;
+	for (const EngineCheck* check : selected)
+	{
+		std::cout << "[" << check->name << "]" << std::endl;
+		const uint32_t failures = CheckContext::GetFailureCount();
+		check->run();
+		if (CheckContext::GetFailureCount() != failures)
+		{
+			failedChecks++;
+		}
+	}
+
+	JobSystem::Terminate();
+
+	std::cout << selected.size() - failedChecks << "/" << selected.size() << " checks passed" << std::endl;
+	return failedChecks == 0 ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Framework/CpuFeatures.h"
+
+/**
+ * @brief Failures of the running check
+ * A failed CHECK prints the condition and its location, the check goes on so one run reports every failure.
+ */
+class CheckContext
+{
+public:
+	static void Fail(const char* condition, const char* file, int line);
+
+	static uint32_t GetFailureCount();
+
+private:
+	CheckContext() {};
+	~CheckContext() {};
+
+	static std::atomic<uint32_t> s_FailureCount;
+};
+
+#define CHECK(condition)                                        \
+	do                                                          \
+	{                                                           \
+		if (!(condition))                                       \
+		{                                                       \
+			CheckContext::Fail(#condition, __FILE__, __LINE__); \
+		}                                                       \
+	} while (0)
+
+/**
+ * @brief Fastest of repeat runs of function in seconds, the first run also warms the caches
+ */
+template<typename Function>
+double MeasureSeconds(Function&& function, uint32_t repeat = 5)
+{
+	double best = 0.0;
+	for (uint32_t i = 0; i < repeat; ++i)
+	{
+		const auto start = std::chrono::high_resolution_clock::now();
+		function();
+		const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		best = i == 0 ? seconds : (seconds < best ? seconds : best);
+	}
+	return best;
+}
+
+/**
+ * @brief Largest resident set of the process so far in bytes, 0 where the platform does not report it
+ */
+size_t GetPeakResidentBytes();
+
+/**
+ * @brief Scalar up to the widest level the CPU supports, the checks compare their SIMD paths over these
+ */
+std::vector<SimdLevel> GetSupportedSimdLevels();
+
+// One function per engine feature, EngineCheck.cpp lists them by name
+void CheckAccessorConversion();
+void CheckAccessorViews();
+void CheckAnimationSampler();
+void CheckAssetCache();
+void CheckAssetCook();
+void CheckBatchLoad();
+void CheckClipCompression();
+void CheckComponentPools();
+void CheckComponentTypes();
+void CheckCookedScene();
+void CheckGlb();
+void CheckHandlePool();
+void CheckLods();
+void CheckMaterialTable();
+void CheckMeshDeformer();
+void CheckMeshOptimizer();
+void CheckMeshSharing();
+void CheckMeshlets();
+void CheckMeshoptDecoder();
+void CheckParallelLoad();
+void CheckQuantizedGltf();
+void CheckSimdMath();
+void CheckStreamingLoad();
+void CheckTransformHierarchy();
+void CheckVertexLayout();
+void CheckVertexQuantizer();
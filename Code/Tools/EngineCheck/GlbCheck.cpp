@@ -0,0 +1,92 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+/**
+ * @brief Best load time of path in seconds, the scene of the last load is returned in scene
+ */
+static double MeasureLoad(const std::string& path, const GltfImportSettings& settings, Scene*& scene)
+{
+	return MeasureSeconds([&]
+		{
+			WL_DELETE(scene);
+			scene = GltfReader::LoadSource(path.c_str(), settings);
+		});
+}
+
+static const SubMesh* GetOnlySubMesh(const Scene* scene)
+{
+	if (!scene || scene->GetMeshes().size() != 1)
+	{
+		return nullptr;
+	}
+
+	const Mesh* mesh = MeshRegistry::GetInstance().Get(scene->GetMeshes()[0]);
+	return mesh && mesh->GetSubmeshes().size() == 1 ? &mesh->GetSubmeshes()[0] : nullptr;
+}
+
+void CheckGlb()
+{
+	const SubMesh source = MakeGridSubMesh(512, 512);
+	const std::string directory = MakeCheckDirectory("glb");
+	const std::string glbPath = directory + "/grid.glb";
+	const std::string gltfPath = directory + "/grid.gltf";
+	CHECK(WriteGltf(glbPath, { &source }));
+	CHECK(WriteGltf(gltfPath, { &source }));
+
+	// The runtime defaults, no mesh pass and no cooked scene
+	const GltfImportSettings settings;
+
+	Scene* glbScene = nullptr;
+	Scene* gltfScene = nullptr;
+	const double glbSeconds = MeasureLoad(glbPath, settings, glbScene);
+	const double gltfSeconds = MeasureLoad(gltfPath, settings, gltfScene);
+
+	// The BIN chunk stays in the mapped file, positions and indices both point into that one mapping
+	const SubMesh* glbSubMesh = GetOnlySubMesh(glbScene);
+	const SubMesh* gltfSubMesh = GetOnlySubMesh(gltfScene);
+	CHECK(glbSubMesh != nullptr && gltfSubMesh != nullptr);
+	if (glbSubMesh && gltfSubMesh)
+	{
+		const AccessorView& position = glbSubMesh->vertexBuffers.at("position");
+		CHECK(position.owner && position.owner == glbSubMesh->indexBuffer.owner);
+		CHECK(position.owner != gltfSubMesh->vertexBuffers.at("position").owner);
+
+		std::vector<glm::vec3> glbPositions;
+		std::vector<glm::vec3> gltfPositions;
+		CHECK(MeshUtils::ReadPositions(*glbSubMesh, glbPositions));
+		CHECK(MeshUtils::ReadPositions(*gltfSubMesh, gltfPositions));
+		CHECK(glbPositions == gltfPositions);
+		CHECK(MeshUtils::ReadIndices(*glbSubMesh) == MeshUtils::ReadIndices(*gltfSubMesh));
+		CHECK(MeshUtils::ReadIndices(*glbSubMesh) == MeshUtils::ReadIndices(source));
+	}
+
+	const double megabytes = std::filesystem::file_size(glbPath) * 1e-6;
+	std::cout << "  " << megabytes << " MB: .glb " << megabytes / glbSeconds << " MB/s, .gltf " << megabytes / gltfSeconds << " MB/s" << std::endl;
+
+	WL_DELETE(glbScene);
+	WL_DELETE(gltfScene);
+
+	// Missing and truncated files fail to load instead of throwing or reading past the mapping
+	CHECK(GltfReader::LoadSource((directory + "/missing.glb").c_str(), settings) == nullptr);
+
+	const std::vector<uint8_t> file = FileSystem::LoadFile(glbPath);
+	for (size_t size : { size_t(0), size_t(8), size_t(20), file.size() / 2, file.size() - 4 })
+	{
+		const std::string truncatedPath = directory + "/truncated.glb";
+		CHECK(FileSystem::WriteFile(truncatedPath, file.data(), size));
+		Scene* truncated = GltfReader::LoadSource(truncatedPath.c_str(), settings);
+		CHECK(truncated == nullptr);
+		WL_DELETE(truncated);
+	}
+}
@@ -0,0 +1,161 @@
+#include "EngineCheck.h"
+
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Framework/HandlePool.h"
+
+/**
+ * @brief Object that counts its constructions and destructions
+ */
+struct CountedObject
+{
+	static int s_Alive;
+	static int s_Destroyed;
+
+	uint32_t value;
+
+	explicit CountedObject(uint32_t value) : value(value) { s_Alive++; }
+	~CountedObject() { s_Alive--; s_Destroyed++; }
+};
+
+int CountedObject::s_Alive = 0;
+int CountedObject::s_Destroyed = 0;
+
+/**
+ * @brief Readers call Get on published handles while one writer creates and destroys under its lock
+ */
+static void CheckConcurrentGet()
+{
+	HandlePool<uint64_t> pool;
+	std::mutex mutex;
+
+	// Enough objects for the writer to publish new chunks while the readers run
+	const uint32_t count = 8 * HandlePool<uint64_t>::kChunkSize;
+	std::vector<std::atomic<uint32_t>> published(count);
+	std::atomic<uint32_t> publishedCount{ 0 };
+	std::atomic<bool> writing{ true };
+	std::atomic<uint32_t> mismatches{ 0 };
+
+	std::vector<std::thread> readers;
+	for (uint32_t r = 0; r < 3; ++r)
+	{
+		readers.emplace_back([&]
+			{
+				while (writing.load(std::memory_order_acquire))
+				{
+					const uint32_t available = publishedCount.load(std::memory_order_acquire);
+					for (uint32_t i = 0; i < available; ++i)
+					{
+						// Every published handle refers to a live object that holds its own index
+						const uint64_t* value = pool.Get(Handle<uint64_t>(published[i].load(std::memory_order_relaxed)));
+						if (!value || *value != i)
+						{
+							mismatches++;
+						}
+					}
+				}
+			});
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// A short lived object in between, its slot is reused by the next Create
+		pool.Destroy(pool.Create(uint64_t(~0ull)));
+		published[i].store(pool.Create(uint64_t(i)).id, std::memory_order_relaxed);
+		publishedCount.store(i + 1, std::memory_order_release);
+	}
+	writing.store(false, std::memory_order_release);
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	CHECK(mismatches == 0);
+	CHECK(pool.GetCount() == count);
+}
+
+void CheckHandlePool()
+{
+	{
+		HandlePool<CountedObject> pool;
+		CHECK(pool.Get(Handle<CountedObject>()) == nullptr);
+
+		// Stale handles: a destroyed object's handle is refused everywhere
+		const Handle<CountedObject> first = pool.Create(1u);
+		const Handle<CountedObject> second = pool.Create(2u);
+		CHECK(first.IsValid() && first.GetGeneration() == 1);
+		CHECK(pool.Get(first)->value == 1 && pool.Get(second)->value == 2);
+		CHECK(pool.Destroy(first));
+		CHECK(pool.Get(first) == nullptr && !pool.IsAlive(first));
+		CHECK(!pool.Destroy(first));
+		CHECK(pool.GetCount() == 1 && CountedObject::s_Alive == 1);
+
+		// Slot reuse: the freed slot comes back before the pool grows, with the next generation
+		const Handle<CountedObject> reused = pool.Create(3u);
+		CHECK(reused.GetIndex() == first.GetIndex() && reused.GetGeneration() == first.GetGeneration() + 1);
+		CHECK(pool.Get(first) == nullptr && pool.Get(reused)->value == 3);
+
+		// Generation wrap: the generation after the largest one is 1 again, never 0, so no handle becomes null
+		Handle<CountedObject> wrapped = reused;
+		bool neverNull = true;
+		while (wrapped.GetGeneration() != Handle<CountedObject>::kMaxGeneration)
+		{
+			pool.Destroy(wrapped);
+			wrapped = pool.Create(4u);
+			neverNull = neverNull && wrapped.IsValid() && wrapped.GetGeneration() != 0 && wrapped.GetIndex() == first.GetIndex();
+		}
+		CHECK(neverNull);
+		pool.Destroy(wrapped);
+		wrapped = pool.Create(5u);
+		CHECK(wrapped.GetIndex() == first.GetIndex() && wrapped.GetGeneration() == 1);
+		CHECK(pool.Get(reused) == nullptr && pool.Get(wrapped)->value == 5);
+
+		// Unload after early destroy: objects destroyed before the pool are not destroyed again by it
+		std::vector<Handle<CountedObject>> handles;
+		for (uint32_t i = 0; i < 3 * HandlePool<CountedObject>::kChunkSize; ++i)
+		{
+			handles.push_back(pool.Create(i));
+		}
+		for (size_t i = 0; i < handles.size(); i += 3)
+		{
+			CHECK(pool.Destroy(handles[i]));
+		}
+		uint32_t visited = 0;
+		pool.ForEach([&](CountedObject&) { visited++; });
+		CHECK(visited == pool.GetCount() && static_cast<int>(visited) == CountedObject::s_Alive);
+	}
+	CHECK(CountedObject::s_Alive == 0);
+
+	CheckConcurrentGet();
+
+	HandlePool<uint64_t> pool;
+	std::vector<Handle<uint64_t>> handles;
+	const uint32_t count = 1000000;
+	const double createSeconds = MeasureSeconds([&]
+		{
+			for (Handle<uint64_t> handle : handles)
+			{
+				pool.Destroy(handle);
+			}
+			handles.clear();
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				handles.push_back(pool.Create(uint64_t(i)));
+			}
+		});
+	uint64_t sink = 0;
+	const double getSeconds = MeasureSeconds([&]
+		{
+			for (Handle<uint64_t> handle : handles)
+			{
+				sink += *pool.Get(handle);
+			}
+		});
+	std::cout << "  Create " << createSeconds / count * 1e9 << " ns, Get " << getSeconds / count * 1e9 << " ns per object"
+		<< (sink == 0 ? " (no object read)" : "") << std::endl;
+}
@@ -0,0 +1,172 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Transform.h"
+#include "Scene/TransformHierarchy.h"
+
+/**
+ * @brief World matrix multiplied up the parent chain, the way GetWorldMatrix computed it before the hierarchy
+ */
+static glm::mat4 GetChainWorldMatrix(const Transform* transform)
+{
+	glm::mat4 world = transform->GetMatrix();
+	for (const Transform* parent = transform->GetParent(); parent; parent = parent->GetParent())
+	{
+		world = parent->GetMatrix() * world;
+	}
+	return world;
+}
+
+static float GetLargestDifference(const std::vector<Transform*>& transforms)
+{
+	float difference = 0.0f;
+	for (const Transform* transform : transforms)
+	{
+		const glm::mat4 cached = transform->GetWorldMatrix();
+		const glm::mat4 expected = GetChainWorldMatrix(transform);
+		for (int c = 0; c < 4; ++c)
+		{
+			for (int r = 0; r < 4; ++r)
+			{
+				difference = std::max(difference, std::abs(cached[c][r] - expected[c][r]));
+			}
+		}
+	}
+	return difference;
+}
+
+/**
+ * @brief Destroying or removing a parent detaches its children, they keep their local transform
+ */
+static void CheckDetach()
+{
+	GameObject* parent = CreateGameObject("parent");
+	Transform* parentTransform = parent->AddComponent<Transform>();
+	parentTransform->SetTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+	GameObject* first = CreateGameObject("first");
+	Transform* firstTransform = first->AddComponent<Transform>();
+	firstTransform->SetParent(parentTransform);
+	firstTransform->SetTranslation(glm::vec3(1.0f, 0.0f, 0.0f));
+	GameObject* second = CreateGameObject("second");
+	Transform* secondTransform = second->AddComponent<Transform>();
+	secondTransform->SetParent(parentTransform);
+	secondTransform->SetTranslation(glm::vec3(2.0f, 0.0f, 0.0f));
+	GameObject* leaf = CreateGameObject("leaf");
+	Transform* leafTransform = leaf->AddComponent<Transform>();
+	leafTransform->SetParent(firstTransform);
+
+	TransformHierarchy::GetInstance().Update();
+	CHECK(firstTransform->GetWorldMatrix()[3].x == 11.0f && leafTransform->GetWorldMatrix()[3].x == 11.0f);
+
+	// The row of the destroyed parent is reused right away, the children must not follow it
+	GameObject::Destroy(parent->GetHandle());
+	GameObject* reused = CreateGameObject("reused");
+	Transform* reusedTransform = reused->AddComponent<Transform>();
+	reusedTransform->SetTranslation(glm::vec3(100.0f, 0.0f, 0.0f));
+	TransformHierarchy::GetInstance().Update();
+	CHECK(firstTransform->GetParent() == nullptr && secondTransform->GetParent() == nullptr && leafTransform->GetParent() == firstTransform);
+	CHECK(firstTransform->GetWorldMatrix()[3].x == 1.0f && secondTransform->GetWorldMatrix()[3].x == 2.0f && leafTransform->GetWorldMatrix()[3].x == 1.0f);
+
+	secondTransform->SetParent(reusedTransform);
+	leafTransform->SetParent(secondTransform);
+	firstTransform->SetParent(secondTransform);
+	second->RemoveComponent<Transform>();
+	GameObject* other = CreateGameObject("other");
+	other->AddComponent<Transform>()->SetTranslation(glm::vec3(1000.0f, 0.0f, 0.0f));
+	TransformHierarchy::GetInstance().Update();
+	CHECK(leafTransform->GetParent() == nullptr && firstTransform->GetParent() == nullptr);
+	CHECK(firstTransform->GetWorldMatrix()[3].x == 1.0f && leafTransform->GetWorldMatrix()[3].x == 0.0f);
+
+	for (GameObject* go : { first, second, leaf, reused, other })
+	{
+		GameObject::Destroy(go->GetHandle());
+	}
+}
+
+void CheckTransformHierarchy()
+{
+	CheckDetach();
+
+	// A 4-ary tree below 8 roots, about 9 levels deep
+	const uint32_t count = 20000;
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+	std::vector<GameObjectHandle> nodes;
+	std::vector<Transform*> transforms;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		GameObject* go = CreateGameObject("node");
+		nodes.push_back(go->GetHandle());
+		Transform* transform = go->AddComponent<Transform>();
+		transform->SetTranslation(glm::vec3(component(random), component(random), component(random)));
+		transform->SetRotation(glm::normalize(glm::quat(1.0f, component(random) * 0.1f, component(random) * 0.1f, component(random) * 0.1f)));
+		transform->SetScale(glm::vec3(1.0f + component(random) * 0.01f));
+		transform->SetParent(i >= 8 ? transforms[(i - 8) / 4] : nullptr);
+		transforms.push_back(transform);
+	}
+
+	TransformHierarchy& hierarchy = TransformHierarchy::GetInstance();
+	TransformUpdateStatistics statistics;
+	const double fullSeconds = MeasureSeconds([&] { statistics = hierarchy.Update(); }, 1);
+	CHECK(statistics.rebuilt && statistics.updatedCount >= count);
+	CHECK(hierarchy.Update().updatedCount == 0);
+	CHECK(GetLargestDifference(transforms) <= 1e-4f);
+
+	// One percent of the transforms move every frame, their subtrees follow
+	const uint32_t frames = 20;
+	std::uniform_int_distribution<uint32_t> pick(0, count - 1);
+	uint64_t updatedCount = 0;
+	const double movingSeconds = MeasureSeconds([&]
+		{
+			for (uint32_t f = 0; f < frames; ++f)
+			{
+				for (uint32_t m = 0; m < count / 100; ++m)
+				{
+					Transform* moved = transforms[pick(random)];
+					moved->SetTranslation(moved->GetTranslation() + glm::vec3(0.01f, 0.0f, 0.0f));
+				}
+				statistics = hierarchy.Update();
+				CHECK(!statistics.rebuilt);
+				updatedCount += statistics.updatedCount;
+			}
+		}, 1);
+	const float difference = GetLargestDifference(transforms);
+	CHECK(difference <= 1e-4f);
+
+	// Below a moved transform nothing is current until the update, reading it falls back to the chain
+	transforms.back()->GetParent()->SetRotation(glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+	CHECK(GetLargestDifference({ transforms.back() }) <= 1e-4f);
+	hierarchy.Update();
+
+	float sink = 0.0f;
+	const double chainSeconds = MeasureSeconds([&]
+		{
+			for (const Transform* transform : transforms)
+			{
+				sink += GetChainWorldMatrix(transform)[3].x;
+			}
+		});
+	const double cachedSeconds = MeasureSeconds([&]
+		{
+			for (const Transform* transform : transforms)
+			{
+				sink += transform->GetWorldMatrix()[3].x;
+			}
+		});
+	std::cout << "  " << count << " transforms: full update " << fullSeconds * 1e3 << " ms (" << statistics.partitionCount << " partitions), 1% moving "
+		<< movingSeconds / frames * 1e3 << " ms/frame for " << updatedCount / frames << " world matrices" << std::endl;
+	std::cout << "  world matrix read " << cachedSeconds / count * 1e9 << " ns cached, " << chainSeconds / count * 1e9 << " ns up the parent chain, largest difference "
+		<< difference << (std::isfinite(sink) ? "" : " (not finite)") << std::endl;
+
+	for (GameObjectHandle node : nodes)
+	{
+		GameObject::Destroy(node);
+	}
+}
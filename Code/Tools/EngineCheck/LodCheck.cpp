@@ -0,0 +1,79 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "Geometry/MeshSimplifier.h"
+#include "Geometry/MeshUtils.h"
+
+/**
+ * @brief Signed area of the triangles projected onto the y = 0 plane of the grid
+ * Flipped triangles subtract their area and holes lose theirs, so it only matches the full resolution area
+ * when the LOD still covers the grid exactly once.
+ */
+static double GetProjectedArea(const uint32_t* indices, size_t indexCount, const std::vector<glm::vec3>& positions)
+{
+	double area = 0.0;
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		const glm::vec3 e1 = positions[indices[i + 1]] - positions[indices[i]];
+		const glm::vec3 e2 = positions[indices[i + 2]] - positions[indices[i]];
+		area += 0.5 * (double(e1.z) * e2.x - double(e1.x) * e2.z);
+	}
+	return area;
+}
+
+void CheckLods()
+{
+	SubMesh subMesh = MakeGridSubMesh(256, 256);
+	const std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	std::vector<glm::vec3> positions;
+	CHECK(MeshUtils::ReadPositions(subMesh, positions));
+
+	const std::vector<float> ratios = { 0.5f, 0.25f, 0.125f };
+	MeshSimplifyStatistics statistics;
+	const double seconds = MeasureSeconds([&] { statistics = MeshSimplifier::GenerateLods(subMesh, ratios); }, 3);
+	CHECK(subMesh.lods.size() == ratios.size());
+
+	// Every LOD meets its triangle budget, only references existing vertices and keeps the grid covered
+	const double fullArea = GetProjectedArea(indices.data(), indices.size(), positions);
+	CHECK(std::abs(std::abs(fullArea) - 1.0) < 1e-3);
+	for (uint32_t lod = 1; lod < subMesh.GetLodCount(); ++lod)
+	{
+		const AccessorView& indexBuffer = subMesh.GetLodIndexBuffer(lod);
+		const uint32_t indexCount = subMesh.GetLodIndexCount(lod);
+		CHECK(indexBuffer.format == VK_FORMAT_R32_UINT && indexBuffer.count == indexCount);
+		CHECK(indexCount % 3 == 0 && indexCount > 0);
+		CHECK(indexCount < subMesh.GetLodIndexCount(lod - 1));
+		CHECK(indexCount / 3 <= static_cast<uint32_t>(indices.size() / 3 * ratios[lod - 1]));
+		CHECK(subMesh.GetLodError(lod) >= subMesh.GetLodError(lod - 1));
+
+		const uint32_t* lodIndices = reinterpret_cast<const uint32_t*>(indexBuffer.Data());
+		bool valid = true;
+		for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			valid = valid && lodIndices[i] < subMesh.vertexCount && lodIndices[i + 1] < subMesh.vertexCount && lodIndices[i + 2] < subMesh.vertexCount;
+			valid = valid && lodIndices[i] != lodIndices[i + 1] && lodIndices[i + 1] != lodIndices[i + 2] && lodIndices[i] != lodIndices[i + 2];
+		}
+		CHECK(valid);
+		CHECK(std::abs(GetProjectedArea(lodIndices, indexCount, positions) - fullArea) < 1e-3);
+	}
+
+	// A tight error budget stops the collapses before the triangle target
+	std::vector<uint32_t> simplified(indices.size());
+	const float maxError = 1e-4f;
+	float error = 0.0f;
+	const size_t indexCount = MeshSimplifier::Simplify(simplified.data(), indices.data(), indices.size(), positions.data(), subMesh.vertexCount, 0, maxError, &error);
+	CHECK(indexCount > 0 && indexCount <= indices.size());
+	CHECK(error <= maxError);
+
+	std::cout << "  " << indices.size() / 3 << " triangles:";
+	for (uint32_t lod = 1; lod < subMesh.GetLodCount(); ++lod)
+	{
+		std::cout << " " << subMesh.GetLodIndexCount(lod) / 3 << " (error " << subMesh.GetLodError(lod) << ")";
+	}
+	std::cout << ", " << statistics.inputTriangles / seconds * 1e-6 << " M triangles/s" << std::endl;
+	std::cout << "  error " << maxError << ": " << indexCount / 3 << " triangles" << std::endl;
+}
@@ -0,0 +1,111 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <iostream>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "ModelReader/GltfReader.h"
+#include "Render/MaterialTable.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+static Material MakeMaterial(const glm::vec4& baseColor, float roughness)
+{
+	Material material("");
+	material.baseColorFactor = baseColor;
+	material.roughnessFactor = roughness;
+	return material;
+}
+
+/**
+ * @brief Gives the .gltf file written by WriteGltf the materials, primitive m uses materials[m], -1 leaves it without one
+ */
+static bool AddMaterials(const std::string& path, const nlohmann::json& materials, const std::vector<int>& primitiveMaterials)
+{
+	const std::vector<uint8_t> text = FileSystem::LoadFile(path);
+	nlohmann::json document = nlohmann::json::parse(text.begin(), text.end());
+	document["materials"] = materials;
+	for (size_t m = 0; m < primitiveMaterials.size(); ++m)
+	{
+		if (primitiveMaterials[m] >= 0)
+		{
+			document["meshes"][m]["primitives"][0]["material"] = primitiveMaterials[m];
+		}
+	}
+
+	const std::string materialText = document.dump();
+	return FileSystem::WriteFile(path, materialText.data(), materialText.size());
+}
+
+static MaterialHandle GetMaterial(const Scene& scene, size_t meshIndex)
+{
+	const Mesh* mesh = meshIndex < scene.GetMeshes().size() ? MeshRegistry::GetInstance().Get(scene.GetMeshes()[meshIndex]) : nullptr;
+	return mesh && !mesh->GetSubmeshes().empty() ? mesh->GetSubmeshes()[0].material : MaterialHandle();
+}
+
+void CheckMaterialTable()
+{
+	MaterialTable& table = MaterialTable::GetInstance();
+	const uint32_t baseCount = table.GetCount();
+
+	// Equal values share a handle whatever the name, any difference makes a new material
+	const MaterialHandle red = table.Add(MakeMaterial(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), 0.5f));
+	CHECK(table.Add(MakeMaterial(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), 0.5f)) == red);
+	CHECK(table.Add(MakeMaterial(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), 0.25f)) != red);
+	Material doubleSided = MakeMaterial(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), 0.5f);
+	doubleSided.doubleSided = true;
+	CHECK(table.Add(std::move(doubleSided)) != red);
+	CHECK(table.Get(red).roughnessFactor == 0.5f);
+	CHECK(&table.Get(MaterialHandle()) == &table.Get(table.GetDefault()));
+	CHECK(table.GetCount() == baseCount + 3);
+
+	// Two files with one material in common, each file also names it differently
+	const SubMesh first = MakeGridSubMesh(8, 8, 1);
+	const SubMesh second = MakeGridSubMesh(8, 8, 2);
+	const SubMesh third = MakeGridSubMesh(8, 8, 3);
+	const std::string directory = MakeCheckDirectory("material_table");
+	const std::string levelPath = directory + "/level.gltf";
+	const std::string propPath = directory + "/prop.gltf";
+	const nlohmann::json blue = { { "name", "blue" }, { "pbrMetallicRoughness", { { "baseColorFactor", { 0.0, 0.0, 1.0, 1.0 } }, { "roughnessFactor", 0.75 } } } };
+	nlohmann::json sharedBlue = blue;
+	sharedBlue["name"] = "prop_blue";
+	const nlohmann::json green = { { "name", "green" }, { "pbrMetallicRoughness", { { "baseColorFactor", { 0.0, 1.0, 0.0, 1.0 } } } }, { "doubleSided", true } };
+	CHECK(WriteGltf(levelPath, { &first, &second, &third }));
+	CHECK(AddMaterials(levelPath, { blue, green, blue }, { 0, 2, -1 }));
+	CHECK(WriteGltf(propPath, { &third, &first }));
+	CHECK(AddMaterials(propPath, { green, sharedBlue }, { 1, 0 }));
+
+	const uint32_t countBeforeLoad = table.GetCount();
+	const GltfImportSettings settings;
+	Scene* level = GltfReader::LoadSource(levelPath.c_str(), settings);
+	Scene* prop = GltfReader::LoadSource(propPath.c_str(), settings);
+	CHECK(level && level->GetMeshes().size() == 3);
+	CHECK(prop && prop->GetMeshes().size() == 2);
+	if (level && level->GetMeshes().size() == 3 && prop && prop->GetMeshes().size() == 2)
+	{
+		// Both blues of the level and the prop's blue are one handle, the primitive without a material gets the default
+		const MaterialHandle levelBlue = GetMaterial(*level, 0);
+		CHECK(levelBlue.IsValid() && levelBlue == GetMaterial(*level, 1));
+		CHECK(GetMaterial(*prop, 0) == levelBlue);
+		CHECK(GetMaterial(*prop, 1).IsValid() && GetMaterial(*prop, 1) != levelBlue);
+		CHECK(GetMaterial(*level, 2) == table.GetDefault());
+		CHECK(table.Get(levelBlue).baseColorFactor == glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+		CHECK(table.Get(GetMaterial(*prop, 1)).doubleSided);
+
+		// The two files add blue and green only
+		CHECK(table.GetCount() == countBeforeLoad + 2);
+	}
+	WL_DELETE(level);
+	WL_DELETE(prop);
+
+	// Materials outlive the scenes, loading a file again finds every one of them
+	Scene* again = GltfReader::LoadSource(propPath.c_str(), settings);
+	CHECK(again && table.GetCount() == countBeforeLoad + 2);
+	WL_DELETE(again);
+
+	std::cout << "  " << table.GetCount() << " materials in the table" << std::endl;
+}
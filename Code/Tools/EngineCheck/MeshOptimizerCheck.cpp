@@ -0,0 +1,94 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <vector>
+
+#include "Geometry/MeshOptimizer.h"
+#include "Geometry/MeshUtils.h"
+
+using TrianglePositions = std::array<float, 9>;
+
+/**
+ * @brief Triangles as their corner positions, each rotated to start at its smallest corner so the winding is kept,
+ * in sorted order so two index buffers of the same triangles compare equal
+ */
+static std::vector<TrianglePositions> GetTriangleSet(const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions)
+{
+	std::vector<TrianglePositions> triangles;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		std::array<glm::vec3, 3> corners = { positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]] };
+		auto less = [](const glm::vec3& a, const glm::vec3& b) { return std::lexicographical_compare(&a.x, &a.x + 3, &b.x, &b.x + 3); };
+		std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), less), corners.end());
+
+		TrianglePositions triangle;
+		for (int c = 0; c < 3; ++c)
+		{
+			triangle[c * 3 + 0] = corners[c].x;
+			triangle[c * 3 + 1] = corners[c].y;
+			triangle[c * 3 + 2] = corners[c].z;
+		}
+		triangles.push_back(triangle);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+void CheckMeshOptimizer()
+{
+	// The grid vertices are shuffled, its index buffer starts far from any cache friendly order
+	const SubMesh source = MakeGridSubMesh(256, 256);
+	const std::vector<uint32_t> sourceIndices = MeshUtils::ReadIndices(source);
+	std::vector<glm::vec3> sourcePositions;
+	CHECK(MeshUtils::ReadPositions(source, sourcePositions));
+
+	// The triangle order Optimize ends with, still in source vertex numbers
+	const float threshold = 1.05f;
+	std::vector<uint32_t> cacheOrder(sourceIndices.size());
+	std::vector<uint32_t> clusters;
+	MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), sourceIndices.data(), sourceIndices.size(), source.vertexCount, &clusters);
+	std::vector<uint32_t> ordered(sourceIndices.size());
+	MeshOptimizer::OptimizeOverdraw(ordered.data(), cacheOrder.data(), cacheOrder.size(), sourcePositions.data(), source.vertexCount, clusters, threshold);
+
+	SubMesh subMesh = source;
+	MeshOptimizeStatistics statistics;
+	const double seconds = MeasureSeconds([&]
+		{
+			subMesh = source;
+			statistics = MeshOptimizer::Optimize(subMesh, threshold);
+		}, 3);
+
+	const std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	std::vector<glm::vec3> positions;
+	CHECK(MeshUtils::ReadPositions(subMesh, positions));
+
+	// Fewer vertices transformed per triangle, the same triangles with the same winding
+	CHECK(statistics.after.acmr < statistics.before.acmr);
+	CHECK(statistics.after.atvr < statistics.before.atvr);
+	CHECK(indices.size() == sourceIndices.size());
+	CHECK(GetTriangleSet(indices, positions) == GetTriangleSet(sourceIndices, sourcePositions));
+
+	// The fetch remap numbers vertices by first use and moves every vertex with its number
+	bool firstUseOrder = true;
+	uint32_t nextVertex = 0;
+	for (uint32_t index : indices)
+	{
+		firstUseOrder = firstUseOrder && index <= nextVertex;
+		nextVertex = std::max(nextVertex, index + 1);
+	}
+	CHECK(firstUseOrder);
+	CHECK(subMesh.vertexCount == nextVertex);
+
+	bool samePositions = indices.size() == ordered.size();
+	for (size_t i = 0; samePositions && i < indices.size(); ++i)
+	{
+		samePositions = positions[indices[i]] == sourcePositions[ordered[i]];
+	}
+	CHECK(samePositions);
+
+	std::cout << "  " << sourceIndices.size() / 3 << " triangles: ACMR " << statistics.before.acmr << " -> " << statistics.after.acmr << ", ATVR "
+		<< statistics.before.atvr << " -> " << statistics.after.atvr << ", optimized in " << seconds * 1e3 << " ms" << std::endl;
+}
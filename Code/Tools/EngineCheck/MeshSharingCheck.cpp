@@ -0,0 +1,150 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/GameObject.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/MeshRenderer.h"
+#include "Scene/Scene.h"
+
+/**
+ * @brief Adds a node instancing a glTF mesh below the root node of a .gltf file written by WriteGltf
+ */
+static bool AddInstances(const std::string& path, const std::vector<uint32_t>& meshIndices)
+{
+	const std::vector<uint8_t> text = FileSystem::LoadFile(path);
+	nlohmann::json document = nlohmann::json::parse(text.begin(), text.end());
+	for (uint32_t meshIndex : meshIndices)
+	{
+		document["nodes"][0]["children"].push_back(document["nodes"].size());
+		document["nodes"].push_back({ { "name", "instance" }, { "mesh", meshIndex } });
+	}
+
+	const std::string instancedText = document.dump();
+	return FileSystem::WriteFile(path, instancedText.data(), instancedText.size());
+}
+
+/**
+ * @brief Meshes the MeshRenderers of a scene draw, one entry per instance
+ */
+static std::vector<MeshHandle> GetInstancedMeshes(const Scene& scene)
+{
+	std::vector<MeshHandle> meshes;
+	for (GameObjectHandle handle : scene.GetNodes())
+	{
+		GameObject* node = GameObject::Get(handle);
+		MeshRenderer* meshRenderer = node ? node->GetComponent<MeshRenderer>() : nullptr;
+		if (meshRenderer)
+		{
+			meshes.push_back(meshRenderer->GetMeshHandle());
+		}
+	}
+	return meshes;
+}
+
+static size_t CountUniqueMeshes(const std::vector<MeshHandle>& meshes)
+{
+	std::set<uint32_t> indices;
+	for (MeshHandle mesh : meshes)
+	{
+		indices.insert(mesh.GetIndex());
+	}
+	return indices.size();
+}
+
+void CheckMeshSharing()
+{
+	MeshRegistry& registry = MeshRegistry::GetInstance();
+	const uint32_t baseCount = registry.GetCount();
+
+	// glTF meshes 0 and 2 hold the same grid, the nodes added below instance meshes 0 and 1 again
+	const SubMesh first = MakeGridSubMesh(64, 64, 1);
+	const SubMesh second = MakeGridSubMesh(64, 64, 2);
+	const std::string directory = MakeCheckDirectory("mesh_sharing");
+	const std::string levelPath = directory + "/level.gltf";
+	const std::string propPath = directory + "/prop.gltf";
+	CHECK(WriteGltf(levelPath, { &first, &second, &first }));
+	CHECK(AddInstances(levelPath, { 0, 0, 1 }));
+	CHECK(WriteGltf(propPath, { &second }));
+
+	const GltfImportSettings settings;
+	Scene* level = GltfReader::LoadSource(levelPath.c_str(), settings);
+	CHECK(level != nullptr);
+	if (!level)
+	{
+		return;
+	}
+
+	// Six instances of three glTF meshes, two of them the same content, draw two meshes
+	const std::vector<MeshHandle> levelInstances = GetInstancedMeshes(*level);
+	CHECK(levelInstances.size() == 6);
+	CHECK(level->GetMeshes().size() == 3);
+	CHECK(CountUniqueMeshes(levelInstances) == 2);
+	CHECK(registry.GetCount() == baseCount + 2);
+	CHECK(level->GetMeshes()[0] == level->GetMeshes()[2] && level->GetMeshes()[0] != level->GetMeshes()[1]);
+
+	// Another file with the same mesh takes a reference instead of decoding it again
+	Scene* prop = GltfReader::LoadSource(propPath.c_str(), settings);
+	CHECK(prop && prop->GetMeshes().size() == 1);
+	if (prop && prop->GetMeshes().size() == 1)
+	{
+		CHECK(prop->GetMeshes()[0] == level->GetMeshes()[1]);
+	}
+	CHECK(registry.GetCount() == baseCount + 2);
+
+	// The level held the first grid twice, deleting it drops both references, the prop keeps the second grid alive
+	const MeshHandle firstMesh = level->GetMeshes()[0];
+	const MeshHandle secondMesh = level->GetMeshes()[1];
+	WL_DELETE(level);
+	CHECK(registry.Get(firstMesh) == nullptr);
+	CHECK(registry.Get(secondMesh) != nullptr);
+	CHECK(registry.GetCount() == baseCount + 1);
+
+	WL_DELETE(prop);
+	CHECK(registry.Get(secondMesh) == nullptr);
+	CHECK(registry.GetCount() == baseCount);
+
+	// Identical meshes of one file decode once
+	const uint32_t copyCount = 16;
+	std::vector<SubMesh> distinct;
+	for (uint32_t i = 0; i < copyCount; ++i)
+	{
+		distinct.push_back(MakeGridSubMesh(64, 64, i + 1));
+	}
+	std::vector<const SubMesh*> copies(copyCount, &first);
+	std::vector<const SubMesh*> distinctPointers;
+	for (const SubMesh& subMesh : distinct)
+	{
+		distinctPointers.push_back(&subMesh);
+	}
+	const std::string copiesPath = directory + "/copies.gltf";
+	const std::string distinctPath = directory + "/distinct.gltf";
+	CHECK(WriteGltf(copiesPath, copies));
+	CHECK(WriteGltf(distinctPath, distinctPointers));
+
+	GltfImportSettings passes = GltfImportSettings::ForCooking();
+	passes.useCookedScene = false;
+	auto measureLoad = [&](const std::string& path)
+	{
+		return MeasureSeconds([&]
+			{
+				Scene* scene = GltfReader::LoadSource(path.c_str(), passes);
+				CHECK(scene && scene->GetMeshes().size() == copyCount);
+				WL_DELETE(scene);
+			}, 3);
+	};
+	const double copiesSeconds = measureLoad(copiesPath);
+	const double distinctSeconds = measureLoad(distinctPath);
+	CHECK(registry.GetCount() == baseCount);
+
+	std::cout << "  " << levelInstances.size() << " instances of 2 meshes, " << copyCount << " copies of a grid load in " << copiesSeconds * 1e3
+		<< " ms, " << copyCount << " distinct grids in " << distinctSeconds * 1e3 << " ms" << std::endl;
+}
@@ -0,0 +1,112 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Geometry/MeshUtils.h"
+#include "Geometry/Meshlet.h"
+
+static std::array<uint32_t, 3> SortedTriangle(uint32_t a, uint32_t b, uint32_t c)
+{
+	std::array<uint32_t, 3> triangle = { a, b, c };
+	std::sort(triangle.begin(), triangle.end());
+	return triangle;
+}
+
+void CheckMeshlets()
+{
+	SubMesh subMesh = MakeGridSubMesh(256, 256);
+	const std::vector<uint32_t> indices = MeshUtils::ReadIndices(subMesh);
+	std::vector<glm::vec3> positions;
+	CHECK(MeshUtils::ReadPositions(subMesh, positions));
+
+	MeshletData data;
+	const double seconds = MeasureSeconds([&] { data = MeshletBuilder::Build(subMesh); });
+	CHECK(data.GetCount() > 0);
+
+	// Every triangle ends up in exactly one meshlet and the meshlets stay within their limits
+	std::vector<std::array<uint32_t, 3>> expected;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		expected.push_back(SortedTriangle(indices[i], indices[i + 1], indices[i + 2]));
+	}
+
+	const uint32_t* vertices = reinterpret_cast<const uint32_t*>(data.vertices.Data());
+	const uint8_t* triangles = data.triangles.Data();
+	std::vector<std::array<uint32_t, 3>> emitted;
+	for (uint32_t m = 0; m < data.GetCount(); ++m)
+	{
+		const Meshlet& meshlet = data.GetMeshlet(m);
+		CHECK(meshlet.vertexCount <= MeshletData::kMaxVertices);
+		CHECK(meshlet.triangleCount <= MeshletData::kMaxTriangles && meshlet.triangleCount > 0);
+		CHECK(meshlet.vertexOffset + meshlet.vertexCount <= data.vertices.count);
+		CHECK((meshlet.triangleOffset + meshlet.triangleCount) * 3 <= data.triangles.count);
+
+		for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+		{
+			const uint8_t* corners = triangles + (static_cast<size_t>(meshlet.triangleOffset) + t) * 3;
+			CHECK(corners[0] < meshlet.vertexCount && corners[1] < meshlet.vertexCount && corners[2] < meshlet.vertexCount);
+			emitted.push_back(SortedTriangle(vertices[meshlet.vertexOffset + corners[0]], vertices[meshlet.vertexOffset + corners[1]], vertices[meshlet.vertexOffset + corners[2]]));
+		}
+
+		// The sphere holds every vertex
+		const glm::vec3 center(data.GetBounds(MeshletBoundsArray::CenterX)[m], data.GetBounds(MeshletBoundsArray::CenterY)[m], data.GetBounds(MeshletBoundsArray::CenterZ)[m]);
+		const float radius = data.GetBounds(MeshletBoundsArray::Radius)[m];
+		for (uint32_t v = 0; v < meshlet.vertexCount; ++v)
+		{
+			CHECK(glm::length(positions[vertices[meshlet.vertexOffset + v]] - center) <= radius * 1.0001f + 1e-6f);
+		}
+	}
+
+	std::sort(expected.begin(), expected.end());
+	std::sort(emitted.begin(), emitted.end());
+	CHECK(emitted == expected);
+
+	// Cone culling is conservative, a meshlet is only rejected when all of its triangles face away
+	std::mt19937 random(3);
+	std::uniform_real_distribution<float> coordinate(-2.0f, 3.0f);
+	uint32_t culled = 0;
+	uint32_t tested = 0;
+	std::vector<uint8_t> visible;
+	for (uint32_t c = 0; c < 64; ++c)
+	{
+		const glm::vec3 camera(coordinate(random), coordinate(random), coordinate(random));
+		data.CullBackFacing(camera, visible);
+		CHECK(visible.size() == data.GetCount());
+
+		for (uint32_t m = 0; m < data.GetCount(); ++m)
+		{
+			const bool backFacing = data.IsBackFacing(m, camera);
+			CHECK(visible[m] == (backFacing ? 0 : 1));
+			tested++;
+			if (!backFacing)
+			{
+				continue;
+			}
+
+			culled++;
+			const Meshlet& meshlet = data.GetMeshlet(m);
+			for (uint32_t t = 0; t < meshlet.triangleCount; ++t)
+			{
+				const uint8_t* corners = triangles + (static_cast<size_t>(meshlet.triangleOffset) + t) * 3;
+				const glm::vec3& p0 = positions[vertices[meshlet.vertexOffset + corners[0]]];
+				const glm::vec3& p1 = positions[vertices[meshlet.vertexOffset + corners[1]]];
+				const glm::vec3& p2 = positions[vertices[meshlet.vertexOffset + corners[2]]];
+				CHECK(glm::dot(glm::cross(p1 - p0, p2 - p0), camera - p0) <= 1e-6f);
+			}
+		}
+	}
+
+	// A SubMesh without positions has no meshlets
+	SubMesh empty;
+	CHECK(MeshletBuilder::Build(empty).GetCount() == 0);
+
+	const MeshletStatistics statistics = MeshletBuilder::GetStatistics(data);
+	std::cout << "  " << indices.size() / 3 << " triangles: " << statistics.meshletCount << " meshlets, vertex fill " << statistics.vertexFill
+		<< ", triangle fill " << statistics.triangleFill << ", " << indices.size() / 3 / seconds * 1e-6 << " M triangles/s" << std::endl;
+	std::cout << "  back facing: " << culled << "/" << tested << " meshlets culled from random cameras" << std::endl;
+}
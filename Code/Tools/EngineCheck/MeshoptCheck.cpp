@@ -0,0 +1,417 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Framework/GlmCommon.h"
+#include "ModelReader/MeshoptDecoder.h"
+
+// Reference encoders of the meshoptimizer codecs. They pick valid but simple encodings (every byte group mode,
+// explicit triangles only), which is enough to drive every decoder path.
+
+static uint32_t EncodeZigZag(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+/**
+ * @brief Encodes one byte stream of a vertex block, n is a multiple of 16
+ */
+static void EncodeByteGroups(std::vector<uint8_t>& output, const uint8_t* bytes, size_t n)
+{
+	const size_t groupCount = n / 16;
+	const size_t header = output.size();
+	output.resize(header + (groupCount + 3) / 4, 0);
+
+	for (size_t g = 0; g < groupCount; ++g)
+	{
+		const uint8_t* group = bytes + g * 16;
+
+		// Mode 0 is all zero, 1 and 2 pack 2 and 4 bits per byte with escaped outliers, 3 stores the bytes
+		uint32_t mode = 3;
+		size_t bestSize = 16;
+		if (std::all_of(group, group + 16, [](uint8_t b) { return b == 0; }))
+		{
+			mode = 0;
+			bestSize = 0;
+		}
+		else
+		{
+			for (uint32_t candidate = 1; candidate <= 2; ++candidate)
+			{
+				const uint32_t bits = 1u << candidate;
+				const uint32_t escape = (1u << bits) - 1;
+				const size_t size = bits * 2 + std::count_if(group, group + 16, [&](uint8_t b) { return b >= escape; });
+				if (size < bestSize)
+				{
+					bestSize = size;
+					mode = candidate;
+				}
+			}
+		}
+		output[header + g / 4] |= static_cast<uint8_t>(mode << ((g % 4) * 2));
+
+		if (mode == 3)
+		{
+			output.insert(output.end(), group, group + 16);
+		}
+		else if (mode > 0)
+		{
+			const uint32_t bits = 1u << mode;
+			const uint32_t escape = (1u << bits) - 1;
+			std::vector<uint8_t> packed(bits * 2, 0);
+			std::vector<uint8_t> escaped;
+			for (uint32_t i = 0; i < 16; ++i)
+			{
+				const uint32_t value = std::min<uint32_t>(group[i], escape);
+				if (value == escape)
+				{
+					escaped.push_back(group[i]);
+				}
+				packed[i * bits / 8] |= static_cast<uint8_t>(value << (8 - bits - (i * bits) % 8));
+			}
+			output.insert(output.end(), packed.begin(), packed.end());
+			output.insert(output.end(), escaped.begin(), escaped.end());
+		}
+	}
+}
+
+static std::vector<uint8_t> EncodeVertexBuffer(const uint8_t* vertices, size_t count, size_t vertexSize)
+{
+	std::vector<uint8_t> output = { 0xa0 };
+	const size_t blockSize = std::min<size_t>((8192 / vertexSize) & ~size_t(15), 256);
+
+	// The first vertex is the tail of the stream and the baseline of the first block
+	std::vector<uint8_t> last(vertices, vertices + vertexSize);
+	for (size_t offset = 0; offset < count; offset += blockSize)
+	{
+		const size_t blockCount = std::min(blockSize, count - offset);
+		std::vector<uint8_t> deltas((blockCount + 15) & ~size_t(15), 0);
+		for (size_t k = 0; k < vertexSize; ++k)
+		{
+			uint8_t previous = last[k];
+			for (size_t i = 0; i < blockCount; ++i)
+			{
+				const uint8_t value = vertices[(offset + i) * vertexSize + k];
+				const int8_t delta = static_cast<int8_t>(static_cast<uint8_t>(value - previous));
+				deltas[i] = static_cast<uint8_t>(EncodeZigZag(delta));
+				previous = value;
+			}
+			EncodeByteGroups(output, deltas.data(), deltas.size());
+		}
+		std::memcpy(last.data(), vertices + (offset + blockCount - 1) * vertexSize, vertexSize);
+	}
+
+	output.resize(output.size() + std::max<size_t>(32, vertexSize) - vertexSize, 0);
+	output.insert(output.end(), vertices, vertices + vertexSize);
+	return output;
+}
+
+static void EncodeVByte(std::vector<uint8_t>& output, uint32_t value)
+{
+	while (value >= 128)
+	{
+		output.push_back(static_cast<uint8_t>((value & 127) | 128));
+		value >>= 7;
+	}
+	output.push_back(static_cast<uint8_t>(value));
+}
+
+static std::vector<uint8_t> EncodeIndexSequence(const std::vector<uint32_t>& indices)
+{
+	std::vector<uint8_t> output = { 0xd1 };
+	uint32_t last[2] = { 0, 0 };
+	for (size_t i = 0; i < indices.size(); ++i)
+	{
+		// Alternate between both baselines so each of them is exercised
+		const uint32_t baseline = i & 1;
+		EncodeVByte(output, (EncodeZigZag(static_cast<int32_t>(indices[i] - last[baseline])) << 1) | baseline);
+		last[baseline] = indices[i];
+	}
+	output.resize(output.size() + 4, 0);
+	return output;
+}
+
+static std::vector<uint8_t> EncodeIndexBuffer(const std::vector<uint32_t>& indices)
+{
+	std::vector<uint8_t> output = { 0xe1 };
+	std::vector<uint8_t> data;
+	uint32_t last = 0;
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		// Every triangle is coded explicitly, as three deltas against the last index
+		output.push_back(0xff);
+		data.push_back(0xff);
+		for (size_t k = 0; k < 3; ++k)
+		{
+			EncodeVByte(data, EncodeZigZag(static_cast<int32_t>(indices[i + k] - last)));
+			last = indices[i + k];
+		}
+	}
+	output.insert(output.end(), data.begin(), data.end());
+	output.resize(output.size() + 16, 0);
+	return output;
+}
+
+static void CheckVertexCodec(const std::vector<SimdLevel>& levels, std::mt19937& random)
+{
+	// Smooth, noisy and slowly changing bytes, so all group modes show up
+	for (size_t vertexSize : { 4, 8, 12, 16, 20, 32, 64, 256 })
+	{
+		for (size_t count : { 1, 15, 16, 17, 100, 1000, 5003 })
+		{
+			std::vector<uint8_t> vertices(count * vertexSize);
+			for (size_t i = 0; i < count; ++i)
+			{
+				for (size_t k = 0; k < vertexSize; ++k)
+				{
+					vertices[i * vertexSize + k] = k % 3 == 0 ? static_cast<uint8_t>(i * 3 + k) : (k % 3 == 1 ? static_cast<uint8_t>(random()) : static_cast<uint8_t>(i / 7));
+				}
+			}
+
+			const std::vector<uint8_t> encoded = EncodeVertexBuffer(vertices.data(), count, vertexSize);
+			for (SimdLevel level : levels)
+			{
+				MeshoptDecoder::SetSimdLevel(level);
+				std::vector<uint8_t> decoded(vertices.size(), 0xcd);
+				CHECK(MeshoptDecoder::DecodeVertexBuffer(decoded.data(), count, vertexSize, encoded.data(), encoded.size()));
+				CHECK(decoded == vertices);
+				CHECK(!MeshoptDecoder::DecodeVertexBuffer(decoded.data(), count, vertexSize, encoded.data(), encoded.size() - 1));
+			}
+		}
+	}
+}
+
+static void CheckIndexCodecs(std::mt19937& random)
+{
+	std::vector<uint32_t> indices(3000);
+	for (uint32_t& index : indices)
+	{
+		index = random() % 70000;
+	}
+
+	const std::vector<uint8_t> sequence = EncodeIndexSequence(indices);
+	std::vector<uint32_t> decoded(indices.size());
+	CHECK(MeshoptDecoder::DecodeIndexSequence(decoded.data(), indices.size(), sizeof(uint32_t), sequence.data(), sequence.size()));
+	CHECK(decoded == indices);
+
+	const std::vector<uint8_t> triangles = EncodeIndexBuffer(indices);
+	std::fill(decoded.begin(), decoded.end(), 0);
+	CHECK(MeshoptDecoder::DecodeIndexBuffer(decoded.data(), indices.size(), sizeof(uint32_t), triangles.data(), triangles.size()));
+	CHECK(decoded == indices);
+	CHECK(!MeshoptDecoder::DecodeIndexBuffer(decoded.data(), indices.size(), sizeof(uint32_t), triangles.data(), triangles.size() / 2));
+
+	std::vector<uint32_t> smallIndices(300);
+	for (uint32_t& index : smallIndices)
+	{
+		index = random() % 60000;
+	}
+	const std::vector<uint8_t> smallTriangles = EncodeIndexBuffer(smallIndices);
+	std::vector<uint16_t> decoded16(smallIndices.size());
+	CHECK(MeshoptDecoder::DecodeIndexBuffer(decoded16.data(), smallIndices.size(), sizeof(uint16_t), smallTriangles.data(), smallTriangles.size()));
+	CHECK(std::equal(decoded16.begin(), decoded16.end(), smallIndices.begin()));
+}
+
+static void CheckFilterPaths(const std::vector<SimdLevel>& levels, std::mt19937& random)
+{
+	// Random input, every path has to produce the bytes of the scalar one
+	for (size_t count : { 1, 3, 4, 7, 8, 9, 31, 1001 })
+	{
+		std::vector<int8_t> octahedral8(count * 4);
+		std::vector<int16_t> octahedral16(count * 4);
+		std::vector<int16_t> quaternions(count * 4);
+		std::vector<uint32_t> exponentials(count * 3);
+		for (int8_t& value : octahedral8)
+		{
+			value = static_cast<int8_t>(random());
+		}
+		for (int16_t& value : octahedral16)
+		{
+			value = static_cast<int16_t>(random());
+		}
+		for (int16_t& value : quaternions)
+		{
+			value = static_cast<int16_t>(random());
+		}
+		for (uint32_t& value : exponentials)
+		{
+			value = random();
+		}
+
+		std::vector<std::vector<int8_t>> results8;
+		std::vector<std::vector<int16_t>> results16;
+		std::vector<std::vector<int16_t>> resultsQuaternion;
+		std::vector<std::vector<uint32_t>> resultsExponential;
+		for (SimdLevel level : levels)
+		{
+			MeshoptDecoder::SetSimdLevel(level);
+			results8.push_back(octahedral8);
+			results16.push_back(octahedral16);
+			resultsQuaternion.push_back(quaternions);
+			resultsExponential.push_back(exponentials);
+			MeshoptDecoder::DecodeFilterOctahedral(results8.back().data(), count, 4);
+			MeshoptDecoder::DecodeFilterOctahedral(results16.back().data(), count, 8);
+			MeshoptDecoder::DecodeFilterQuaternion(resultsQuaternion.back().data(), count, 8);
+			MeshoptDecoder::DecodeFilterExponential(resultsExponential.back().data(), count, 12);
+		}
+
+		for (size_t l = 1; l < levels.size(); ++l)
+		{
+			CHECK(results8[l] == results8[0]);
+			CHECK(results16[l] == results16[0]);
+			CHECK(resultsQuaternion[l] == resultsQuaternion[0]);
+			CHECK(resultsExponential[l] == resultsExponential[0]);
+		}
+	}
+}
+
+static void CheckFilterRoundTrips(const std::vector<SimdLevel>& levels, std::mt19937& random)
+{
+	const size_t count = 1000;
+
+	// Octahedral 16-bit normals, the fourth component passes through
+	std::vector<int16_t> octahedral(count * 4);
+	std::vector<glm::vec3> normals(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const float a = i * 0.37f;
+		const float b = i * 0.11f;
+		const glm::vec3 normal(std::cos(a) * std::sin(b), std::sin(a) * std::sin(b), std::cos(b));
+		normals[i] = normal;
+
+		const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		float u = normal.x / length;
+		float v = normal.y / length;
+		if (normal.z < 0.0f)
+		{
+			const float foldedU = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+			const float foldedV = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+			u = foldedU;
+			v = foldedV;
+		}
+		octahedral[i * 4 + 0] = static_cast<int16_t>(std::lround(u * 32767.0f));
+		octahedral[i * 4 + 1] = static_cast<int16_t>(std::lround(v * 32767.0f));
+		octahedral[i * 4 + 2] = 32767;
+		octahedral[i * 4 + 3] = 5;
+	}
+
+	// Quaternions store the three smallest components and the index of the largest one
+	std::vector<int16_t> quaternions(count * 4);
+	std::vector<glm::vec4> rotations(count);
+	std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+	for (size_t i = 0; i < count; ++i)
+	{
+		glm::vec4 rotation(component(random), component(random), component(random), component(random));
+		rotation = glm::normalize(rotation);
+		uint32_t largest = 0;
+		for (uint32_t k = 1; k < 4; ++k)
+		{
+			largest = std::abs(rotation[k]) > std::abs(rotation[largest]) ? k : largest;
+		}
+		rotation *= rotation[largest] < 0.0f ? -1.0f : 1.0f;
+		rotations[i] = rotation;
+
+		const int32_t scale = (2047 << 2) | 3;
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			quaternions[i * 4 + k] = static_cast<int16_t>(std::lround(rotation[(largest + 1 + k) & 3] * std::sqrt(2.0f) * scale));
+		}
+		quaternions[i * 4 + 3] = static_cast<int16_t>((2047 << 2) | largest);
+	}
+
+	// Exponentials are a signed 24-bit mantissa and an 8-bit exponent
+	const std::vector<float> values = { 1.0f, -2.5f, 1234.5678f, 0.001f, 0.0f, -1e6f };
+	std::vector<uint32_t> exponentials;
+	for (float value : values)
+	{
+		int exponent = 0;
+		std::frexp(value, &exponent);
+		const int shift = value == 0.0f ? 0 : exponent - 23;
+		const int mantissa = value == 0.0f ? 0 : static_cast<int>(std::lround(std::ldexp(value, -shift)));
+		exponentials.push_back((static_cast<uint32_t>(shift) << 24) | (static_cast<uint32_t>(mantissa) & 0xffffff));
+	}
+
+	for (SimdLevel level : levels)
+	{
+		MeshoptDecoder::SetSimdLevel(level);
+
+		std::vector<int16_t> decodedNormals = octahedral;
+		MeshoptDecoder::DecodeFilterOctahedral(decodedNormals.data(), count, 8);
+		float worstNormal = 1.0f;
+		bool passedThrough = true;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const glm::vec3 decoded(decodedNormals[i * 4], decodedNormals[i * 4 + 1], decodedNormals[i * 4 + 2]);
+			worstNormal = std::min(worstNormal, glm::dot(decoded / 32767.0f, normals[i]));
+			passedThrough = passedThrough && decodedNormals[i * 4 + 3] == 5;
+		}
+		CHECK(worstNormal > 0.9999f);
+		CHECK(passedThrough);
+
+		std::vector<int16_t> decodedQuaternions = quaternions;
+		MeshoptDecoder::DecodeFilterQuaternion(decodedQuaternions.data(), count, 8);
+		float worstRotation = 1.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const glm::vec4 decoded(decodedQuaternions[i * 4], decodedQuaternions[i * 4 + 1], decodedQuaternions[i * 4 + 2], decodedQuaternions[i * 4 + 3]);
+			worstRotation = std::min(worstRotation, glm::dot(decoded / 32767.0f, rotations[i]));
+		}
+		CHECK(worstRotation > 0.999f);
+
+		std::vector<uint32_t> decodedValues = exponentials;
+		MeshoptDecoder::DecodeFilterExponential(decodedValues.data(), decodedValues.size(), 4);
+		for (size_t i = 0; i < values.size(); ++i)
+		{
+			float decoded = 0.0f;
+			std::memcpy(&decoded, &decodedValues[i], sizeof(float));
+			CHECK(std::abs(decoded - values[i]) <= std::abs(values[i]) * 1e-6f);
+		}
+	}
+}
+
+void CheckMeshoptDecoder()
+{
+	const std::vector<SimdLevel> levels = GetSupportedSimdLevels();
+	const SimdLevel initialLevel = MeshoptDecoder::GetSimdLevel();
+	std::mt19937 random(1);
+
+	CheckVertexCodec(levels, random);
+	CheckIndexCodecs(random);
+	CheckFilterPaths(levels, random);
+	CheckFilterRoundTrips(levels, random);
+
+	// Throughput on a 16 byte vertex with slowly changing bytes, as quantized attributes have
+	const size_t count = 1 << 20;
+	const size_t vertexSize = 16;
+	std::vector<uint8_t> vertices(count * vertexSize);
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (size_t k = 0; k < vertexSize; ++k)
+		{
+			vertices[i * vertexSize + k] = static_cast<uint8_t>(i * (k + 1) / 5);
+		}
+	}
+	const std::vector<uint8_t> encoded = EncodeVertexBuffer(vertices.data(), count, vertexSize);
+	std::vector<uint8_t> decoded(vertices.size());
+	std::vector<int16_t> octahedral(count * 4);
+	for (int16_t& value : octahedral)
+	{
+		value = static_cast<int16_t>(random());
+	}
+
+	for (SimdLevel level : levels)
+	{
+		MeshoptDecoder::SetSimdLevel(level);
+		const double vertexSeconds = MeasureSeconds([&] { MeshoptDecoder::DecodeVertexBuffer(decoded.data(), count, vertexSize, encoded.data(), encoded.size()); });
+		const double filterSeconds = MeasureSeconds([&] { MeshoptDecoder::DecodeFilterOctahedral(octahedral.data(), count, 8); });
+		std::cout << "  " << GetSimdLevelName(level) << ": vertex codec " << vertices.size() / vertexSeconds * 1e-9 << " GB/s, octahedral filter "
+			<< count * 8 / filterSeconds * 1e-9 << " GB/s" << std::endl;
+	}
+	std::cout << "  compression ratio " << double(encoded.size()) / vertices.size() << std::endl;
+
+	MeshoptDecoder::SetSimdLevel(initialLevel);
+}
@@ -0,0 +1,158 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "Framework/JobSystem.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+static double MeasureLoad(const std::string& path, const GltfImportSettings& settings, uint32_t threadCount, Scene*& scene)
+{
+	JobSystem::Initialized(threadCount);
+	return MeasureSeconds([&]
+		{
+			WL_DELETE(scene);
+			scene = GltfReader::LoadSource(path.c_str(), settings);
+		}, 3);
+}
+
+/**
+ * @brief Copy of a .gltf file with one accessor changed, corrupt edits the JSON of the accessor
+ */
+template<typename Edit>
+static std::string WriteCorruptGltf(const std::string& path, const std::string& name, Edit&& corrupt)
+{
+	const std::vector<uint8_t> text = FileSystem::LoadFile(path);
+	nlohmann::json document = nlohmann::json::parse(text.begin(), text.end());
+	corrupt(document);
+
+	const std::string corruptPath = path.substr(0, path.find_last_of("/\\") + 1) + name;
+	const std::string corruptText = document.dump();
+	CHECK(FileSystem::WriteFile(corruptPath, corruptText.data(), corruptText.size()));
+	return corruptPath;
+}
+
+/**
+ * @brief Loads a malformed file on every thread, the load fails and nothing it built stays behind
+ */
+static void CheckMalformedLoad(const std::string& path, const GltfImportSettings& settings)
+{
+	const uint32_t meshCount = MeshRegistry::GetInstance().GetCount();
+	const uint32_t nodeCount = GameObject::GetCount();
+
+	Scene* scene = nullptr;
+	bool threw = false;
+	try
+	{
+		scene = GltfReader::LoadSource(path.c_str(), settings);
+	}
+	catch (const std::exception&)
+	{
+		threw = true;
+	}
+	CHECK(threw || scene == nullptr);
+	WL_DELETE(scene);
+	CHECK(MeshRegistry::GetInstance().GetCount() == meshCount);
+	CHECK(GameObject::GetCount() == nodeCount);
+}
+
+void CheckParallelLoad()
+{
+	// Many meshes of different vertex orders, so the primitives spread over the workers
+	const uint32_t meshCount = 48;
+	std::vector<SubMesh> sources;
+	for (uint32_t i = 0; i < meshCount; ++i)
+	{
+		sources.push_back(MakeGridSubMesh(64, 64, i + 1));
+	}
+	std::vector<const SubMesh*> sourcePointers;
+	for (const SubMesh& source : sources)
+	{
+		sourcePointers.push_back(&source);
+	}
+
+	const std::string path = MakeCheckDirectory("parallel_load") + "/grids.glb";
+	CHECK(WriteGltf(path, sourcePointers));
+
+	// Every mesh pass runs per primitive on the pool
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+	settings.useCookedScene = false;
+
+	const uint32_t threadCount = JobSystem::GetInstance().GetThreadCount();
+	Scene* serial = nullptr;
+	Scene* parallel = nullptr;
+	const double serialSeconds = MeasureLoad(path, settings, 1, serial);
+	const double parallelSeconds = MeasureLoad(path, settings, threadCount, parallel);
+
+	// The scene does not depend on the thread count
+	CHECK(serial && parallel);
+	if (serial && parallel)
+	{
+		CHECK(serial->GetMeshes().size() == meshCount);
+		CHECK(parallel->GetMeshes().size() == serial->GetMeshes().size());
+		for (size_t m = 0; m < serial->GetMeshes().size() && m < parallel->GetMeshes().size(); ++m)
+		{
+			const Mesh* serialMesh = MeshRegistry::GetInstance().Get(serial->GetMeshes()[m]);
+			const Mesh* parallelMesh = MeshRegistry::GetInstance().Get(parallel->GetMeshes()[m]);
+			CHECK(serialMesh && parallelMesh && serialMesh->GetSubmeshes().size() == parallelMesh->GetSubmeshes().size());
+			if (!serialMesh || !parallelMesh || serialMesh->GetSubmeshes().size() != parallelMesh->GetSubmeshes().size())
+			{
+				continue;
+			}
+
+			for (size_t s = 0; s < serialMesh->GetSubmeshes().size(); ++s)
+			{
+				const SubMesh& a = serialMesh->GetSubmeshes()[s];
+				const SubMesh& b = parallelMesh->GetSubmeshes()[s];
+				std::vector<glm::vec3> positionsA;
+				std::vector<glm::vec3> positionsB;
+				CHECK(MeshUtils::ReadPositions(a, positionsA) && MeshUtils::ReadPositions(b, positionsB));
+				CHECK(positionsA == positionsB);
+				CHECK(MeshUtils::ReadIndices(a) == MeshUtils::ReadIndices(b));
+				CHECK(a.meshlets.GetCount() == b.meshlets.GetCount());
+				CHECK(a.lods.size() == b.lods.size());
+			}
+		}
+	}
+
+	// Malformed primitives throw on the workers, the load reports them on the calling thread once every batch is done
+	const std::string gltfPath = MakeCheckDirectory("parallel_load_malformed") + "/grids.gltf";
+	CHECK(WriteGltf(gltfPath, sourcePointers));
+	const std::string pastBuffer = WriteCorruptGltf(gltfPath, "past_buffer.gltf", [&](nlohmann::json& document)
+		{
+			const uint32_t accessor = document["meshes"][meshCount / 2]["primitives"][0]["attributes"]["POSITION"];
+			document["accessors"][accessor]["count"] = document["accessors"][accessor]["count"].get<uint32_t>() * 1000;
+		});
+	const std::string missingAccessor = WriteCorruptGltf(gltfPath, "missing_accessor.gltf", [&](nlohmann::json& document)
+		{
+			document["meshes"][meshCount - 1]["primitives"][0]["indices"] = document["accessors"].size() + 100;
+		});
+	CHECK(threadCount > 1);
+	for (const std::string& malformed : { pastBuffer, missingAccessor })
+	{
+		CheckMalformedLoad(malformed, settings);
+	}
+
+	// In a batch only the malformed file fails
+	const std::vector<Scene*> batch = GltfReader::LoadFiles({ gltfPath, pastBuffer, missingAccessor }, settings);
+	CHECK(batch.size() == 3 && batch[0] != nullptr && batch[1] == nullptr && batch[2] == nullptr);
+	for (Scene* scene : batch)
+	{
+		WL_DELETE(scene);
+	}
+
+	std::cout << "  " << meshCount << " meshes: 1 thread " << serialSeconds * 1e3 << " ms, " << threadCount << " threads " << parallelSeconds * 1e3
+		<< " ms (" << serialSeconds / parallelSeconds << "x)" << std::endl;
+
+	WL_DELETE(serial);
+	WL_DELETE(parallel);
+}
@@ -0,0 +1,222 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <vector>
+
+#include <json.hpp>
+
+#include "Apps/BaseInclude.h"
+#include "Apps/FileSystem.h"
+#include "Geometry/MeshUtils.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/MeshRegistry.h"
+#include "Scene/Scene.h"
+
+static const float kPositionScale = 1000.0f;
+
+/**
+ * @brief Quantized copy of a grid as the vertex input stage would fetch it
+ */
+struct QuantizedGrid
+{
+	std::vector<int16_t> positions; /* xyz and padding, SHORT */
+	std::vector<int8_t> normals;    /* xyz and padding, normalized BYTE */
+	std::vector<uint16_t> texcoords; /* normalized UNSIGNED_SHORT */
+	std::vector<uint16_t> indices;
+};
+
+/**
+ * @brief Writes a KHR_mesh_quantization .gltf of the grid, positions scaled by kPositionScale and undone by the node scale
+ */
+static bool WriteQuantizedGltf(const std::string& path, const SubMesh& subMesh, QuantizedGrid& grid)
+{
+	std::vector<glm::vec3> positions;
+	if (!MeshUtils::ReadPositions(subMesh, positions))
+	{
+		return false;
+	}
+
+	const AccessorView& normals = subMesh.vertexBuffers.at("normal");
+	const AccessorView& texcoords = subMesh.vertexBuffers.at("texcoord_0");
+	glm::vec3 minimum(32767.0f);
+	glm::vec3 maximum(-32768.0f);
+	for (uint32_t v = 0; v < subMesh.vertexCount; ++v)
+	{
+		const glm::vec4 normal = MeshUtils::DecodeElement(normals.format, normals.At(v));
+		const glm::vec4 texcoord = MeshUtils::DecodeElement(texcoords.format, texcoords.At(v));
+		for (int c = 0; c < 3; ++c)
+		{
+			const int16_t position = static_cast<int16_t>(std::lround(positions[v][c] * kPositionScale));
+			grid.positions.push_back(position);
+			grid.normals.push_back(static_cast<int8_t>(std::lround(normal[c] * 127.0f)));
+			minimum[c] = std::min(minimum[c], static_cast<float>(position));
+			maximum[c] = std::max(maximum[c], static_cast<float>(position));
+		}
+		grid.positions.push_back(0);
+		grid.normals.push_back(0);
+		grid.texcoords.push_back(static_cast<uint16_t>(std::lround(texcoord.x * 65535.0f)));
+		grid.texcoords.push_back(static_cast<uint16_t>(std::lround(texcoord.y * 65535.0f)));
+	}
+	for (uint32_t index : MeshUtils::ReadIndices(subMesh))
+	{
+		grid.indices.push_back(static_cast<uint16_t>(index));
+	}
+
+	// Vertex attributes keep the 4 byte element alignment the extension requires, hence the padding
+	std::vector<uint8_t> bin;
+	nlohmann::json bufferViews = nlohmann::json::array();
+	auto addData = [&](const void* data, size_t size, uint32_t stride, uint32_t target)
+	{
+		nlohmann::json bufferView = { { "buffer", 0 }, { "byteOffset", bin.size() }, { "byteLength", size }, { "target", target } };
+		if (stride != 0)
+		{
+			bufferView["byteStride"] = stride;
+		}
+		bufferViews.push_back(bufferView);
+		bin.resize(bin.size() + ((size + 3) & ~size_t(3)), 0);
+		std::memcpy(bin.data() + bin.size() - ((size + 3) & ~size_t(3)), data, size);
+		return bufferViews.size() - 1;
+	};
+
+	const uint32_t count = subMesh.vertexCount;
+	nlohmann::json accessors = nlohmann::json::array();
+	accessors.push_back({ { "bufferView", addData(grid.positions.data(), grid.positions.size() * sizeof(int16_t), 8, 34962) }, { "componentType", 5122 },
+		{ "count", count }, { "type", "VEC3" }, { "min", { minimum.x, minimum.y, minimum.z } }, { "max", { maximum.x, maximum.y, maximum.z } } });
+	accessors.push_back({ { "bufferView", addData(grid.normals.data(), grid.normals.size(), 4, 34962) }, { "componentType", 5120 },
+		{ "normalized", true }, { "count", count }, { "type", "VEC3" } });
+	accessors.push_back({ { "bufferView", addData(grid.texcoords.data(), grid.texcoords.size() * sizeof(uint16_t), 4, 34962) }, { "componentType", 5123 },
+		{ "normalized", true }, { "count", count }, { "type", "VEC2" } });
+	accessors.push_back({ { "bufferView", addData(grid.indices.data(), grid.indices.size() * sizeof(uint16_t), 0, 34963) }, { "componentType", 5123 },
+		{ "count", grid.indices.size() }, { "type", "SCALAR" } });
+
+	const std::string binName = path.substr(path.find_last_of("/\\") + 1) + ".bin";
+	const float nodeScale = 1.0f / kPositionScale;
+	nlohmann::json document = {
+		{ "asset", { { "version", "2.0" } } },
+		{ "extensionsUsed", { "KHR_mesh_quantization" } },
+		{ "extensionsRequired", { "KHR_mesh_quantization" } },
+		{ "buffers", { { { "uri", binName }, { "byteLength", bin.size() } } } },
+		{ "bufferViews", bufferViews },
+		{ "accessors", accessors },
+		{ "meshes", { { { "primitives", { { { "attributes", { { "POSITION", 0 }, { "NORMAL", 1 }, { "TEXCOORD_0", 2 } } }, { "indices", 3 } } } } } } },
+		{ "nodes", { { { "name", "grid" }, { "mesh", 0 }, { "scale", { nodeScale, nodeScale, nodeScale } } } } },
+		{ "scenes", { { { "nodes", { 0 } } } } },
+		{ "scene", 0 } };
+
+	const std::string text = document.dump();
+	return FileSystem::WriteFile(path.substr(0, path.find_last_of("/\\") + 1) + binName, bin.data(), bin.size())
+		&& FileSystem::WriteFile(path, text.data(), text.size());
+}
+
+static size_t GetVertexBytes(const SubMesh& subMesh)
+{
+	return subMesh.layout.positionStream.ByteSize() + subMesh.layout.attributeStream.ByteSize();
+}
+
+void CheckQuantizedGltf()
+{
+	const SubMesh source = MakeGridSubMesh(64, 64);
+	const std::string directory = MakeCheckDirectory("quantized_gltf");
+	const std::string path = directory + "/quantized.gltf";
+	const std::string floatPath = directory + "/float.gltf";
+	QuantizedGrid grid;
+	CHECK(WriteQuantizedGltf(path, source, grid));
+	CHECK(WriteGltf(floatPath, { &source }));
+
+	// Every mesh pass runs, none of them may bring the attributes back to float
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+	settings.useCookedScene = false;
+	settings.quantizeVertices = true;
+	Scene* scene = GltfReader::LoadSource(path.c_str(), settings);
+	Scene* floatScene = GltfReader::LoadSource(floatPath.c_str(), GltfImportSettings());
+	CHECK(scene && scene->GetMeshes().size() == 1);
+	CHECK(floatScene && floatScene->GetMeshes().size() == 1);
+
+	const Mesh* mesh = scene && scene->GetMeshes().size() == 1 ? MeshRegistry::GetInstance().Get(scene->GetMeshes()[0]) : nullptr;
+	const Mesh* floatMesh = floatScene && floatScene->GetMeshes().size() == 1 ? MeshRegistry::GetInstance().Get(floatScene->GetMeshes()[0]) : nullptr;
+	CHECK(mesh && mesh->GetSubmeshes().size() == 1 && floatMesh && floatMesh->GetSubmeshes().size() == 1);
+	if (!mesh || mesh->GetSubmeshes().size() != 1 || !floatMesh || floatMesh->GetSubmeshes().size() != 1)
+	{
+		WL_DELETE(scene);
+		WL_DELETE(floatScene);
+		return;
+	}
+
+	const SubMesh& subMesh = mesh->GetSubmeshes()[0];
+	const SubMesh& floatSubMesh = floatMesh->GetSubmeshes()[0];
+
+	// The stored integers are fetched as they are, 3 component formats widened into the padding
+	const AccessorView& positions = subMesh.vertexBuffers.at("position");
+	const AccessorView& normals = subMesh.vertexBuffers.at("normal");
+	const AccessorView& texcoords = subMesh.vertexBuffers.at("texcoord_0");
+	CHECK(positions.format == VK_FORMAT_R16G16B16A16_SSCALED);
+	CHECK(normals.format == VK_FORMAT_R8G8B8A8_SNORM);
+	CHECK(texcoords.format == VK_FORMAT_R16G16_UNORM);
+	CHECK(subMesh.layout.positionStream.format == VK_FORMAT_R16G16B16A16_SSCALED);
+	CHECK(subMesh.vertexCount == source.vertexCount && subMesh.octahedralMask == 0);
+
+	// The passes reorder vertices and triangles, grid positions are unique so they find the vertex of the file again
+	std::map<std::array<int16_t, 3>, uint32_t> fileVertices;
+	for (uint32_t v = 0; v < source.vertexCount; ++v)
+	{
+		fileVertices[{ grid.positions[v * 4], grid.positions[v * 4 + 1], grid.positions[v * 4 + 2] }] = v;
+	}
+
+	std::vector<uint32_t> fileVertex(subMesh.vertexCount, ~0u);
+	bool sameVertices = true;
+	for (uint32_t v = 0; sameVertices && v < subMesh.vertexCount; ++v)
+	{
+		const glm::vec4 position = MeshUtils::DecodeElement(positions.format, positions.At(v));
+		const glm::vec4 normal = MeshUtils::DecodeElement(normals.format, normals.At(v));
+		const glm::vec4 texcoord = MeshUtils::DecodeElement(texcoords.format, texcoords.At(v));
+		auto it = fileVertices.find({ static_cast<int16_t>(position.x), static_cast<int16_t>(position.y), static_cast<int16_t>(position.z) });
+		sameVertices = it != fileVertices.end() && position.w == 0.0f;
+		if (sameVertices)
+		{
+			const uint32_t file = fileVertex[v] = it->second;
+			sameVertices = std::lround(normal.x * 127.0f) == grid.normals[file * 4] && std::lround(normal.y * 127.0f) == grid.normals[file * 4 + 1]
+				&& std::lround(normal.z * 127.0f) == grid.normals[file * 4 + 2]
+				&& std::lround(texcoord.x * 65535.0f) == grid.texcoords[file * 2] && std::lround(texcoord.y * 65535.0f) == grid.texcoords[file * 2 + 1];
+		}
+	}
+	CHECK(sameVertices);
+
+	// Same triangles with the same winding, each rotated to start at its smallest file vertex
+	auto getTriangles = [](const std::vector<uint32_t>& triangleIndices, const std::vector<uint32_t>& toFile)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i + 2 < triangleIndices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> triangle;
+			for (size_t c = 0; c < 3; ++c)
+			{
+				triangle[c] = triangleIndices[i + c] < toFile.size() ? toFile[triangleIndices[i + c]] : ~0u;
+			}
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	};
+	std::vector<uint32_t> identity(source.vertexCount);
+	std::iota(identity.begin(), identity.end(), 0u);
+	const std::vector<uint32_t> fileIndices(grid.indices.begin(), grid.indices.end());
+	CHECK(sameVertices && getTriangles(MeshUtils::ReadIndices(subMesh), fileVertex) == getTriangles(fileIndices, identity));
+
+	// 8 + 4 + 4 bytes instead of 12 + 12 + 8 per vertex
+	const size_t bytes = GetVertexBytes(subMesh);
+	const size_t floatBytes = GetVertexBytes(floatSubMesh);
+	CHECK(bytes * 2 <= floatBytes);
+
+	std::cout << "  " << subMesh.vertexCount << " vertices: " << bytes << " bytes quantized, " << floatBytes << " bytes float" << std::endl;
+
+	WL_DELETE(scene);
+	WL_DELETE(floatScene);
+}
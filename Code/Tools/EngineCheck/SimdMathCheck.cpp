@@ -0,0 +1,197 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Math/SimdMath.h"
+
+/**
+ * @brief Element wise equality of two float arrays, so that -0 and 0 compare equal
+ */
+template<typename T>
+static bool IsSame(const std::vector<T>& a, const std::vector<T>& b)
+{
+	const float* x = reinterpret_cast<const float*>(a.data());
+	const float* y = reinterpret_cast<const float*>(b.data());
+	return a.size() == b.size() && std::equal(x, x + a.size() * sizeof(T) / sizeof(float), y);
+}
+
+static Aabb TransformAabb(const Affine3x4& transform, const Aabb& box)
+{
+	const glm::mat4 matrix = transform.ToMat4();
+	Aabb out{ glm::vec3(INFINITY), glm::vec3(-INFINITY) };
+	for (int k = 0; k < 8; ++k)
+	{
+		const glm::vec3 corner(k & 1 ? box.max.x : box.min.x, k & 2 ? box.max.y : box.min.y, k & 4 ? box.max.z : box.min.z);
+		const glm::vec3 world(matrix * glm::vec4(corner, 1.0f));
+		out.min = glm::min(out.min, world);
+		out.max = glm::max(out.max, world);
+	}
+	return out;
+}
+
+void CheckSimdMath()
+{
+	// An odd count, so every path also runs its remainder
+	const size_t count = 100003;
+	std::mt19937 random(7);
+	auto uniform = [&](float low, float high) { return std::uniform_real_distribution<float>(low, high)(random); };
+
+	std::vector<glm::vec3> translations(count);
+	std::vector<glm::vec3> scales(count);
+	std::vector<glm::quat> rotations(count);
+	std::vector<glm::quat> targets(count);
+	std::vector<glm::quat> unnormalized(count);
+	std::vector<float> weights(count);
+	std::vector<Aabb> boxes(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		translations[i] = glm::vec3(uniform(-100.0f, 100.0f), uniform(-100.0f, 100.0f), uniform(-100.0f, 100.0f));
+		scales[i] = glm::vec3(uniform(0.1f, 3.0f), uniform(0.1f, 3.0f), uniform(0.1f, 3.0f));
+		rotations[i] = glm::normalize(glm::quat(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f)));
+		targets[i] = glm::normalize(glm::quat(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f)));
+		unnormalized[i] = glm::quat(uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f));
+		weights[i] = uniform(0.0f, 1.0f);
+		const glm::vec3 a(uniform(-5.0f, 5.0f), uniform(-5.0f, 5.0f), uniform(-5.0f, 5.0f));
+		const glm::vec3 b(uniform(-5.0f, 5.0f), uniform(-5.0f, 5.0f), uniform(-5.0f, 5.0f));
+		boxes[i] = { glm::min(a, b), glm::max(a, b) };
+	}
+	// Equal, opposite and nearly equal rotations take the other slerp branches, zero quaternions normalize to the identity
+	targets[5] = rotations[5];
+	targets[6] = -rotations[6];
+	targets[7] = glm::normalize(glm::quat(rotations[7].w + 1e-4f, rotations[7].x, rotations[7].y, rotations[7].z));
+	unnormalized[3] = glm::quat(0.0f, 0.0f, 0.0f, 0.0f);
+
+	std::vector<Affine3x4> composed(count);
+	std::vector<Affine3x4> others(count);
+	std::vector<Affine3x4> products(count);
+	std::vector<glm::quat> normalized(count);
+	std::vector<glm::quat> slerped(count);
+	std::vector<Aabb> bounds(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		const glm::mat4 matrix = glm::scale(glm::translate(glm::mat4(1.0f), translations[i]) * glm::mat4_cast(rotations[i]), scales[i]);
+		const glm::mat4 other = glm::scale(glm::translate(glm::mat4(1.0f), scales[i]) * glm::mat4_cast(targets[i]), translations[i] * 0.01f);
+		composed[i] = Affine3x4::FromMat4(matrix);
+		others[i] = Affine3x4::FromMat4(other);
+		products[i] = Affine3x4::FromMat4(matrix * other);
+		normalized[i] = glm::normalize(unnormalized[i]);
+		slerped[i] = glm::slerp(rotations[i], targets[i], weights[i]);
+		bounds[i] = TransformAabb(composed[i], boxes[i]);
+	}
+
+	// Compose, multiply and normalize give the bits of glm on every path, slerp and the boxes come within a few ulp
+	// and are the same on every path
+	const SimdLevel initialLevel = SimdMath::GetSimdLevel();
+	const std::vector<SimdLevel> levels = GetSupportedSimdLevels();
+	std::vector<glm::quat> scalarSlerped;
+	std::vector<Aabb> scalarBounds;
+	std::vector<Affine3x4> affines(count);
+	std::vector<glm::quat> quaternions(count);
+	std::vector<Aabb> boxesOut(count);
+	for (SimdLevel level : levels)
+	{
+		SimdMath::SetSimdLevel(level);
+		SimdMath::ComposeAffine(translations.data(), rotations.data(), scales.data(), affines.data(), count);
+		CHECK(IsSame(affines, composed));
+		SimdMath::MultiplyAffine(composed.data(), others.data(), affines.data(), count);
+		CHECK(IsSame(affines, products));
+		affines = others;
+		SimdMath::MultiplyAffine(composed.data(), affines.data(), affines.data(), count);
+		CHECK(IsSame(affines, products));
+		quaternions = unnormalized;
+		SimdMath::NormalizeQuaternions(quaternions.data(), count);
+		CHECK(IsSame(quaternions, normalized));
+
+		SimdMath::SlerpQuaternions(rotations.data(), targets.data(), weights.data(), quaternions.data(), count);
+		float slerpError = 0.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			// The two signs of a quaternion are the same rotation
+			const float d = glm::dot(quaternions[i], slerped[i]) < 0.0f ? -1.0f : 1.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				slerpError = std::max(slerpError, std::abs(d * quaternions[i][k] - slerped[i][k]));
+			}
+		}
+		CHECK(slerpError <= 1e-5f);
+
+		SimdMath::TransformAabbs(composed.data(), boxes.data(), boxesOut.data(), count);
+		float boxError = 0.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				boxError = std::max({ boxError, std::abs(boxesOut[i].min[k] - bounds[i].min[k]) / (1.0f + std::abs(bounds[i].min[k])),
+					std::abs(boxesOut[i].max[k] - bounds[i].max[k]) / (1.0f + std::abs(bounds[i].max[k])) });
+			}
+		}
+		CHECK(boxError <= 1e-5f);
+		std::vector<Aabb> inPlace = boxes;
+		SimdMath::TransformAabbs(composed.data(), inPlace.data(), inPlace.data(), count);
+		CHECK(IsSame(inPlace, boxesOut));
+
+		if (level == SimdLevel::Scalar)
+		{
+			scalarSlerped = quaternions;
+			scalarBounds = boxesOut;
+		}
+		CHECK(IsSame(quaternions, scalarSlerped) && IsSame(boxesOut, scalarBounds));
+		std::cout << "  " << GetSimdLevelName(level) << ": largest slerp error " << slerpError << ", largest relative box error " << boxError << std::endl;
+	}
+
+	std::vector<glm::mat4> matrices(count);
+	std::vector<glm::mat4> left(count);
+	std::vector<glm::mat4> right(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		left[i] = composed[i].ToMat4();
+		right[i] = others[i].ToMat4();
+	}
+	const double glmCompose = MeasureSeconds([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				matrices[i] = glm::scale(glm::translate(glm::mat4(1.0f), translations[i]) * glm::mat4_cast(rotations[i]), scales[i]);
+			}
+		});
+	const double glmMultiply = MeasureSeconds([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				matrices[i] = left[i] * right[i];
+			}
+		});
+	const double glmSlerp = MeasureSeconds([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				quaternions[i] = glm::slerp(rotations[i], targets[i], weights[i]);
+			}
+		});
+	const double glmBoxes = MeasureSeconds([&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				boxesOut[i] = TransformAabb(composed[i], boxes[i]);
+			}
+		});
+	std::cout << "  glm: compose " << glmCompose / count * 1e9 << ", multiply " << glmMultiply / count * 1e9 << ", slerp " << glmSlerp / count * 1e9
+		<< ", box " << glmBoxes / count * 1e9 << " ns per element" << std::endl;
+
+	for (SimdLevel level : levels)
+	{
+		SimdMath::SetSimdLevel(level);
+		const double compose = MeasureSeconds([&] { SimdMath::ComposeAffine(translations.data(), rotations.data(), scales.data(), affines.data(), count); });
+		const double multiply = MeasureSeconds([&] { SimdMath::MultiplyAffine(composed.data(), others.data(), affines.data(), count); });
+		const double slerp = MeasureSeconds([&] { SimdMath::SlerpQuaternions(rotations.data(), targets.data(), weights.data(), quaternions.data(), count); });
+		const double box = MeasureSeconds([&] { SimdMath::TransformAabbs(composed.data(), boxes.data(), boxesOut.data(), count); });
+		std::cout << "  " << GetSimdLevelName(level) << ": compose " << compose / count * 1e9 << ", multiply " << multiply / count * 1e9 << ", slerp "
+			<< slerp / count * 1e9 << ", box " << box / count * 1e9 << " ns per element" << std::endl;
+	}
+
+	SimdMath::SetSimdLevel(initialLevel);
+}
@@ -0,0 +1,111 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Apps/BaseInclude.h"
+#include "Framework/JobSystem.h"
+#include "ModelReader/GltfReader.h"
+#include "Scene/GameObject.h"
+#include "Scene/GameObjectUntil.h"
+#include "Scene/Scene.h"
+#include "Scene/Transform.h"
+#include "Scene/TransformHierarchy.h"
+
+void CheckStreamingLoad()
+{
+	if (JobSystem::GetInstance().GetThreadCount() < 2)
+	{
+		std::cout << "  skipped, streaming needs worker threads" << std::endl;
+		return;
+	}
+
+	// Meshes heavy enough that every one takes far longer than a frame
+	const uint32_t meshCount = 32;
+	std::vector<SubMesh> sources;
+	std::vector<const SubMesh*> sourcePointers;
+	for (uint32_t i = 0; i < meshCount; ++i)
+	{
+		sources.push_back(MakeGridSubMesh(128, 128, i + 1));
+	}
+	for (const SubMesh& source : sources)
+	{
+		sourcePointers.push_back(&source);
+	}
+	const std::string directory = MakeCheckDirectory("streaming_load");
+	const std::string path = directory + "/grids.glb";
+	const std::string singlePath = directory + "/grid.glb";
+	CHECK(WriteGltf(path, sourcePointers));
+	CHECK(WriteGltf(singlePath, { sourcePointers[0] }));
+
+	GltfImportSettings settings = GltfImportSettings::ForCooking();
+	settings.useCookedScene = false;
+
+	const double meshSeconds = MeasureSeconds([&]
+		{
+			Scene* scene = GltfReader::LoadSource(singlePath.c_str(), settings);
+			WL_DELETE(scene);
+		}, 3);
+
+	// A level already in the world, large enough that every frame's hierarchy update runs a ParallelFor
+	std::vector<GameObjectHandle> nodes;
+	std::vector<Transform*> level;
+	for (uint32_t i = 0; i < 20000; ++i)
+	{
+		GameObject* go = CreateGameObject("level");
+		nodes.push_back(go->GetHandle());
+		level.push_back(go->AddComponent<Transform>());
+		level.back()->SetParent(i >= 8 ? level[(i - 8) / 4] : nullptr);
+	}
+	TransformHierarchy::GetInstance().Update();
+
+	// The player loop: main thread jobs, then the hierarchy, until the load is done
+	uint32_t nodesReady = 0;
+	bool hierarchyReady = false;
+	GltfStreamSettings stream;
+	stream.onHierarchyReady = [&](GltfAsyncLoad&) { hierarchyReady = true; };
+	stream.onNodeReady = [&](GltfAsyncLoad&, GameObject*) { nodesReady++; };
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	GltfLoadHandle load = GltfReader::LoadFileAsync(path.c_str(), settings, stream);
+	const double requestSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	uint32_t streamingFrames = 0;
+	double longestFrame = 0.0;
+	while (!load->IsDone())
+	{
+		const auto frameStart = std::chrono::high_resolution_clock::now();
+		JobSystem::GetInstance().RunMainThreadJobs();
+		level[streamingFrames % 8]->SetTranslation(glm::vec3(static_cast<float>(streamingFrames), 0.0f, 0.0f));
+		TransformHierarchy::GetInstance().Update();
+		longestFrame = std::max(longestFrame, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - frameStart).count());
+
+		if (load->GetState() == GltfLoadState::Hierarchy)
+		{
+			streamingFrames++;
+		}
+	}
+
+	// Frames kept running while the meshes streamed in, none of them waited for a mesh
+	CHECK(load->GetState() == GltfLoadState::Complete);
+	CHECK(hierarchyReady && nodesReady == meshCount);
+	CHECK(requestSeconds < meshSeconds);
+	CHECK(streamingFrames > 1);
+	CHECK(longestFrame < meshSeconds / 2);
+	CHECK(load->GetTimeToHierarchy() >= 0.0 && load->GetTimeToHierarchy() <= load->GetTimeToFirstVisibleNode());
+	CHECK(load->GetTimeToFirstVisibleNode() >= 0.0 && load->GetTimeToFirstVisibleNode() < load->GetTimeToComplete());
+
+	std::cout << "  " << meshCount << " meshes of " << meshSeconds * 1e3 << " ms: hierarchy " << load->GetTimeToHierarchy() * 1e3 << " ms, first visible node "
+		<< load->GetTimeToFirstVisibleNode() * 1e3 << " ms, complete " << load->GetTimeToComplete() * 1e3 << " ms, " << streamingFrames
+		<< " frames while streaming, longest " << longestFrame * 1e3 << " ms" << std::endl;
+
+	Scene* scene = load->GetScene();
+	WL_DELETE(scene);
+	for (GameObjectHandle node : nodes)
+	{
+		GameObject::Destroy(node);
+	}
+}
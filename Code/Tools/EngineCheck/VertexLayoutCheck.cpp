@@ -0,0 +1,132 @@
+#include "EngineCheck.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "Render/VertexLayout.h"
+#include "Scene/Mesh.h"
+
+/**
+ * @brief View of count random elements of format, stride leaves padding after each element when it is larger than the format
+ */
+static AccessorView MakeRandomView(uint32_t count, VkFormat format, uint32_t stride, std::mt19937& random)
+{
+	std::vector<uint8_t> data(static_cast<size_t>(count) * stride);
+	for (uint8_t& byte : data)
+	{
+		byte = static_cast<uint8_t>(random());
+	}
+	return AccessorView::FromData(std::move(data), stride, count, format);
+}
+
+static const VkVertexInputAttributeDescription* FindAttribute(const VertexLayout& layout, uint32_t location)
+{
+	for (const VkVertexInputAttributeDescription& attribute : layout.attributes)
+	{
+		if (attribute.location == location)
+		{
+			return &attribute;
+		}
+	}
+	return nullptr;
+}
+
+void CheckVertexLayout()
+{
+	const uint32_t vertexCount = 1000;
+	std::mt19937 random(7);
+
+	// Strided positions, known semantics, semantics the enum does not name and one view nothing can fetch
+	SubMesh subMesh;
+	subMesh.vertexCount = vertexCount;
+	subMesh.vertexBuffers["position"] = MakeRandomView(vertexCount, VK_FORMAT_R32G32B32_SFLOAT, 20, random);
+	subMesh.vertexBuffers["normal"] = MakeRandomView(vertexCount, VK_FORMAT_R16G16_SNORM, 4, random);
+	subMesh.vertexBuffers["texcoord_0"] = MakeRandomView(vertexCount, VK_FORMAT_R32G32_SFLOAT, 8, random);
+	subMesh.vertexBuffers["color_0"] = MakeRandomView(vertexCount, VK_FORMAT_R16G16B16A16_UNORM, 8, random);
+	subMesh.vertexBuffers["texcoord_2"] = MakeRandomView(vertexCount, VK_FORMAT_R16G16_UNORM, 12, random);
+	subMesh.vertexBuffers["color_1"] = MakeRandomView(vertexCount, VK_FORMAT_R8G8B8A8_UNORM, 6, random);
+	subMesh.vertexBuffers["_custom"] = MakeRandomView(vertexCount, VK_FORMAT_R32_SFLOAT, 4, random);
+	subMesh.vertexBuffers["bogus"] = MakeRandomView(vertexCount, VK_FORMAT_UNDEFINED, 4, random);
+
+	std::map<std::string, std::vector<uint8_t>> expected;
+	for (const auto& vertexBuffer : subMesh.vertexBuffers)
+	{
+		if (vertexBuffer.second.format != VK_FORMAT_UNDEFINED)
+		{
+			expected[vertexBuffer.first] = vertexBuffer.second.CopyPacked();
+		}
+	}
+
+	const VertexLayout layout = VertexLayoutBuilder::Build(subMesh);
+
+	// Unknown semantics stay in the interleaved stream after the known ones, the unusable view is reported
+	CHECK(layout.extraAttributes == std::vector<std::string>({ "_custom", "color_1", "texcoord_2" }));
+	CHECK(layout.droppedAttributes == std::vector<std::string>({ "bogus" }));
+	CHECK(layout.GetLocation("texcoord_0") == static_cast<uint32_t>(VertexSemantic::Texcoord0));
+	CHECK(layout.GetLocation("texcoord_2") == static_cast<uint32_t>(VertexSemantic::Count) + 2);
+	CHECK(layout.GetLocation("tangent") == ~0u && layout.GetLocation("bogus") == ~0u);
+	CHECK(layout.HasSemantic(VertexSemantic::Color0) && !layout.HasSemantic(VertexSemantic::Tangent));
+	CHECK(layout.attributes.size() == expected.size());
+
+	// Bindings carry the stride of the stream they read, positions alone and tightly packed
+	CHECK(layout.bindings.size() == 2);
+	const AccessorView* streams[] = { &layout.positionStream, &layout.attributeStream };
+	uint32_t strides[2] = { 0, 0 };
+	for (const VkVertexInputBindingDescription& binding : layout.bindings)
+	{
+		CHECK(binding.binding < 2 && binding.stride == streams[binding.binding]->stride && binding.inputRate == VK_VERTEX_INPUT_RATE_VERTEX);
+		strides[binding.binding & 1] = binding.stride;
+	}
+	CHECK(strides[VertexLayout::kPositionBinding] == GetFormatSize(VK_FORMAT_R32G32B32_SFLOAT));
+	CHECK(layout.attributeStream.count == vertexCount);
+
+	// Offsets are 4 byte aligned and every attribute fits its binding's stride without overlapping another one
+	std::set<uint32_t> locations;
+	std::vector<std::pair<uint32_t, uint32_t>> ranges;
+	for (const VkVertexInputAttributeDescription& attribute : layout.attributes)
+	{
+		CHECK(locations.insert(attribute.location).second);
+		CHECK(attribute.offset % 4 == 0);
+		CHECK(attribute.offset + GetFormatSize(attribute.format) <= strides[attribute.binding]);
+		if (attribute.binding == VertexLayout::kAttributeBinding)
+		{
+			ranges.emplace_back(attribute.offset, attribute.offset + GetFormatSize(attribute.format));
+		}
+	}
+	std::sort(ranges.begin(), ranges.end());
+	for (size_t i = 1; i < ranges.size(); ++i)
+	{
+		CHECK(ranges[i - 1].second <= ranges[i].first);
+	}
+
+	// Fetching what the descriptions say returns the source elements, so do the SubMesh views that now alias the streams
+	for (const auto& element : expected)
+	{
+		const VkVertexInputAttributeDescription* attribute = FindAttribute(layout, layout.GetLocation(element.first));
+		CHECK(attribute != nullptr);
+		if (!attribute)
+		{
+			continue;
+		}
+
+		const uint32_t size = GetFormatSize(attribute->format);
+		const AccessorView& stream = *streams[attribute->binding];
+		const AccessorView& view = subMesh.vertexBuffers[element.first];
+		bool fetched = view.count == vertexCount && view.format == attribute->format;
+		for (uint32_t i = 0; fetched && i < vertexCount; ++i)
+		{
+			const uint8_t* source = element.second.data() + static_cast<size_t>(i) * size;
+			fetched = std::memcmp(stream.Data() + static_cast<size_t>(i) * strides[attribute->binding] + attribute->offset, source, size) == 0
+				&& std::memcmp(view.At(i), source, size) == 0;
+		}
+		CHECK(fetched);
+	}
+
+	std::cout << "  " << layout.attributes.size() << " attributes, interleaved stride " << layout.attributeStream.stride << " bytes, "
+		<< layout.extraAttributes.size() << " without a semantic" << std::endl;
+}
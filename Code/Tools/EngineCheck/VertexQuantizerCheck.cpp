@@ -0,0 +1,125 @@
+#include "EngineCheck.h"
+#include "CheckMeshes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Geometry/MeshUtils.h"
+#include "Geometry/VertexQuantizer.h"
+#include "Render/VertexLayout.h"
+#include "Scene/Mesh.h"
+
+/**
+ * @brief Largest angle in degrees between the source directions and the decoded octahedral ones
+ */
+static float GetOctahedralError(const std::vector<glm::vec3>& directions, const AccessorView& view)
+{
+	float largest = 0.0f;
+	for (uint32_t v = 0; v < view.count; ++v)
+	{
+		const glm::vec4 encoded = MeshUtils::DecodeElement(view.format, view.At(v));
+		const glm::vec3 decoded = VertexQuantizer::DecodeOctahedral(glm::vec2(encoded.x, encoded.y));
+		// The chord keeps its precision for small angles where acos of the dot product does not
+		const float chord = glm::length(decoded - glm::normalize(directions[v]));
+		largest = std::max(largest, 2.0f * std::asin(std::min(1.0f, chord * 0.5f)) * 57.2957795f);
+	}
+	return largest;
+}
+
+void CheckVertexQuantizer()
+{
+	// Directions over the whole sphere, both octahedral hemispheres and the folded edges
+	std::mt19937 random(3);
+	std::normal_distribution<float> gaussian;
+	std::vector<glm::vec3> directions;
+	for (uint32_t i = 0; i < 20000; ++i)
+	{
+		directions.push_back(glm::normalize(glm::vec3(gaussian(random), gaussian(random), gaussian(random))));
+	}
+	for (const glm::vec3 axis : { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1), glm::vec3(-1, -1, -1) })
+	{
+		directions.push_back(glm::normalize(axis));
+	}
+
+	float exactError = 0.0f;
+	for (const glm::vec3& direction : directions)
+	{
+		exactError = std::max(exactError, glm::length(VertexQuantizer::DecodeOctahedral(VertexQuantizer::EncodeOctahedral(direction)) - direction));
+	}
+	CHECK(exactError < 1e-5f);
+
+	// Grid positions, normals, texture coordinates and tangents, one texture coordinate set wraps and stays float
+	SubMesh source = MakeGridSubMesh(64, 64);
+	const uint32_t vertexCount = source.vertexCount;
+	std::vector<glm::vec3> normals(directions.begin(), directions.begin() + vertexCount);
+	std::vector<glm::vec4> tangents(vertexCount);
+	std::vector<glm::vec2> wrapped(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		tangents[v] = glm::vec4(directions[vertexCount + v], v % 3 ? 1.0f : -1.0f);
+		wrapped[v] = glm::vec2(v * 0.01f, -0.5f);
+	}
+	source.vertexBuffers["normal"] = MakeAccessorView(normals, VK_FORMAT_R32G32B32_SFLOAT);
+	source.vertexBuffers["tangent"] = MakeAccessorView(tangents, VK_FORMAT_R32G32B32A32_SFLOAT);
+	source.vertexBuffers["texcoord_1"] = MakeAccessorView(wrapped, VK_FORMAT_R32G32_SFLOAT);
+
+	std::vector<glm::vec3> positions;
+	CHECK(MeshUtils::ReadPositions(source, positions));
+	glm::vec3 minimum = positions[0];
+	glm::vec3 maximum = positions[0];
+	for (const glm::vec3& position : positions)
+	{
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+	const PositionQuantization quantization = PositionQuantization::FromBounds(minimum, maximum);
+	CHECK(quantization.IsValid());
+
+	const AccessorView& texcoords = source.vertexBuffers["texcoord_0"];
+	float octahedralErrors[2] = { 0.0f, 0.0f };
+	for (uint32_t octahedralBits : { 8u, 16u })
+	{
+		SubMesh subMesh = source;
+		VertexQuantizer::Quantize(subMesh, quantization, octahedralBits);
+		const bool wide = octahedralBits > 8;
+		const AccessorView& position = subMesh.vertexBuffers["position"];
+		const AccessorView& normal = subMesh.vertexBuffers["normal"];
+		const AccessorView& tangent = subMesh.vertexBuffers["tangent"];
+		const AccessorView& texcoord = subMesh.vertexBuffers["texcoord_0"];
+		CHECK(position.format == VK_FORMAT_R16G16B16A16_SNORM && position.count == vertexCount);
+		CHECK(normal.format == (wide ? VK_FORMAT_R16G16_SNORM : VK_FORMAT_R8G8_SNORM));
+		CHECK(tangent.format == (wide ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R8G8B8A8_SNORM));
+		CHECK(texcoord.format == VK_FORMAT_R16G16_UNORM);
+		CHECK(subMesh.vertexBuffers["texcoord_1"].format == VK_FORMAT_R32G32_SFLOAT);
+		CHECK(subMesh.octahedralMask == ((1u << static_cast<uint32_t>(VertexSemantic::Normal)) | (1u << static_cast<uint32_t>(VertexSemantic::Tangent))));
+
+		// Positions dequantize to within half a step of the shared scale on every axis, texture coordinates likewise
+		float positionError = 0.0f;
+		float texcoordError = 0.0f;
+		bool handedness = true;
+		for (uint32_t v = 0; v < vertexCount; ++v)
+		{
+			const glm::vec3 dequantized = quantization.offset + quantization.scale * glm::vec3(MeshUtils::DecodeElement(position.format, position.At(v)));
+			const glm::vec3 positionDelta = glm::abs(dequantized - positions[v]);
+			positionError = std::max(positionError, std::max(std::max(positionDelta.x, positionDelta.y), positionDelta.z));
+
+			const glm::vec4 quantizedTexcoord = MeshUtils::DecodeElement(texcoord.format, texcoord.At(v));
+			const glm::vec4 sourceTexcoord = MeshUtils::DecodeElement(texcoords.format, texcoords.At(v));
+			texcoordError = std::max(texcoordError, std::max(std::fabs(quantizedTexcoord.x - sourceTexcoord.x), std::fabs(quantizedTexcoord.y - sourceTexcoord.y)));
+
+			handedness = handedness && (MeshUtils::DecodeElement(tangent.format, tangent.At(v)).w < 0.0f) == (tangents[v].w < 0.0f);
+		}
+		CHECK(positionError <= quantization.scale * 0.5f / 32767.0f * 1.01f);
+		CHECK(texcoordError <= 0.5f / 65535.0f * 1.01f);
+		CHECK(handedness);
+
+		float& octahedralError = octahedralErrors[wide ? 1 : 0];
+		octahedralError = std::max(GetOctahedralError(normals, normal), GetOctahedralError(std::vector<glm::vec3>(directions.begin() + vertexCount, directions.end()), tangent));
+		CHECK(octahedralError < (wide ? 0.005f : 1.0f));
+	}
+
+	std::cout << "  octahedral error 8 bits " << octahedralErrors[0] << " deg, 16 bits " << octahedralErrors[1] << " deg" << std::endl;
+}